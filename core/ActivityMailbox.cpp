@@ -0,0 +1,74 @@
+// ==============================================================================
+// WeaR-studio ActivityMailbox Implementation
+// ==============================================================================
+
+#include "ActivityMailbox.h"
+
+namespace WeaR {
+
+ActivityMailbox::ActivityMailbox(int intervalMs, QObject* parent)
+    : QObject(parent)
+{
+    // Started by the first post()
+    m_timer = new QTimer(this);
+    m_timer->setInterval(intervalMs);
+    connect(m_timer, &QTimer::timeout, this, &ActivityMailbox::flush);
+
+    m_interval.start();
+}
+
+ActivityMailbox::~ActivityMailbox() = default;
+
+ActivitySummary ActivityMailbox::take() {
+    ActivitySummary summary;
+    summary.count = m_count.exchange(0, std::memory_order_relaxed);
+    summary.bytes = m_bytes.exchange(0, std::memory_order_relaxed);
+    summary.flagged = m_flagged.exchange(0, std::memory_order_relaxed);
+    summary.lastValue = m_lastValue.load(std::memory_order_relaxed);
+    summary.intervalMs = m_interval.restart();
+    return summary;
+}
+
+void ActivityMailbox::setEnabled(bool enabled) {
+    if (m_enabled.exchange(enabled) == enabled) return;
+
+    // The timer stops on its next idle or disabled flush; enabling
+    // restarts it if events are waiting
+    if (enabled) {
+        QMetaObject::invokeMethod(this, [this]() {
+            take();
+            m_armed = false;
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ActivityMailbox::arm() {
+    if (!m_enabled) {
+        m_armed = false;
+        return;
+    }
+    if (!m_timer->isActive()) {
+        m_interval.restart();
+        m_timer->start();
+    }
+}
+
+void ActivityMailbox::flush() {
+    // Idle or disabled: stop until the next post() re-arms the timer
+    if (m_count.load() == 0 || !m_enabled) {
+        m_timer->stop();
+        m_armed = false;
+
+        // An event posted before disarming saw the timer as armed
+        if (m_count.load() > 0 && m_enabled && !m_armed.exchange(true)) {
+            arm();
+        }
+        return;
+    }
+
+    const ActivitySummary summary = take();
+    m_delivered++;
+    emit summaryReady(summary);
+}
+
+} // namespace WeaR
@@ -0,0 +1,123 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio ActivityMailbox
+// Lock-free event counters delivered as rate-limited summaries
+// ==============================================================================
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <cstdint>
+
+namespace WeaR {
+
+/**
+ * @brief Aggregate of the events posted since the previous summary
+ */
+struct ActivitySummary {
+    int64_t count = 0;          ///< Events in this interval
+    int64_t bytes = 0;          ///< Sum of event sizes
+    int64_t flagged = 0;        ///< Events posted with the flag set (e.g. keyframes)
+    int64_t lastValue = 0;      ///< Value of the most recent event (e.g. PTS)
+    int64_t intervalMs = 0;     ///< Time covered by this summary
+};
+
+/**
+ * @brief Coalesces high-rate notifications for the GUI thread
+ *
+ * Worker threads post() per packet or per frame; this only touches a few
+ * atomics and never allocates. A timer on the mailbox's own thread drains
+ * the counters and emits one summaryReady() per interval, and only if
+ * something happened. The timer stops after an interval without events,
+ * and the first post() after that queues one event to restart it, so an
+ * idle or disabled mailbox costs no wakeups.
+ *
+ * The counters are drained one at a time, so an event racing with a
+ * drain may be split across two summaries; nothing is lost.
+ */
+class ActivityMailbox : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Create a mailbox delivering on the calling thread
+     * @param intervalMs Summary interval (100 ms = 10 Hz)
+     */
+    explicit ActivityMailbox(int intervalMs = 100, QObject* parent = nullptr);
+    ~ActivityMailbox() override;
+
+    /**
+     * @brief Record one event (lock-free, any thread)
+     * @param bytes Size of the event
+     * @param flagged Count the event as flagged
+     * @param value Value reported as lastValue
+     */
+    void post(int64_t bytes = 0, bool flagged = false, int64_t value = 0) noexcept {
+        m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (flagged) {
+            m_flagged.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_lastValue.store(value, std::memory_order_relaxed);
+        m_posted.fetch_add(1, std::memory_order_relaxed);
+
+        // Ordered against flush() disarming, so a stopped timer is always restarted
+        m_count.fetch_add(1);
+        if (!m_armed.load() && m_enabled.load(std::memory_order_relaxed) && !m_armed.exchange(true)) {
+            QMetaObject::invokeMethod(this, &ActivityMailbox::arm, Qt::QueuedConnection);
+        }
+    }
+
+    /**
+     * @brief Enable or disable delivery (any thread)
+     *
+     * Owners disable the mailbox while nothing is connected to the signal
+     * they relay summaries to. Events are still counted, but no timer
+     * runs; enabling drops what was counted in the meantime.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Drain the counters without waiting for the timer
+     */
+    ActivitySummary take();
+
+    /**
+     * @brief Total events posted
+     */
+    [[nodiscard]] int64_t postedCount() const { return m_posted.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Total summaries emitted
+     *
+     * postedCount() / deliveredCount() is the reduction in cross-thread
+     * notifications compared to signalling every event.
+     */
+    [[nodiscard]] int64_t deliveredCount() const { return m_delivered; }
+
+signals:
+    /**
+     * @brief Emitted at most once per interval when events were posted
+     */
+    void summaryReady(const WeaR::ActivitySummary& summary);
+
+private slots:
+    void flush();
+    void arm();
+
+private:
+    QTimer* m_timer = nullptr;
+    QElapsedTimer m_interval;
+    std::atomic<bool> m_armed{false};      ///< Timer running or about to start
+    std::atomic<bool> m_enabled{true};
+
+    std::atomic<int64_t> m_count{0};
+    std::atomic<int64_t> m_bytes{0};
+    std::atomic<int64_t> m_flagged{0};
+    std::atomic<int64_t> m_lastValue{0};
+    std::atomic<int64_t> m_posted{0};
+    int64_t m_delivered = 0;
+};
+
+} // namespace WeaR
@@ -0,0 +1,229 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio BondedProtocol
+// Wire format shared by BondedTransport (sender) and BondedReceiver
+// ==============================================================================
+
+#include <QByteArray>
+#include <QString>
+#include <QtEndian>
+
+#include <cstdint>
+
+namespace WeaR {
+
+/**
+ * @brief Bonded link message types
+ *
+ * Every link is a TCP connection carrying length-prefixed messages:
+ * [type u8][payload length u32][payload]. All integers are big-endian.
+ * - Hello (sender, first on each link): magic, version, session id,
+ *   link index, target URL, shared secret
+ * - Data (sender): sequence number, send time, stream bytes
+ * - Ack (receiver, one per Data on the same link): Data messages
+ *   received on the link so far, echoed send time
+ * - Bye (sender, on every link at the end): number of chunks in the stream
+ */
+enum class BondedMessageType : uint8_t {
+    Hello = 1,
+    Data = 2,
+    Ack = 3,
+    Bye = 4
+};
+
+constexpr quint16 kBondedDefaultPort = 7935;
+constexpr uint32_t kBondedMagic = 0x57424E44;          ///< "WBND"
+constexpr uint8_t kBondedVersion = 2;                  ///< 2: Hello carries the shared secret
+constexpr int kBondedHeaderSize = 5;                   ///< Type + payload length
+constexpr int kBondedMaxPayload = 1024 * 1024;         ///< Larger lengths are a protocol error
+
+/**
+ * @brief One decoded message
+ */
+struct BondedMessage {
+    BondedMessageType type = BondedMessageType::Data;
+    QByteArray payload;
+};
+
+namespace detail {
+
+inline void appendU8(QByteArray& out, uint8_t value) {
+    out.append(static_cast<char>(value));
+}
+
+inline void appendU16(QByteArray& out, uint16_t value) {
+    const uint16_t be = qToBigEndian(value);
+    out.append(reinterpret_cast<const char*>(&be), sizeof(be));
+}
+
+inline void appendU32(QByteArray& out, uint32_t value) {
+    const uint32_t be = qToBigEndian(value);
+    out.append(reinterpret_cast<const char*>(&be), sizeof(be));
+}
+
+inline void appendU64(QByteArray& out, uint64_t value) {
+    const uint64_t be = qToBigEndian(value);
+    out.append(reinterpret_cast<const char*>(&be), sizeof(be));
+}
+
+template <typename T>
+T readBE(const QByteArray& in, int offset) {
+    return qFromBigEndian<T>(in.constData() + offset);
+}
+
+} // namespace detail
+
+/**
+ * @brief Frame a payload
+ */
+inline QByteArray encodeBondedMessage(BondedMessageType type, const QByteArray& payload) {
+    QByteArray out;
+    out.reserve(kBondedHeaderSize + payload.size());
+    detail::appendU8(out, static_cast<uint8_t>(type));
+    detail::appendU32(out, static_cast<uint32_t>(payload.size()));
+    out.append(payload);
+    return out;
+}
+
+/**
+ * @brief Take the next complete message off a receive buffer
+ * @param buffer Bytes received so far (consumed on success)
+ * @param message Decoded message
+ * @param error Set on an invalid type or length
+ * @return true if a message was taken
+ */
+inline bool takeBondedMessage(QByteArray& buffer, BondedMessage& message, bool& error) {
+    error = false;
+    if (buffer.size() < kBondedHeaderSize) return false;
+
+    const uint8_t type = static_cast<uint8_t>(buffer[0]);
+    const uint32_t length = detail::readBE<uint32_t>(buffer, 1);
+    if (type < static_cast<uint8_t>(BondedMessageType::Hello) ||
+        type > static_cast<uint8_t>(BondedMessageType::Bye) ||
+        length > static_cast<uint32_t>(kBondedMaxPayload)) {
+        error = true;
+        return false;
+    }
+    if (buffer.size() < kBondedHeaderSize + static_cast<qsizetype>(length)) return false;
+
+    message.type = static_cast<BondedMessageType>(type);
+    message.payload = buffer.mid(kBondedHeaderSize, length);
+    buffer.remove(0, kBondedHeaderSize + length);
+    return true;
+}
+
+/**
+ * @brief Hello: opens a link of a session
+ */
+struct BondedHello {
+    uint64_t sessionId = 0;
+    uint8_t linkIndex = 0;
+    QString url;                ///< Where the receiver should forward the stream
+    QByteArray secret;          ///< Shared secret configured on the receiver
+
+    [[nodiscard]] QByteArray encode() const {
+        const QByteArray utf8 = url.toUtf8();
+        QByteArray out;
+        detail::appendU32(out, kBondedMagic);
+        detail::appendU8(out, kBondedVersion);
+        detail::appendU64(out, sessionId);
+        detail::appendU8(out, linkIndex);
+        detail::appendU16(out, static_cast<uint16_t>(utf8.size()));
+        out.append(utf8);
+        detail::appendU16(out, static_cast<uint16_t>(secret.size()));
+        out.append(secret);
+        return encodeBondedMessage(BondedMessageType::Hello, out);
+    }
+
+    static bool decode(const QByteArray& payload, BondedHello& hello) {
+        if (payload.size() < 16) return false;
+        if (detail::readBE<uint32_t>(payload, 0) != kBondedMagic) return false;
+        if (static_cast<uint8_t>(payload[4]) != kBondedVersion) return false;
+        hello.sessionId = detail::readBE<uint64_t>(payload, 5);
+        hello.linkIndex = static_cast<uint8_t>(payload[13]);
+        const uint16_t urlSize = detail::readBE<uint16_t>(payload, 14);
+        if (payload.size() < 16 + urlSize + 2) return false;
+        hello.url = QString::fromUtf8(payload.constData() + 16, urlSize);
+        const int secretOffset = 16 + urlSize;
+        const uint16_t secretSize = detail::readBE<uint16_t>(payload, secretOffset);
+        if (payload.size() < secretOffset + 2 + secretSize) return false;
+        hello.secret = payload.mid(secretOffset + 2, secretSize);
+        return true;
+    }
+};
+
+/**
+ * @brief Data: one chunk of the stream
+ */
+struct BondedData {
+    uint64_t sequence = 0;
+    uint64_t sendTimeUs = 0;    ///< Sender clock, echoed in the Ack
+    QByteArray bytes;
+
+    static constexpr int kPrefixSize = 16;
+
+    /**
+     * @brief Encode without building the message twice (bytes stay shared)
+     */
+    static QByteArray encode(uint64_t sequence, uint64_t sendTimeUs, const QByteArray& bytes) {
+        QByteArray out;
+        out.reserve(kBondedHeaderSize + kPrefixSize + bytes.size());
+        detail::appendU8(out, static_cast<uint8_t>(BondedMessageType::Data));
+        detail::appendU32(out, static_cast<uint32_t>(kPrefixSize + bytes.size()));
+        detail::appendU64(out, sequence);
+        detail::appendU64(out, sendTimeUs);
+        out.append(bytes);
+        return out;
+    }
+
+    static bool decode(const QByteArray& payload, BondedData& data) {
+        if (payload.size() < kPrefixSize) return false;
+        data.sequence = detail::readBE<uint64_t>(payload, 0);
+        data.sendTimeUs = detail::readBE<uint64_t>(payload, 8);
+        data.bytes = payload.mid(kPrefixSize);
+        return true;
+    }
+};
+
+/**
+ * @brief Ack: delivery report of one link
+ */
+struct BondedAck {
+    uint64_t linkChunks = 0;    ///< Data messages received on this link
+    uint64_t echoTimeUs = 0;    ///< sendTimeUs of the newest one
+
+    [[nodiscard]] QByteArray encode() const {
+        QByteArray out;
+        detail::appendU64(out, linkChunks);
+        detail::appendU64(out, echoTimeUs);
+        return encodeBondedMessage(BondedMessageType::Ack, out);
+    }
+
+    static bool decode(const QByteArray& payload, BondedAck& ack) {
+        if (payload.size() < 16) return false;
+        ack.linkChunks = detail::readBE<uint64_t>(payload, 0);
+        ack.echoTimeUs = detail::readBE<uint64_t>(payload, 8);
+        return true;
+    }
+};
+
+/**
+ * @brief Bye: end of stream
+ */
+struct BondedBye {
+    uint64_t totalChunks = 0;   ///< Sequence numbers 0 .. totalChunks - 1 were sent
+
+    [[nodiscard]] QByteArray encode() const {
+        QByteArray out;
+        detail::appendU64(out, totalChunks);
+        return encodeBondedMessage(BondedMessageType::Bye, out);
+    }
+
+    static bool decode(const QByteArray& payload, BondedBye& bye) {
+        if (payload.size() < 8) return false;
+        bye.totalChunks = detail::readBE<uint64_t>(payload, 0);
+        return true;
+    }
+};
+
+} // namespace WeaR
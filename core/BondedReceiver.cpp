@@ -0,0 +1,557 @@
+// ==============================================================================
+// WeaR-studio BondedReceiver Implementation
+// ==============================================================================
+
+#include "BondedReceiver.h"
+#include "BondedProtocol.h"
+#include "ThreadPolicy.h"
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QMutex>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QWaitCondition>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/error.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+
+namespace WeaR {
+
+namespace {
+
+/// Compare secrets without leaking the matching prefix length through timing
+bool secretMatches(const QByteArray& presented, const QByteArray& expected) {
+    unsigned char difference = presented.size() == expected.size() ? 0 : 1;
+    for (qsizetype i = 0; i < expected.size(); ++i) {
+        const char c = i < presented.size() ? presented[i] : 0;
+        difference |= static_cast<unsigned char>(c ^ expected[i]);
+    }
+    return difference == 0;
+}
+
+/// Sender-chosen outputs may only publish to an RTMP ingest
+bool isPublishUrl(const QString& url) {
+    const QString scheme = QUrl(url).scheme().toLower();
+    return scheme == QLatin1String("rtmp") || scheme == QLatin1String("rtmps");
+}
+
+} // namespace
+
+// ==============================================================================
+// Forwarder: writes one session's stream to its output
+// ==============================================================================
+class BondedReceiver::Forwarder {
+public:
+    /**
+     * @param url Output URL
+     * @param publishOnly Restrict avio to RTMP (URL supplied by a sender)
+     */
+    Forwarder(const QString& url, bool publishOnly)
+        : m_url(url)
+        , m_publishOnly(publishOnly)
+    {
+        m_thread = std::thread(&Forwarder::run, this);
+    }
+
+    ~Forwarder() {
+        stop();
+    }
+
+    void push(const QByteArray& bytes) {
+        QMutexLocker lock(&m_mutex);
+        m_queue.push_back(bytes);
+        m_queuedBytes += bytes.size();
+        m_condition.wakeOne();
+    }
+
+    /// Write what is queued, then close the output
+    void finish() {
+        QMutexLocker lock(&m_mutex);
+        m_finishing = true;
+        m_condition.wakeOne();
+    }
+
+    /// Close the output now
+    void stop() {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_stopping = true;
+        }
+        m_condition.wakeOne();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    int64_t queuedBytes() const {
+        QMutexLocker lock(&m_mutex);
+        return m_queuedBytes;
+    }
+
+    bool failed() const { return m_failed; }
+    bool done() const { return m_done; }
+    bool isOpen() const { return m_open; }
+    int64_t bytesForwarded() const { return m_bytesForwarded; }
+
+private:
+    static int interrupt(void* opaque) {
+        return static_cast<Forwarder*>(opaque)->m_stopping ? 1 : 0;
+    }
+
+    void run() {
+        ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Network, QStringLiteral("WeaR bond forward"));
+
+        AVDictionary* options = nullptr;
+        av_dict_set(&options, "rtmp_live", "live", 0);
+        av_dict_set(&options, "timeout", "10000000", 0);
+        if (m_publishOnly) {
+            av_dict_set(&options, "protocol_whitelist", "rtmp,rtmps,tcp,tls", 0);
+        }
+
+        // The stream is FLV already; rtmp:// publishes it tag by tag
+        AVIOInterruptCB interruptCallback{&Forwarder::interrupt, this};
+        AVIOContext* output = nullptr;
+        int ret = avio_open2(&output, m_url.toUtf8().constData(), AVIO_FLAG_WRITE,
+                             &interruptCallback, &options);
+        av_dict_free(&options);
+
+        if (ret < 0) {
+            char errbuf[256];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            qCritical() << "Bond receiver cannot open" << m_url << ":" << errbuf;
+            m_failed = true;
+            m_done = true;
+            return;
+        }
+        m_open = true;
+
+        while (true) {
+            QByteArray bytes;
+            {
+                QMutexLocker lock(&m_mutex);
+                while (m_queue.empty() && !m_finishing && !m_stopping) {
+                    m_condition.wait(&m_mutex);
+                }
+                if (m_stopping || m_queue.empty()) break;
+
+                bytes = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_queuedBytes -= bytes.size();
+            }
+
+            avio_write(output, reinterpret_cast<const unsigned char*>(bytes.constData()), bytes.size());
+            avio_flush(output);
+            if (output->error < 0) {
+                char errbuf[256];
+                av_strerror(output->error, errbuf, sizeof(errbuf));
+                qCritical() << "Bond receiver output failed:" << errbuf;
+                m_failed = true;
+                break;
+            }
+            m_bytesForwarded += bytes.size();
+        }
+
+        avio_closep(&output);
+        m_open = false;
+        m_done = true;
+    }
+
+    QString m_url;
+    bool m_publishOnly = true;
+    std::thread m_thread;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    std::deque<QByteArray> m_queue;
+    int64_t m_queuedBytes = 0;
+    bool m_finishing = false;
+
+    std::atomic<bool> m_stopping{false};
+    std::atomic<bool> m_failed{false};
+    std::atomic<bool> m_done{false};
+    std::atomic<bool> m_open{false};
+    std::atomic<int64_t> m_bytesForwarded{0};
+};
+
+// ==============================================================================
+// Construction
+// ==============================================================================
+BondedReceiver::BondedReceiver(QObject* parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_checkTimer(new QTimer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &BondedReceiver::onNewConnection);
+    connect(m_checkTimer, &QTimer::timeout, this, &BondedReceiver::checkSessions);
+}
+
+BondedReceiver::~BondedReceiver() {
+    close();
+}
+
+bool BondedReceiver::listen(const BondedReceiverSettings& settings) {
+    close();
+    m_settings = settings;
+
+    const QHostAddress address = settings.listenAddress.isEmpty()
+        ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(settings.listenAddress);
+    if (address.isNull()) {
+        qWarning() << "Bond receiver: invalid listen address" << settings.listenAddress;
+        return false;
+    }
+
+    // Anyone who can reach the port could otherwise publish through it
+    if (!address.isLoopback() && settings.secret.isEmpty()) {
+        qWarning() << "Bond receiver: a secret is required to listen on" << address.toString();
+        return false;
+    }
+
+    if (!m_server->listen(address, settings.port)) {
+        qWarning() << "Bond receiver cannot listen on port" << settings.port << ":" << m_server->errorString();
+        return false;
+    }
+
+    m_checkTimer->start(kCheckIntervalMs);
+    qDebug() << "Bond receiver listening on" << m_server->serverAddress().toString()
+             << "port" << m_server->serverPort();
+    return true;
+}
+
+void BondedReceiver::close() {
+    m_checkTimer->stop();
+    m_server->close();
+
+    for (auto& entry : m_sessions) {
+        endSession(entry.second.get(), QStringLiteral("Receiver closed"));
+    }
+    reapSessions();
+
+    // Pending links that never sent a Hello
+    for (auto it = m_links.begin(); it != m_links.end(); ++it) {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+    m_links.clear();
+
+    m_finishing.clear();
+}
+
+QList<BondedSessionStatistics> BondedReceiver::statistics() const {
+    QList<BondedSessionStatistics> result;
+    for (const auto& entry : m_sessions) {
+        const Session* session = entry.second.get();
+        BondedSessionStatistics stats = session->stats;
+        stats.links = session->links.size();
+        stats.reorderChunks = static_cast<int>(session->reorder.size());
+        if (session->forwarder) {
+            stats.bytesForwarded = session->forwarder->bytesForwarded();
+            stats.forwarding = session->forwarder->isOpen();
+        }
+        result.append(stats);
+    }
+    return result;
+}
+
+// ==============================================================================
+// Links
+// ==============================================================================
+void BondedReceiver::onNewConnection() {
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket* socket = m_server->nextPendingConnection();
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        connect(socket, &QTcpSocket::readyRead, this, &BondedReceiver::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &BondedReceiver::onDisconnected);
+        m_links.insert(socket, LinkState());
+    }
+}
+
+void BondedReceiver::onReadyRead() {
+    auto* socket = qobject_cast<QTcpSocket*>(sender());
+    auto it = m_links.find(socket);
+    if (!socket || it == m_links.end()) return;
+
+    LinkState& state = it.value();
+    state.buffer += socket->readAll();
+
+    BondedMessage message;
+    bool error = false;
+    bool ackDue = false;
+    uint64_t echoTimeUs = 0;
+
+    while (!error && takeBondedMessage(state.buffer, message, error)) {
+        switch (message.type) {
+            case BondedMessageType::Hello: {
+                BondedHello hello;
+                if (state.session || !BondedHello::decode(message.payload, hello) ||
+                    !attachLink(socket, state, hello)) {
+                    error = true;
+                }
+                break;
+            }
+            case BondedMessageType::Data: {
+                BondedData data;
+                if (!state.session || !BondedData::decode(message.payload, data)) {
+                    error = true;
+                    break;
+                }
+                state.chunks++;
+                echoTimeUs = data.sendTimeUs;
+                ackDue = true;
+                if (!state.session->ended) {
+                    onData(state.session, data.sequence, data.bytes);
+                }
+                break;
+            }
+            case BondedMessageType::Bye: {
+                BondedBye bye;
+                if (!state.session || !BondedBye::decode(message.payload, bye)) {
+                    error = true;
+                    break;
+                }
+                Session* session = state.session;
+                session->byeReceived = true;
+                session->totalChunks = bye.totalChunks;
+                if (!session->ended && session->nextSequence >= session->totalChunks) {
+                    endSession(session, QStringLiteral("Stream ended"), true);
+                }
+                break;
+            }
+            default:
+                error = true;
+                break;
+        }
+    }
+
+    // One cumulative ack per read
+    if (ackDue && !error) {
+        socket->write(BondedAck{state.chunks, echoTimeUs}.encode());
+    }
+
+    if (error) {
+        qWarning() << "Bond receiver dropping link from" << socket->peerAddress().toString()
+                   << "(invalid or refused message)";
+        socket->abort();
+    }
+
+    reapSessions();
+}
+
+void BondedReceiver::onDisconnected() {
+    auto* socket = qobject_cast<QTcpSocket*>(sender());
+    auto it = m_links.find(socket);
+    if (!socket || it == m_links.end()) return;
+
+    if (Session* session = it.value().session) {
+        session->links.removeAll(socket);
+        if (session->links.isEmpty()) {
+            session->idleTimer.start();
+        }
+        qDebug() << "Bonded link of session" << QString::number(session->id, 16) << "closed,"
+                 << session->links.size() << "left";
+    }
+
+    m_links.erase(it);
+    socket->deleteLater();
+}
+
+BondedReceiver::Session* BondedReceiver::attachLink(QTcpSocket* socket, LinkState& state,
+                                                    const BondedHello& hello) {
+    const uint64_t sessionId = hello.sessionId;
+
+    if (!secretMatches(hello.secret, m_settings.secret.toUtf8())) {
+        qWarning() << "Bond receiver: wrong secret from" << socket->peerAddress().toString();
+        return nullptr;
+    }
+
+    // A session that ended cannot continue (its output is gone)
+    if (m_endedSessions.contains(sessionId)) return nullptr;
+
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end()) {
+        auto session = std::make_unique<Session>();
+        session->id = sessionId;
+        session->senderUrl = m_settings.forwardUrl.isEmpty();
+        session->url = session->senderUrl ? hello.url : m_settings.forwardUrl;
+        session->stats.sessionId = sessionId;
+        session->stats.url = session->url;
+        if (session->url.isEmpty()) {
+            qWarning() << "Bonded session" << QString::number(sessionId, 16) << "has no forward URL";
+            return nullptr;
+        }
+        if (session->senderUrl && !isPublishUrl(session->url)) {
+            qWarning() << "Bonded session" << QString::number(sessionId, 16)
+                       << "refused: only rtmp:// and rtmps:// outputs may be requested by a sender";
+            return nullptr;
+        }
+
+        // Publish to the ingest right away: a sender that connects ahead
+        // of go-live gets the ingest handshake done while it waits
+        session->forwarder = std::make_unique<Forwarder>(session->url, session->senderUrl);
+
+        it = m_sessions.emplace(sessionId, std::move(session)).first;
+        qDebug() << "Bonded session" << QString::number(sessionId, 16) << "started";
+        emit sessionStarted(sessionId, it->second->url);
+    }
+
+    Session* session = it->second.get();
+    if (session->ended) return nullptr;
+
+    session->links.append(socket);
+    state.session = session;
+    qDebug() << "Bonded link from" << socket->peerAddress().toString() << "joined session"
+             << QString::number(sessionId, 16) << "-" << session->links.size() << "links";
+    return session;
+}
+
+// ==============================================================================
+// Reordering
+// ==============================================================================
+void BondedReceiver::onData(Session* session, uint64_t sequence, const QByteArray& bytes) {
+    BondedSessionStatistics& stats = session->stats;
+    stats.chunksReceived++;
+
+    if (sequence < session->nextSequence || session->reorder.count(sequence)) {
+        stats.duplicates++;
+        return;
+    }
+
+    // Ahead of a gap: hold it
+    if (sequence != session->nextSequence) {
+        stats.outOfOrder++;
+        session->reorder.emplace(sequence, bytes);
+        session->reorderBytes += bytes.size();
+        stats.maxReorderChunks = std::max(stats.maxReorderChunks, static_cast<int>(session->reorder.size()));
+        if (!session->gapOpen) {
+            session->gapOpen = true;
+            session->gapTimer.start();
+        }
+        if (session->reorderBytes > m_settings.maxReorderBytes) {
+            endSession(session, QStringLiteral("Reorder buffer overflow waiting for chunk %1")
+                                    .arg(session->nextSequence));
+        }
+        return;
+    }
+
+    forward(session, bytes);
+    session->nextSequence++;
+
+    // The gap closed: release what waited behind it
+    while (!session->reorder.empty() && session->reorder.begin()->first == session->nextSequence) {
+        auto front = session->reorder.begin();
+        forward(session, front->second);
+        session->reorderBytes -= front->second.size();
+        session->reorder.erase(front);
+        session->nextSequence++;
+    }
+
+    if (session->gapOpen) {
+        stats.maxGapWaitMs = std::max(stats.maxGapWaitMs, session->gapTimer.nsecsElapsed() / 1e6);
+        session->gapOpen = !session->reorder.empty();
+        if (session->gapOpen) {
+            session->gapTimer.start();
+        }
+    }
+
+    if (session->byeReceived && session->nextSequence >= session->totalChunks) {
+        endSession(session, QStringLiteral("Stream ended"), true);
+    }
+}
+
+void BondedReceiver::forward(Session* session, const QByteArray& bytes) {
+    if (!session->forwarder) {
+        session->forwarder = std::make_unique<Forwarder>(session->url, session->senderUrl);
+    }
+    session->forwarder->push(bytes);
+}
+
+// ==============================================================================
+// Session Lifetime
+// ==============================================================================
+void BondedReceiver::endSession(Session* session, const QString& reason, bool finished) {
+    if (session->ended) return;
+    session->ended = true;
+    session->finished = finished;
+    session->endReason = reason;
+}
+
+void BondedReceiver::checkSessions() {
+    for (auto& entry : m_sessions) {
+        Session* session = entry.second.get();
+        if (session->ended) continue;
+
+        if (session->gapOpen && session->gapTimer.elapsed() > m_settings.reorderTimeoutMs) {
+            endSession(session, QStringLiteral("Chunk %1 missing for %2 ms")
+                                    .arg(session->nextSequence).arg(session->gapTimer.elapsed()));
+        } else if (session->links.isEmpty() && session->idleTimer.isValid() &&
+                   session->idleTimer.elapsed() > m_settings.idleTimeoutMs) {
+            endSession(session, QStringLiteral("All links lost"));
+        } else if (session->forwarder && session->forwarder->failed()) {
+            endSession(session, QStringLiteral("Output failed"));
+        } else if (session->forwarder && session->forwarder->queuedBytes() > m_settings.maxReorderBytes) {
+            endSession(session, QStringLiteral("Output cannot keep up"));
+        }
+    }
+    reapSessions();
+
+    // Finished outputs close on their own; collect them
+    m_finishing.erase(std::remove_if(m_finishing.begin(), m_finishing.end(),
+                                     [](const std::unique_ptr<Forwarder>& forwarder) {
+                                         return forwarder->done();
+                                     }),
+                      m_finishing.end());
+}
+
+void BondedReceiver::reapSessions() {
+    for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+        Session* session = it->second.get();
+        if (!session->ended) {
+            ++it;
+            continue;
+        }
+
+        for (QTcpSocket* socket : session->links) {
+            m_links.remove(socket);
+            socket->disconnect(this);
+            if (session->finished) {
+                socket->disconnectFromHost();
+            } else {
+                socket->abort();
+            }
+            socket->deleteLater();
+        }
+
+        if (session->forwarder) {
+            if (session->finished) {
+                session->forwarder->finish();
+                m_finishing.push_back(std::move(session->forwarder));
+            } else {
+                session->forwarder->stop();
+            }
+        }
+
+        const uint64_t id = session->id;
+        const QString reason = session->endReason;
+        const BondedSessionStatistics& stats = session->stats;
+        qDebug() << "Bonded session" << QString::number(id, 16) << "ended:" << reason
+                 << "- chunks" << stats.chunksReceived << "duplicates" << stats.duplicates
+                 << "out of order" << stats.outOfOrder << "max gap wait" << stats.maxGapWaitMs << "ms";
+
+        m_endedSessions.insert(id);
+        it = m_sessions.erase(it);
+        emit sessionEnded(id, reason);
+    }
+}
+
+} // namespace WeaR
@@ -0,0 +1,168 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio BondedReceiver
+// Reassembles bonded uplink streams and forwards them to the ingest
+// ==============================================================================
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+namespace WeaR {
+
+struct BondedHello;
+
+/**
+ * @brief Bond receiver configuration
+ */
+struct BondedReceiverSettings {
+    QString listenAddress;              ///< Address to listen on (empty = loopback only)
+    quint16 port = 7935;                ///< Port the senders connect to
+    QString secret;                     ///< Shared secret senders must present (required off loopback)
+    QString forwardUrl;                 ///< Output for every session (empty = rtmp(s) URL sent by the sender)
+    int reorderTimeoutMs = 5000;        ///< Wait for a missing chunk (longer than the sender's linkTimeoutMs)
+    int64_t maxReorderBytes = 32LL * 1024 * 1024; ///< Chunks held behind a gap (and unsent output)
+    int idleTimeoutMs = 10000;          ///< Session without any link for this long ends
+};
+
+/**
+ * @brief State of one bonded session
+ */
+struct BondedSessionStatistics {
+    uint64_t sessionId = 0;
+    QString url;                        ///< Forward target
+    int links = 0;                      ///< Links currently connected
+    int64_t chunksReceived = 0;         ///< Data messages, duplicates included
+    int64_t duplicates = 0;             ///< Chunks received twice (resent after a link failure)
+    int64_t outOfOrder = 0;             ///< Chunks that arrived ahead of a gap
+    int reorderChunks = 0;              ///< Chunks waiting behind a gap now
+    int maxReorderChunks = 0;           ///< Most chunks ever waiting
+    double maxGapWaitMs = 0.0;          ///< Longest wait for a missing chunk
+    int64_t bytesForwarded = 0;         ///< Stream bytes written to the output
+    bool forwarding = false;            ///< Output opened
+};
+
+/**
+ * @brief Receiving end of BondedTransport
+ *
+ * Accepts the links of any number of sessions (grouped by the session id
+ * in their Hello), acknowledges every chunk on the link that carried it,
+ * restores the chunk order in a reorder buffer and writes the contiguous
+ * stream to the forward URL through FFmpeg's avio on a per-session
+ * thread. The stream is the sender's FLV muxer output, which FFmpeg's
+ * rtmp:// protocol publishes as is; a file: forwardUrl records it
+ * instead, which is handy for loopback tests.
+ *
+ * Links must present the configured secret in their Hello, and a
+ * receiver reachable from other hosts refuses to start without one. A
+ * forward URL chosen by the sender is only accepted for rtmp/rtmps, and
+ * avio is limited to the protocols those need, so a sender cannot make
+ * the receiver write files or start programs; only forwardUrl, set by
+ * whoever runs the receiver, may use other protocols.
+ *
+ * Chunks are never skipped: a gap that is not filled within
+ * reorderTimeoutMs ends the session, and the sender starts a new one.
+ * Links of an ended session are refused.
+ *
+ * Lives on the thread that created it (it needs an event loop).
+ */
+class BondedReceiver : public QObject {
+    Q_OBJECT
+
+public:
+    explicit BondedReceiver(QObject* parent = nullptr);
+    ~BondedReceiver() override;
+
+    /**
+     * @brief Start accepting links
+     * @return true if listening
+     */
+    bool listen(const BondedReceiverSettings& settings);
+
+    /**
+     * @brief End all sessions and stop listening
+     */
+    void close();
+
+    /**
+     * @brief Get statistics of the active sessions
+     */
+    [[nodiscard]] QList<BondedSessionStatistics> statistics() const;
+
+signals:
+    /**
+     * @brief Emitted when the first link of a session arrives
+     */
+    void sessionStarted(quint64 sessionId, const QString& url);
+
+    /**
+     * @brief Emitted when a session ends
+     * @param reason Why (sender finished, gap timeout, output failure, ...)
+     */
+    void sessionEnded(quint64 sessionId, const QString& reason);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void checkSessions();
+
+private:
+    class Forwarder;
+
+    struct Session {
+        uint64_t id = 0;
+        QString url;
+        bool senderUrl = false;         ///< url came from the sender's Hello, not forwardUrl
+        QList<QTcpSocket*> links;
+        std::map<uint64_t, QByteArray> reorder; ///< Chunks behind a gap, by sequence
+        int64_t reorderBytes = 0;
+        uint64_t nextSequence = 0;
+        bool gapOpen = false;
+        QElapsedTimer gapTimer;         ///< Since the current gap opened
+        QElapsedTimer idleTimer;        ///< Since the last link dropped
+        bool byeReceived = false;
+        uint64_t totalChunks = 0;
+        bool ended = false;
+        bool finished = false;          ///< Ended by the sender (flush the output)
+        QString endReason;
+        std::unique_ptr<Forwarder> forwarder;
+        BondedSessionStatistics stats;
+    };
+
+    struct LinkState {
+        QByteArray buffer;
+        Session* session = nullptr;
+        uint64_t chunks = 0;            ///< Data messages received on this link
+    };
+
+    Session* attachLink(QTcpSocket* socket, LinkState& state, const BondedHello& hello);
+    void onData(Session* session, uint64_t sequence, const QByteArray& bytes);
+    void forward(Session* session, const QByteArray& bytes);
+    void endSession(Session* session, const QString& reason, bool finished = false);
+    void reapSessions();
+
+    BondedReceiverSettings m_settings;
+    QTcpServer* m_server = nullptr;
+    QTimer* m_checkTimer = nullptr;
+    QHash<QTcpSocket*, LinkState> m_links;
+    std::map<uint64_t, std::unique_ptr<Session>> m_sessions;
+    QSet<uint64_t> m_endedSessions;
+    std::vector<std::unique_ptr<Forwarder>> m_finishing; ///< Flushing outputs of finished sessions
+
+    static constexpr int kCheckIntervalMs = 100;
+};
+
+} // namespace WeaR
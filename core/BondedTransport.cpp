@@ -0,0 +1,541 @@
+// ==============================================================================
+// WeaR-studio BondedTransport Implementation
+// ==============================================================================
+
+#include "BondedTransport.h"
+#include "BondedProtocol.h"
+#include "ThreadPolicy.h"
+
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QHostAddress>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+
+#include <algorithm>
+#include <vector>
+
+namespace WeaR {
+
+BondedTransport::BondedTransport(const BondedSettings& settings)
+    : m_settings(settings)
+{
+    m_settings.chunkBytes = std::clamp(m_settings.chunkBytes, 1024, kBondedMaxPayload - BondedData::kPrefixSize);
+    m_clock.start();
+}
+
+BondedTransport::~BondedTransport() {
+    stopThreads();
+}
+
+// ==============================================================================
+// Session
+// ==============================================================================
+bool BondedTransport::open(const QString& targetUrl, int timeoutMs) {
+    if (m_running) return false;
+    if (m_settings.receiverHost.isEmpty()) {
+        qWarning() << "No bond receiver configured";
+        return false;
+    }
+
+    m_targetUrl = targetUrl;
+    m_sessionId = QRandomGenerator::global()->generate64() | 1;
+
+    QList<BondedLinkSettings> links = m_settings.links;
+    if (links.isEmpty()) {
+        links.append(BondedLinkSettings{QStringLiteral("Default"), QString(), 0});
+    }
+
+    m_running = true;
+    for (int i = 0; i < links.size(); ++i) {
+        auto link = std::make_unique<Link>();
+        link->settings = links[i];
+        link->index = i;
+        link->stats.name = links[i].name.isEmpty() ? QStringLiteral("Link %1").arg(i + 1) : links[i].name;
+        m_links.push_back(std::move(link));
+    }
+    for (auto& link : m_links) {
+        link->thread = std::thread(&BondedTransport::linkLoop, this, link.get());
+    }
+
+    // The first link is enough to start; the others join as they come up
+    int up = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        QDeadlineTimer deadline(timeoutMs);
+        while (!anyLinkUpLocked() && !deadline.hasExpired()) {
+            m_writeCondition.wait(&m_mutex, deadline);
+        }
+        for (const auto& link : m_links) {
+            if (link->up) up++;
+        }
+    }
+
+    if (up == 0) {
+        qWarning() << "No bonded link reached" << m_settings.receiverHost << "port" << m_settings.receiverPort;
+        stopThreads();
+        return false;
+    }
+
+    qDebug() << "Bonded session" << QString::number(m_sessionId, 16) << "started with"
+             << up << "of" << m_links.size() << "links up";
+    return true;
+}
+
+bool BondedTransport::write(const uint8_t* data, int size) {
+    if (size <= 0) return true;
+
+    QMutexLocker lock(&m_mutex);
+    if (!m_running || m_closing) return false;
+
+    for (int offset = 0; offset < size; offset += m_settings.chunkBytes) {
+        Chunk chunk;
+        chunk.sequence = m_nextSequence++;
+        chunk.bytes = QByteArray(reinterpret_cast<const char*>(data) + offset,
+                                 std::min(m_settings.chunkBytes, size - offset));
+        m_pending.push_back(std::move(chunk));
+    }
+    dispatchLocked();
+
+    // Backpressure: return once every chunk has a link
+    QDeadlineTimer deadline(m_settings.linkTimeoutMs);
+    while (!m_pending.empty() || outstandingBytesLocked() > m_settings.maxBufferedBytes) {
+        if (!m_running || deadline.hasExpired()) {
+            qWarning() << "Bonded links stalled," << m_pending.size() << "chunks without a link";
+            return false;
+        }
+        m_writeCondition.wait(&m_mutex, deadline);
+        dispatchLocked();
+    }
+    return true;
+}
+
+void BondedTransport::close() {
+    if (!m_running) return;
+
+    {
+        QMutexLocker lock(&m_mutex);
+        m_closing = true;
+
+        // Let outstanding chunks arrive so the Bye describes a complete stream
+        QDeadlineTimer deadline(m_settings.linkTimeoutMs);
+        while ((!m_pending.empty() || outstandingBytesLocked() > 0) &&
+               anyLinkUpLocked() && !deadline.hasExpired()) {
+            m_writeCondition.wait(&m_mutex, deadline);
+            dispatchLocked();
+        }
+
+        m_byeChunks = m_nextSequence;
+        m_sendBye = true;
+        m_linkCondition.wakeAll();
+
+        QDeadlineTimer byeDeadline(kByeFlushMs);
+        auto byePending = [this]() {
+            return std::any_of(m_links.begin(), m_links.end(), [](const auto& link) {
+                return link->up && !link->byeSent;
+            });
+        };
+        while (byePending() && !byeDeadline.hasExpired()) {
+            m_writeCondition.wait(&m_mutex, byeDeadline);
+        }
+    }
+
+    stopThreads();
+    qDebug() << "Bonded session" << QString::number(m_sessionId, 16) << "closed after"
+             << m_byeChunks << "chunks";
+}
+
+void BondedTransport::stopThreads() {
+    {
+        QMutexLocker lock(&m_mutex);
+        m_running = false;
+    }
+    m_linkCondition.wakeAll();
+    m_writeCondition.wakeAll();
+
+    for (auto& link : m_links) {
+        if (link->thread.joinable()) {
+            link->thread.join();
+        }
+    }
+}
+
+QList<BondedLinkStatistics> BondedTransport::statistics() const {
+    QMutexLocker lock(&m_mutex);
+
+    QList<BondedLinkStatistics> result;
+    for (const auto& link : m_links) {
+        BondedLinkStatistics stats = link->stats;
+        stats.up = link->up;
+        stats.rttMs = link->srttUs / 1000.0;
+        stats.minRttMs = link->minRttUs / 1000.0;
+        stats.throughputKbps = link->rateKbps;
+        stats.queuedBytes = link->queuedBytes;
+        stats.inflightBytes = link->inflightBytes;
+        result.append(stats);
+    }
+    return result;
+}
+
+// ==============================================================================
+// Link Threads
+// ==============================================================================
+void BondedTransport::linkLoop(Link* link) {
+    ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Network,
+                                                  QStringLiteral("WeaR bond link %1").arg(link->index + 1));
+
+    QTcpSocket socket;
+    QByteArray received;
+    bool failureLogged = false;
+
+    // Token bucket of the optional rate limit
+    const double bytesPerUs = link->settings.maxKbps > 0 ? link->settings.maxKbps / 8000.0 : 0.0;
+    double tokens = 0.0;
+    int64_t refillUs = nowUs();
+
+    while (m_running) {
+        // (Re)connect
+        if (socket.state() != QAbstractSocket::ConnectedState) {
+            {
+                QMutexLocker lock(&m_mutex);
+                if (link->up) {
+                    linkDownLocked(link, socket.errorString());
+                }
+                if (m_closing) {
+                    m_linkCondition.wait(&m_mutex, kPollMs);
+                    continue;
+                }
+            }
+
+            socket.abort();
+            received.clear();
+
+            bool connected = false;
+            if (!link->settings.localAddress.isEmpty() &&
+                !socket.bind(QHostAddress(link->settings.localAddress))) {
+                // Interface gone (modem unplugged); retry later
+            } else {
+                socket.connectToHost(m_settings.receiverHost, m_settings.receiverPort);
+                connected = socket.waitForConnected(m_settings.linkTimeoutMs);
+            }
+
+            if (!connected) {
+                if (!failureLogged) {
+                    qWarning() << "Bonded link" << link->stats.name << "cannot connect:" << socket.errorString();
+                    failureLogged = true;
+                }
+                socket.abort();
+                QMutexLocker lock(&m_mutex);
+                if (m_running) {
+                    m_linkCondition.wait(&m_mutex, m_settings.reconnectIntervalMs);
+                }
+                continue;
+            }
+            failureLogged = false;
+
+            socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            socket.write(BondedHello{m_sessionId, static_cast<uint8_t>(link->index), m_targetUrl,
+                                     m_settings.secret.toUtf8()}.encode());
+            socket.flush();
+
+            tokens = 0.0;
+            refillUs = nowUs();
+
+            QMutexLocker lock(&m_mutex);
+            link->up = true;
+            link->byeSent = false;
+            link->chunksWritten = 0;
+            link->lastProgressUs = nowUs();
+            link->rateIntervalStartUs = 0;
+            link->rateIntervalBytes = 0;
+            qDebug() << "Bonded link" << link->stats.name << "up via"
+                     << (link->settings.localAddress.isEmpty() ? QStringLiteral("any interface") : link->settings.localAddress);
+            dispatchLocked();
+            m_writeCondition.wakeAll();
+            continue;
+        }
+
+        // Next chunk (or the Bye)
+        QByteArray message;
+        bool bye = false;
+        {
+            QMutexLocker lock(&m_mutex);
+            int64_t now = nowUs();
+
+            if (link->inflightBytes > 0 &&
+                now - link->lastProgressUs > static_cast<int64_t>(m_settings.linkTimeoutMs) * 1000) {
+                linkDownLocked(link, QStringLiteral("no acknowledgement for %1 ms").arg(m_settings.linkTimeoutMs));
+                socket.abort();
+                continue;
+            }
+
+            auto refill = [&]() {
+                if (bytesPerUs <= 0.0) return;
+                const double burst = std::max(m_settings.chunkBytes + 64.0, bytesPerUs * kBurstUs);
+                tokens = std::min(burst, tokens + (now - refillUs) * bytesPerUs);
+                refillUs = now;
+            };
+            auto messageSize = [](const Chunk& chunk) {
+                return kBondedHeaderSize + BondedData::kPrefixSize + chunk.bytes.size();
+            };
+
+            refill();
+            const bool byeDue = m_sendBye && !link->byeSent && link->queue.empty();
+            const bool throttled = !link->queue.empty() && bytesPerUs > 0.0 &&
+                                   tokens < messageSize(link->queue.front());
+            if ((link->queue.empty() || throttled) && !byeDue) {
+                m_linkCondition.wait(&m_mutex, kPollMs);
+                now = nowUs();
+                refill();
+            }
+
+            if (!link->queue.empty() &&
+                (bytesPerUs <= 0.0 || tokens >= messageSize(link->queue.front()))) {
+                Chunk chunk = std::move(link->queue.front());
+                link->queue.pop_front();
+
+                const int bytes = chunk.bytes.size();
+                link->queuedBytes -= bytes;
+                if (link->inflightBytes == 0) {
+                    link->lastProgressUs = now;
+                }
+                link->inflightBytes += bytes;
+                link->chunksWritten++;
+                link->stats.chunksSent++;
+                if (chunk.resent) {
+                    link->stats.chunksResent++;
+                }
+
+                message = BondedData::encode(chunk.sequence, static_cast<uint64_t>(now), chunk.bytes);
+                tokens -= message.size();
+                link->unacked.push_back(std::move(chunk));
+            } else if (m_sendBye && !link->byeSent && link->queue.empty()) {
+                message = BondedBye{m_byeChunks}.encode();
+                bye = true;
+            }
+        }
+
+        if (!message.isEmpty()) {
+            socket.write(message);
+        }
+        socket.flush();
+
+        if (bye) {
+            socket.waitForBytesWritten(kByeFlushMs);
+            QMutexLocker lock(&m_mutex);
+            link->byeSent = true;
+            m_writeCondition.wakeAll();
+        }
+
+        // Acks
+        if (socket.bytesAvailable() > 0 || socket.waitForReadyRead(0)) {
+            received += socket.readAll();
+
+            BondedMessage incoming;
+            bool error = false;
+            while (takeBondedMessage(received, incoming, error)) {
+                BondedAck ack;
+                if (incoming.type != BondedMessageType::Ack || !BondedAck::decode(incoming.payload, ack)) {
+                    error = true;
+                    break;
+                }
+                QMutexLocker lock(&m_mutex);
+                onAckLocked(link, ack.linkChunks, ack.echoTimeUs);
+            }
+
+            if (error) {
+                QMutexLocker lock(&m_mutex);
+                linkDownLocked(link, QStringLiteral("protocol error"));
+                socket.abort();
+            }
+        }
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        link->up = false;
+    }
+
+    if (socket.state() == QAbstractSocket::ConnectedState) {
+        socket.disconnectFromHost();
+        if (socket.state() != QAbstractSocket::UnconnectedState) {
+            socket.waitForDisconnected(kByeFlushMs);
+        }
+    }
+}
+
+// ==============================================================================
+// Congestion Tracking
+// ==============================================================================
+void BondedTransport::onAckLocked(Link* link, uint64_t linkChunks, uint64_t echoTimeUs) {
+    if (!link->up || linkChunks > link->chunksWritten) return;
+
+    const int64_t now = nowUs();
+
+    // Links are TCP: acks cover the oldest unacknowledged chunks in order
+    const uint64_t outstanding = link->chunksWritten - linkChunks;
+    int64_t ackedBytes = 0;
+    while (link->unacked.size() > outstanding) {
+        ackedBytes += link->unacked.front().bytes.size();
+        link->unacked.pop_front();
+    }
+    if (ackedBytes == 0) return;
+
+    link->inflightBytes -= ackedBytes;
+    link->stats.bytesAcked += ackedBytes;
+    link->lastProgressUs = now;
+
+    // RTT includes the send buffer and the modem queue, which is the point
+    const int64_t rttUs = now - static_cast<int64_t>(echoTimeUs);
+    if (echoTimeUs > 0 && rttUs >= 0) {
+        link->srttUs = link->srttUs > 0.0 ? link->srttUs * 0.875 + rttUs * 0.125 : rttUs;
+        link->minRttUs = link->minRttUs > 0.0 ? std::min(link->minRttUs, static_cast<double>(rttUs)) : rttUs;
+    }
+
+    // Delivery rate over short intervals, windowed maximum
+    if (link->rateIntervalStartUs == 0) {
+        link->rateIntervalStartUs = now;
+        link->rateIntervalBytes = 0;
+        return;
+    }
+    link->rateIntervalBytes += ackedBytes;
+
+    const int64_t elapsedUs = now - link->rateIntervalStartUs;
+    if (elapsedUs >= kRateIntervalUs) {
+        const double sampleKbps = link->rateIntervalBytes * 8000.0 / elapsedUs;
+
+        // A link that was not kept busy says nothing about its capacity
+        const bool appLimited = link->queue.empty() && m_pending.empty() &&
+                                link->inflightBytes < windowBytesLocked(link) / 2;
+        if (!appLimited || sampleKbps > link->rateKbps) {
+            link->rateSamples.emplace_back(now, sampleKbps);
+        }
+
+        while (link->rateSamples.size() > 1 && now - link->rateSamples.front().first > kRateWindowUs) {
+            link->rateSamples.pop_front();
+        }
+        if (!link->rateSamples.empty()) {
+            double rate = 0.0;
+            for (const auto& sample : link->rateSamples) {
+                rate = std::max(rate, sample.second);
+            }
+            link->rateKbps = rate;
+        }
+
+        link->rateIntervalStartUs = now;
+        link->rateIntervalBytes = 0;
+    }
+
+    dispatchLocked();
+    m_writeCondition.wakeAll();
+}
+
+void BondedTransport::linkDownLocked(Link* link, const QString& reason) {
+    if (!link->up) return;
+
+    link->up = false;
+    link->stats.failures++;
+    qWarning() << "Bonded link" << link->stats.name << "down:" << reason
+               << "-" << link->unacked.size() + link->queue.size() << "chunks move to other links";
+
+    // Unacknowledged and queued chunks go back in sequence order, ahead of new ones
+    std::vector<Chunk> chunks;
+    chunks.reserve(link->unacked.size() + link->queue.size() + m_pending.size());
+    for (Chunk& chunk : link->unacked) {
+        chunk.resent = true;
+        chunks.push_back(std::move(chunk));
+    }
+    for (Chunk& chunk : link->queue) {
+        chunks.push_back(std::move(chunk));
+    }
+    for (Chunk& chunk : m_pending) {
+        chunks.push_back(std::move(chunk));
+    }
+    std::sort(chunks.begin(), chunks.end(), [](const Chunk& a, const Chunk& b) {
+        return a.sequence < b.sequence;
+    });
+
+    m_pending.clear();
+    for (Chunk& chunk : chunks) {
+        m_pending.push_back(std::move(chunk));
+    }
+
+    link->unacked.clear();
+    link->queue.clear();
+    link->queuedBytes = 0;
+    link->inflightBytes = 0;
+    link->rateIntervalStartUs = 0;
+    link->rateIntervalBytes = 0;
+
+    dispatchLocked();
+    m_writeCondition.wakeAll();
+}
+
+int64_t BondedTransport::windowBytesLocked(const Link* link) const {
+    const double rateKbps = link->rateKbps > 0.0 ? link->rateKbps : kInitialRateKbps;
+    const double rttUs = link->srttUs > 0.0 ? link->srttUs : kInitialRttUs;
+
+    // Two RTTs at the delivery rate: enough to grow, not enough to bloat
+    const double bytes = rateKbps / 8000.0 * (2.0 * rttUs + kWindowSlackUs);
+    return std::max(static_cast<int64_t>(bytes), static_cast<int64_t>(m_settings.chunkBytes) * 2);
+}
+
+BondedTransport::Link* BondedTransport::pickLinkLocked(int size) const {
+    Link* best = nullptr;
+    double bestArrivalUs = 0.0;
+
+    for (const auto& link : m_links) {
+        if (!link->up || link->byeSent) continue;
+
+        const int64_t outstanding = link->queuedBytes + link->inflightBytes;
+        if (outstanding > 0 && outstanding + size > windowBytesLocked(link.get())) continue;
+
+        // Expected arrival of this chunk on the link
+        const double rateKbps = link->rateKbps > 0.0 ? link->rateKbps : kInitialRateKbps;
+        const double rttUs = link->srttUs > 0.0 ? link->srttUs : kInitialRttUs;
+        const double arrivalUs = (outstanding + size) * 8000.0 / rateKbps + rttUs / 2.0;
+
+        if (!best || arrivalUs < bestArrivalUs) {
+            best = link.get();
+            bestArrivalUs = arrivalUs;
+        }
+    }
+    return best;
+}
+
+void BondedTransport::dispatchLocked() {
+    bool assigned = false;
+    while (!m_pending.empty()) {
+        Link* link = pickLinkLocked(m_pending.front().bytes.size());
+        if (!link) break;
+
+        link->queuedBytes += m_pending.front().bytes.size();
+        link->queue.push_back(std::move(m_pending.front()));
+        m_pending.pop_front();
+        assigned = true;
+    }
+
+    if (assigned) {
+        m_linkCondition.wakeAll();
+    }
+    if (m_pending.empty()) {
+        m_writeCondition.wakeAll();
+    }
+}
+
+int64_t BondedTransport::outstandingBytesLocked() const {
+    int64_t bytes = 0;
+    for (const Chunk& chunk : m_pending) {
+        bytes += chunk.bytes.size();
+    }
+    for (const auto& link : m_links) {
+        bytes += link->queuedBytes + link->inflightBytes;
+    }
+    return bytes;
+}
+
+bool BondedTransport::anyLinkUpLocked() const {
+    return std::any_of(m_links.begin(), m_links.end(), [](const auto& link) { return link->up; });
+}
+
+} // namespace WeaR
@@ -0,0 +1,205 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio BondedTransport
+// Stripes the output byte stream across several uplinks
+// ==============================================================================
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace WeaR {
+
+/**
+ * @brief One uplink of a bonded connection
+ */
+struct BondedLinkSettings {
+    QString name;               ///< Display name (e.g. "LTE 1")
+    QString localAddress;       ///< Local interface address to bind (empty = any)
+    int maxKbps = 0;            ///< Send rate limit (0 = unlimited; for testing on loopback)
+};
+
+/**
+ * @brief Bonded transport configuration
+ */
+struct BondedSettings {
+    bool enabled = false;       ///< Stream through a bond receiver instead of directly
+    QString receiverHost;       ///< Bond receiver address
+    quint16 receiverPort = 7935; ///< Bond receiver port
+    QString secret;             ///< Shared secret the receiver was started with
+    QList<BondedLinkSettings> links; ///< One entry per uplink
+
+    int chunkBytes = 16 * 1024;         ///< Stream bytes per Data message
+    int linkTimeoutMs = 3000;           ///< No ack for this long takes a link down
+    int reconnectIntervalMs = 2000;     ///< Retry interval of a link that is down
+    int64_t maxBufferedBytes = 8 * 1024 * 1024; ///< Unacknowledged bytes before writes block
+};
+
+/**
+ * @brief State of one uplink
+ */
+struct BondedLinkStatistics {
+    QString name;
+    bool up = false;                ///< Connected and carrying data
+    double rttMs = 0.0;             ///< Smoothed send-to-ack time
+    double minRttMs = 0.0;          ///< Lowest send-to-ack time seen
+    double throughputKbps = 0.0;    ///< Estimated delivery rate
+    int64_t queuedBytes = 0;        ///< Assigned, not yet written
+    int64_t inflightBytes = 0;      ///< Written, not yet acknowledged
+    int64_t bytesAcked = 0;         ///< Delivered to the receiver
+    int64_t chunksSent = 0;         ///< Data messages written
+    int64_t chunksResent = 0;       ///< Of those, taken over from a failed link
+    int failures = 0;               ///< Times the link went down
+};
+
+/**
+ * @brief Bonded uplink sender
+ *
+ * Field units often have several weak uplinks (Wi-Fi plus LTE modems)
+ * instead of one good one. The stream is cut into numbered chunks which
+ * are spread over one TCP connection per link, each bound to its own
+ * local interface; a BondedReceiver puts them back in order and forwards
+ * the stream to the ingest.
+ *
+ * Every chunk is acknowledged on the link that carried it, which gives
+ * each link a smoothed RTT (including the queue in the modem and the
+ * send buffer) and a delivery rate (windowed maximum, so idle periods do
+ * not lower it). A chunk goes to the link where it is expected to
+ * arrive first: (queued + in flight + chunk) / rate + RTT / 2. Links
+ * whose in-flight bytes exceed about two RTTs at their rate get nothing
+ * more until acks come back, so a congested link stops taking data
+ * instead of building a queue. When a link fails (error, or no ack
+ * within linkTimeoutMs), its unacknowledged chunks are resent on the
+ * other links and it is reconnected in the background; duplicates are
+ * discarded by the receiver.
+ *
+ * write() blocks while no link can take data, and fails when none comes
+ * back within linkTimeoutMs. The byte stream is opaque; StreamManager
+ * feeds it the FLV muxer output through a custom AVIOContext.
+ *
+ * For testing on loopback, bind the links to 127.0.0.x addresses and set
+ * maxKbps per link.
+ *
+ * Thread-safe; one thread per link.
+ */
+class BondedTransport {
+public:
+    explicit BondedTransport(const BondedSettings& settings);
+    ~BondedTransport();
+
+    // Prevent copying
+    BondedTransport(const BondedTransport&) = delete;
+    BondedTransport& operator=(const BondedTransport&) = delete;
+
+    /**
+     * @brief Connect the links
+     * @param targetUrl URL the receiver forwards to (sent in the Hello)
+     * @param timeoutMs How long to wait for the first link
+     * @return true if at least one link is up
+     */
+    bool open(const QString& targetUrl, int timeoutMs);
+
+    /**
+     * @brief Send stream bytes
+     *
+     * Returns once the bytes are assigned to links; blocks while all
+     * links are congested.
+     *
+     * @return false if no link took data within linkTimeoutMs
+     */
+    bool write(const uint8_t* data, int size);
+
+    /**
+     * @brief End the stream
+     *
+     * Waits (up to linkTimeoutMs) for outstanding chunks to be
+     * acknowledged, sends Bye and disconnects.
+     */
+    void close();
+
+    /**
+     * @brief Get per-link statistics
+     */
+    [[nodiscard]] QList<BondedLinkStatistics> statistics() const;
+
+private:
+    struct Chunk {
+        uint64_t sequence = 0;
+        QByteArray bytes;
+        bool resent = false;
+    };
+
+    struct Link {
+        BondedLinkSettings settings;
+        int index = 0;
+        std::thread thread;
+
+        bool up = false;
+        bool byeSent = false;
+        std::deque<Chunk> queue;        ///< Assigned, not yet written
+        std::deque<Chunk> unacked;      ///< Written, oldest first
+        int64_t queuedBytes = 0;
+        int64_t inflightBytes = 0;
+        uint64_t chunksWritten = 0;     ///< Data messages written on this connection
+        int64_t lastProgressUs = 0;     ///< Last ack (or first write after idle)
+
+        // Congestion tracking
+        double srttUs = 0.0;
+        double minRttUs = 0.0;
+        double rateKbps = 0.0;          ///< Windowed maximum of the samples
+        std::deque<std::pair<int64_t, double>> rateSamples; ///< (time, kbps)
+        int64_t rateIntervalStartUs = 0;
+        int64_t rateIntervalBytes = 0;
+
+        BondedLinkStatistics stats;
+    };
+
+    int64_t nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    void stopThreads();
+    void linkLoop(Link* link);
+    void onAckLocked(Link* link, uint64_t linkChunks, uint64_t echoTimeUs);
+    void linkDownLocked(Link* link, const QString& reason);
+    Link* pickLinkLocked(int size) const;
+    int64_t windowBytesLocked(const Link* link) const;
+    void dispatchLocked();
+    int64_t outstandingBytesLocked() const;
+    bool anyLinkUpLocked() const;
+
+    BondedSettings m_settings;
+    QString m_targetUrl;
+    uint64_t m_sessionId = 0;
+    QElapsedTimer m_clock;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_linkCondition;     ///< Wakes link threads (new chunks, stop)
+    QWaitCondition m_writeCondition;    ///< Wakes writers (acks, link changes)
+    std::vector<std::unique_ptr<Link>> m_links;
+    std::deque<Chunk> m_pending;        ///< Waiting for a link (resends first)
+    uint64_t m_nextSequence = 0;
+    bool m_closing = false;             ///< No more writes; draining
+    bool m_sendBye = false;
+    uint64_t m_byeChunks = 0;
+    std::atomic<bool> m_running{false};
+
+    static constexpr double kInitialRateKbps = 2000.0;  ///< Until the first rate sample
+    static constexpr double kInitialRttUs = 100000.0;   ///< Until the first RTT sample
+    static constexpr int64_t kRateIntervalUs = 100000;  ///< Rate sample length
+    static constexpr int64_t kRateWindowUs = 3000000;   ///< Maximum filter window
+    static constexpr int64_t kWindowSlackUs = 50000;    ///< Added to two RTTs in the window
+    static constexpr int64_t kBurstUs = 20000;          ///< Rate limit bucket depth
+    static constexpr int kPollMs = 5;                   ///< Link thread socket poll interval
+    static constexpr int kByeFlushMs = 1000;            ///< Time allowed for the Bye to leave
+};
+
+} // namespace WeaR
@@ -0,0 +1,464 @@
+// ==============================================================================
+// WeaR-studio BroadcastDelay Implementation
+// ==============================================================================
+
+#include "BroadcastDelay.h"
+#include "ThreadPolicy.h"
+
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace WeaR {
+
+/**
+ * @brief Append-only spill file, mapped for its whole capacity
+ */
+struct BroadcastDelay::SpillSegment {
+    std::unique_ptr<QTemporaryFile> file;
+    uchar* map = nullptr;
+    int64_t capacity = 0;
+    int64_t used = 0;       ///< Bytes appended so far
+    int pending = 0;        ///< Appended packets not yet released
+
+    ~SpillSegment() {
+        if (file && map) file->unmap(map);
+    }
+};
+
+// ==============================================================================
+// Singleton
+// ==============================================================================
+BroadcastDelay& BroadcastDelay::instance() {
+    static BroadcastDelay instance;
+    return instance;
+}
+
+BroadcastDelay::BroadcastDelay(QObject* parent)
+    : QObject(parent)
+    , m_spillDirectory(QDir::tempPath())
+{
+    m_clock.start();
+
+    // Under pressure, waiting packets move to disk rather than being dropped
+    m_memoryStage = MemoryGovernor::instance().registerStage(
+        QStringLiteral("Broadcast delay"), MemoryClass::StreamFrames,
+        [this](int64_t bytesWanted) { return shed(bytesWanted); }
+    );
+
+    m_releaseThread = std::thread(&BroadcastDelay::releaseLoop, this);
+}
+
+BroadcastDelay::~BroadcastDelay() {
+    {
+        QMutexLocker lock(&m_mutex);
+        m_running = false;
+    }
+    m_condition.wakeAll();
+    if (m_releaseThread.joinable()) {
+        m_releaseThread.join();
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        m_records.clear();
+        m_segments.clear();
+    }
+    MemoryGovernor::instance().unregisterStage(m_memoryStage);
+}
+
+// ==============================================================================
+// Configuration
+// ==============================================================================
+void BroadcastDelay::setOutputCallback(EncodedPacketCallback callback) {
+    QMutexLocker lock(&m_outputMutex);
+    m_outputCallback = std::move(callback);
+}
+
+void BroadcastDelay::setDelayMs(int ms) {
+    const int64_t delayUs = static_cast<int64_t>(std::max(ms, 0)) * 1000;
+
+    {
+        QMutexLocker lock(&m_mutex);
+        if (delayUs == m_targetDelayUs) return;
+        m_targetDelayUs = delayUs;
+
+        if (delayUs >= m_delayUs) {
+            // Output holds for the difference; the timeline moves with it
+            if (m_hasAnchor) {
+                m_shiftUs += delayUs - m_delayUs;
+            }
+            m_delayUs = delayUs;
+            notifyDelayChanged(m_delayUs);
+        }
+        // Lower delays wait for a keyframe in the release thread
+    }
+    m_condition.wakeAll();
+
+    qDebug() << "Broadcast delay set to:" << ms << "ms";
+}
+
+int BroadcastDelay::delayMs() const {
+    QMutexLocker lock(&m_mutex);
+    return static_cast<int>(m_targetDelayUs / 1000);
+}
+
+void BroadcastDelay::setMemoryLimitBytes(int64_t bytes) {
+    QMutexLocker lock(&m_mutex);
+    m_memoryLimitBytes = std::max<int64_t>(bytes, 0);
+    if (m_memoryBytes > m_memoryLimitBytes) {
+        spillLocked(m_memoryBytes - m_memoryLimitBytes);
+    }
+}
+
+void BroadcastDelay::setSpillDirectory(const QString& path) {
+    QMutexLocker lock(&m_mutex);
+    m_spillDirectory = path.isEmpty() ? QDir::tempPath() : path;
+    m_spillFailed = false;
+}
+
+// ==============================================================================
+// Packets
+// ==============================================================================
+bool BroadcastDelay::push(const EncodedPacket& packet) {
+    if (!packet.data || packet.size <= 0) return false;
+
+    const int64_t now = nowUs();
+
+    // Reserved before locking: the governor may ask other stages to shed
+    const bool reserved = MemoryGovernor::instance().reserve(m_memoryStage, packet.size);
+    MemoryReservation reservation = reserved
+        ? MemoryReservation(m_memoryStage, packet.size) : MemoryReservation();
+
+    QMutexLocker lock(&m_mutex);
+
+    // Map timestamps onto the arrival clock; re-anchor on encoder restarts
+    if (!m_hasAnchor || std::llabs(packet.dts + m_anchorUs - now) > kResyncUs) {
+        m_anchorUs = now - packet.dts;
+        m_hasAnchor = true;
+    }
+
+    // No delay: straight through, behind anything the release thread is sending
+    if (m_delayUs == 0 && m_targetDelayUs == 0 && m_records.empty()) {
+        EncodedPacket out = packet;
+        out.pts += m_shiftUs;
+        out.dts += m_shiftUs;
+        m_stats.packetsReleased++;
+
+        m_outputMutex.lock();
+        lock.unlock();
+        output(out);
+        m_outputMutex.unlock();
+        return true;
+    }
+
+    Record record;
+    record.pts = packet.pts;
+    record.dts = packet.dts;
+    record.duration = packet.duration;
+    record.dueUs = packet.dts + m_anchorUs;
+    record.isKeyframe = packet.isKeyframe;
+    record.size = packet.size;
+    record.data = QByteArray(reinterpret_cast<const char*>(packet.data), packet.size);
+    record.reservation = std::move(reservation);
+
+    m_records.push_back(std::move(record));
+    m_memoryBytes += packet.size;
+
+    // Without a reservation the packet may not stay in memory
+    if (!reserved) {
+        spillRecordLocked(m_records.back());
+    }
+    if (m_memoryBytes > m_memoryLimitBytes) {
+        spillLocked(m_memoryBytes - m_memoryLimitBytes);
+    }
+
+    lock.unlock();
+    m_condition.wakeAll();
+    return true;
+}
+
+void BroadcastDelay::drain() {
+    {
+        QMutexLocker lock(&m_mutex);
+        m_draining = true;
+        notifyDrainedLocked();
+    }
+    m_condition.wakeAll();
+}
+
+void BroadcastDelay::clear() {
+    {
+        QMutexLocker lock(&m_mutex);
+        clearLocked();
+    }
+    m_condition.wakeAll();
+}
+
+void BroadcastDelay::clearLocked() {
+    m_records.clear();
+    m_segments.clear();
+    m_spilledCount = 0;
+    m_memoryBytes = 0;
+    m_spilledBytes = 0;
+    m_spillFailed = false;
+    m_draining = false;
+
+    // A new timeline starts with the requested delay
+    m_hasAnchor = false;
+    m_shiftUs = 0;
+    if (m_delayUs != m_targetDelayUs) {
+        m_delayUs = m_targetDelayUs;
+        notifyDelayChanged(m_delayUs);
+    }
+}
+
+// ==============================================================================
+// Release
+// ==============================================================================
+void BroadcastDelay::releaseLoop() {
+    ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Network, QStringLiteral("WeaR stream delay"));
+
+    QMutexLocker lock(&m_mutex);
+
+    while (m_running) {
+        const int64_t now = nowUs();
+
+        if (m_targetDelayUs < m_delayUs) {
+            applyPendingCutLocked(now);
+        }
+
+        if (m_records.empty()) {
+            m_condition.wait(&m_mutex);
+            continue;
+        }
+
+        const int64_t releaseAt = m_records.front().dueUs + m_delayUs;
+        if (releaseAt > now) {
+            int64_t waitUs = releaseAt - now;
+            if (m_targetDelayUs < m_delayUs) {
+                waitUs = std::min(waitUs, kCutPollUs);
+            }
+            QDeadlineTimer deadline(Qt::PreciseTimer);
+            deadline.setPreciseRemainingTime(0, waitUs * 1000, Qt::PreciseTimer);
+            m_condition.wait(&m_mutex, deadline);
+            continue;
+        }
+
+        Record record = std::move(m_records.front());
+        m_records.pop_front();
+        if (m_spilledCount > 0) m_spilledCount--;
+
+        QByteArray bytes;
+        if (record.segment) {
+            bytes = QByteArray(reinterpret_cast<const char*>(record.segment->map + record.offset), record.size);
+            m_spilledBytes -= record.size;
+            releaseSegmentLocked(record.segment);
+        } else {
+            bytes = std::move(record.data);
+            m_memoryBytes -= record.size;
+        }
+
+        EncodedPacket packet;
+        packet.data = reinterpret_cast<const uint8_t*>(bytes.constData());
+        packet.size = record.size;
+        packet.pts = record.pts + m_shiftUs;
+        packet.dts = record.dts + m_shiftUs;
+        packet.duration = record.duration;
+        packet.isKeyframe = record.isKeyframe;
+
+        const double errorMs = (now - releaseAt) / 1000.0;
+        m_stats.packetsReleased++;
+        m_delayedReleases++;
+        m_releaseErrorSumMs += errorMs;
+        m_stats.maxReleaseErrorMs = std::max(m_stats.maxReleaseErrorMs, errorMs);
+
+        // Keep release order against pass-through pushes
+        m_outputMutex.lock();
+        lock.unlock();
+        output(packet);
+        m_outputMutex.unlock();
+        lock.relock();
+
+        notifyDrainedLocked();
+    }
+}
+
+void BroadcastDelay::applyPendingCutLocked(int64_t now) {
+    // Buffer shallower than the new delay: nothing has to be skipped
+    if (m_records.empty() || m_records.front().dueUs + m_targetDelayUs > now) {
+        m_delayUs = m_targetDelayUs;
+        notifyDelayChanged(m_delayUs);
+        return;
+    }
+
+    // Newest keyframe already due under the new delay
+    size_t cut = m_records.size();
+    for (size_t i = 0; i < m_records.size(); ++i) {
+        const Record& record = m_records[i];
+        if (record.dueUs + m_targetDelayUs > now) break;
+        if (record.isKeyframe) cut = i;
+    }
+
+    // Keep releasing at the old delay until one is
+    if (cut == m_records.size()) return;
+
+    // The keyframe takes the timestamp of the first skipped packet
+    if (cut > 0) {
+        m_shiftUs -= m_records[cut].dts - m_records.front().dts;
+        m_stats.packetsSkipped += static_cast<int64_t>(cut);
+        for (size_t i = 0; i < cut; ++i) {
+            dropFrontLocked();
+        }
+    }
+
+    m_stats.delayCuts++;
+    m_delayUs = m_targetDelayUs;
+    notifyDelayChanged(m_delayUs);
+
+    qDebug() << "Broadcast delay cut to" << m_delayUs / 1000 << "ms, skipped" << cut << "packets";
+}
+
+void BroadcastDelay::dropFrontLocked() {
+    Record& record = m_records.front();
+    if (record.segment) {
+        m_spilledBytes -= record.size;
+        releaseSegmentLocked(record.segment);
+    } else {
+        m_memoryBytes -= record.size;
+    }
+    m_records.pop_front();
+    if (m_spilledCount > 0) m_spilledCount--;
+}
+
+void BroadcastDelay::output(const EncodedPacket& packet) {
+    if (m_outputCallback) {
+        m_outputCallback(packet);
+    }
+}
+
+void BroadcastDelay::notifyDelayChanged(int64_t delayUs) {
+    const int ms = static_cast<int>(delayUs / 1000);
+    QMetaObject::invokeMethod(this, [this, ms]() { emit delayChanged(ms); }, Qt::QueuedConnection);
+}
+
+void BroadcastDelay::notifyDrainedLocked() {
+    if (!m_draining || !m_records.empty()) return;
+
+    m_draining = false;
+    QMetaObject::invokeMethod(this, [this]() { emit drained(); }, Qt::QueuedConnection);
+}
+
+// ==============================================================================
+// Spilling
+// ==============================================================================
+int64_t BroadcastDelay::spillLocked(int64_t bytesWanted) {
+    int64_t freed = 0;
+
+    // Oldest in-memory packets go first; the newest stay in memory
+    while (freed < bytesWanted && m_spilledCount < m_records.size()) {
+        Record& record = m_records[m_spilledCount];
+        if (!record.segment) {
+            const int size = record.size;
+            if (!spillRecordLocked(record)) break;
+            freed += size;
+        }
+        m_spilledCount++;
+    }
+    return freed;
+}
+
+bool BroadcastDelay::spillRecordLocked(Record& record) {
+    if (record.segment) return true;
+
+    SpillSegment* segment = segmentForLocked(record.size);
+    if (!segment) return false;
+
+    std::memcpy(segment->map + segment->used, record.data.constData(), record.size);
+    record.segment = segment;
+    record.offset = segment->used;
+    segment->used += record.size;
+    segment->pending++;
+
+    record.data = QByteArray();
+    record.reservation.reset();
+    m_memoryBytes -= record.size;
+    m_spilledBytes += record.size;
+    return true;
+}
+
+BroadcastDelay::SpillSegment* BroadcastDelay::segmentForLocked(int size) {
+    if (!m_segments.empty()) {
+        SpillSegment* back = m_segments.back().get();
+        if (back->used + size <= back->capacity) return back;
+    }
+    if (m_spillFailed) return nullptr;
+
+    auto segment = std::make_unique<SpillSegment>();
+    segment->capacity = std::max<int64_t>(kSegmentBytes, size);
+    segment->file = std::make_unique<QTemporaryFile>(
+        QDir(m_spillDirectory).filePath(QStringLiteral("wear-delay-XXXXXX.spill")));
+
+    if (!segment->file->open() || !segment->file->resize(segment->capacity)) {
+        qWarning() << "Cannot create broadcast delay spill file in" << m_spillDirectory
+                   << "- keeping packets in memory";
+        m_spillFailed = true;
+        return nullptr;
+    }
+
+    segment->map = segment->file->map(0, segment->capacity);
+    if (!segment->map) {
+        qWarning() << "Cannot map broadcast delay spill file:" << segment->file->errorString();
+        m_spillFailed = true;
+        return nullptr;
+    }
+
+    m_segments.push_back(std::move(segment));
+    return m_segments.back().get();
+}
+
+void BroadcastDelay::releaseSegmentLocked(SpillSegment* segment) {
+    if (--segment->pending > 0) return;
+
+    // All its packets are out; the file is removed with it
+    auto it = std::find_if(m_segments.begin(), m_segments.end(),
+                           [segment](const std::unique_ptr<SpillSegment>& s) { return s.get() == segment; });
+    if (it != m_segments.end()) {
+        m_segments.erase(it);
+    }
+}
+
+int64_t BroadcastDelay::shed(int64_t bytesWanted) {
+    QMutexLocker lock(&m_mutex);
+    return spillLocked(bytesWanted);
+}
+
+// ==============================================================================
+// Statistics
+// ==============================================================================
+BroadcastDelayStatistics BroadcastDelay::statistics() const {
+    QMutexLocker lock(&m_mutex);
+
+    BroadcastDelayStatistics stats = m_stats;
+    stats.delayMs = static_cast<int>(m_delayUs / 1000);
+    stats.targetDelayMs = static_cast<int>(m_targetDelayUs / 1000);
+    stats.bufferedPackets = static_cast<int>(m_records.size());
+    if (!m_records.empty()) {
+        stats.bufferedMs = (m_records.back().dts - m_records.front().dts) / 1000.0;
+    }
+    stats.memoryBytes = m_memoryBytes;
+    stats.spilledBytes = m_spilledBytes;
+    stats.spillSegments = static_cast<int>(m_segments.size());
+
+    if (m_delayedReleases > 0) {
+        stats.averageReleaseErrorMs = m_releaseErrorSumMs / m_delayedReleases;
+    }
+    return stats;
+}
+
+} // namespace WeaR
@@ -0,0 +1,241 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio BroadcastDelay
+// Delays encoded packets between the encoder and the stream outputs
+// ==============================================================================
+
+#include "EncoderManager.h"
+#include "MemoryGovernor.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <cstdint>
+
+class QTemporaryFile;
+
+namespace WeaR {
+
+/**
+ * @brief Broadcast delay statistics
+ */
+struct BroadcastDelayStatistics {
+    int delayMs = 0;                ///< Delay currently applied
+    int targetDelayMs = 0;          ///< Requested delay (differs while a cut waits for a keyframe)
+    int bufferedPackets = 0;        ///< Packets waiting for release
+    double bufferedMs = 0.0;        ///< Timestamp span of the waiting packets
+    int64_t memoryBytes = 0;        ///< Waiting packet bytes held in memory
+    int64_t spilledBytes = 0;       ///< Waiting packet bytes in spill files
+    int spillSegments = 0;          ///< Spill files in use
+    int64_t packetsReleased = 0;    ///< Packets passed to the output
+    int64_t packetsSkipped = 0;     ///< Packets dropped by delay cuts
+    int64_t delayCuts = 0;          ///< Delay reductions performed at a keyframe
+    double averageReleaseErrorMs = 0.0; ///< Mean (release time - due time) of delayed packets
+    double maxReleaseErrorMs = 0.0; ///< Worst (release time - due time)
+};
+
+/**
+ * @brief Stream delay stage between the encoder and the outputs
+ *
+ * Competitive events delay the broadcast by 30-120 s. Packets from the
+ * encoder are held here and passed to the output callback when their
+ * timestamp, mapped onto the arrival clock, plus the delay is reached.
+ * At 6 Mbps two minutes is about 90 MB, so only the most recent packets
+ * stay in memory (bounded by a byte limit and the MemoryGovernor); older
+ * ones are appended to memory-mapped spill files, which are deleted as
+ * soon as all their packets have been released.
+ *
+ * The delay can be changed while streaming:
+ * - Raising it holds the output for the difference
+ * - Lowering it waits until a buffered keyframe is due under the new
+ *   delay, drops the packets before it and continues from there
+ * Output timestamps are shifted on both changes so the stream timeline
+ * stays continuous and monotonic.
+ *
+ * With a delay of 0 and nothing buffered, packets pass straight through.
+ * Packet timestamps are in microseconds, the encoder timebase the
+ * StreamManager assumes.
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class BroadcastDelay : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the BroadcastDelay instance
+     */
+    static BroadcastDelay& instance();
+
+    // Prevent copying
+    BroadcastDelay(const BroadcastDelay&) = delete;
+    BroadcastDelay& operator=(const BroadcastDelay&) = delete;
+
+    ~BroadcastDelay() override;
+
+    // =========================================================================
+    // Configuration
+    // =========================================================================
+
+    /**
+     * @brief Set where released packets go
+     *
+     * Called from the release thread (or the pushing thread when passing
+     * through); packet data is only valid during the call.
+     */
+    void setOutputCallback(EncodedPacketCallback callback);
+
+    /**
+     * @brief Set the delay
+     *
+     * Takes effect immediately when raised; when lowered, at the next
+     * keyframe that is due under the new delay.
+     *
+     * @param ms Delay in milliseconds (0 = off)
+     */
+    void setDelayMs(int ms);
+
+    /**
+     * @brief Get the requested delay in milliseconds
+     */
+    [[nodiscard]] int delayMs() const;
+
+    /**
+     * @brief Set how many packet bytes are kept in memory before spilling
+     */
+    void setMemoryLimitBytes(int64_t bytes);
+
+    /**
+     * @brief Set the directory for spill files (default: system temp)
+     */
+    void setSpillDirectory(const QString& path);
+
+    // =========================================================================
+    // Packets
+    // =========================================================================
+
+    /**
+     * @brief Add an encoded packet
+     * @param packet Packet from the encoder (data is copied)
+     * @return true if the packet was buffered or passed through
+     */
+    bool push(const EncodedPacket& packet);
+
+    /**
+     * @brief Release the waiting packets on schedule, then emit drained()
+     *
+     * Call when the encoder stops and keep the outputs open until
+     * drained(), so viewers see the delayed tail of the broadcast.
+     * clear() cancels the drain and drops the tail.
+     */
+    void drain();
+
+    /**
+     * @brief Drop all waiting packets and reset the timeline
+     *
+     * Call when the stream stops; the next packet starts a new timeline.
+     */
+    void clear();
+
+    /**
+     * @brief Get statistics
+     */
+    [[nodiscard]] BroadcastDelayStatistics statistics() const;
+
+signals:
+    /**
+     * @brief Emitted when the applied delay changes
+     * @param ms New delay in milliseconds
+     */
+    void delayChanged(int ms);
+
+    /**
+     * @brief Emitted when a drain() has released the last waiting packet
+     */
+    void drained();
+
+private:
+    // Private constructor for singleton
+    explicit BroadcastDelay(QObject* parent = nullptr);
+
+    struct SpillSegment;
+
+    struct Record {
+        int64_t pts = 0;
+        int64_t dts = 0;
+        int64_t duration = 0;
+        int64_t dueUs = 0;              ///< Timestamp on the arrival clock
+        bool isKeyframe = false;
+        int size = 0;
+        QByteArray data;                ///< Packet bytes while in memory
+        SpillSegment* segment = nullptr; ///< Spill file holding the bytes
+        int64_t offset = 0;             ///< Offset in the spill file
+        MemoryReservation reservation;
+    };
+
+    int64_t nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    void releaseLoop();
+    void applyPendingCutLocked(int64_t now);
+    void dropFrontLocked();
+    int64_t spillLocked(int64_t bytesWanted);
+    bool spillRecordLocked(Record& record);
+    SpillSegment* segmentForLocked(int size);
+    void releaseSegmentLocked(SpillSegment* segment);
+    void clearLocked();
+    void output(const EncodedPacket& packet);
+    void notifyDelayChanged(int64_t delayUs);
+    void notifyDrainedLocked();
+    int64_t shed(int64_t bytesWanted);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    QElapsedTimer m_clock;
+    std::thread m_releaseThread;
+    std::atomic<bool> m_running{true};
+
+    QMutex m_outputMutex;
+    EncodedPacketCallback m_outputCallback;
+
+    // Delay
+    int64_t m_delayUs = 0;              ///< Applied delay
+    int64_t m_targetDelayUs = 0;        ///< Requested delay
+    int64_t m_shiftUs = 0;              ///< Added to output timestamps
+    bool m_hasAnchor = false;
+    int64_t m_anchorUs = 0;             ///< Arrival clock - dts
+    bool m_draining = false;            ///< drain() waits for the buffer to empty
+
+    // Waiting packets, oldest first; oldest are spilled first
+    std::deque<Record> m_records;
+    size_t m_spilledCount = 0;          ///< Leading records known to be spilled
+    int64_t m_memoryBytes = 0;
+    int64_t m_spilledBytes = 0;
+    int64_t m_memoryLimitBytes = 32LL * 1024 * 1024;
+
+    // Spill files, oldest first
+    std::deque<std::unique_ptr<SpillSegment>> m_segments;
+    QString m_spillDirectory;
+    bool m_spillFailed = false;
+
+    int m_memoryStage = -1;
+
+    // Statistics
+    BroadcastDelayStatistics m_stats;
+    int64_t m_delayedReleases = 0;      ///< Releases from the buffer (not passed through)
+    double m_releaseErrorSumMs = 0.0;
+
+    static constexpr int64_t kSegmentBytes = 64LL * 1024 * 1024;
+    static constexpr int64_t kResyncUs = 1000000;    ///< Timestamp jump that re-anchors the timeline
+    static constexpr int64_t kCutPollUs = 10000;     ///< Recheck interval while a cut waits
+};
+
+} // namespace WeaR
@@ -0,0 +1,218 @@
+// ==============================================================================
+// WeaR-studio CanvasPool Implementation
+// ==============================================================================
+
+#include "CanvasPool.h"
+#include "MemoryGovernor.h"
+
+#include <QDebug>
+#include <QMutex>
+
+#include <vector>
+#include <cstdlib>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace WeaR {
+
+namespace {
+
+constexpr size_t kRowAlignment = 64;
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief One page-aligned buffer, huge-page backed when possible
+ */
+struct CanvasBuffer {
+    uchar* data = nullptr;
+    size_t bytes = 0;
+    bool hugePages = false;
+    bool mapped = false;    ///< Allocated with mmap/VirtualAlloc (else aligned malloc)
+};
+
+CanvasBuffer allocateBuffer(size_t bytes, bool wantHugePages) {
+    CanvasBuffer buffer;
+
+#ifdef Q_OS_WIN
+    if (wantHugePages) {
+        // Needs SeLockMemoryPrivilege; silently falls back without it
+        const SIZE_T largePage = GetLargePageMinimum();
+        if (largePage > 0) {
+            const size_t rounded = alignUp(bytes, largePage);
+            void* p = VirtualAlloc(nullptr, rounded, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES,
+                                   PAGE_READWRITE);
+            if (p) {
+                buffer.data = static_cast<uchar*>(p);
+                buffer.bytes = rounded;
+                buffer.hugePages = true;
+                buffer.mapped = true;
+                return buffer;
+            }
+        }
+    }
+
+    void* p = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (p) {
+        buffer.data = static_cast<uchar*>(p);
+        buffer.bytes = bytes;
+        buffer.mapped = true;
+    }
+#else
+    const size_t rounded = wantHugePages ? alignUp(bytes, kHugePageSize) : bytes;
+    void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED) {
+        buffer.data = static_cast<uchar*>(p);
+        buffer.bytes = rounded;
+        buffer.mapped = true;
+#ifdef MADV_HUGEPAGE
+        if (wantHugePages) {
+            buffer.hugePages = madvise(p, rounded, MADV_HUGEPAGE) == 0;
+        }
+#endif
+        return buffer;
+    }
+
+    // Last resort: plain aligned heap memory
+    void* heap = std::aligned_alloc(kRowAlignment, alignUp(bytes, kRowAlignment));
+    if (heap) {
+        buffer.data = static_cast<uchar*>(heap);
+        buffer.bytes = bytes;
+    }
+#endif
+
+    return buffer;
+}
+
+void freeBuffer(CanvasBuffer& buffer) {
+    if (!buffer.data) return;
+
+#ifdef Q_OS_WIN
+    VirtualFree(buffer.data, 0, MEM_RELEASE);
+#else
+    if (buffer.mapped) {
+        munmap(buffer.data, buffer.bytes);
+    } else {
+        std::free(buffer.data);
+    }
+#endif
+
+    buffer.data = nullptr;
+}
+
+} // namespace
+
+// ==============================================================================
+// Shared slot state (outlives the pool while frames are in flight)
+// ==============================================================================
+struct CanvasPool::Shared {
+    std::vector<CanvasBuffer> buffers;
+    std::vector<int> freeSlots;
+    QMutex mutex;
+    MemoryReservation reservation;
+
+    ~Shared() {
+        for (CanvasBuffer& buffer : buffers) {
+            freeBuffer(buffer);
+        }
+    }
+};
+
+/**
+ * @brief QImage cleanup payload returning a slot to its pool
+ */
+struct CanvasPool::SlotHandle {
+    std::shared_ptr<Shared> shared;
+    int slot = -1;
+};
+
+CanvasPool::CanvasPool(const QSize& size, QImage::Format format, int slotCount, bool hugePages)
+    : m_size(size)
+    , m_format(format)
+    , m_shared(std::make_shared<Shared>())
+{
+    // All 32-bit formats: 4 bytes per pixel, rows padded to 64 bytes
+    m_bytesPerLine = static_cast<qsizetype>(alignUp(static_cast<size_t>(size.width()) * 4, kRowAlignment));
+    const size_t bufferBytes = static_cast<size_t>(m_bytesPerLine) * size.height();
+    if (bufferBytes == 0) return;
+
+    // Preallocated canvases are long-lived frame memory
+    static const int memoryStage = MemoryGovernor::instance().registerStage(
+        QStringLiteral("Canvas pool"), MemoryClass::StreamFrames);
+
+    int64_t reserved = 0;
+    for (int i = 0; i < slotCount; ++i) {
+        CanvasBuffer buffer = allocateBuffer(bufferBytes, hugePages);
+        if (!buffer.data) {
+            qWarning() << "CanvasPool: failed to allocate canvas" << i << "of" << slotCount;
+            break;
+        }
+        reserved += static_cast<int64_t>(buffer.bytes);
+        m_shared->freeSlots.push_back(static_cast<int>(m_shared->buffers.size()));
+        m_shared->buffers.push_back(buffer);
+    }
+
+    // Accounted for visibility; the pool is never shed
+    if (MemoryGovernor::instance().reserve(memoryStage, reserved)) {
+        m_shared->reservation = MemoryReservation(memoryStage, reserved);
+    }
+
+    qDebug() << "CanvasPool:" << m_shared->buffers.size() << "canvases of" << size
+             << "stride" << m_bytesPerLine << (usesHugePages() ? "(huge pages)" : "");
+}
+
+CanvasPool::~CanvasPool() = default;
+
+QImage CanvasPool::acquire() {
+    int slot = -1;
+    {
+        QMutexLocker lock(&m_shared->mutex);
+        if (!m_shared->freeSlots.empty()) {
+            slot = m_shared->freeSlots.back();
+            m_shared->freeSlots.pop_back();
+        }
+    }
+
+    if (slot < 0) {
+        // Every canvas is still referenced; don't stall the render loop
+        m_fallbacks++;
+        return QImage(m_size, m_format);
+    }
+
+    auto* handle = new SlotHandle{m_shared, slot};
+    return QImage(
+        m_shared->buffers[slot].data,
+        m_size.width(), m_size.height(), m_bytesPerLine, m_format,
+        [](void* info) {
+            auto* h = static_cast<SlotHandle*>(info);
+            {
+                QMutexLocker lock(&h->shared->mutex);
+                h->shared->freeSlots.push_back(h->slot);
+            }
+            delete h;
+        },
+        handle
+    );
+}
+
+int CanvasPool::slotCount() const {
+    return static_cast<int>(m_shared->buffers.size());
+}
+
+int CanvasPool::freeCount() const {
+    QMutexLocker lock(&m_shared->mutex);
+    return static_cast<int>(m_shared->freeSlots.size());
+}
+
+bool CanvasPool::usesHugePages() const {
+    return !m_shared->buffers.empty() && m_shared->buffers.front().hugePages;
+}
+
+} // namespace WeaR
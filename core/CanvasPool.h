@@ -0,0 +1,96 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio CanvasPool
+// Ring of preallocated, aligned canvas buffers for composited frames
+// ==============================================================================
+
+#include <QImage>
+#include <QSize>
+
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+namespace WeaR {
+
+/**
+ * @brief Fixed set of reusable canvas buffers
+ *
+ * The render loop composites every tick into a canvas of the same size.
+ * Instead of allocating a new QImage each time, CanvasPool preallocates a
+ * ring of buffers and hands them out as ordinary QImages. Each image
+ * references its buffer through QImage's cleanup hook; when the last
+ * consumer (preview, encoder, last-frame cache) drops its copy, the
+ * buffer goes back to the pool.
+ *
+ * - Rows are 64-byte aligned (cache line / AVX-512 friendly strides)
+ * - Buffers are backed by transparent huge pages where available
+ *   (Linux madvise, Windows large pages when the privilege is held),
+ *   reducing TLB misses when scanning 4K canvases
+ * - If every buffer is in use, acquire() falls back to a regular
+ *   allocation instead of blocking the render loop
+ *
+ * The pool itself may be destroyed while frames are still in use; the
+ * buffers are freed once the last of them is released.
+ */
+class CanvasPool {
+public:
+    /**
+     * @brief Create a pool
+     * @param size Canvas size in pixels
+     * @param format 32-bit image format of the canvases
+     * @param slotCount Number of preallocated buffers
+     * @param hugePages Try to back buffers with huge pages
+     */
+    CanvasPool(const QSize& size, QImage::Format format, int slotCount = 6, bool hugePages = true);
+    ~CanvasPool();
+
+    CanvasPool(const CanvasPool&) = delete;
+    CanvasPool& operator=(const CanvasPool&) = delete;
+
+    /**
+     * @brief Get a free canvas
+     *
+     * Contents are undefined; the caller is expected to clear or fully
+     * overwrite it.
+     *
+     * @return Canvas image, never null unless allocation failed
+     */
+    [[nodiscard]] QImage acquire();
+
+    [[nodiscard]] QSize size() const { return m_size; }
+    [[nodiscard]] QImage::Format format() const { return m_format; }
+    [[nodiscard]] int slotCount() const;
+
+    /**
+     * @brief Number of buffers not referenced by any frame
+     */
+    [[nodiscard]] int freeCount() const;
+
+    /**
+     * @brief Check whether buffers are backed by huge pages
+     */
+    [[nodiscard]] bool usesHugePages() const;
+
+    /**
+     * @brief Number of acquire() calls that found no free buffer
+     */
+    [[nodiscard]] int64_t fallbackCount() const { return m_fallbacks; }
+
+    /**
+     * @brief Bytes per row of pooled canvases (64-byte aligned)
+     */
+    [[nodiscard]] qsizetype bytesPerLine() const { return m_bytesPerLine; }
+
+private:
+    struct Shared;
+    struct SlotHandle;
+
+    QSize m_size;
+    QImage::Format m_format;
+    qsizetype m_bytesPerLine = 0;
+    std::shared_ptr<Shared> m_shared;
+    std::atomic<int64_t> m_fallbacks{0};
+};
+
+} // namespace WeaR
@@ -447,19 +447,27 @@ VideoFrame CaptureManager::captureVideoFrame() {
     if (!texture) return frame;
     
     frame.hardwareFrame = texture.Get();
+    frame.hardwareSize = QSize(m_impl->frameWidth(), m_impl->frameHeight());
     frame.isHardwareFrame = true;
     frame.timestamp = timestamp;
+    frame.hasTimestamp = true;
     frame.frameNumber = m_frameNumber++;
     
     // Store reference to keep texture alive
     m_currentFrame = texture;
     m_frameTimestamp = timestamp;
     
+    // Crop is a view: GPU consumers read cropRect, nothing is copied
+    QRect region = m_config.captureRegion;
+    frame = frame.cropped(region);
+    
     // If software frame is needed (e.g., for preview), convert to QImage
-    // This is expensive - only do when necessary
+    // This is expensive - only do when necessary. Only the region of
+    // interest is read back from the GPU.
     if (!m_config.useHardwareAcceleration) {
-        frame.softwareFrame = textureToQImage(texture.Get());
+        frame.softwareFrame = textureToQImage(texture.Get(), region);
         frame.isHardwareFrame = false;
+        frame.cropRect = QRect();
     }
     
     return frame;
@@ -747,16 +755,35 @@ void CaptureManager::cleanupD3D11() {
     m_ownsDevice = false;
 }
 
-QImage CaptureManager::textureToQImage(ID3D11Texture2D* texture) {
+QImage CaptureManager::textureToQImage(ID3D11Texture2D* texture, const QRect& region) {
     if (!texture || !m_d3dContext) return QImage();
     
     // Get texture description
     D3D11_TEXTURE2D_DESC desc;
     texture->GetDesc(&desc);
     
-    // Create staging texture if needed
+    // Clip the region of interest to the texture (empty = full frame)
+    QRect textureRect(0, 0, static_cast<int>(desc.Width), static_cast<int>(desc.Height));
+    QRect copyRect = region.isEmpty() ? textureRect : region.intersected(textureRect);
+    if (copyRect.isEmpty()) return QImage();
+    
+    // (Re)create staging texture sized to the region if needed
+    if (m_stagingTexture) {
+        D3D11_TEXTURE2D_DESC stagingDesc;
+        m_stagingTexture->GetDesc(&stagingDesc);
+        if (stagingDesc.Width != static_cast<UINT>(copyRect.width()) ||
+            stagingDesc.Height != static_cast<UINT>(copyRect.height()) ||
+            stagingDesc.Format != desc.Format) {
+            m_stagingTexture.Reset();
+        }
+    }
+    
     if (!m_stagingTexture) {
         D3D11_TEXTURE2D_DESC stagingDesc = desc;
+        stagingDesc.Width = static_cast<UINT>(copyRect.width());
+        stagingDesc.Height = static_cast<UINT>(copyRect.height());
+        stagingDesc.MipLevels = 1;
+        stagingDesc.ArraySize = 1;
         stagingDesc.Usage = D3D11_USAGE_STAGING;
         stagingDesc.BindFlags = 0;
         stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
@@ -769,8 +796,15 @@ QImage CaptureManager::textureToQImage(ID3D11Texture2D* texture) {
         }
     }
     
-    // Copy to staging texture
-    m_d3dContext->CopyResource(m_stagingTexture.Get(), texture);
+    // Copy only the region of interest to the staging texture
+    D3D11_BOX box;
+    box.left = static_cast<UINT>(copyRect.left());
+    box.top = static_cast<UINT>(copyRect.top());
+    box.front = 0;
+    box.right = static_cast<UINT>(copyRect.left() + copyRect.width());
+    box.bottom = static_cast<UINT>(copyRect.top() + copyRect.height());
+    box.back = 1;
+    m_d3dContext->CopySubresourceRegion(m_stagingTexture.Get(), 0, 0, 0, 0, texture, 0, &box);
     
     // Map staging texture
     D3D11_MAPPED_SUBRESOURCE mapped;
@@ -783,8 +817,8 @@ QImage CaptureManager::textureToQImage(ID3D11Texture2D* texture) {
     // Create QImage from mapped data
     QImage image(
         static_cast<const uchar*>(mapped.pData),
-        desc.Width,
-        desc.Height,
+        copyRect.width(),
+        copyRect.height(),
         mapped.RowPitch,
         QImage::Format_ARGB32
     );
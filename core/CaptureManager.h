@@ -272,7 +272,7 @@ private:
     bool createCaptureSession();
     void destroyCaptureSession();
     void onFrameArrived();
-    QImage textureToQImage(ID3D11Texture2D* texture);
+    QImage textureToQImage(ID3D11Texture2D* texture, const QRect& region = QRect());
 };
 
 } // namespace WeaR
@@ -4,10 +4,15 @@
 // ==============================================================================
 
 #include "EncoderManager.h"
+#include "MemoryGovernor.h"
+#include "JobSystem.h"
+#include "ThreadPolicy.h"
+#include "QualityGovernor.h"
 
 #include <QDebug>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QMetaMethod>
 
 // FFmpeg headers (C linkage)
 extern "C" {
@@ -15,11 +20,14 @@ extern "C" {
 #include <libavutil/opt.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/pixfmt.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 }
 
+#include <algorithm>
 #include <chrono>
 #include <deque>
+#include <vector>
 
 namespace WeaR {
 
@@ -74,13 +82,15 @@ static const char* presetToString(EncoderPreset preset, bool isNvenc) {
 struct QueuedFrame {
     AVFrame* frame = nullptr;
     int64_t pts = 0;
+    MemoryReservation reservation;  // Released with the frame
     
     QueuedFrame() = default;
-    QueuedFrame(AVFrame* f, int64_t p) : frame(f), pts(p) {}
+    QueuedFrame(AVFrame* f, int64_t p, MemoryReservation r = MemoryReservation())
+        : frame(f), pts(p), reservation(std::move(r)) {}
     
     // Move semantics
     QueuedFrame(QueuedFrame&& other) noexcept 
-        : frame(other.frame), pts(other.pts) {
+        : frame(other.frame), pts(other.pts), reservation(std::move(other.reservation)) {
         other.frame = nullptr;
     }
     
@@ -89,6 +99,7 @@ struct QueuedFrame {
             if (frame) av_frame_free(&frame);
             frame = other.frame;
             pts = other.pts;
+            reservation = std::move(other.reservation);
             other.frame = nullptr;
         }
         return *this;
@@ -108,11 +119,19 @@ struct QueuedFrame {
 // ==============================================================================
 class EncoderManager::Impl {
 public:
-    Impl(EncoderManager* parent) : m_parent(parent) {}
+    Impl(EncoderManager* parent) : m_parent(parent) {
+        // Raw frames waiting for the encoder are the largest buffers in
+        // the pipeline; under pressure the oldest ones are dropped
+        m_memoryStage = MemoryGovernor::instance().registerStage(
+            QStringLiteral("Encoder frame queue"), MemoryClass::StreamFrames,
+            [this](int64_t bytesWanted) { return shedFrames(bytesWanted); }
+        );
+    }
     
     ~Impl() {
         stop();
         cleanup();
+        MemoryGovernor::instance().unregisterStage(m_memoryStage);
     }
     
     bool configure(const EncoderSettings& settings) {
@@ -173,6 +192,18 @@ public:
     }
     
     void pushFrame(const QImage& image, int64_t pts) {
+        pushConverted([&]() { return imageToAVFrame(image); }, pts, true);
+    }
+    
+    void pushFrame(const PlanarFrame& planes, int64_t pts) {
+        // Referenced planes are the compositor's pooled canvas, which is
+        // accounted there; only a converted copy is new memory
+        const bool copies = !m_codecContext || !canReferencePlanes(planes);
+        pushConverted([&]() { return planarToAVFrame(planes); }, pts, copies);
+    }
+    
+    template <typename Convert>
+    void pushConverted(Convert&& convert, int64_t pts, bool allocates) {
         if (!m_running || !m_codecContext) return;
         
         // Check queue size
@@ -185,13 +216,39 @@ public:
             }
         }
         
-        // Convert QImage to AVFrame
-        AVFrame* frame = imageToAVFrame(image);
+        // Account the converted frame against the global memory budget
+        const int64_t frameBytes = allocates ? av_image_get_buffer_size(
+            m_codecContext->pix_fmt, m_settings.width, m_settings.height, 32) : 0;
+        if (frameBytes > 0 && !MemoryGovernor::instance().reserve(m_memoryStage, frameBytes)) {
+            m_stats.framesDropped++;
+            qWarning() << "Memory budget exhausted, dropping frame";
+            return;
+        }
+        MemoryReservation reservation = frameBytes > 0
+            ? MemoryReservation(m_memoryStage, frameBytes) : MemoryReservation();
+        
+        // Convert the input to an AVFrame in the encoder's format
+        QElapsedTimer convertTimer;
+        convertTimer.start();
+        
+        AVFrame* frame = convert();
         if (!frame) {
-            qWarning() << "Failed to convert image to AVFrame";
+            qWarning() << "Failed to convert frame to AVFrame";
             return;
         }
         
+        {
+            QMutexLocker lock(&m_statsMutex);
+            m_convertTimes.push_back(convertTimer.nsecsElapsed() / 1e6);
+            if (m_convertTimes.size() > 60) {
+                m_convertTimes.pop_front();
+            }
+            
+            double sum = 0;
+            for (double t : m_convertTimes) sum += t;
+            m_stats.averageConvertTimeMs = sum / m_convertTimes.size();
+        }
+        
         // Set PTS
         if (pts < 0) {
             pts = m_frameCounter * (AV_TIME_BASE / m_settings.fpsNum);
@@ -202,7 +259,7 @@ public:
         // Add to queue
         {
             QMutexLocker lock(&m_queueMutex);
-            m_frameQueue.emplace_back(frame, pts);
+            m_frameQueue.emplace_back(frame, pts, std::move(reservation));
         }
         
         m_queueCondition.wakeOne();
@@ -219,6 +276,13 @@ public:
     QString activeEncoderName() const { return m_activeEncoderName; }
     EncoderType activeEncoderType() const { return m_activeEncoderType; }
     
+    const AVCodecParameters* codecParameters() const {
+        QMutexLocker lock(&m_mutex);
+        return m_codecpar;
+    }
+    
+    void requestKeyframe() { m_keyframeRequested = true; }
+    
     void setPacketCallback(EncodedPacketCallback callback) {
         QMutexLocker lock(&m_mutex);
         m_packetCallback = std::move(callback);
@@ -232,6 +296,28 @@ public:
     int maxQueueSize() const { return m_maxQueueSize; }
     void setMaxQueueSize(int size) { m_maxQueueSize = size; }
     
+    int64_t shedFrames(int64_t bytesWanted) {
+        // Drop the oldest frames; the newest one is always kept
+        std::deque<QueuedFrame> dropped;
+        int64_t freed = 0;
+        {
+            QMutexLocker lock(&m_queueMutex);
+            while (freed < bytesWanted && m_frameQueue.size() > 1) {
+                freed += m_frameQueue.front().reservation.bytes();
+                dropped.push_back(std::move(m_frameQueue.front()));
+                m_frameQueue.pop_front();
+            }
+        }
+        
+        if (!dropped.empty()) {
+            QMutexLocker lock(&m_statsMutex);
+            m_stats.framesDropped += static_cast<int64_t>(dropped.size());
+        }
+        
+        // Frames (and their reservations) are released here, outside the lock
+        return freed;
+    }
+    
     EncoderManager::Statistics statistics() const {
         QMutexLocker lock(&m_statsMutex);
         return m_stats;
@@ -387,8 +473,14 @@ private:
                 break;
         }
         
-        // Preset
-        const char* presetStr = presetToString(m_settings.preset, isNvenc);
+        // Preset (the quality governor may pick a faster one under load)
+        const EncoderPreset preset = QualityGovernor::instance().effectivePreset(m_settings.preset);
+        if (preset != m_settings.preset) {
+            qInfo() << "Quality governor: using faster encoder preset"
+                    << presetToString(preset, isNvenc) << "instead of"
+                    << presetToString(m_settings.preset, isNvenc);
+        }
+        const char* presetStr = presetToString(preset, isNvenc);
         av_opt_set(m_codecContext->priv_data, "preset", presetStr, 0);
         
         // Profile
@@ -420,6 +512,9 @@ private:
         // Global header for streaming
         m_codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
         
+        // Requested keyframes must be IDR so a stream can start on them
+        av_opt_set_int(m_codecContext->priv_data, "forced-idr", 1, 0);
+        
         // Open codec
         int ret = avcodec_open2(m_codecContext, codec, nullptr);
         if (ret < 0) {
@@ -431,6 +526,14 @@ private:
             return false;
         }
         
+        // Parameters for the stream header (extradata is set once opened)
+        m_codecpar = avcodec_parameters_alloc();
+        if (!m_codecpar || avcodec_parameters_from_context(m_codecpar, m_codecContext) < 0) {
+            qCritical() << "Failed to export codec parameters";
+            cleanup();
+            return false;
+        }
+        
         // Allocate packet
         m_packet = av_packet_alloc();
         if (!m_packet) {
@@ -452,6 +555,8 @@ private:
             return false;
         }
         
+        createScaleBands();
+        
         m_frameCounter = 0;
         
         qDebug() << "Encoder initialized:"
@@ -463,15 +568,29 @@ private:
     }
     
     void cleanup() {
+        for (ScaleBand& band : m_scaleBands) {
+            sws_freeContext(band.context);
+        }
+        m_scaleBands.clear();
+        
         if (m_swsContext) {
             sws_freeContext(m_swsContext);
             m_swsContext = nullptr;
         }
         
+        if (m_planarSwsContext) {
+            sws_freeContext(m_planarSwsContext);
+            m_planarSwsContext = nullptr;
+        }
+        
         if (m_packet) {
             av_packet_free(&m_packet);
         }
         
+        if (m_codecpar) {
+            avcodec_parameters_free(&m_codecpar);
+        }
+        
         if (m_codecContext) {
             avcodec_free_context(&m_codecContext);
         }
@@ -506,6 +625,7 @@ private:
     
     void encodingLoop() {
         qDebug() << "Encoding thread started";
+        ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Encode, QStringLiteral("WeaR encoder"));
         
         while (m_running) {
             QueuedFrame queuedFrame;
@@ -554,6 +674,11 @@ private:
     void encodeFrame(AVFrame* frame) {
         if (!m_codecContext || !frame) return;
         
+        // Keyframe requested by an output (stream start or reconnect)
+        if (m_keyframeRequested.exchange(false)) {
+            frame->pict_type = AV_PICTURE_TYPE_I;
+        }
+        
         // Send frame to encoder
         int ret = avcodec_send_frame(m_codecContext, frame);
         if (ret < 0) {
@@ -608,14 +733,94 @@ private:
         
         // Emit signal
         emit m_parent->packetEncoded(m_packet->pts, m_packet->size, isKeyframe);
+        m_parent->m_packetMailbox->post(m_packet->size, isKeyframe, m_packet->pts);
+    }
+    
+    static AVPixelFormat planarFormat(const PlanarFrame& planes) {
+        return planes.format == FramePixelFormat::NV12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+    }
+    
+    bool canReferencePlanes(const PlanarFrame& planes) const {
+        return planarFormat(planes) == m_codecContext->pix_fmt &&
+               planes.size == QSize(m_settings.width, m_settings.height);
+    }
+    
+    AVFrame* planarToAVFrame(const PlanarFrame& planes) {
+        if (!planes.isValid()) return nullptr;
+        
+        const AVPixelFormat srcFormat = planarFormat(planes);
+        
+        AVFrame* frame = av_frame_alloc();
+        if (!frame) return nullptr;
+        
+        frame->format = m_codecContext->pix_fmt;
+        frame->width = m_settings.width;
+        frame->height = m_settings.height;
+        
+        // Same layout as the encoder: reference the planes instead of
+        // copying them. Each plane gets its own read-only buffer holding a
+        // reference to the owner, so av_frame_ref/make_writable inside the
+        // encoder see (and keep alive) every plane the frame points to
+        if (canReferencePlanes(planes)) {
+            const int planeCount = srcFormat == AV_PIX_FMT_NV12 ? 2 : 3;
+            for (int i = 0; i < planeCount; ++i) {
+                const int rows = i == 0 ? m_settings.height : (m_settings.height + 1) / 2;
+                auto* owner = new std::shared_ptr<const void>(planes.owner);
+                frame->buf[i] = av_buffer_create(
+                    const_cast<uint8_t*>(planes.data[i]),
+                    static_cast<size_t>(planes.linesize[i]) * rows,
+                    [](void* opaque, uint8_t*) {
+                        delete static_cast<std::shared_ptr<const void>*>(opaque);
+                    },
+                    owner, AV_BUFFER_FLAG_READONLY
+                );
+                if (!frame->buf[i]) {
+                    delete owner;
+                    av_frame_free(&frame);   // Releases the planes created so far
+                    return nullptr;
+                }
+                frame->data[i] = const_cast<uint8_t*>(planes.data[i]);
+                frame->linesize[i] = planes.linesize[i];
+            }
+            return frame;
+        }
+        
+        // Otherwise a chroma re-layout (e.g. NV12 for hardware encoders)
+        // and/or a rescale, still without an RGB round trip
+        if (av_frame_get_buffer(frame, 32) < 0) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+        
+        m_planarSwsContext = sws_getCachedContext(
+            m_planarSwsContext,
+            planes.size.width(), planes.size.height(), srcFormat,
+            m_settings.width, m_settings.height, m_codecContext->pix_fmt,
+            SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
+        );
+        if (!m_planarSwsContext) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+        
+        sws_scale(m_planarSwsContext, planes.data, planes.linesize, 0, planes.size.height(),
+                  frame->data, frame->linesize);
+        return frame;
     }
     
     AVFrame* imageToAVFrame(const QImage& image) {
-        // Ensure correct format
+        // The scaler reads BGRA and ignores alpha. RGB32 (the opaque canvas)
+        // and ARGB32 pass straight through; premultiplied ARGB does too, as
+        // its colour is the frame composited over black, which is what an
+        // opaque video frame shows. Anything else is converted once.
         QImage converted = image;
-        if (image.format() != QImage::Format_ARGB32 &&
-            image.format() != QImage::Format_RGB32) {
-            converted = image.convertToFormat(QImage::Format_ARGB32);
+        if (image.format() != QImage::Format_RGB32 &&
+            image.format() != QImage::Format_ARGB32 &&
+            image.format() != QImage::Format_ARGB32_Premultiplied) {
+            converted = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            
+            QMutexLocker lock(&m_statsMutex);
+            m_stats.formatConversions++;
         }
         
         // Scale if needed
@@ -648,18 +853,75 @@ private:
         }
         
         // Convert BGRA to YUV using swscale
-        const uint8_t* srcSlice[1] = { converted.constBits() };
         int srcStride[1] = { static_cast<int>(converted.bytesPerLine()) };
         
-        sws_scale(
-            m_swsContext,
-            srcSlice, srcStride, 0, m_settings.height,
-            frame->data, frame->linesize
-        );
+        if (m_scaleBands.empty()) {
+            const uint8_t* srcSlice[1] = { converted.constBits() };
+            sws_scale(
+                m_swsContext,
+                srcSlice, srcStride, 0, m_settings.height,
+                frame->data, frame->linesize
+            );
+            return frame;
+        }
+        
+        // Each band has its own context over its own rows, so they can run
+        // concurrently on the shared job system
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(m_codecContext->pix_fmt);
+        JobSystem::instance().parallelFor(static_cast<int>(m_scaleBands.size()), [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                const ScaleBand& band = m_scaleBands[i];
+                
+                const uint8_t* srcSlice[1] = { converted.constBits() + band.top * converted.bytesPerLine() };
+                uint8_t* dst[AV_NUM_DATA_POINTERS] = {};
+                for (int plane = 0; plane < AV_NUM_DATA_POINTERS && frame->data[plane]; ++plane) {
+                    const int shift = (plane == 1 || plane == 2) ? desc->log2_chroma_h : 0;
+                    dst[plane] = frame->data[plane] + (band.top >> shift) * frame->linesize[plane];
+                }
+                
+                sws_scale(band.context, srcSlice, srcStride, 0, band.height, dst, frame->linesize);
+            }
+        }, 1, JobPriority::RealTime);
         
         return frame;
     }
     
+    void createScaleBands() {
+        // Bands must start on chroma row boundaries
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(m_codecContext->pix_fmt);
+        if (!desc) return;
+        const int rowAlign = 1 << desc->log2_chroma_h;
+        
+        const int bandCount = std::clamp(m_settings.height / kMinScaleBandRows, 1,
+                                         JobSystem::instance().workerCount() + 1);
+        if (bandCount <= 1) return;
+        
+        int top = 0;
+        for (int i = 1; i <= bandCount; ++i) {
+            const int bottom = (i == bandCount)
+                ? m_settings.height
+                : (i * m_settings.height / bandCount) / rowAlign * rowAlign;
+            if (bottom <= top) continue;
+            
+            SwsContext* context = sws_getContext(
+                m_settings.width, bottom - top, AV_PIX_FMT_BGRA,
+                m_settings.width, bottom - top, m_codecContext->pix_fmt,
+                SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
+            );
+            if (!context) {
+                // Fall back to the single full-frame context
+                for (ScaleBand& band : m_scaleBands) {
+                    sws_freeContext(band.context);
+                }
+                m_scaleBands.clear();
+                return;
+            }
+            
+            m_scaleBands.push_back(ScaleBand{context, top, bottom - top});
+            top = bottom;
+        }
+    }
+    
     // Parent reference
     EncoderManager* m_parent;
     
@@ -671,6 +933,7 @@ private:
     
     // State
     std::atomic<bool> m_running{false};
+    std::atomic<bool> m_keyframeRequested{false};
     std::thread m_encoderThread;
     
     // Settings
@@ -678,8 +941,19 @@ private:
     
     // FFmpeg objects
     AVCodecContext* m_codecContext = nullptr;
+    AVCodecParameters* m_codecpar = nullptr;      ///< Exported after the codec opens
     AVPacket* m_packet = nullptr;
     SwsContext* m_swsContext = nullptr;
+    SwsContext* m_planarSwsContext = nullptr;     ///< Planar input, created on first use
+    
+    // Horizontal bands converted in parallel (empty = single context)
+    struct ScaleBand {
+        SwsContext* context = nullptr;
+        int top = 0;
+        int height = 0;
+    };
+    std::vector<ScaleBand> m_scaleBands;
+    static constexpr int kMinScaleBandRows = 128;
     
     // Encoder info
     QString m_activeEncoderName;
@@ -688,6 +962,7 @@ private:
     // Frame queue
     std::deque<QueuedFrame> m_frameQueue;
     int m_maxQueueSize = 30;  // ~0.5 second at 60fps
+    int m_memoryStage = -1;
     int64_t m_frameCounter = 0;
     
     // Callback
@@ -696,6 +971,7 @@ private:
     // Statistics
     EncoderManager::Statistics m_stats;
     std::deque<double> m_encodeTimes;
+    std::deque<double> m_convertTimes;
 };
 
 // ==============================================================================
@@ -709,7 +985,20 @@ EncoderManager& EncoderManager::instance() {
 EncoderManager::EncoderManager(QObject* parent)
     : QObject(parent)
     , m_impl(std::make_unique<Impl>(this))
+    , m_packetMailbox(new ActivityMailbox(100, this))
 {
+    connect(m_packetMailbox, &ActivityMailbox::summaryReady, this, &EncoderManager::encodeActivity);
+    m_packetMailbox->setEnabled(false);
+}
+
+void EncoderManager::connectNotify(const QMetaMethod& signal) {
+    Q_UNUSED(signal);
+    m_packetMailbox->setEnabled(isSignalConnected(QMetaMethod::fromSignal(&EncoderManager::encodeActivity)));
+}
+
+void EncoderManager::disconnectNotify(const QMetaMethod& signal) {
+    Q_UNUSED(signal);
+    m_packetMailbox->setEnabled(isSignalConnected(QMetaMethod::fromSignal(&EncoderManager::encodeActivity)));
 }
 
 EncoderManager::~EncoderManager() = default;
@@ -742,10 +1031,18 @@ bool EncoderManager::isInitialized() const {
     return m_impl->isInitialized();
 }
 
+void EncoderManager::requestKeyframe() {
+    m_impl->requestKeyframe();
+}
+
 void EncoderManager::pushFrame(const QImage& image, int64_t pts) {
     m_impl->pushFrame(image, pts);
 }
 
+void EncoderManager::pushFrame(const PlanarFrame& planes, int64_t pts) {
+    m_impl->pushFrame(planes, pts);
+}
+
 int EncoderManager::queueSize() const {
     return m_impl->queueSize();
 }
@@ -766,6 +1063,10 @@ EncoderType EncoderManager::activeEncoderType() const {
     return m_impl->activeEncoderType();
 }
 
+const AVCodecParameters* EncoderManager::codecParameters() const {
+    return m_impl->codecParameters();
+}
+
 bool EncoderManager::isHardwareEncodingAvailable() {
     return Impl::isHardwareEncodingAvailable();
 }
@@ -4,6 +4,9 @@
 // Hardware-accelerated video encoding using FFmpeg (NVENC/AMF/libx264)
 // ==============================================================================
 
+#include "ISource.h"
+#include "ActivityMailbox.h"
+
 #include <QObject>
 #include <QMutex>
 #include <QImage>
@@ -18,6 +21,7 @@
 // Forward declarations for FFmpeg types (avoid including headers in .h)
 struct AVCodec;
 struct AVCodecContext;
+struct AVCodecParameters;
 struct AVFrame;
 struct AVPacket;
 struct SwsContext;
@@ -221,6 +225,15 @@ public:
      * @return true if encoder is ready
      */
     [[nodiscard]] bool isInitialized() const;
+    
+    /**
+     * @brief Make the next encoded frame a keyframe (IDR)
+     * 
+     * Outputs that start publishing or reconnect call this so they do
+     * not wait up to a keyframe interval for a decodable frame.
+     * Thread-safe.
+     */
+    void requestKeyframe();
 
     // =========================================================================
     // Frame Input
@@ -237,6 +250,19 @@ public:
      */
     void pushFrame(const QImage& image, int64_t pts = -1);
     
+    /**
+     * @brief Push a planar YUV frame to the encoding queue
+     * 
+     * When the planes already match the encoder's pixel format and size
+     * the AVFrame references them directly (the frame's owner is kept
+     * alive until the encoder is done); otherwise they are re-laid out or
+     * scaled in YUV. Thread-safe like pushFrame(const QImage&).
+     * 
+     * @param planes Frame to encode (NV12 or I420)
+     * @param pts Presentation timestamp (microseconds), -1 for auto
+     */
+    void pushFrame(const PlanarFrame& planes, int64_t pts = -1);
+    
     /**
      * @brief Get the number of frames waiting in queue
      * @return Queue size
@@ -271,6 +297,16 @@ public:
      */
     [[nodiscard]] EncoderType activeEncoderType() const;
     
+    /**
+     * @brief Get the codec parameters of the open encoder
+     * 
+     * Includes the extradata (SPS/PPS) needed for the stream header;
+     * pass them to StreamManager::setCodecParameters(), which copies them.
+     * 
+     * @return Parameters, null while the encoder is not initialized
+     */
+    [[nodiscard]] const AVCodecParameters* codecParameters() const;
+    
     /**
      * @brief Check if hardware encoding is available
      * @return true if NVENC/AMF/QSV is available
@@ -294,6 +330,8 @@ public:
         double averageEncodeTimeMs = 0.0;
         double currentFps = 0.0;
         double averageBitrateKbps = 0.0;
+        double averageConvertTimeMs = 0.0;  ///< Input to YUV conversion per frame
+        int64_t formatConversions = 0;      ///< Frames that needed a QImage format conversion first
     };
     [[nodiscard]] Statistics statistics() const;
 
@@ -306,6 +344,15 @@ signals:
      */
     void packetEncoded(int64_t pts, int size, bool isKeyframe);
     
+    /**
+     * @brief Rate-limited summary of encoded packets (10 Hz, GUI thread)
+     * 
+     * count = packets, bytes = encoded bytes, flagged = keyframes,
+     * lastValue = PTS of the newest packet. Prefer this over
+     * packetEncoded() for UI updates.
+     */
+    void encodeActivity(const WeaR::ActivitySummary& summary);
+    
     /**
      * @brief Emitted when encoder encounters an error
      * @param error Error description
@@ -322,6 +369,11 @@ signals:
      */
     void encoderStopped();
 
+protected:
+    // Deliver activity summaries only while someone listens
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
+
 private:
     // Private constructor for singleton
     explicit EncoderManager(QObject* parent = nullptr);
@@ -329,6 +381,9 @@ private:
     // Internal implementation
     class Impl;
     std::unique_ptr<Impl> m_impl;
+    
+    // Coalesced packet notifications for the GUI thread
+    ActivityMailbox* m_packetMailbox = nullptr;
 };
 
 } // namespace WeaR
@@ -0,0 +1,80 @@
+// ==============================================================================
+// WeaR-studio FrameConverter Implementation
+// ==============================================================================
+
+#include "FrameConverter.h"
+
+#include <QDebug>
+
+// FFmpeg headers (C linkage)
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace WeaR {
+
+// ==============================================================================
+// Per-thread scaler cache
+// ==============================================================================
+namespace {
+
+struct ScalerCache {
+    SwsContext* context = nullptr;
+
+    ~ScalerCache() {
+        if (context) {
+            sws_freeContext(context);
+        }
+    }
+};
+
+AVPixelFormat toAVPixelFormat(FramePixelFormat format) {
+    switch (format) {
+        case FramePixelFormat::NV12: return AV_PIX_FMT_NV12;
+        case FramePixelFormat::I420: return AV_PIX_FMT_YUV420P;
+        default: return AV_PIX_FMT_BGRA;
+    }
+}
+
+} // namespace
+
+QImage FrameConverter::toImage(const PlanarFrame& frame) {
+    if (!frame.isValid()) return QImage();
+
+    thread_local ScalerCache cache;
+
+    const int width = frame.size.width();
+    const int height = frame.size.height();
+
+    cache.context = sws_getCachedContext(
+        cache.context,
+        width, height, toAVPixelFormat(frame.format),
+        width, height, AV_PIX_FMT_BGRA,
+        SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
+    );
+
+    if (!cache.context) {
+        qWarning() << "Failed to create YUV to RGB scaler";
+        return QImage();
+    }
+
+    QImage image(width, height, QImage::Format_RGB32);
+    if (image.isNull()) return QImage();
+
+    uint8_t* dst[1] = { image.bits() };
+    int dstStride[1] = { static_cast<int>(image.bytesPerLine()) };
+
+    sws_scale(cache.context, frame.data, frame.linesize, 0, height, dst, dstStride);
+
+    return image;
+}
+
+QImage FrameConverter::toImage(const VideoFrame& frame) {
+    if (!frame.softwareFrame.isNull()) {
+        return frame.softwareFrame;
+    }
+    return toImage(frame.planes);
+}
+
+} // namespace WeaR
@@ -0,0 +1,45 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio FrameConverter
+// CPU pixel format conversion between planar YUV frames and QImage
+// ==============================================================================
+
+#include "ISource.h"
+
+#include <QImage>
+
+namespace WeaR {
+
+/**
+ * @brief Pixel format conversion helpers
+ * 
+ * Sources may hand out planar YUV frames (see PlanarFrame) so that
+ * YUV-capable consumers never pay for an RGB conversion. Consumers that
+ * only understand QImage use these helpers to convert on demand.
+ * 
+ * All functions are thread-safe; scaler contexts are cached per thread.
+ */
+class FrameConverter {
+public:
+    FrameConverter() = delete;
+
+    /**
+     * @brief Convert a planar frame to a 32-bit QImage
+     * @param frame Planar frame (NV12 or I420)
+     * @return Image in Format_RGB32, null if conversion failed
+     */
+    [[nodiscard]] static QImage toImage(const PlanarFrame& frame);
+
+    /**
+     * @brief Get a QImage for any software frame
+     * 
+     * Returns softwareFrame directly when present, otherwise converts
+     * the planar data.
+     * 
+     * @param frame Video frame
+     * @return Image, null if the frame has no CPU data
+     */
+    [[nodiscard]] static QImage toImage(const VideoFrame& frame);
+};
+
+} // namespace WeaR
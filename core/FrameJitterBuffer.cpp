@@ -0,0 +1,188 @@
+// ==============================================================================
+// WeaR-studio FrameJitterBuffer Implementation
+// ==============================================================================
+
+#include "FrameJitterBuffer.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace WeaR {
+
+std::atomic<int64_t> FrameJitterBuffer::s_defaultLatencyTargetUs{33000};
+
+FrameJitterBuffer::FrameJitterBuffer(int capacity)
+    : m_capacity(std::max(capacity, 2))
+{
+}
+
+// ==============================================================================
+// Clock
+// ==============================================================================
+int64_t FrameJitterBuffer::clockUs() {
+    static const QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed() / 1000;
+}
+
+void FrameJitterBuffer::setDefaultLatencyTargetUs(int64_t us) {
+    s_defaultLatencyTargetUs = std::max<int64_t>(us, 0);
+}
+
+int64_t FrameJitterBuffer::defaultLatencyTargetUs() {
+    return s_defaultLatencyTargetUs;
+}
+
+void FrameJitterBuffer::setLatencyTargetUs(int64_t us) {
+    QMutexLocker lock(&m_mutex);
+    m_latencyTargetUs = us < 0 ? -1 : us;
+}
+
+int64_t FrameJitterBuffer::latencyTargetUs() const {
+    QMutexLocker lock(&m_mutex);
+    return m_latencyTargetUs < 0 ? s_defaultLatencyTargetUs.load() : m_latencyTargetUs;
+}
+
+// ==============================================================================
+// Buffering
+// ==============================================================================
+bool FrameJitterBuffer::isBuffered(const VideoFrame& frame) const {
+    for (const Entry& entry : m_frames) {
+        const VideoFrame& buffered = entry.frame;
+        if (buffered.timestamp == frame.timestamp) return true;
+
+        // Static sources restamp the same pixels on every call
+        if (!frame.softwareFrame.isNull() &&
+            buffered.softwareFrame.cacheKey() == frame.softwareFrame.cacheKey()) {
+            return true;
+        }
+        if (frame.isPlanar() && buffered.planes.owner == frame.planes.owner) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FrameJitterBuffer::push(const VideoFrame& frame, int64_t clockUs) {
+    // Texture pointers are not owned by the frame and cannot be held;
+    // unstamped frames cannot be scheduled
+    if (!frame.isValid() || frame.isHardwareFrame || !frame.hasTimestamp) return false;
+
+    QMutexLocker lock(&m_mutex);
+
+    if (isBuffered(frame)) return true;
+
+    // Seek, loop or restart: the old mapping and frames no longer apply
+    if (!m_frames.empty()) {
+        const int64_t expected = clockUs - m_offsetUs;
+        if (frame.timestamp < m_frames.back().frame.timestamp ||
+            std::llabs(frame.timestamp - expected) > kDiscontinuityUs) {
+            resetLocked();
+        }
+    }
+
+    updateOffset(clockUs, frame.timestamp);
+
+    Entry entry;
+    entry.frame = frame;
+    entry.sequence = m_nextSequence++;
+    m_frames.push_back(std::move(entry));
+    m_stats.framesReceived++;
+
+    // Frame rate from PTS spacing
+    if (m_ptsFrames == 0) {
+        m_firstPts = frame.timestamp;
+    }
+    m_lastPts = frame.timestamp;
+    m_ptsFrames++;
+
+    // Full: the oldest frame is dropped unseen (counted as a skip when a
+    // later frame is shown)
+    while (static_cast<int>(m_frames.size()) > m_capacity) {
+        m_frames.pop_front();
+    }
+    return true;
+}
+
+void FrameJitterBuffer::updateOffset(int64_t clockUs, int64_t pts) {
+    m_offsetSamples.emplace_back(clockUs, clockUs - pts);
+    while (!m_offsetSamples.empty() && clockUs - m_offsetSamples.front().first > kOffsetWindowUs) {
+        m_offsetSamples.pop_front();
+    }
+
+    // The fastest arrival in the window is the least delayed one
+    int64_t offset = m_offsetSamples.front().second;
+    for (const auto& sample : m_offsetSamples) {
+        offset = std::min(offset, sample.second);
+    }
+    m_offsetUs = offset;
+}
+
+VideoFrame FrameJitterBuffer::select(int64_t canvasUs) {
+    QMutexLocker lock(&m_mutex);
+
+    if (m_frames.empty()) return VideoFrame();
+
+    const int64_t latency = m_latencyTargetUs < 0 ? s_defaultLatencyTargetUs.load() : m_latencyTargetUs;
+    const int64_t due = canvasUs - latency;
+
+    // Newest frame whose mapped PTS is due; the oldest if none is due yet
+    size_t chosen = 0;
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        if (m_frames[i].frame.timestamp + m_offsetUs <= due) {
+            chosen = i;
+        } else {
+            break;
+        }
+    }
+
+    // Older frames will never be shown
+    m_frames.erase(m_frames.begin(), m_frames.begin() + static_cast<std::ptrdiff_t>(chosen));
+    const Entry& shown = m_frames.front();
+
+    m_stats.ticks++;
+    if (shown.sequence == m_lastShown) {
+        m_stats.repeats++;
+    } else if (m_lastShown >= 0 && shown.sequence > m_lastShown + 1) {
+        m_stats.skips += shown.sequence - m_lastShown - 1;
+    }
+    m_lastShown = shown.sequence;
+
+    return shown.frame;
+}
+
+void FrameJitterBuffer::reset() {
+    QMutexLocker lock(&m_mutex);
+    resetLocked();
+}
+
+void FrameJitterBuffer::resetLocked() {
+    m_frames.clear();
+    m_offsetSamples.clear();
+    m_offsetUs = 0;
+    m_ptsFrames = 0;
+}
+
+FrameJitterStatistics FrameJitterBuffer::statistics() const {
+    QMutexLocker lock(&m_mutex);
+
+    FrameJitterStatistics stats = m_stats;
+    stats.buffered = static_cast<int>(m_frames.size());
+    if (stats.ticks > 0) {
+        stats.repeatRatio = static_cast<double>(stats.repeats) / stats.ticks;
+    }
+    if (stats.framesReceived > 0) {
+        stats.skipRatio = static_cast<double>(stats.skips) / stats.framesReceived;
+    }
+    if (m_ptsFrames > 1 && m_lastPts > m_firstPts) {
+        stats.sourceFps = (m_ptsFrames - 1) * 1e6 / (m_lastPts - m_firstPts);
+    }
+    return stats;
+}
+
+} // namespace WeaR
@@ -0,0 +1,132 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio FrameJitterBuffer
+// Timestamped source frames and PTS-based selection for canvas ticks
+// ==============================================================================
+
+#include "ISource.h"
+
+#include <QMutex>
+
+#include <atomic>
+#include <deque>
+#include <cstdint>
+
+namespace WeaR {
+
+/**
+ * @brief Frame timing statistics of one source
+ */
+struct FrameJitterStatistics {
+    int64_t framesReceived = 0;     ///< Distinct source frames seen
+    int64_t ticks = 0;              ///< Canvas ticks served
+    int64_t repeats = 0;            ///< Ticks that showed the previous frame again
+    int64_t skips = 0;              ///< Source frames never shown
+    int buffered = 0;               ///< Frames currently buffered
+    double repeatRatio = 0.0;       ///< repeats / ticks
+    double skipRatio = 0.0;         ///< skips / framesReceived
+    double sourceFps = 0.0;         ///< Frame rate measured from source PTS
+};
+
+/**
+ * @brief Short buffer of timestamped frames from one source
+ *
+ * Sources run at their own rate (24, 30, 50 fps, ...) while the canvas
+ * ticks at the output rate. Taking whatever frame is newest at each tick
+ * makes the cadence depend on when the tick happens to land, which shows
+ * as judder. Instead, new frames are buffered with their PTS, the PTS is
+ * mapped onto the pipeline clock (using the smallest observed arrival
+ * delay, tracked over a sliding window), and each tick shows the newest
+ * frame due at (tick time - latency target). Frames are thereby shown on
+ * a steady schedule, delayed by the latency target; the source's audio
+ * must be delayed by the same amount (SceneItem::currentAudioFrame()).
+ *
+ * A PTS discontinuity (seek, loop, source restart) resets the mapping.
+ * Thread-safe.
+ */
+class FrameJitterBuffer {
+public:
+    /**
+     * @brief Create a buffer
+     * @param capacity Frames kept at most
+     */
+    explicit FrameJitterBuffer(int capacity = 6);
+
+    /**
+     * @brief Offer the source's current frame
+     *
+     * Frames already buffered (same timestamp or same pixel data) are
+     * ignored, so polling a source every tick is fine.
+     *
+     * @param frame Source frame (hardware and unstamped frames are not buffered)
+     * @param clockUs Arrival time on the pipeline clock
+     * @return false if the frame cannot be buffered (use it directly)
+     */
+    bool push(const VideoFrame& frame, int64_t clockUs);
+
+    /**
+     * @brief Get the frame to show at a canvas tick
+     * @param canvasUs Tick time on the pipeline clock
+     * @return Frame due at canvasUs minus the latency target (invalid if empty)
+     */
+    [[nodiscard]] VideoFrame select(int64_t canvasUs);
+
+    /**
+     * @brief Set the latency target of this buffer
+     * @param us Delay behind the canvas clock, -1 for the default
+     */
+    void setLatencyTargetUs(int64_t us);
+    [[nodiscard]] int64_t latencyTargetUs() const;
+
+    /**
+     * @brief Drop buffered frames and the clock mapping
+     */
+    void reset();
+
+    /**
+     * @brief Get statistics
+     */
+    [[nodiscard]] FrameJitterStatistics statistics() const;
+
+    /**
+     * @brief Set the latency target used by buffers without their own
+     */
+    static void setDefaultLatencyTargetUs(int64_t us);
+    [[nodiscard]] static int64_t defaultLatencyTargetUs();
+
+    /**
+     * @brief Current time on the pipeline clock (monotonic, microseconds)
+     */
+    [[nodiscard]] static int64_t clockUs();
+
+private:
+    struct Entry {
+        VideoFrame frame;
+        int64_t sequence = 0;
+    };
+
+    bool isBuffered(const VideoFrame& frame) const;
+    void updateOffset(int64_t clockUs, int64_t pts);
+    void resetLocked();
+
+    mutable QMutex m_mutex;
+    std::deque<Entry> m_frames;             ///< Ascending PTS
+    std::deque<std::pair<int64_t, int64_t>> m_offsetSamples; ///< (clock, clock - pts)
+    int m_capacity;
+    int64_t m_offsetUs = 0;
+    int64_t m_latencyTargetUs = -1;
+
+    int64_t m_nextSequence = 0;
+    int64_t m_lastShown = -1;
+    int64_t m_firstPts = 0;
+    int64_t m_lastPts = 0;
+    int64_t m_ptsFrames = 0;                ///< Frames since m_firstPts
+    FrameJitterStatistics m_stats;
+
+    static std::atomic<int64_t> s_defaultLatencyTargetUs;
+
+    static constexpr int64_t kOffsetWindowUs = 2000000;     ///< Arrival delay window
+    static constexpr int64_t kDiscontinuityUs = 1000000;    ///< PTS jump that resets the mapping
+};
+
+} // namespace WeaR
@@ -151,5 +151,5 @@ public:
 } // namespace WeaR
 
 // Qt Plugin interface declaration for filters
-#define WEAR_FILTER_IID "com.wear-studio.filter/1.0"
+#define WEAR_FILTER_IID "com.wear-studio.filter/1.1"
 Q_DECLARE_INTERFACE(WeaR::IFilter, WEAR_FILTER_IID)
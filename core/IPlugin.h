@@ -10,6 +10,8 @@
 
 namespace WeaR {
 
+class IPluginHost;
+
 /**
  * @brief Plugin type enumeration
  * Defines the category of functionality a plugin provides
@@ -76,10 +78,11 @@ struct PluginInfo {
  * All WeaR-studio plugins must implement this interface.
  * The plugin lifecycle is:
  * 1. Plugin is loaded via PluginManager
- * 2. initialize() is called
- * 3. Plugin is used by the application
- * 4. shutdown() is called before unloading
- * 5. Plugin is unloaded
+ * 2. attachHost() hands over the application services
+ * 3. initialize() is called
+ * 4. Plugin is used by the application
+ * 5. shutdown() is called before unloading
+ * 6. Plugin is unloaded
  * 
  * @note Plugins must be thread-safe if they set the ThreadSafe capability
  */
@@ -117,6 +120,17 @@ public:
      */
     [[nodiscard]] virtual PluginCapability capabilities() const = 0;
 
+    /**
+     * @brief Receive the application services
+     * 
+     * Called by the host before initialize(). Plugins that need shared
+     * services (image cache, thread roles) keep the pointer and use it
+     * instead of the core singletons, which are per-module copies.
+     * 
+     * @param host Application services, valid until the plugin is unloaded
+     */
+    virtual void attachHost(IPluginHost* host) { Q_UNUSED(host); }
+
     /**
      * @brief Initialize the plugin
      * 
@@ -157,5 +171,5 @@ public:
 } // namespace WeaR
 
 // Qt Plugin interface declaration
-#define WEAR_PLUGIN_IID "com.wear-studio.plugin/1.0"
+#define WEAR_PLUGIN_IID "com.wear-studio.plugin/1.1"
 Q_DECLARE_INTERFACE(WeaR::IPlugin, WEAR_PLUGIN_IID)
@@ -0,0 +1,80 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio Plugin Host Interface
+// IPluginHost.h - Application services offered to plugins
+// ==============================================================================
+
+#include <QImage>
+#include <QString>
+
+namespace WeaR {
+
+class ISource;                  // ISource.h
+struct ImageKey;                // ImageCache.h
+struct ImageSequenceInfo;       // ImageCache.h
+enum class ThreadRole;          // ThreadPolicy.h
+
+/**
+ * @brief Application services available to plugins
+ *
+ * Plugins are separate modules that link the static core library, so a
+ * plugin calling ImageCache::instance() or ThreadPolicy::instance() would
+ * get its own copy of that singleton (and of the JobSystem, MemoryGovernor
+ * and QualityGovernor behind it). The host passes this interface to every
+ * plugin before initialize(); its methods are virtual and run in the host
+ * module, so plugin work is accounted against the application's caches,
+ * budgets, worker pool and thread roles.
+ *
+ * Only the value types used in the signatures are needed by a plugin;
+ * they are forward-declared here so this header does not pull in the
+ * implementation classes.
+ *
+ * The host outlives every plugin it is attached to.
+ */
+class IPluginHost {
+public:
+    virtual ~IPluginHost() = default;
+
+    // =========================================================================
+    // Image Cache
+    // =========================================================================
+
+    /**
+     * @brief Look up a decoded frame without blocking (ImageCache::lookup)
+     * @return Decoded image, or null while it is being decoded
+     */
+    [[nodiscard]] virtual QImage lookupImage(const ImageKey& key, int frameIndex) = 0;
+
+    /**
+     * @brief Decode upcoming sequence frames in the background (ImageCache::prefetch)
+     */
+    virtual void prefetchImage(const ImageKey& key, int firstFrame) = 0;
+
+    /**
+     * @brief Get frame count and timing of a file (ImageCache::sequenceInfo)
+     */
+    [[nodiscard]] virtual ImageSequenceInfo imageSequenceInfo(const ImageKey& key) = 0;
+
+    // =========================================================================
+    // Threads
+    // =========================================================================
+
+    /**
+     * @brief Apply a role's policy to the calling thread (ThreadPolicy::applyToCurrentThread)
+     */
+    virtual void applyThreadRole(ThreadRole role, const QString& threadName) = 0;
+
+    // =========================================================================
+    // Settings
+    // =========================================================================
+
+    /**
+     * @brief Report that a source's saved settings changed
+     *
+     * Call it when the source's settings widget changes anything
+     * saveSettings() returns, so the scene collection saves the change.
+     */
+    virtual void notifySourceSettingsChanged(ISource* source) = 0;
+};
+
+} // namespace WeaR
@@ -8,6 +8,7 @@
 #include <QImage>
 #include <QSize>
 #include <QRect>
+#include <QVariantMap>
 #include <memory>
 
 // Forward declarations for hardware acceleration
@@ -16,24 +17,202 @@ struct ID3D11Device;
 
 namespace WeaR {
 
+/**
+ * @brief Pixel layout of CPU frame data
+ */
+enum class FramePixelFormat {
+    BGRA,       ///< Packed 32-bit, stored in VideoFrame::softwareFrame
+    NV12,       ///< Y plane + interleaved UV plane (4:2:0)
+    I420        ///< Separate Y, U and V planes (4:2:0)
+};
+
+/**
+ * @brief Planar (YUV) frame data shared by reference
+ * 
+ * Plane pointers alias memory owned by @c owner (e.g. a decoder frame),
+ * so copying a PlanarFrame never copies pixels.
+ */
+struct PlanarFrame {
+    FramePixelFormat format = FramePixelFormat::I420;
+    QSize size;                         ///< Luma dimensions
+    const uint8_t* data[3] = {};        ///< Plane pointers (unused planes are null)
+    int linesize[3] = {};               ///< Plane strides in bytes
+    std::shared_ptr<const void> owner;  ///< Keeps the plane memory alive
+
+    [[nodiscard]] bool isValid() const {
+        return owner && data[0] && size.isValid() &&
+               format != FramePixelFormat::BGRA;
+    }
+};
+
 /**
  * @brief Video frame data container
- * Holds either software (QImage) or hardware (D3D11 texture) frame data
+ * Holds software (QImage or planar YUV) or hardware (D3D11 texture) frame data
  */
 struct VideoFrame {
     QImage softwareFrame;           ///< CPU-accessible frame (RGBA)
+    PlanarFrame planes;             ///< CPU-accessible planar frame (alternative to softwareFrame)
     ID3D11Texture2D* hardwareFrame = nullptr;  ///< GPU texture (optional)
+    QSize hardwareSize;             ///< Dimensions of hardwareFrame
+    QRect cropRect;                 ///< Visible region of hardwareFrame (empty = full)
     int64_t timestamp = 0;          ///< Presentation timestamp (microseconds)
     int64_t frameNumber = 0;        ///< Sequential frame number
+    bool hasTimestamp = false;      ///< timestamp was set by the source (false = unstamped)
     bool isHardwareFrame = false;   ///< True if hardwareFrame is valid
 
     [[nodiscard]] bool isValid() const {
-        return isHardwareFrame ? (hardwareFrame != nullptr) : !softwareFrame.isNull();
+        if (isHardwareFrame) return hardwareFrame != nullptr;
+        return !softwareFrame.isNull() || planes.isValid();
+    }
+
+    [[nodiscard]] bool isPlanar() const {
+        return softwareFrame.isNull() && planes.isValid();
+    }
+
+    [[nodiscard]] FramePixelFormat pixelFormat() const {
+        return isPlanar() ? planes.format : FramePixelFormat::BGRA;
     }
 
     [[nodiscard]] QSize size() const {
-        return softwareFrame.isNull() ? QSize() : softwareFrame.size();
+        if (!softwareFrame.isNull()) return softwareFrame.size();
+        if (planes.isValid()) return planes.size;
+        return cropRect.isEmpty() ? hardwareSize : cropRect.size();
+    }
+
+    /**
+     * @brief Get a cropped view of this frame without copying pixels
+     * 
+     * The software frame becomes a QImage that points into the original
+     * buffer at the region's offset, keeping the original row stride. The
+     * original buffer stays alive for as long as the view does. Hardware
+     * frames only record the region in cropRect for the consumer to apply,
+     * clipped to the texture (hardwareSize) or the previous crop.
+     *
+     * Each call creates a new QImage, so the view has a new cacheKey();
+     * sources cropping every capture should go through a CroppedViewCache.
+     * 
+     * @param region Region of interest in frame coordinates (empty = full)
+     * @return Frame restricted to the region
+     */
+    [[nodiscard]] VideoFrame cropped(const QRect& region) const {
+        if (region.isEmpty()) return *this;
+
+        VideoFrame view = *this;
+        if (!softwareFrame.isNull()) {
+            view.softwareFrame = cropImageView(softwareFrame, region);
+        }
+        if (planes.isValid()) {
+            view.planes = cropPlanesView(planes, region);
+        }
+        if (hardwareFrame) {
+            const QRect bounds = cropRect.isEmpty() ? QRect(QPoint(0, 0), hardwareSize) : cropRect;
+            const QRect r = region.translated(bounds.topLeft());
+            view.cropRect = bounds.isEmpty() ? r : r.intersected(bounds);
+        }
+        return view;
+    }
+
+    /**
+     * @brief Create a stride-offset view of an image region (zero-copy)
+     * @param image Source image (must use a whole-byte pixel depth)
+     * @param region Region of interest, clipped to the image
+     * @return Image sharing the source pixels, or the source if no crop applies
+     */
+    [[nodiscard]] static QImage cropImageView(const QImage& image, const QRect& region) {
+        QRect r = region.intersected(image.rect());
+        if (r.isEmpty() || r == image.rect() || image.depth() < 8 || image.depth() % 8 != 0) {
+            return image;
+        }
+
+        // constBits() on a const image never detaches, so the view aliases
+        // the same buffer the source frame was produced into
+        const int bytesPerPixel = image.depth() / 8;
+        const uchar* origin = image.constBits()
+                            + static_cast<qsizetype>(r.y()) * image.bytesPerLine()
+                            + static_cast<qsizetype>(r.x()) * bytesPerPixel;
+
+        // The view holds a shallow copy of the source as its cleanup info so
+        // the underlying buffer outlives every consumer of the view
+        auto* keepAlive = new QImage(image);
+        return QImage(
+            origin, r.width(), r.height(), image.bytesPerLine(), image.format(),
+            [](void* info) { delete static_cast<QImage*>(info); },
+            keepAlive
+        );
+    }
+
+    /**
+     * @brief Create a plane-offset view of a 4:2:0 planar region (zero-copy)
+     * 
+     * The region is aligned to even coordinates so chroma samples stay
+     * co-sited with their luma block.
+     */
+    [[nodiscard]] static PlanarFrame cropPlanesView(const PlanarFrame& frame, const QRect& region) {
+        QRect r = region.intersected(QRect(QPoint(0, 0), frame.size));
+        r.setLeft(r.left() & ~1);
+        r.setTop(r.top() & ~1);
+        r.setWidth(r.width() & ~1);
+        r.setHeight(r.height() & ~1);
+        if (r.isEmpty() || r.size() == frame.size) return frame;
+
+        PlanarFrame view = frame;
+        view.size = r.size();
+        view.data[0] = frame.data[0] + r.y() * frame.linesize[0] + r.x();
+        if (frame.format == FramePixelFormat::NV12) {
+            view.data[1] = frame.data[1] + (r.y() / 2) * frame.linesize[1] + r.x();
+        } else {
+            view.data[1] = frame.data[1] + (r.y() / 2) * frame.linesize[1] + r.x() / 2;
+            view.data[2] = frame.data[2] + (r.y() / 2) * frame.linesize[2] + r.x() / 2;
+        }
+        return view;
+    }
+};
+
+/**
+ * @brief Keeps the cropped view of an unchanged frame stable
+ *
+ * VideoFrame::cropped() wraps the region in a new QImage, which has a new
+ * cacheKey() every time. Downstream caches keyed on cacheKey() (dirty
+ * tiles, transformed rasters, YUV layers, duplicate detection) only hit
+ * when an unchanged frame comes back as the same view, so sources that
+ * crop on every capture keep one of these and crop through it.
+ */
+class CroppedViewCache {
+public:
+    /**
+     * @brief Crop a frame, reusing the previous view for the same image and region
+     */
+    [[nodiscard]] VideoFrame crop(const VideoFrame& frame, const QRect& region) {
+        if (region.isEmpty() || frame.softwareFrame.isNull()) return frame.cropped(region);
+
+        const qint64 key = frame.softwareFrame.cacheKey();
+        if (key != m_sourceKey || region != m_region) {
+            m_sourceKey = key;
+            m_region = region;
+            m_view = VideoFrame::cropImageView(frame.softwareFrame, region);
+        }
+
+        // Planes and hardware crops are plain values; only the image is reused
+        VideoFrame rest = frame;
+        rest.softwareFrame = QImage();
+        VideoFrame view = rest.cropped(region);
+        view.softwareFrame = m_view;
+        return view;
     }
+
+    /**
+     * @brief Drop the remembered view (and its reference to the source image)
+     */
+    void clear() {
+        m_sourceKey = 0;
+        m_region = QRect();
+        m_view = QImage();
+    }
+
+private:
+    qint64 m_sourceKey = 0;
+    QRect m_region;
+    QImage m_view;
 };
 
 /**
@@ -180,10 +359,32 @@ public:
     [[nodiscard]] virtual QStringList availableDevices() const {
         return QStringList();
     }
+
+    /**
+     * @brief Get source-specific settings for persistence
+     * 
+     * Everything not covered by SourceConfig (file paths, text, ...).
+     * Scene collections store the map and pass it back to loadSettings().
+     * 
+     * @return Settings (values must be JSON-compatible)
+     */
+    [[nodiscard]] virtual QVariantMap saveSettings() const {
+        return QVariantMap();
+    }
+
+    /**
+     * @brief Restore settings produced by saveSettings()
+     * @param settings Previously saved settings
+     * @return true if applied
+     */
+    virtual bool loadSettings(const QVariantMap& settings) {
+        (void)settings;
+        return true;
+    }
 };
 
 } // namespace WeaR
 
 // Qt Plugin interface declaration for sources
-#define WEAR_SOURCE_IID "com.wear-studio.source/1.0"
+#define WEAR_SOURCE_IID "com.wear-studio.source/1.1"
 Q_DECLARE_INTERFACE(WeaR::ISource, WEAR_SOURCE_IID)
@@ -0,0 +1,457 @@
+// ==============================================================================
+// WeaR-studio ImageCache Implementation
+// Process-wide cache of decoded still images and image sequences
+// ==============================================================================
+
+#include "ImageCache.h"
+#include "MemoryGovernor.h"
+#include "QualityGovernor.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QImageReader>
+
+#include <algorithm>
+
+namespace WeaR {
+
+namespace {
+
+constexpr int kDefaultFrameDelayMs = 100;
+
+QImage toCompositorFormat(const QImage& image, const QSize& targetSize) {
+    QImage result = image;
+
+    // Not every format plugin honours setScaledSize (e.g. some animations)
+    if (targetSize.isValid() && result.size() != targetSize) {
+        result = result.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    // Decode straight into the format the compositor blends fastest
+    const QImage::Format format = result.hasAlphaChannel()
+        ? QImage::Format_ARGB32_Premultiplied
+        : QImage::Format_RGB32;
+    if (result.format() != format) {
+        result.convertTo(format);
+    }
+    return result;
+}
+
+} // namespace
+
+// ==============================================================================
+// ImageKey / ImageSequenceInfo
+// ==============================================================================
+QString ImageKey::toString(int frameIndex) const {
+    return QString("%1|%2|%3x%4|%5")
+        .arg(path)
+        .arg(modifiedMs)
+        .arg(targetSize.width())
+        .arg(targetSize.height())
+        .arg(frameIndex);
+}
+
+int ImageSequenceInfo::delayMs(int frameIndex) const {
+    if (frameIndex >= 0 && frameIndex < static_cast<int>(frameDelaysMs.size())) {
+        int delay = frameDelaysMs[frameIndex];
+        // Browsers treat tiny GIF delays as "as fast as reasonable"
+        if (delay > 10) return delay;
+    }
+    return kDefaultFrameDelayMs;
+}
+
+// ==============================================================================
+// ImageCache Singleton
+// ==============================================================================
+ImageCache& ImageCache::instance() {
+    static ImageCache instance;
+    return instance;
+}
+
+ImageCache::ImageCache(QObject* parent)
+    : QObject(parent)
+{
+    // Decodes run as background jobs; construct the scheduler first so it
+    // outlives this cache
+    JobSystem::instance();
+
+    m_memoryStage = MemoryGovernor::instance().registerStage(
+        QStringLiteral("Decoded image cache"), MemoryClass::Thumbnail,
+        [this](int64_t bytesWanted) { return shed(bytesWanted); }
+    );
+}
+
+ImageCache::~ImageCache() {
+    m_shuttingDown = true;
+    m_decodeJobs.wait();
+    clear();
+    MemoryGovernor::instance().unregisterStage(m_memoryStage);
+}
+
+ImageKey ImageCache::keyFor(const QString& path, const QSize& targetSize) {
+    ImageKey key;
+    QFileInfo info(path);
+    if (!info.exists()) return key;
+
+    key.path = info.absoluteFilePath();
+    key.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+    key.targetSize = targetSize;
+    return key;
+}
+
+QImage ImageCache::lookup(const ImageKey& key, int frameIndex) {
+    if (!key.isValid()) return QImage();
+
+    const QString cacheKey = key.toString(frameIndex);
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_entries.find(cacheKey);
+        if (it != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->lruPosition);
+            return it->image;
+        }
+    }
+
+    schedule(key, frameIndex, 1);
+    return QImage();
+}
+
+QImage ImageCache::get(const ImageKey& key, int frameIndex) {
+    if (!key.isValid()) return QImage();
+
+    QImage image = lookup(key, frameIndex);
+    if (!image.isNull()) return image;
+
+    // Returned even if the memory budget did not allow caching it
+    return decodeFrame(key, frameIndex);
+}
+
+void ImageCache::prefetch(const ImageKey& key, int firstFrame) {
+    if (!key.isValid()) return;
+
+    int count;
+    {
+        QMutexLocker lock(&m_mutex);
+        count = m_prefetchFrames;
+    }
+
+    // While the quality governor sheds background work only the frame
+    // playback needs next is decoded; the deeper read-ahead is skipped
+    if (!QualityGovernor::instance().thumbnailsEnabled()) {
+        count = 1;
+    }
+
+    // The window wraps to the start of the sequence for looping playback
+    const int frameCount = std::max(sequenceInfo(key).frameCount, 1);
+    const int first = firstFrame % frameCount;
+    count = std::min(count, frameCount);
+    const int tail = std::min(count, frameCount - first);
+    schedule(key, first, tail);
+    if (count > tail) {
+        schedule(key, 0, count - tail);
+    }
+}
+
+ImageSequenceInfo ImageCache::sequenceInfo(const ImageKey& key) {
+    const QString infoKey = key.toString(-1);
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_sequences.find(infoKey);
+        if (it != m_sequences.end()) return *it;
+    }
+
+    // Header only - no pixel decoding
+    ImageSequenceInfo info;
+    QImageReader reader(key.path);
+    if (reader.canRead()) {
+        info.frameCount = std::max(reader.imageCount(), 1);
+        info.loopCount = reader.loopCount();
+        info.nativeSize = reader.size();
+    }
+    info.frameDelaysMs.assign(info.frameCount, 0);
+
+    QMutexLocker lock(&m_mutex);
+    return *m_sequences.insert(infoKey, info);
+}
+
+void ImageCache::setBudgetBytes(qint64 bytes) {
+    QMutexLocker lock(&m_mutex);
+    m_budgetBytes = std::max<qint64>(bytes, 0);
+    evictLocked(m_budgetBytes);
+}
+
+qint64 ImageCache::budgetBytes() const {
+    QMutexLocker lock(&m_mutex);
+    return m_budgetBytes;
+}
+
+qint64 ImageCache::usedBytes() const {
+    QMutexLocker lock(&m_mutex);
+    return m_usedBytes;
+}
+
+void ImageCache::setPrefetchFrames(int frames) {
+    QMutexLocker lock(&m_mutex);
+    m_prefetchFrames = std::clamp(frames, 1, 256);
+}
+
+void ImageCache::invalidate(const QString& path) {
+    const QString absolutePath = QFileInfo(path).absoluteFilePath();
+
+    QMutexLocker lock(&m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->path == absolutePath) {
+            m_usedBytes -= it->image.sizeInBytes();
+            MemoryGovernor::instance().release(m_memoryStage, it->image.sizeInBytes());
+            m_lru.erase(it->lruPosition);
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const QString prefix = absolutePath + '|';
+    for (auto it = m_sequences.begin(); it != m_sequences.end();) {
+        it = it.key().startsWith(prefix) ? m_sequences.erase(it) : std::next(it);
+    }
+
+    // A busy decoder keeps running on its own reference and is dropped
+    // once drained
+    for (auto it = m_decoders.begin(); it != m_decoders.end();) {
+        it = it.key().startsWith(prefix) ? m_decoders.erase(it) : std::next(it);
+    }
+}
+
+void ImageCache::clear() {
+    QMutexLocker lock(&m_mutex);
+    m_entries.clear();
+    m_lru.clear();
+    m_sequences.clear();
+    m_decoders.clear();
+    MemoryGovernor::instance().release(m_memoryStage, m_usedBytes);
+    m_usedBytes = 0;
+}
+
+// ==============================================================================
+// Decoding
+// ==============================================================================
+void ImageCache::schedule(const ImageKey& key, int firstFrame, int count) {
+    // Frames past the end would never decode and stay pending forever
+    const int frameCount = sequenceInfo(key).frameCount;
+    count = std::min(firstFrame + count, frameCount) - firstFrame;
+    if (firstFrame < 0 || count <= 0) return;
+
+    const QString infoKey = key.toString(-1);
+    std::shared_ptr<SequenceDecoder> decoder;
+    {
+        QMutexLocker lock(&m_mutex);
+
+        // Queue only frames that are neither cached nor already queued
+        std::vector<int> frames;
+        for (int frame = firstFrame; frame < firstFrame + count; ++frame) {
+            const QString cacheKey = key.toString(frame);
+            if (!m_entries.contains(cacheKey) && !m_pending.contains(cacheKey)) {
+                m_pending.insert(cacheKey);
+                frames.push_back(frame);
+            }
+        }
+        if (frames.empty()) return;
+
+        std::shared_ptr<SequenceDecoder>& slot = m_decoders[infoKey];
+        if (!slot) {
+            slot = std::make_shared<SequenceDecoder>();
+        }
+        slot->wanted.insert(frames.begin(), frames.end());
+
+        if (slot->running) return;
+        slot->running = true;
+        decoder = slot;
+    }
+
+    m_decodeJobs.run([this, key, decoder]() {
+        runDecoder(key, decoder);
+    });
+}
+
+void ImageCache::runDecoder(const ImageKey& key, const std::shared_ptr<SequenceDecoder>& decoder) {
+    const QString infoKey = key.toString(-1);
+    const int frameCount = sequenceInfo(key).frameCount;
+
+    while (true) {
+        int target;
+        {
+            QMutexLocker lock(&m_mutex);
+            if (m_shuttingDown) {
+                for (int frame : decoder->wanted) {
+                    m_pending.remove(key.toString(frame));
+                }
+                decoder->wanted.clear();
+            }
+            if (decoder->wanted.empty()) {
+                decoder->running = false;
+
+                // Keep only decoders parked in the middle of a sequence
+                auto it = m_decoders.find(infoKey);
+                if (!decoder->reader && it != m_decoders.end() && it.value() == decoder) {
+                    m_decoders.erase(it);
+                }
+                return;
+            }
+
+            // Carry on forward; go back only when nothing is ahead
+            auto next = decoder->wanted.lower_bound(decoder->nextFrame);
+            target = next != decoder->wanted.end() ? *next : *decoder->wanted.begin();
+        }
+
+        if (!decoder->reader || target < decoder->nextFrame) {
+            decoder->reader = std::make_unique<QImageReader>(key.path);
+            decoder->reader->setAutoTransform(true);
+            if (key.targetSize.isValid()) {
+                decoder->reader->setScaledSize(key.targetSize);
+            }
+            decoder->nextFrame = 0;
+
+            // Random access when the format supports it (GIF does not)
+            if (target > 0 && decoder->reader->jumpToImage(target)) {
+                decoder->nextFrame = target;
+            }
+        }
+
+        bool failed = false;
+        while (decoder->nextFrame <= target) {
+            const int frame = decoder->nextFrame;
+            QImage decoded = decoder->reader->read();
+            if (decoded.isNull()) {
+                if (frame == 0) {
+                    qWarning() << "Failed to decode image:" << key.path << decoder->reader->errorString();
+                }
+                failed = true;
+                break;
+            }
+            ++decoder->nextFrame;
+
+            const QString cacheKey = key.toString(frame);
+            bool missing;
+            {
+                QMutexLocker lock(&m_mutex);
+                auto it = m_sequences.find(infoKey);
+                if (it != m_sequences.end() && frame < static_cast<int>(it->frameDelaysMs.size())) {
+                    it->frameDelaysMs[frame] = decoder->reader->nextImageDelay();
+                }
+                missing = !m_entries.contains(cacheKey);
+            }
+
+            // Frames passed on the way to the target are kept too, unless
+            // an earlier pass left them cached
+            if (missing) {
+                insert(cacheKey, key.path, toCompositorFormat(decoded, key.targetSize));
+                emit imageReady(key.path, frame);
+            }
+
+            QMutexLocker lock(&m_mutex);
+            decoder->wanted.erase(frame);
+            m_pending.remove(cacheKey);
+        }
+
+        QMutexLocker lock(&m_mutex);
+        if (failed) {
+            // Nothing at or after this frame will decode; the header may
+            // have promised more frames than the file holds
+            const int frame = decoder->nextFrame;
+            for (auto it = decoder->wanted.lower_bound(frame); it != decoder->wanted.end();) {
+                m_pending.remove(key.toString(*it));
+                it = decoder->wanted.erase(it);
+            }
+            auto info = m_sequences.find(infoKey);
+            if (frame > 0 && info != m_sequences.end() && frame < info->frameCount) {
+                info->frameCount = frame;
+                info->frameDelaysMs.resize(frame);
+            }
+        }
+        if (failed || decoder->nextFrame >= frameCount) {
+            // The next loop starts over; don't hold the file meanwhile
+            decoder->reader.reset();
+            decoder->nextFrame = 0;
+        }
+    }
+}
+
+QImage ImageCache::decodeFrame(const ImageKey& key, int frameIndex) {
+    QImageReader reader(key.path);
+    reader.setAutoTransform(true);
+    if (key.targetSize.isValid()) {
+        reader.setScaledSize(key.targetSize);
+    }
+
+    // Random access when the format supports it, otherwise decode forward
+    int frame = 0;
+    if (frameIndex > 0 && reader.jumpToImage(frameIndex)) {
+        frame = frameIndex;
+    }
+
+    QImage decoded;
+    for (; frame <= frameIndex; ++frame) {
+        decoded = reader.read();
+        if (decoded.isNull()) {
+            qWarning() << "Failed to decode image:" << key.path << reader.errorString();
+            return QImage();
+        }
+    }
+
+    const QString cacheKey = key.toString(frameIndex);
+    QImage converted = toCompositorFormat(decoded, key.targetSize);
+    bool missing;
+    {
+        QMutexLocker lock(&m_mutex);
+        missing = !m_entries.contains(cacheKey);
+    }
+    if (missing) {
+        insert(cacheKey, key.path, converted);
+    }
+    return converted;
+}
+
+void ImageCache::insert(const QString& cacheKey, const QString& path, const QImage& image) {
+    // Reserve before locking: the governor may call back into shed()
+    if (!MemoryGovernor::instance().reserve(m_memoryStage, image.sizeInBytes())) {
+        return;
+    }
+
+    QMutexLocker lock(&m_mutex);
+
+    auto existing = m_entries.find(cacheKey);
+    if (existing != m_entries.end()) {
+        m_usedBytes -= existing->image.sizeInBytes();
+        MemoryGovernor::instance().release(m_memoryStage, existing->image.sizeInBytes());
+        m_lru.erase(existing->lruPosition);
+        m_entries.erase(existing);
+    }
+
+    m_lru.push_front(cacheKey);
+    m_entries.insert(cacheKey, Entry{image, path, m_lru.begin()});
+    m_usedBytes += image.sizeInBytes();
+
+    evictLocked(m_budgetBytes);
+}
+
+void ImageCache::evictLocked(qint64 budget) {
+    // Keep at least the most recent entry so an oversized image still shows
+    while (m_usedBytes > budget && m_lru.size() > 1) {
+        auto it = m_entries.find(m_lru.back());
+        if (it != m_entries.end()) {
+            m_usedBytes -= it->image.sizeInBytes();
+            MemoryGovernor::instance().release(m_memoryStage, it->image.sizeInBytes());
+            m_entries.erase(it);
+        }
+        m_lru.pop_back();
+    }
+}
+
+qint64 ImageCache::shed(qint64 bytesWanted) {
+    QMutexLocker lock(&m_mutex);
+    const qint64 before = m_usedBytes;
+    evictLocked(std::max<qint64>(m_usedBytes - bytesWanted, 0));
+    return before - m_usedBytes;
+}
+
+} // namespace WeaR
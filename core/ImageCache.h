@@ -0,0 +1,224 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio ImageCache
+// Process-wide cache of decoded still images and image sequences
+// ==============================================================================
+
+#include "JobSystem.h"
+
+#include <QObject>
+#include <QImage>
+#include <QString>
+#include <QSize>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+
+#include <list>
+#include <memory>
+#include <set>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+class QImageReader;
+
+namespace WeaR {
+
+/**
+ * @brief Identifies one decoded image in the cache
+ *
+ * The file's modification time is part of the key, so editing an
+ * overlay on disk naturally invalidates its cached frames.
+ */
+struct ImageKey {
+    QString path;               ///< Absolute file path
+    qint64 modifiedMs = 0;      ///< File modification time (ms since epoch)
+    QSize targetSize;           ///< Decode size (invalid = native size)
+
+    [[nodiscard]] bool isValid() const { return !path.isEmpty(); }
+    [[nodiscard]] QString toString(int frameIndex) const;
+};
+
+/**
+ * @brief Timing information for an animated image
+ */
+struct ImageSequenceInfo {
+    int frameCount = 1;             ///< Number of frames (1 for still images)
+    int loopCount = -1;             ///< -1 = loop forever, 0 = play once
+    std::vector<int> frameDelaysMs; ///< Per-frame delay, filled as frames decode
+    QSize nativeSize;               ///< Size of the image on disk
+
+    [[nodiscard]] bool isAnimated() const { return frameCount > 1; }
+
+    /**
+     * @brief Delay of a frame, with a sane default for unknown delays
+     */
+    [[nodiscard]] int delayMs(int frameIndex) const;
+};
+
+/**
+ * @brief Process-wide decoded image cache
+ *
+ * Image sources look up decoded frames here instead of decoding files
+ * themselves, so an overlay used by several items or scenes is decoded
+ * once and shared (QImage is implicitly shared, no pixel copies).
+ *
+ * - Entries are keyed by path, modification time, target size and frame
+ * - Total decoded size is capped by an LRU byte budget
+ * - Decoding runs as background jobs on the JobSystem; lookups never block
+ * - Requesting a sequence frame also decodes the following frames
+ * - Each sequence has one forward-only decoder whose reader stays open
+ *   between requests, so formats without random access (GIF) are not
+ *   decoded from the first frame again for every prefetch
+ * - Decoded bytes are also accounted with the MemoryGovernor, which may
+ *   evict entries when the pipeline needs the memory
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class ImageCache : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the ImageCache instance
+     */
+    static ImageCache& instance();
+
+    // Prevent copying
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    ~ImageCache() override;
+
+    /**
+     * @brief Build a cache key for a file
+     *
+     * Reads the file's modification time; callers should keep the key
+     * and refresh it occasionally rather than calling this per frame.
+     *
+     * @param path File path
+     * @param targetSize Decode size (invalid = native size)
+     * @return Key, invalid if the file does not exist
+     */
+    [[nodiscard]] static ImageKey keyFor(const QString& path, const QSize& targetSize = QSize());
+
+    /**
+     * @brief Look up a decoded frame without blocking
+     *
+     * If the frame is not cached, a background decode is scheduled and a
+     * null image is returned; imageReady() is emitted once it is available.
+     *
+     * @param key Image key
+     * @param frameIndex Frame of a sequence (0 for still images)
+     * @return Decoded image, or null if not cached yet
+     */
+    [[nodiscard]] QImage lookup(const ImageKey& key, int frameIndex = 0);
+
+    /**
+     * @brief Decode a frame synchronously if it is not cached
+     * @param key Image key
+     * @param frameIndex Frame of a sequence
+     * @return Decoded image, null on failure
+     */
+    [[nodiscard]] QImage get(const ImageKey& key, int frameIndex = 0);
+
+    /**
+     * @brief Schedule background decoding of upcoming sequence frames
+     * @param key Image key
+     * @param firstFrame First frame to have ready
+     */
+    void prefetch(const ImageKey& key, int firstFrame);
+
+    /**
+     * @brief Get frame count and timing of a file
+     *
+     * Reads only the image header the first time; frame delays are
+     * filled in as frames are decoded.
+     */
+    [[nodiscard]] ImageSequenceInfo sequenceInfo(const ImageKey& key);
+
+    /**
+     * @brief Set the decoded-memory budget
+     * @param bytes Maximum bytes of decoded pixels kept in the cache
+     */
+    void setBudgetBytes(qint64 bytes);
+
+    /**
+     * @brief Get the decoded-memory budget
+     */
+    [[nodiscard]] qint64 budgetBytes() const;
+
+    /**
+     * @brief Get bytes of decoded pixels currently cached
+     */
+    [[nodiscard]] qint64 usedBytes() const;
+
+    /**
+     * @brief Set how many sequence frames are decoded ahead of playback
+     */
+    void setPrefetchFrames(int frames);
+
+    /**
+     * @brief Drop every cached entry for a file (all sizes and frames)
+     */
+    void invalidate(const QString& path);
+
+    /**
+     * @brief Drop all cached entries
+     */
+    void clear();
+
+signals:
+    /**
+     * @brief Emitted when a scheduled decode finished
+     */
+    void imageReady(const QString& path, int frameIndex);
+
+private:
+    ImageCache(QObject* parent = nullptr);
+
+    struct Entry {
+        QImage image;
+        QString path;
+        std::list<QString>::iterator lruPosition;
+    };
+
+    /**
+     * @brief Forward-only decoding position of one sequence
+     *
+     * Only the job draining it touches the reader; the wanted set and the
+     * running flag are guarded by m_mutex.
+     */
+    struct SequenceDecoder {
+        std::unique_ptr<QImageReader> reader;
+        int nextFrame = 0;              ///< Frame the reader returns next
+        std::set<int> wanted;           ///< Frames queued for decoding
+        bool running = false;           ///< A job is draining wanted
+    };
+
+    void schedule(const ImageKey& key, int firstFrame, int count);
+    void runDecoder(const ImageKey& key, const std::shared_ptr<SequenceDecoder>& decoder);
+    QImage decodeFrame(const ImageKey& key, int frameIndex);
+    void insert(const QString& cacheKey, const QString& path, const QImage& image);
+    void evictLocked(qint64 budget);
+    qint64 shed(qint64 bytesWanted);
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    std::list<QString> m_lru;               ///< Most recently used first
+    QHash<QString, ImageSequenceInfo> m_sequences;
+    QSet<QString> m_pending;                ///< Frames queued for decoding
+    QHash<QString, std::shared_ptr<SequenceDecoder>> m_decoders; ///< Busy or mid-sequence, by toString(-1)
+
+    qint64 m_budgetBytes = 256ll * 1024 * 1024;
+    qint64 m_usedBytes = 0;
+    int m_prefetchFrames = 8;
+    int m_memoryStage = -1;     ///< MemoryGovernor stage of the decoded frames
+
+    JobGroup m_decodeJobs{JobPriority::Background};
+    std::atomic<bool> m_shuttingDown{false};
+};
+
+} // namespace WeaR
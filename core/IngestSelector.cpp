@@ -0,0 +1,493 @@
+// ==============================================================================
+// WeaR-studio IngestSelector Implementation
+// ==============================================================================
+
+#include "IngestSelector.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+#include <QUrl>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace WeaR {
+
+namespace {
+
+constexpr int kHandshakeSize = 1536;        ///< RTMP C1/S1/C2 size
+constexpr quint16 kRtmpPort = 1935;
+constexpr quint16 kRtmpsPort = 443;
+
+/**
+ * @brief Acknowledgement message (type 3) on chunk stream 2
+ *
+ * A legal client message that servers accept and ignore; its payload is
+ * the byte count of the server's handshake.
+ */
+constexpr char kAcknowledgement[16] = {
+    0x02,                   // fmt 0, chunk stream 2
+    0x00, 0x00, 0x00,       // timestamp
+    0x00, 0x00, 0x04,       // message length
+    0x03,                   // message type: acknowledgement
+    0x00, 0x00, 0x00, 0x00, // message stream 0
+    0x00, 0x00, 0x0C, 0x01  // sequence number: S0 + S1 + S2
+};
+
+/**
+ * @brief Time an upload through a small send buffer
+ */
+void measureUpload(const QHostAddress& address, quint16 port,
+                   const IngestProbeSettings& settings, IngestProbeResult& result) {
+    QTcpSocket socket;
+    socket.connectToHost(address, port);
+    if (!socket.waitForConnected(settings.connectTimeoutMs)) return;
+
+    socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket.setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, settings.sendBufferBytes);
+    const int sendBuffer = std::max(socket.socketOption(QAbstractSocket::SendBufferSizeSocketOption).toInt(),
+                                    settings.sendBufferBytes);
+
+    // C0 + C1: version 3, time 0, zero field (simple handshake), random bytes
+    QByteArray c0c1(1 + kHandshakeSize, '\0');
+    c0c1[0] = 3;
+    for (int i = 9; i < c0c1.size(); ++i) {
+        c0c1[i] = static_cast<char>(QRandomGenerator::global()->bounded(256));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    socket.write(c0c1);
+
+    // S0 + S1; plain TCP listeners never answer, so do not wait long
+    QByteArray answer;
+    QDeadlineTimer answerDeadline(static_cast<qint64>(result.rttMs * 4) + 100);
+    while (answer.size() < 1 + kHandshakeSize && !answerDeadline.hasExpired()) {
+        if (!socket.waitForReadyRead(static_cast<int>(answerDeadline.remainingTime()))) break;
+        answer += socket.read(1 + kHandshakeSize - answer.size());
+    }
+    if (answer.size() == 1 + kHandshakeSize && answer[0] == 3) {
+        result.rtmp = true;
+        result.handshakeMs = timer.nsecsElapsed() / 1e6;
+    }
+
+    // C2 echoes S1, then acknowledgements up to the probe size
+    QByteArray payload;
+    payload.reserve(settings.throughputBytes + kHandshakeSize);
+    if (result.rtmp) {
+        payload += answer.mid(1);
+    }
+    while (payload.size() < settings.throughputBytes) {
+        payload.append(kAcknowledgement, sizeof(kAcknowledgement));
+    }
+
+    timer.restart();
+    socket.write(payload);
+
+    QDeadlineTimer uploadDeadline(settings.throughputTimeoutMs);
+    while (socket.bytesToWrite() > 0 && !uploadDeadline.hasExpired()) {
+        if (!socket.waitForBytesWritten(static_cast<int>(uploadDeadline.remainingTime()))) break;
+    }
+    const double elapsedMs = timer.nsecsElapsed() / 1e6;
+
+    // Closed by the server mid-upload: the byte count is unreliable
+    if (socket.state() != QAbstractSocket::ConnectedState) {
+        socket.abort();
+        return;
+    }
+
+    // The first send buffer's worth leaves instantly; the rest is paced by the path
+    const qint64 sent = payload.size() - socket.bytesToWrite();
+    const qint64 paced = sent - sendBuffer;
+    if (paced > 0 && elapsedMs > 0.0) {
+        result.throughputKbps = paced * 8.0 / elapsedMs;
+    }
+
+    socket.abort();
+}
+
+} // namespace
+
+// ==============================================================================
+// Singleton
+// ==============================================================================
+IngestSelector& IngestSelector::instance() {
+    static IngestSelector instance;
+    return instance;
+}
+
+IngestSelector::IngestSelector(QObject* parent)
+    : QObject(parent)
+{
+}
+
+// ==============================================================================
+// Configuration
+// ==============================================================================
+void IngestSelector::setEndpoints(StreamService service, const QList<IngestEndpoint>& endpoints) {
+    QMutexLocker lock(&m_mutex);
+    if (endpoints.isEmpty()) {
+        m_endpoints.remove(static_cast<int>(service));
+    } else {
+        m_endpoints.insert(static_cast<int>(service), endpoints);
+    }
+}
+
+QList<IngestEndpoint> IngestSelector::endpoints(StreamService service) const {
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_endpoints.constFind(static_cast<int>(service));
+        if (it != m_endpoints.cend()) return it.value();
+
+        it = m_directories.constFind(static_cast<int>(service));
+        if (it != m_directories.cend()) return it.value();
+    }
+
+    return defaultEndpoints(service);
+}
+
+QList<IngestEndpoint> IngestSelector::defaultEndpoints(StreamService service) {
+    if (service == StreamService::YouTube) {
+        // Either ingest accepts a stream on its own
+        return {
+            IngestEndpoint{QStringLiteral("Primary"), QStringLiteral("rtmp://a.rtmp.youtube.com/live2")},
+            IngestEndpoint{QStringLiteral("Backup"), QStringLiteral("rtmp://b.rtmp.youtube.com/live2?backup=1")}
+        };
+    }
+
+    // Otherwise the preset's single ingest
+    const QString url = StreamSettings::getServiceUrl(service);
+    if (url.isEmpty()) return {};
+    return { IngestEndpoint{QStringLiteral("Default"), url} };
+}
+
+void IngestSelector::setProbeSettings(const IngestProbeSettings& settings) {
+    QMutexLocker lock(&m_mutex);
+    m_settings = settings;
+}
+
+IngestProbeSettings IngestSelector::probeSettings() const {
+    QMutexLocker lock(&m_mutex);
+    return m_settings;
+}
+
+// ==============================================================================
+// Service Directories
+// ==============================================================================
+QList<IngestEndpoint> IngestSelector::fetchDirectory(StreamService service) {
+    // Twitch publishes its ingests; the other services have fixed lists
+    if (service != StreamService::Twitch) return {};
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(QUrl(QStringLiteral("https://ingest.twitch.tv/ingests")));
+    request.setTransferTimeout(kDirectoryTimeoutMs);
+
+    std::unique_ptr<QNetworkReply> reply(manager.get(request));
+    QEventLoop loop;
+    QObject::connect(reply.get(), &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qWarning() << "Failed to fetch the Twitch ingest list:" << reply->errorString();
+        return {};
+    }
+
+    QList<IngestEndpoint> endpoints;
+    const QJsonArray ingests = QJsonDocument::fromJson(reply->readAll())
+                                   .object().value(QStringLiteral("ingests")).toArray();
+    for (const QJsonValue& value : ingests) {
+        const QJsonObject ingest = value.toObject();
+        if (ingest.value(QStringLiteral("availability")).toDouble(1.0) <= 0.0) continue;
+
+        // "rtmp://<host>/app/{stream_key}"
+        QString url = ingest.value(QStringLiteral("url_template")).toString();
+        url.remove(QStringLiteral("/{stream_key}"));
+        if (url.isEmpty()) continue;
+
+        endpoints.append(IngestEndpoint{ingest.value(QStringLiteral("name")).toString(), url});
+    }
+
+    qDebug() << "Fetched" << endpoints.size() << "Twitch ingests";
+    return endpoints;
+}
+
+void IngestSelector::refreshDirectory(StreamService service) {
+    const int key = static_cast<int>(service);
+    const int64_t now = QDateTime::currentMSecsSinceEpoch();
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_endpoints.contains(key)) return;  // Explicit lists win
+
+        // Failed fetches are not retried before the TTL either
+        auto fetched = m_directoryFetchedMs.constFind(key);
+        if (fetched != m_directoryFetchedMs.cend() &&
+            now - fetched.value() < static_cast<int64_t>(m_settings.cacheTtlSec) * 1000) {
+            return;
+        }
+        m_directoryFetchedMs.insert(key, now);
+    }
+
+    const QList<IngestEndpoint> endpoints = fetchDirectory(service);
+    if (endpoints.isEmpty()) return;
+
+    QMutexLocker lock(&m_mutex);
+    m_directories.insert(key, endpoints);
+}
+
+// ==============================================================================
+// Probing
+// ==============================================================================
+IngestProbeResult IngestSelector::probeEndpoint(const IngestEndpoint& endpoint,
+                                                const IngestProbeSettings& settings) {
+    IngestProbeResult result;
+    result.url = endpoint.url;
+    result.probedAtMs = QDateTime::currentMSecsSinceEpoch();
+
+    const QUrl url(endpoint.url);
+    const bool secure = url.scheme() == QLatin1String("rtmps");
+    const quint16 port = static_cast<quint16>(url.port(secure ? kRtmpsPort : kRtmpPort));
+    if (url.host().isEmpty()) {
+        result.error = QStringLiteral("Invalid URL");
+        return result;
+    }
+
+    // Resolve once so connect times do not include DNS
+    const QHostInfo host = QHostInfo::fromName(url.host());
+    if (host.error() != QHostInfo::NoError || host.addresses().isEmpty()) {
+        result.error = host.errorString();
+        return result;
+    }
+    const QHostAddress address = host.addresses().first();
+
+    std::vector<double> connectTimes;
+    for (int attempt = 0; attempt < std::max(settings.connectAttempts, 1); ++attempt) {
+        QTcpSocket socket;
+        QElapsedTimer timer;
+        timer.start();
+
+        socket.connectToHost(address, port);
+        if (!socket.waitForConnected(settings.connectTimeoutMs)) {
+            result.error = socket.errorString();
+            continue;
+        }
+        connectTimes.push_back(timer.nsecsElapsed() / 1e6);
+        socket.abort();
+    }
+    if (connectTimes.empty()) return result;
+
+    std::sort(connectTimes.begin(), connectTimes.end());
+    result.rttMs = connectTimes[connectTimes.size() / 2];
+    result.reachable = true;
+    result.error.clear();
+
+    // TLS ingests would need a TLS session for the upload
+    if (!secure && settings.throughputBytes > 0) {
+        measureUpload(address, port, settings, result);
+    }
+    return result;
+}
+
+QList<IngestProbeResult> IngestSelector::probe(const QList<IngestEndpoint>& endpoints, bool useCache) {
+    const IngestProbeSettings settings = probeSettings();
+    const int64_t now = QDateTime::currentMSecsSinceEpoch();
+
+    std::vector<IngestProbeResult> measured(static_cast<size_t>(endpoints.size()));
+    std::vector<bool> fresh(measured.size(), false);
+
+    {
+        QMutexLocker lock(&m_mutex);
+        for (int i = 0; i < endpoints.size(); ++i) {
+            auto cached = m_cache.constFind(endpoints[i].url);
+            if (useCache && cached != m_cache.cend() &&
+                now - cached.value().probedAtMs < static_cast<int64_t>(settings.cacheTtlSec) * 1000) {
+                measured[i] = cached.value();
+                fresh[i] = true;
+            }
+        }
+    }
+
+    // Endpoints are independent; probe them all at once
+    std::vector<std::thread> probes;
+    for (int i = 0; i < endpoints.size(); ++i) {
+        if (fresh[i]) continue;
+        probes.emplace_back([&measured, &endpoints, &settings, i]() {
+            measured[i] = probeEndpoint(endpoints[i], settings);
+        });
+    }
+    for (std::thread& probe : probes) {
+        probe.join();
+    }
+
+    QList<IngestProbeResult> results;
+    results.reserve(endpoints.size());
+    {
+        QMutexLocker lock(&m_mutex);
+        for (size_t i = 0; i < measured.size(); ++i) {
+            if (!fresh[i]) {
+                m_cache.insert(measured[i].url, measured[i]);
+            }
+            results.append(measured[i]);
+        }
+    }
+
+    for (const IngestProbeResult& result : results) {
+        qDebug() << "Ingest" << result.url << (result.reachable ? "RTT" : "unreachable:")
+                 << (result.reachable ? QString::number(result.rttMs, 'f', 1) + " ms" : result.error)
+                 << "throughput" << result.throughputKbps << "kbps" << (result.rtmp ? "(RTMP)" : "");
+    }
+    return results;
+}
+
+// ==============================================================================
+// Selection
+// ==============================================================================
+int IngestSelector::best(const QList<IngestProbeResult>& results, int requiredKbps) {
+    int chosen = -1;
+    bool chosenFast = false;
+
+    for (int i = 0; i < results.size(); ++i) {
+        const IngestProbeResult& result = results[i];
+        if (!result.reachable) continue;
+
+        // Unmeasured throughput does not disqualify an endpoint
+        const bool fast = requiredKbps <= 0 || result.throughputKbps <= 0.0 ||
+                          result.throughputKbps >= requiredKbps * kThroughputHeadroom;
+
+        if (chosen < 0) {
+            chosen = i;
+            chosenFast = fast;
+            continue;
+        }
+
+        const IngestProbeResult& current = results[chosen];
+        bool better = false;
+        if (fast != chosenFast) {
+            better = fast;
+        } else if (fast) {
+            better = result.rttMs < current.rttMs;
+        } else {
+            better = result.throughputKbps > current.throughputKbps;
+        }
+
+        if (better) {
+            chosen = i;
+            chosenFast = fast;
+        }
+    }
+    return chosen;
+}
+
+QList<IngestEndpoint> IngestSelector::closest(const QList<IngestEndpoint>& endpoints, int count) const {
+    // One connect each, no upload and no caching
+    IngestProbeSettings screening = probeSettings();
+    screening.connectAttempts = 1;
+    screening.throughputBytes = 0;
+
+    std::vector<IngestProbeResult> measured(static_cast<size_t>(endpoints.size()));
+    std::vector<std::thread> probes;
+    for (int i = 0; i < endpoints.size(); ++i) {
+        probes.emplace_back([&measured, &endpoints, &screening, i]() {
+            measured[i] = probeEndpoint(endpoints[i], screening);
+        });
+    }
+    for (std::thread& probe : probes) {
+        probe.join();
+    }
+
+    std::vector<int> order;
+    for (int i = 0; i < endpoints.size(); ++i) {
+        if (measured[i].reachable) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&measured](int a, int b) {
+        return measured[a].rttMs < measured[b].rttMs;
+    });
+
+    QList<IngestEndpoint> nearest;
+    for (int i = 0; i < std::min<int>(count, static_cast<int>(order.size())); ++i) {
+        nearest.append(endpoints[order[i]]);
+    }
+    return nearest;
+}
+
+QList<IngestEndpoint> IngestSelector::screened(StreamService service, const QList<IngestEndpoint>& endpoints) {
+    QStringList urls;
+    for (const IngestEndpoint& endpoint : endpoints) {
+        urls.append(endpoint.url);
+    }
+
+    const int key = static_cast<int>(service);
+    const int64_t now = QDateTime::currentMSecsSinceEpoch();
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_screenings.constFind(key);
+        if (it != m_screenings.cend() && it->candidates == urls &&
+            now - it->screenedAtMs < static_cast<int64_t>(m_settings.cacheTtlSec) * 1000) {
+            return it->nearest;
+        }
+    }
+
+    const QList<IngestEndpoint> nearest = closest(endpoints, kMaxFullProbes);
+    if (!nearest.isEmpty()) {
+        QMutexLocker lock(&m_mutex);
+        m_screenings.insert(key, Screening{urls, nearest, now});
+    }
+    return nearest;
+}
+
+QString IngestSelector::selectUrl(StreamService service, const QString& fallbackUrl, int requiredKbps) {
+    refreshDirectory(service);
+
+    QList<IngestEndpoint> candidates = endpoints(service);
+    // Nothing to choose from: keep the configured URL
+    if (candidates.size() < 2) return fallbackUrl;
+
+    // Directories list ingests worldwide; fully probe only the closest
+    if (candidates.size() > kMaxFullProbes) {
+        candidates = screened(service, candidates);
+        if (candidates.isEmpty()) {
+            qWarning() << "No ingest endpoint reachable, using" << fallbackUrl;
+            return fallbackUrl;
+        }
+    }
+
+    const QList<IngestProbeResult> results = probe(candidates);
+    const int index = best(results, requiredKbps);
+    if (index < 0) {
+        qWarning() << "No ingest endpoint reachable, using" << fallbackUrl;
+        return fallbackUrl;
+    }
+
+    const IngestProbeResult& chosen = results[index];
+    qDebug() << "Selected ingest" << candidates[index].name << chosen.url
+             << "RTT" << chosen.rttMs << "ms," << chosen.throughputKbps << "kbps";
+    emit ingestSelected(chosen.url, chosen);
+    return chosen.url;
+}
+
+IngestProbeResult IngestSelector::cachedResult(const QString& url) const {
+    QMutexLocker lock(&m_mutex);
+    return m_cache.value(url);
+}
+
+void IngestSelector::clearCache() {
+    QMutexLocker lock(&m_mutex);
+    m_cache.clear();
+    m_screenings.clear();
+}
+
+} // namespace WeaR
@@ -0,0 +1,214 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio IngestSelector
+// Picks the best ingest endpoint of a service by measured RTT and throughput
+// ==============================================================================
+
+#include "StreamManager.h"
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+
+namespace WeaR {
+
+/**
+ * @brief One ingest server of a streaming service
+ */
+struct IngestEndpoint {
+    QString name;               ///< Display name (e.g. "Frankfurt")
+    QString url;                ///< Base RTMP URL without stream key
+};
+
+/**
+ * @brief Measurement of one ingest endpoint
+ */
+struct IngestProbeResult {
+    QString url;                ///< Endpoint URL
+    bool reachable = false;     ///< TCP connect succeeded
+    bool rtmp = false;          ///< Server answered the RTMP handshake
+    double rttMs = 0.0;         ///< Median TCP connect time (DNS excluded)
+    double handshakeMs = 0.0;   ///< C0/C1 sent to S0/S1 received (0 if no answer)
+    double throughputKbps = 0.0; ///< Upload rate of the probe (0 = not measured)
+    int64_t probedAtMs = 0;     ///< When measured (ms since epoch)
+    QString error;              ///< Why the endpoint is unreachable
+};
+
+/**
+ * @brief Probe parameters
+ */
+struct IngestProbeSettings {
+    int connectAttempts = 3;            ///< TCP connects per endpoint (median is used)
+    int connectTimeoutMs = 2000;        ///< Per connect
+    int throughputBytes = 256 * 1024;   ///< Upload size of the throughput probe (0 = skip)
+    int throughputTimeoutMs = 1500;     ///< Upload time limit
+    int sendBufferBytes = 16 * 1024;    ///< Socket send buffer during the upload
+    int cacheTtlSec = 600;              ///< How long results are reused
+};
+
+/**
+ * @brief Ingest endpoint selection
+ *
+ * Services run many regional ingests and the best one depends on where
+ * the streamer is. Each service has an endpoint list: one set with
+ * setEndpoints(), else Twitch's published ingest directory (fetched and
+ * cached for the probe TTL), YouTube's primary and backup ingests, or the
+ * single StreamSettings::getServiceUrl() entry. Long lists are screened
+ * by a single connect each and only the closest few are probed fully.
+ * The endpoints are probed in parallel:
+ * - TCP connect RTT, the median of a few connects to the resolved address
+ * - A short upload: the RTMP handshake (C0/C1, C2 echoing S1) followed by
+ *   Acknowledgement messages, timed through a small send buffer so the
+ *   rate follows the path rather than the local buffer
+ *
+ * Results are cached per URL for a TTL, and so is the screening of a
+ * long list, so a repeated selection does not probe again. The best
+ * endpoint is the
+ * reachable one with the lowest RTT among those fast enough for the
+ * stream bitrate (or the fastest one if none is). Plain TCP listeners are
+ * probed the same way (without the RTMP answer), so local listeners with
+ * artificial delay can stand in for ingests (see tools/IngestHarness.cpp).
+ * rtmps:// endpoints get the RTT probe only.
+ *
+ * probe() and selectUrl() block for up to a few seconds; call them from
+ * a worker thread (StreamManager selects on its output thread, once per
+ * session).
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class IngestSelector : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the IngestSelector instance
+     */
+    static IngestSelector& instance();
+
+    // Prevent copying
+    IngestSelector(const IngestSelector&) = delete;
+    IngestSelector& operator=(const IngestSelector&) = delete;
+
+    ~IngestSelector() override = default;
+
+    // =========================================================================
+    // Configuration
+    // =========================================================================
+
+    /**
+     * @brief Set the endpoints of a service
+     * @param service Service (Custom lists are used for custom URLs)
+     * @param endpoints Candidate ingests, empty to restore the default
+     */
+    void setEndpoints(StreamService service, const QList<IngestEndpoint>& endpoints);
+
+    /**
+     * @brief Get the endpoints of a service
+     *
+     * Does not fetch; a service directory is used once selectUrl() has
+     * fetched it.
+     */
+    [[nodiscard]] QList<IngestEndpoint> endpoints(StreamService service) const;
+
+    /**
+     * @brief Built-in endpoints of a service (without any directory)
+     */
+    [[nodiscard]] static QList<IngestEndpoint> defaultEndpoints(StreamService service);
+
+    /**
+     * @brief Set probe parameters
+     */
+    void setProbeSettings(const IngestProbeSettings& settings);
+    [[nodiscard]] IngestProbeSettings probeSettings() const;
+
+    // =========================================================================
+    // Probing and Selection
+    // =========================================================================
+
+    /**
+     * @brief Probe endpoints in parallel (blocking)
+     * @param endpoints Endpoints to measure
+     * @param useCache Reuse results younger than the TTL
+     * @return One result per endpoint, in order
+     */
+    QList<IngestProbeResult> probe(const QList<IngestEndpoint>& endpoints, bool useCache = true);
+
+    /**
+     * @brief Pick the best endpoint of a service (blocking while probing)
+     *
+     * With fewer than two endpoints nothing is probed and fallbackUrl
+     * is returned.
+     *
+     * @param service Service
+     * @param fallbackUrl Configured URL, returned when there is no choice or no endpoint is reachable
+     * @param requiredKbps Stream bitrate the endpoint should sustain
+     * @return Base URL of the chosen ingest
+     */
+    QString selectUrl(StreamService service, const QString& fallbackUrl, int requiredKbps = 0);
+
+    /**
+     * @brief Choose among probe results
+     * @return Index of the best result, -1 if none is reachable
+     */
+    [[nodiscard]] static int best(const QList<IngestProbeResult>& results, int requiredKbps);
+
+    /**
+     * @brief Get the cached result of an endpoint
+     * @return Result (url empty if not cached)
+     */
+    [[nodiscard]] IngestProbeResult cachedResult(const QString& url) const;
+
+    /**
+     * @brief Forget all cached results and screenings
+     */
+    void clearCache();
+
+signals:
+    /**
+     * @brief Emitted (from the probing thread) when an ingest was chosen
+     * @param url Base URL of the chosen ingest
+     * @param result Its measurement
+     */
+    void ingestSelected(const QString& url, const WeaR::IngestProbeResult& result);
+
+private:
+    // Private constructor for singleton
+    explicit IngestSelector(QObject* parent = nullptr);
+
+    static IngestProbeResult probeEndpoint(const IngestEndpoint& endpoint, const IngestProbeSettings& settings);
+    static QList<IngestEndpoint> fetchDirectory(StreamService service);
+    void refreshDirectory(StreamService service);
+    QList<IngestEndpoint> closest(const QList<IngestEndpoint>& endpoints, int count) const;
+    QList<IngestEndpoint> screened(StreamService service, const QList<IngestEndpoint>& endpoints);
+
+    /**
+     * @brief Closest endpoints of a long list, kept for the probe TTL
+     */
+    struct Screening {
+        QStringList candidates;         ///< URLs that were screened
+        QList<IngestEndpoint> nearest;
+        int64_t screenedAtMs = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<int, QList<IngestEndpoint>> m_endpoints;
+    QHash<int, QList<IngestEndpoint>> m_directories;    ///< Fetched service directories
+    QHash<int, int64_t> m_directoryFetchedMs;
+    QHash<QString, IngestProbeResult> m_cache;
+    QHash<int, Screening> m_screenings;
+    IngestProbeSettings m_settings;
+
+    /// Throughput below the requirement times this is "too slow"
+    static constexpr double kThroughputHeadroom = 1.5;
+    /// Endpoints probed fully after the connect screening
+    static constexpr int kMaxFullProbes = 4;
+    static constexpr int kDirectoryTimeoutMs = 3000;
+};
+
+} // namespace WeaR
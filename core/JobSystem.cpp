@@ -0,0 +1,341 @@
+// ==============================================================================
+// WeaR-studio JobSystem Implementation
+// ==============================================================================
+
+#include "JobSystem.h"
+#include "ThreadPolicy.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <thread>
+
+namespace WeaR {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+thread_local int t_workerIndex = -1;
+
+} // namespace
+
+// ==============================================================================
+// Internal types
+// ==============================================================================
+struct JobSystem::Task {
+    Job job;
+    JobPriority priority = JobPriority::Background;
+    Clock::time_point queuedAt;
+};
+
+struct JobSystem::Worker {
+    QMutex mutex;
+    std::deque<Task> queue;
+    JobPriority priority = JobPriority::RealTime;   ///< Set the worker belongs to
+    std::thread thread;
+};
+
+struct JobSystem::QueueCounters {
+    std::atomic<int64_t> submitted{0};
+    std::atomic<int64_t> completed{0};
+    std::atomic<int64_t> stolen{0};
+    std::atomic<int64_t> latencySumUs{0};
+    std::atomic<int64_t> latencyMaxUs{0};
+};
+
+// ==============================================================================
+// JobSystem Singleton
+// ==============================================================================
+JobSystem& JobSystem::instance() {
+    static JobSystem instance;
+    return instance;
+}
+
+JobSystem::JobSystem(QObject* parent)
+    : QObject(parent)
+    , m_counters(std::make_unique<QueueCounters[]>(kPriorityCount))
+{
+    // Leave one core for the GUI thread, which also joins parallelFor();
+    // background workers run at low priority, so they only use idle time
+    const unsigned cores = std::max(std::thread::hardware_concurrency(), 2u);
+    m_workerCounts[static_cast<int>(JobPriority::RealTime)] = static_cast<int>(cores - 1);
+    m_workerCounts[static_cast<int>(JobPriority::Background)] = static_cast<int>(std::max(cores / 4, 1u));
+
+    for (int priority = 0; priority < kPriorityCount; ++priority) {
+        m_firstWorkers[priority] = static_cast<int>(m_workers.size());
+        for (int i = 0; i < m_workerCounts[priority]; ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->priority = static_cast<JobPriority>(priority);
+            m_workers.push_back(std::move(worker));
+        }
+    }
+    for (int i = 0; i < static_cast<int>(m_workers.size()); ++i) {
+        m_workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+    }
+
+    qDebug() << "JobSystem started with" << workerCount(JobPriority::RealTime) << "real-time and"
+             << workerCount(JobPriority::Background) << "background workers";
+}
+
+JobSystem::~JobSystem() {
+    {
+        QMutexLocker lock(&m_sleepMutex);
+        m_running = false;
+    }
+    for (QWaitCondition& wake : m_wake) {
+        wake.wakeAll();
+    }
+
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // Finish leftovers here so nothing waiting on a JobGroup hangs
+    for (auto& worker : m_workers) {
+        for (Task& task : worker->queue) {
+            task.job();
+        }
+        worker->queue.clear();
+    }
+}
+
+bool JobSystem::isWorkerThread() const {
+    return t_workerIndex >= 0;
+}
+
+// ==============================================================================
+// Submission
+// ==============================================================================
+void JobSystem::submit(Job job, JobPriority priority) {
+    if (!job) return;
+
+    const int set = static_cast<int>(priority);
+    if (m_workerCounts[set] == 0 || !m_running) {
+        job();
+        return;
+    }
+
+    // Keep locality for jobs spawned by jobs of the same set; spread everything else
+    const int index = t_workerIndex >= 0 && m_workers[t_workerIndex]->priority == priority
+        ? t_workerIndex
+        : m_firstWorkers[set] + static_cast<int>(m_nextWorker[set]++ % m_workerCounts[set]);
+
+    // Count first so a worker never sleeps on a queued task
+    m_queued[set]++;
+    Task task{std::move(job), priority, Clock::now()};
+    {
+        QMutexLocker lock(&m_workers[index]->mutex);
+        m_workers[index]->queue.push_back(std::move(task));
+    }
+    m_counters[set].submitted++;
+
+    // Taking the sleep mutex orders this wake after a worker's empty check
+    {
+        QMutexLocker lock(&m_sleepMutex);
+    }
+    m_wake[set].wakeOne();
+}
+
+void JobSystem::parallelFor(int count, const std::function<void(int begin, int end)>& body,
+                            int grain, JobPriority priority) {
+    if (count <= 0) return;
+
+    grain = std::max(grain, 1);
+    const int chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workerCount(priority) == 0) {
+        body(0, count);
+        return;
+    }
+
+    struct State {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        QMutex mutex;
+        QWaitCondition finished;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers that start after every chunk is claimed return immediately;
+    // body is only touched while a claimed chunk keeps the caller waiting
+    auto runChunks = [state, chunks, count, grain, &body]() {
+        int chunk;
+        while ((chunk = state->next++) < chunks) {
+            const int begin = chunk * grain;
+            body(begin, std::min(begin + grain, count));
+            if (++state->done == chunks) {
+                QMutexLocker lock(&state->mutex);
+                state->finished.wakeAll();
+            }
+        }
+    };
+
+    const int helpers = std::min(chunks - 1, workerCount(priority));
+    for (int i = 0; i < helpers; ++i) {
+        submit(runChunks, priority);
+    }
+
+    runChunks();
+
+    QMutexLocker lock(&state->mutex);
+    while (state->done < chunks) {
+        state->finished.wait(&state->mutex);
+    }
+}
+
+// ==============================================================================
+// Workers
+// ==============================================================================
+void JobSystem::workerLoop(int index) {
+    t_workerIndex = index;
+    const int set = static_cast<int>(m_workers[index]->priority);
+    if (m_workers[index]->priority == JobPriority::Background) {
+        ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Background,
+                                                      QString("WeaR bg job %1").arg(index - m_firstWorkers[set]));
+    } else {
+        ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Render, QString("WeaR job %1").arg(index));
+    }
+
+    while (m_running) {
+        Task task;
+        bool stolen = false;
+        if (takeTask(index, task, stolen)) {
+            runTask(task, stolen);
+            continue;
+        }
+
+        QMutexLocker lock(&m_sleepMutex);
+        if (m_queued[set] == 0 && m_running) {
+            m_wake[set].wait(&m_sleepMutex);
+        }
+    }
+}
+
+bool JobSystem::takeTask(int index, Task& task, bool& stolen) {
+    const int set = static_cast<int>(m_workers[index]->priority);
+    const int first = m_firstWorkers[set];
+    const int count = m_workerCounts[set];
+
+    {
+        // Own queue: oldest first to bound latency
+        Worker& own = *m_workers[index];
+        QMutexLocker lock(&own.mutex);
+        if (!own.queue.empty()) {
+            task = std::move(own.queue.front());
+            own.queue.pop_front();
+            m_queued[set]--;
+            stolen = false;
+            return true;
+        }
+    }
+
+    for (int offset = 1; offset < count; ++offset) {
+        // Steal from the far end, away from the owner
+        Worker& victim = *m_workers[first + (index - first + offset) % count];
+        QMutexLocker lock(&victim.mutex);
+        if (!victim.queue.empty()) {
+            task = std::move(victim.queue.back());
+            victim.queue.pop_back();
+            m_queued[set]--;
+            stolen = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::runTask(Task& task, bool stolen) {
+    QueueCounters& counters = m_counters[static_cast<int>(task.priority)];
+
+    const int64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - task.queuedAt).count();
+    counters.latencySumUs += latencyUs;
+
+    int64_t previousMax = counters.latencyMaxUs;
+    while (latencyUs > previousMax &&
+           !counters.latencyMaxUs.compare_exchange_weak(previousMax, latencyUs)) {
+    }
+
+    if (stolen) {
+        counters.stolen++;
+    }
+
+    task.job();
+    counters.completed++;
+}
+
+// ==============================================================================
+// Statistics
+// ==============================================================================
+JobQueueStats JobSystem::statistics(JobPriority priority) const {
+    const QueueCounters& counters = m_counters[static_cast<int>(priority)];
+
+    JobQueueStats stats;
+    stats.submitted = counters.submitted;
+    stats.completed = counters.completed;
+    stats.stolen = counters.stolen;
+    stats.maxLatencyUs = static_cast<double>(counters.latencyMaxUs);
+    if (stats.completed > 0) {
+        stats.averageLatencyUs = static_cast<double>(counters.latencySumUs) / stats.completed;
+    }
+    return stats;
+}
+
+void JobSystem::resetStatistics() {
+    for (int i = 0; i < kPriorityCount; ++i) {
+        m_counters[i].submitted = 0;
+        m_counters[i].completed = 0;
+        m_counters[i].stolen = 0;
+        m_counters[i].latencySumUs = 0;
+        m_counters[i].latencyMaxUs = 0;
+    }
+}
+
+// ==============================================================================
+// JobGroup
+// ==============================================================================
+JobGroup::JobGroup(JobPriority priority)
+    : m_priority(priority)
+{
+}
+
+JobGroup::~JobGroup() {
+    wait();
+}
+
+void JobGroup::run(Job job) {
+    if (!job) return;
+
+    {
+        QMutexLocker lock(&m_mutex);
+        m_pending++;
+    }
+
+    JobSystem::instance().submit([this, job = std::move(job)]() {
+        job();
+
+        QMutexLocker lock(&m_mutex);
+        if (--m_pending == 0) {
+            m_finished.wakeAll();
+        }
+    }, m_priority);
+}
+
+void JobGroup::wait() {
+    QMutexLocker lock(&m_mutex);
+    while (m_pending > 0) {
+        m_finished.wait(&m_mutex);
+    }
+}
+
+int JobGroup::pending() const {
+    QMutexLocker lock(&m_mutex);
+    return m_pending;
+}
+
+} // namespace WeaR
@@ -0,0 +1,185 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio JobSystem
+// Shared work-stealing scheduler for CPU pipeline stages
+// ==============================================================================
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace WeaR {
+
+/**
+ * @brief Scheduling class of a job
+ *
+ * Real-time jobs (compositing, frame conversion) and background jobs
+ * (image decoding, saving) run on separate worker sets, so background
+ * work runs at the Background thread role's priority and never takes a
+ * real-time worker.
+ */
+enum class JobPriority {
+    RealTime = 0,       ///< Work on the current frame's critical path
+    Background          ///< Work that may wait behind frame work
+};
+
+/**
+ * @brief Latency statistics of one priority queue
+ */
+struct JobQueueStats {
+    int64_t submitted = 0;          ///< Jobs queued
+    int64_t completed = 0;          ///< Jobs finished
+    int64_t stolen = 0;             ///< Jobs run by a worker other than the one queued on
+    double averageLatencyUs = 0.0;  ///< Mean time from submit to start
+    double maxLatencyUs = 0.0;      ///< Worst time from submit to start
+};
+
+/**
+ * @brief Unit of work
+ */
+using Job = std::function<void()>;
+
+/**
+ * @brief Process-wide work-stealing job scheduler
+ *
+ * Real-time jobs run on one worker per spare core (ThreadRole::Render),
+ * background jobs on a smaller set of workers with ThreadRole::Background,
+ * which the OS schedules behind frame work. Each worker has its own deque.
+ * Jobs submitted from a worker of the matching set go to that worker's
+ * deque; other jobs are spread round-robin over the set. Idle workers
+ * steal from the other workers of their set, so one scheduler serves
+ * every stage without oversubscribing the CPU.
+ *
+ * Long-running loops (encoder, stream output) keep their dedicated
+ * threads; this is for short, splittable work.
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class JobSystem : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the JobSystem instance
+     */
+    static JobSystem& instance();
+
+    // Prevent copying
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    ~JobSystem() override;
+
+    /**
+     * @brief Queue a job
+     * @param job Work to run on a worker thread
+     * @param priority Scheduling class
+     */
+    void submit(Job job, JobPriority priority = JobPriority::Background);
+
+    /**
+     * @brief Run a loop body over [0, count) in parallel and wait for it
+     *
+     * The range is split into chunks of @p grain indices. The calling
+     * thread works on chunks too, so this is safe to call from a worker
+     * and never waits on work that has not started.
+     *
+     * @param count Number of indices
+     * @param body Called with [begin, end) sub-ranges
+     * @param grain Indices per chunk
+     * @param priority Scheduling class of the helper jobs
+     */
+    void parallelFor(int count, const std::function<void(int begin, int end)>& body,
+                     int grain = 1, JobPriority priority = JobPriority::RealTime);
+
+    /**
+     * @brief Number of worker threads serving a priority
+     */
+    [[nodiscard]] int workerCount(JobPriority priority = JobPriority::RealTime) const {
+        return m_workerCounts[static_cast<int>(priority)];
+    }
+
+    /**
+     * @brief Check if the calling thread is one of the workers
+     */
+    [[nodiscard]] bool isWorkerThread() const;
+
+    /**
+     * @brief Get statistics for one priority queue
+     */
+    [[nodiscard]] JobQueueStats statistics(JobPriority priority) const;
+
+    /**
+     * @brief Reset all statistics
+     */
+    void resetStatistics();
+
+private:
+    JobSystem(QObject* parent = nullptr);
+
+    struct Task;
+    struct Worker;
+    struct QueueCounters;
+
+    static constexpr int kPriorityCount = 2;
+
+    void workerLoop(int index);
+    bool takeTask(int index, Task& task, bool& stolen);
+    void runTask(Task& task, bool stolen);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;    ///< Real-time set first, then background
+    std::unique_ptr<QueueCounters[]> m_counters;
+    int m_firstWorkers[kPriorityCount] = {};           ///< Index of each set's first worker
+    int m_workerCounts[kPriorityCount] = {};           ///< Workers in each set
+
+    QMutex m_sleepMutex;
+    QWaitCondition m_wake[kPriorityCount];
+    std::atomic<int> m_queued[kPriorityCount]{};
+    std::atomic<bool> m_running{true};
+    std::atomic<unsigned> m_nextWorker[kPriorityCount]{};
+};
+
+/**
+ * @brief Set of jobs that can be waited for together
+ *
+ * Destroying a group waits for its jobs, so they may safely capture the
+ * owner of the group.
+ */
+class JobGroup {
+public:
+    explicit JobGroup(JobPriority priority = JobPriority::Background);
+    ~JobGroup();
+
+    JobGroup(const JobGroup&) = delete;
+    JobGroup& operator=(const JobGroup&) = delete;
+
+    /**
+     * @brief Queue a job in this group
+     */
+    void run(Job job);
+
+    /**
+     * @brief Block until every job of the group has finished
+     */
+    void wait();
+
+    /**
+     * @brief Number of jobs queued or running
+     */
+    [[nodiscard]] int pending() const;
+
+private:
+    JobPriority m_priority;
+    mutable QMutex m_mutex;
+    QWaitCondition m_finished;
+    int m_pending = 0;
+};
+
+} // namespace WeaR
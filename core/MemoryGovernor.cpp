@@ -0,0 +1,199 @@
+// ==============================================================================
+// WeaR-studio MemoryGovernor Implementation
+// ==============================================================================
+
+#include "MemoryGovernor.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace WeaR {
+
+namespace {
+
+const char* className(MemoryClass memoryClass) {
+    switch (memoryClass) {
+        case MemoryClass::Preview: return "preview";
+        case MemoryClass::Thumbnail: return "thumbnails";
+        case MemoryClass::LowerRendition: return "lower renditions";
+        case MemoryClass::StreamFrames: return "stream frames";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+// ==============================================================================
+// MemoryGovernor Singleton
+// ==============================================================================
+MemoryGovernor& MemoryGovernor::instance() {
+    static MemoryGovernor instance;
+    return instance;
+}
+
+MemoryGovernor::MemoryGovernor(QObject* parent)
+    : QObject(parent)
+{
+}
+
+MemoryGovernor::~MemoryGovernor() = default;
+
+void MemoryGovernor::setBudgetBytes(int64_t bytes) {
+    m_budgetBytes = std::max<int64_t>(bytes, 0);
+    qDebug() << "Memory budget set to" << (m_budgetBytes / (1024 * 1024)) << "MB";
+}
+
+// ==============================================================================
+// Stages
+// ==============================================================================
+int MemoryGovernor::registerStage(const QString& name, MemoryClass memoryClass,
+                                  MemoryShedCallback shed) {
+    QMutexLocker lock(&m_mutex);
+
+    Stage stage;
+    stage.stats.id = static_cast<int>(m_stages.size());
+    stage.stats.name = name;
+    stage.stats.memoryClass = memoryClass;
+    stage.shed = std::move(shed);
+    stage.active = true;
+
+    m_stages.push_back(std::move(stage));
+    return m_stages.back().stats.id;
+}
+
+void MemoryGovernor::unregisterStage(int stageId) {
+    QMutexLocker lock(&m_mutex);
+    if (stageId < 0 || stageId >= static_cast<int>(m_stages.size())) return;
+
+    Stage& stage = m_stages[stageId];
+    m_usedBytes -= stage.stats.bytes;
+    stage.stats.bytes = 0;
+    stage.shed = nullptr;
+    stage.active = false;
+}
+
+bool MemoryGovernor::reserve(int stageId, int64_t bytes) {
+    return reserveBytes(stageId, bytes, true);
+}
+
+void MemoryGovernor::reserveAlways(int stageId, int64_t bytes) {
+    reserveBytes(stageId, bytes, false);
+}
+
+bool MemoryGovernor::reserveBytes(int stageId, int64_t bytes, bool mayRefuse) {
+    if (bytes <= 0) return true;
+
+    MemoryClass requester;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (stageId < 0 || stageId >= static_cast<int>(m_stages.size()) ||
+            !m_stages[stageId].active) {
+            return true;  // Unknown stages are not governed
+        }
+        requester = m_stages[stageId].stats.memoryClass;
+    }
+
+    int64_t used = (m_usedBytes += bytes);
+
+    // Over budget: shed less important stages first, then the requester's peers
+    if (used > m_budgetBytes) {
+        for (int level = 0; level <= static_cast<int>(requester); ++level) {
+            std::vector<std::pair<int, MemoryShedCallback>> callbacks;
+            {
+                QMutexLocker lock(&m_mutex);
+                for (const Stage& stage : m_stages) {
+                    if (stage.active && stage.shed && stage.stats.id != stageId &&
+                        static_cast<int>(stage.stats.memoryClass) == level) {
+                        callbacks.emplace_back(stage.stats.id, stage.shed);
+                    }
+                }
+            }
+
+            if (level > m_shedLevel) {
+                updatePressure(level);
+            }
+
+            for (auto& [id, shed] : callbacks) {
+                const int64_t wanted = m_usedBytes - m_budgetBytes;
+                if (wanted <= 0) break;
+
+                const int64_t freed = shed(wanted);
+                if (freed > 0) {
+                    QMutexLocker lock(&m_mutex);
+                    m_stages[id].stats.shedBytes += freed;
+                }
+            }
+
+            if (m_usedBytes <= m_budgetBytes) break;
+        }
+
+        if (m_usedBytes > m_budgetBytes && mayRefuse) {
+            m_usedBytes -= bytes;
+
+            QMutexLocker lock(&m_mutex);
+            m_stages[stageId].stats.rejectedReservations++;
+            return false;
+        }
+    }
+
+    QMutexLocker lock(&m_mutex);
+    MemoryStageStats& stats = m_stages[stageId].stats;
+    stats.bytes += bytes;
+    stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+    return true;
+}
+
+void MemoryGovernor::release(int stageId, int64_t bytes) {
+    if (bytes <= 0) return;
+
+    {
+        QMutexLocker lock(&m_mutex);
+        if (stageId < 0 || stageId >= static_cast<int>(m_stages.size()) ||
+            !m_stages[stageId].active) {
+            return;
+        }
+        m_stages[stageId].stats.bytes -= bytes;
+    }
+
+    const int64_t used = (m_usedBytes -= bytes);
+
+    // Hysteresis: stop shedding only once comfortably below the budget
+    if (m_shedLevel >= 0 && used < static_cast<int64_t>(m_budgetBytes * kLowWatermark)) {
+        updatePressure(-1);
+    }
+}
+
+bool MemoryGovernor::isShedding(MemoryClass memoryClass) const {
+    return static_cast<int>(memoryClass) <= m_shedLevel;
+}
+
+QList<MemoryStageStats> MemoryGovernor::stageStatistics() const {
+    QMutexLocker lock(&m_mutex);
+
+    QList<MemoryStageStats> result;
+    for (const Stage& stage : m_stages) {
+        if (stage.active) {
+            result.append(stage.stats);
+        }
+    }
+    return result;
+}
+
+void MemoryGovernor::updatePressure(int shedLevel) {
+    const int previous = m_shedLevel.exchange(shedLevel);
+    if (previous == shedLevel) return;
+
+    if (shedLevel >= 0) {
+        qWarning() << "Memory pressure:" << (m_usedBytes / (1024 * 1024)) << "MB of"
+                   << (m_budgetBytes / (1024 * 1024)) << "MB, shedding up to"
+                   << className(static_cast<MemoryClass>(shedLevel));
+    } else {
+        qDebug() << "Memory pressure relieved";
+    }
+
+    emit pressureChanged(shedLevel >= 0,
+                         static_cast<MemoryClass>(std::max(shedLevel, 0)));
+}
+
+} // namespace WeaR
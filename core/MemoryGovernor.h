@@ -0,0 +1,242 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio MemoryGovernor
+// Global byte budget shared by every frame queue and buffer pool
+// ==============================================================================
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMutex>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace WeaR {
+
+/**
+ * @brief Importance of a memory stage, in shedding order
+ *
+ * Under pressure, stages are asked to free memory starting with the
+ * least important class. Stream frames are shed last.
+ */
+enum class MemoryClass {
+    Preview = 0,        ///< Preview copies and cached last frames
+    Thumbnail,          ///< Thumbnails and other caches that can be re-decoded
+    LowerRendition,     ///< Additional lower-resolution outputs
+    StreamFrames        ///< Frames and packets on their way to the stream
+};
+
+/**
+ * @brief Byte accounting of one registered stage
+ */
+struct MemoryStageStats {
+    int id = -1;
+    QString name;
+    MemoryClass memoryClass = MemoryClass::Preview;
+    int64_t bytes = 0;              ///< Bytes currently in flight
+    int64_t peakBytes = 0;          ///< Highest bytes in flight
+    int64_t shedBytes = 0;          ///< Bytes freed on request of the governor
+    int64_t rejectedReservations = 0; ///< Reservations refused for lack of budget
+};
+
+/**
+ * @brief Callback asking a stage to free memory
+ * @param bytesWanted Bytes the governor would like released
+ * @return Bytes actually released (the stage must also call release())
+ */
+using MemoryShedCallback = std::function<int64_t(int64_t bytesWanted)>;
+
+/**
+ * @brief Global memory budget for the frame pipeline
+ *
+ * Every queue and pool that holds frames registers a stage and accounts
+ * its buffers in bytes with reserve()/release(). When a reservation would
+ * exceed the budget, the governor asks stages to shed load in MemoryClass
+ * order (preview first, stream frames last) before refusing it.
+ *
+ * Producers of optional output (preview, thumbnails) can also check
+ * isShedding() and skip work entirely while the pipeline is under
+ * pressure.
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class MemoryGovernor : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the MemoryGovernor instance
+     */
+    static MemoryGovernor& instance();
+
+    // Prevent copying
+    MemoryGovernor(const MemoryGovernor&) = delete;
+    MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+    ~MemoryGovernor() override;
+
+    // =========================================================================
+    // Budget
+    // =========================================================================
+
+    /**
+     * @brief Set the total byte budget for all stages
+     */
+    void setBudgetBytes(int64_t bytes);
+
+    /**
+     * @brief Get the total byte budget
+     */
+    [[nodiscard]] int64_t budgetBytes() const { return m_budgetBytes; }
+
+    /**
+     * @brief Get bytes currently reserved by all stages
+     */
+    [[nodiscard]] int64_t usedBytes() const { return m_usedBytes; }
+
+    // =========================================================================
+    // Stages
+    // =========================================================================
+
+    /**
+     * @brief Register a stage
+     * @param name Display name (e.g. "Encoder frame queue")
+     * @param memoryClass Importance used for shedding order
+     * @param shed Called to free memory under pressure (optional)
+     * @return Stage ID for reserve()/release()
+     */
+    int registerStage(const QString& name, MemoryClass memoryClass,
+                      MemoryShedCallback shed = nullptr);
+
+    /**
+     * @brief Unregister a stage, releasing whatever it still accounts
+     */
+    void unregisterStage(int stageId);
+
+    /**
+     * @brief Account bytes for a stage
+     *
+     * If the budget would be exceeded, stages of the same or lower
+     * importance (other than the caller) are asked to shed first.
+     * Shed callbacks run on the calling thread without governor locks
+     * held.
+     *
+     * @param stageId Stage ID
+     * @param bytes Bytes about to be held
+     * @return true if accounted, false if the caller should drop the data
+     */
+    [[nodiscard]] bool reserve(int stageId, int64_t bytes);
+
+    /**
+     * @brief Account bytes for data that must not be dropped
+     *
+     * Sheds like reserve(), but accounts the bytes even if the budget
+     * is still exceeded afterwards, so the other stages keep shedding
+     * until usage comes back down.
+     *
+     * @param stageId Stage ID
+     * @param bytes Bytes about to be held
+     */
+    void reserveAlways(int stageId, int64_t bytes);
+
+    /**
+     * @brief Return bytes previously reserved
+     */
+    void release(int stageId, int64_t bytes);
+
+    /**
+     * @brief Check if a class is currently being shed
+     *
+     * True from the moment a reservation had to shed this class until
+     * usage falls back below the low watermark.
+     */
+    [[nodiscard]] bool isShedding(MemoryClass memoryClass) const;
+
+    /**
+     * @brief Get per-stage byte accounting
+     */
+    [[nodiscard]] QList<MemoryStageStats> stageStatistics() const;
+
+signals:
+    /**
+     * @brief Emitted when the shedding level changes
+     * @param shedding True while any class is being shed
+     * @param highestClass Most important class currently being shed
+     */
+    void pressureChanged(bool shedding, WeaR::MemoryClass highestClass);
+
+private:
+    MemoryGovernor(QObject* parent = nullptr);
+
+    struct Stage {
+        MemoryStageStats stats;
+        MemoryShedCallback shed;
+        bool active = false;
+    };
+
+    bool reserveBytes(int stageId, int64_t bytes, bool mayRefuse);
+    void updatePressure(int shedLevel);
+
+    std::vector<Stage> m_stages;
+    mutable QMutex m_mutex;
+
+    std::atomic<int64_t> m_budgetBytes{768ll * 1024 * 1024};
+    std::atomic<int64_t> m_usedBytes{0};
+    std::atomic<int> m_shedLevel{-1};   ///< Highest MemoryClass being shed, -1 = none
+
+    static constexpr double kLowWatermark = 0.85;
+};
+
+/**
+ * @brief RAII handle for bytes reserved with the MemoryGovernor
+ *
+ * Movable, not copyable. Releases the bytes when destroyed, so it can be
+ * embedded in queued items to keep accounting exact on every path that
+ * drops them.
+ */
+class MemoryReservation {
+public:
+    MemoryReservation() = default;
+    MemoryReservation(int stageId, int64_t bytes) : m_stageId(stageId), m_bytes(bytes) {}
+
+    MemoryReservation(MemoryReservation&& other) noexcept
+        : m_stageId(other.m_stageId), m_bytes(other.m_bytes) {
+        other.m_bytes = 0;
+    }
+
+    MemoryReservation& operator=(MemoryReservation&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_stageId = other.m_stageId;
+            m_bytes = other.m_bytes;
+            other.m_bytes = 0;
+        }
+        return *this;
+    }
+
+    ~MemoryReservation() { reset(); }
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    /**
+     * @brief Release the bytes now
+     */
+    void reset() {
+        if (m_bytes > 0) {
+            MemoryGovernor::instance().release(m_stageId, m_bytes);
+            m_bytes = 0;
+        }
+    }
+
+    [[nodiscard]] int64_t bytes() const { return m_bytes; }
+
+private:
+    int m_stageId = -1;
+    int64_t m_bytes = 0;
+};
+
+} // namespace WeaR
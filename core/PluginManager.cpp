@@ -4,6 +4,9 @@
 // ==============================================================================
 
 #include "PluginManager.h"
+#include "ImageCache.h"
+#include "SourceActivation.h"
+#include "ThreadPolicy.h"
 
 #include <QCoreApplication>
 #include <QDir>
@@ -152,6 +155,7 @@ bool PluginManager::registerPlugin(QPluginLoader* loader, const QString& path) {
     m_plugins.insert(info.id, entry);
     
     // Initialize the plugin
+    plugin->attachHost(this);
     if (!plugin->initialize()) {
         qWarning() << "Plugin initialization failed:" << info.id;
         // Still keep it registered but mark as not loaded
@@ -236,6 +240,7 @@ bool PluginManager::loadPlugin(const QString& id) {
     entry.instance = qobject_cast<IPlugin*>(instance);
     
     if (entry.instance) {
+        entry.instance->attachHost(this);
         entry.instance->initialize();
         entry.isLoaded = true;
         categorizePlugin(entry);
@@ -301,6 +306,9 @@ bool PluginManager::unloadPlugin(const QString& id) {
         ISource* source = dynamic_cast<ISource*>(entry.instance);
         if (source) {
             m_sources.removeOne(source);
+            
+            // The instance goes away with the library
+            SourceActivation::instance().forget(source);
         }
     } else if (entry.type == PluginType::Filter) {
         IFilter* filter = dynamic_cast<IFilter*>(entry.instance);
@@ -479,4 +487,27 @@ PluginInfo PluginManager::pluginInfo(const QString& id) const {
     return PluginInfo();
 }
 
+// ==============================================================================
+// Plugin Host Services
+// ==============================================================================
+QImage PluginManager::lookupImage(const ImageKey& key, int frameIndex) {
+    return ImageCache::instance().lookup(key, frameIndex);
+}
+
+void PluginManager::prefetchImage(const ImageKey& key, int firstFrame) {
+    ImageCache::instance().prefetch(key, firstFrame);
+}
+
+ImageSequenceInfo PluginManager::imageSequenceInfo(const ImageKey& key) {
+    return ImageCache::instance().sequenceInfo(key);
+}
+
+void PluginManager::applyThreadRole(ThreadRole role, const QString& threadName) {
+    ThreadPolicy::instance().applyToCurrentThread(role, threadName);
+}
+
+void PluginManager::notifySourceSettingsChanged(ISource* source) {
+    emit sourceSettingsChanged(source);
+}
+
 } // namespace WeaR
@@ -7,6 +7,7 @@
 #include "IPlugin.h"
 #include "ISource.h"
 #include "IFilter.h"
+#include "IPluginHost.h"
 
 #include <QObject>
 #include <QMutex>
@@ -43,6 +44,7 @@ struct PluginEntry {
  * - Loading/unloading plugins dynamically
  * - Categorizing plugins by type (Source, Filter, etc.)
  * - Creating plugin instances via factory pattern
+ * - Serving the application's shared services to plugins (IPluginHost)
  * 
  * Thread-safe Singleton pattern for application-wide access.
  * 
@@ -59,7 +61,7 @@ struct PluginEntry {
  *   ISource* colorSource = plugins.createSource("wear.source.color");
  * @endcode
  */
-class PluginManager : public QObject {
+class PluginManager : public QObject, public IPluginHost {
     Q_OBJECT
 
 public:
@@ -219,6 +221,16 @@ public:
      */
     [[nodiscard]] PluginInfo pluginInfo(const QString& id) const;
 
+    // =========================================================================
+    // Plugin Host Services (IPluginHost)
+    // =========================================================================
+    
+    [[nodiscard]] QImage lookupImage(const ImageKey& key, int frameIndex) override;
+    void prefetchImage(const ImageKey& key, int firstFrame) override;
+    [[nodiscard]] ImageSequenceInfo imageSequenceInfo(const ImageKey& key) override;
+    void applyThreadRole(ThreadRole role, const QString& threadName) override;
+    void notifySourceSettingsChanged(ISource* source) override;
+
 signals:
     /**
      * @brief Emitted when a plugin is discovered
@@ -239,6 +251,11 @@ signals:
      * @brief Emitted when plugin loading fails
      */
     void pluginLoadError(const QString& id, const QString& error);
+    
+    /**
+     * @brief Emitted when a plugin reports changed source settings
+     */
+    void sourceSettingsChanged(WeaR::ISource* source);
 
 private:
     // Private constructor for singleton
@@ -0,0 +1,208 @@
+// ==============================================================================
+// WeaR-studio QualityGovernor Implementation
+// ==============================================================================
+
+#include "QualityGovernor.h"
+#include "SceneManager.h"
+#include "StreamManager.h"
+
+#include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
+
+namespace WeaR {
+
+namespace {
+
+// Overload / headroom thresholds as fractions of the frame budget
+constexpr double kOverloadedBudget = 0.9;
+constexpr double kHealthyBudget = 0.6;
+
+// Stream packet queue depths (~2 s and ~0.5 s at 60 fps)
+constexpr int kOverloadedStreamQueue = 120;
+constexpr int kHealthyStreamQueue = 30;
+
+} // namespace
+
+// ==============================================================================
+// QualityGovernor Singleton
+// ==============================================================================
+QualityGovernor& QualityGovernor::instance() {
+    static QualityGovernor instance;
+    return instance;
+}
+
+QualityGovernor::QualityGovernor(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QualityGovernor::~QualityGovernor() = default;
+
+void QualityGovernor::start() {
+    // Created lazily so the timer lives on the thread that starts sampling
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setInterval(kSampleIntervalMs);
+        connect(m_timer, &QTimer::timeout, this, &QualityGovernor::evaluate);
+    }
+
+    m_overloadedSamples = 0;
+    m_healthySamples = 0;
+    m_lastDrops = EncoderManager::instance().statistics().framesDropped +
+                  StreamManager::instance().statistics().droppedPackets;
+    m_timer->start();
+}
+
+void QualityGovernor::stop() {
+    if (m_timer) {
+        m_timer->stop();
+    }
+    setLevel(0, QStringLiteral("render loop stopped"));
+}
+
+void QualityGovernor::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    if (!enabled) {
+        setLevel(0, QStringLiteral("governor disabled"));
+    }
+}
+
+// ==============================================================================
+// Stage Queries
+// ==============================================================================
+int QualityGovernor::previewFrameDivisor() const {
+    return m_level >= static_cast<int>(QualityLevel::ReducedPreview) ? 2 : 1;
+}
+
+bool QualityGovernor::thumbnailsEnabled() const {
+    return m_level < static_cast<int>(QualityLevel::NoThumbnails);
+}
+
+bool QualityGovernor::smoothScaling() const {
+    return m_level < static_cast<int>(QualityLevel::FastScaling);
+}
+
+EncoderPreset QualityGovernor::effectivePreset(EncoderPreset configured) const {
+    if (m_level < static_cast<int>(QualityLevel::FasterEncoderPreset)) {
+        return configured;
+    }
+    // Two steps faster, e.g. Fast -> VeryFast
+    return static_cast<EncoderPreset>(std::max(static_cast<int>(configured) - 2, 0));
+}
+
+int QualityGovernor::outputFrameDivisor() const {
+    return m_level >= static_cast<int>(QualityLevel::ReducedOutputFps) ? 2 : 1;
+}
+
+QString QualityGovernor::levelName(QualityLevel level) {
+    switch (level) {
+        case QualityLevel::Full: return "full quality";
+        case QualityLevel::ReducedPreview: return "reduced preview fps";
+        case QualityLevel::NoThumbnails: return "thumbnails disabled";
+        case QualityLevel::FastScaling: return "fast scaling";
+        case QualityLevel::FasterEncoderPreset: return "faster encoder preset";
+        case QualityLevel::ReducedOutputFps: return "reduced output fps";
+    }
+    return "unknown";
+}
+
+// ==============================================================================
+// Evaluation
+// ==============================================================================
+PipelineLoadSample QualityGovernor::sample() {
+    PipelineLoadSample s;
+
+    const RenderStatistics render = SceneManager::instance().statistics();
+    s.renderTimeMs = render.averageRenderTimeMs;
+    s.frameBudgetMs = render.targetFps > 0 ? 1000.0 / render.targetFps : 1000.0 / 60.0;
+
+    EncoderManager& encoder = EncoderManager::instance();
+    const EncoderManager::Statistics encoderStats = encoder.statistics();
+    if (encoder.isRunning()) {
+        s.encodeTimeMs = encoderStats.averageEncodeTimeMs;
+        s.encoderQueue = encoder.queueSize();
+        s.encoderQueueMax = encoder.maxQueueSize();
+    }
+
+    StreamManager& stream = StreamManager::instance();
+    s.streamQueue = stream.queueSize();
+
+    const int64_t drops = encoderStats.framesDropped + stream.statistics().droppedPackets;
+    s.newDrops = std::max<int64_t>(drops - m_lastDrops, 0);
+    m_lastDrops = drops;
+
+    return s;
+}
+
+void QualityGovernor::evaluate() {
+    const PipelineLoadSample s = sample();
+    if (!m_enabled) return;
+
+    QStringList overload;
+    if (s.renderTimeMs > s.frameBudgetMs * kOverloadedBudget) {
+        overload << QString("render %1 ms of %2 ms budget")
+            .arg(s.renderTimeMs, 0, 'f', 1).arg(s.frameBudgetMs, 0, 'f', 1);
+    }
+    if (s.encodeTimeMs > s.frameBudgetMs * kOverloadedBudget) {
+        overload << QString("encode %1 ms of %2 ms budget")
+            .arg(s.encodeTimeMs, 0, 'f', 1).arg(s.frameBudgetMs, 0, 'f', 1);
+    }
+    if (s.encoderQueueMax > 0 && s.encoderQueue * 2 >= s.encoderQueueMax) {
+        overload << QString("encoder queue %1/%2").arg(s.encoderQueue).arg(s.encoderQueueMax);
+    }
+    if (s.streamQueue > kOverloadedStreamQueue) {
+        overload << QString("stream queue %1 packets").arg(s.streamQueue);
+    }
+    if (s.newDrops > 0) {
+        overload << QString("%1 frames dropped").arg(s.newDrops);
+    }
+
+    const bool healthy = overload.isEmpty() &&
+                         s.renderTimeMs < s.frameBudgetMs * kHealthyBudget &&
+                         s.encodeTimeMs < s.frameBudgetMs * kHealthyBudget &&
+                         s.encoderQueue * 5 <= s.encoderQueueMax &&
+                         s.streamQueue < kHealthyStreamQueue;
+
+    if (!overload.isEmpty()) {
+        m_healthySamples = 0;
+        if (++m_overloadedSamples >= kDegradeAfterSamples && m_level < kMaxLevel) {
+            m_overloadedSamples = 0;
+            setLevel(m_level + 1, overload.join(", "));
+        }
+    } else if (healthy) {
+        m_overloadedSamples = 0;
+        if (++m_healthySamples >= kRecoverAfterSamples && m_level > 0) {
+            m_healthySamples = 0;
+            setLevel(m_level - 1, QString("headroom for %1 s (render %2 ms, encode %3 ms)")
+                .arg(kRecoverAfterSamples * kSampleIntervalMs / 1000)
+                .arg(s.renderTimeMs, 0, 'f', 1)
+                .arg(s.encodeTimeMs, 0, 'f', 1));
+        }
+    } else {
+        // Neither overloaded nor clearly idle: hold the current level
+        m_overloadedSamples = 0;
+        m_healthySamples = 0;
+    }
+}
+
+void QualityGovernor::setLevel(int level, const QString& reason) {
+    level = std::clamp(level, 0, kMaxLevel);
+    const int previous = m_level.exchange(level);
+    if (previous == level) return;
+
+    const QualityLevel newLevel = static_cast<QualityLevel>(level);
+    qInfo() << "Quality governor:" << (level > previous ? "degrading to" : "restoring to")
+            << levelName(newLevel) << "-" << reason;
+
+    // The preset cannot be changed on an open encoder
+    const int presetLevel = static_cast<int>(QualityLevel::FasterEncoderPreset);
+    if ((previous < presetLevel) != (level < presetLevel) && EncoderManager::instance().isRunning()) {
+        qInfo() << "Quality governor: encoder preset change applies from the next encoder start";
+    }
+
+    emit levelChanged(newLevel, reason);
+}
+
+} // namespace WeaR
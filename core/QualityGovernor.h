@@ -0,0 +1,152 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio QualityGovernor
+// Staged quality degradation when the pipeline falls behind
+// ==============================================================================
+
+#include "EncoderManager.h"
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+
+#include <atomic>
+
+namespace WeaR {
+
+/**
+ * @brief Degradation stages, applied cumulatively in this order
+ */
+enum class QualityLevel {
+    Full = 0,               ///< No degradation
+    ReducedPreview,         ///< Preview updated at half rate
+    NoThumbnails,           ///< Thumbnails paused, image read-ahead cut to the next frame
+    FastScaling,            ///< Nearest-neighbour scaling in the compositor
+    FasterEncoderPreset,    ///< Faster encoder preset (from the next encoder start)
+    ReducedOutputFps        ///< Every other frame sent to the encoder
+};
+
+/**
+ * @brief Sample of the pipeline health signals
+ */
+struct PipelineLoadSample {
+    double renderTimeMs = 0.0;      ///< Average composite time
+    double encodeTimeMs = 0.0;      ///< Average encode time
+    double frameBudgetMs = 0.0;     ///< Time available per frame
+    int encoderQueue = 0;           ///< Frames waiting for the encoder
+    int encoderQueueMax = 0;        ///< Encoder queue capacity
+    int streamQueue = 0;            ///< Packets waiting for the network
+    int64_t newDrops = 0;           ///< Frames dropped since the last sample
+};
+
+/**
+ * @brief Watches stage latencies and queue depths and degrades quality
+ *
+ * Samples the pipeline twice a second. After sustained overload it moves
+ * one QualityLevel down; after a longer healthy period it moves one level
+ * back up. Pipeline stages query the current level through the accessors
+ * below. Every decision is logged with the reason.
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class QualityGovernor : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the QualityGovernor instance
+     */
+    static QualityGovernor& instance();
+
+    // Prevent copying
+    QualityGovernor(const QualityGovernor&) = delete;
+    QualityGovernor& operator=(const QualityGovernor&) = delete;
+
+    ~QualityGovernor() override;
+
+    /**
+     * @brief Start sampling (call from the GUI thread)
+     */
+    void start();
+
+    /**
+     * @brief Stop sampling and restore full quality
+     */
+    void stop();
+
+    /**
+     * @brief Enable or disable automatic degradation
+     */
+    void setEnabled(bool enabled);
+    [[nodiscard]] bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Get the current level
+     */
+    [[nodiscard]] QualityLevel level() const { return static_cast<QualityLevel>(m_level.load()); }
+
+    // =========================================================================
+    // Stage Queries
+    // =========================================================================
+
+    /**
+     * @brief Render ticks per preview update
+     */
+    [[nodiscard]] int previewFrameDivisor() const;
+
+    /**
+     * @brief Check if background thumbnail and image read-ahead work may run
+     */
+    [[nodiscard]] bool thumbnailsEnabled() const;
+
+    /**
+     * @brief Check if the compositor should use smooth (bilinear) scaling
+     */
+    [[nodiscard]] bool smoothScaling() const;
+
+    /**
+     * @brief Get the encoder preset to use for a configured preset
+     */
+    [[nodiscard]] EncoderPreset effectivePreset(EncoderPreset configured) const;
+
+    /**
+     * @brief Render ticks per frame sent to the encoder
+     */
+    [[nodiscard]] int outputFrameDivisor() const;
+
+    /**
+     * @brief Get display name of a level
+     */
+    [[nodiscard]] static QString levelName(QualityLevel level);
+
+signals:
+    /**
+     * @brief Emitted when the level changes
+     * @param level New level
+     * @param reason Why it changed
+     */
+    void levelChanged(WeaR::QualityLevel level, const QString& reason);
+
+private:
+    QualityGovernor(QObject* parent = nullptr);
+
+    void evaluate();
+    PipelineLoadSample sample();
+    void setLevel(int level, const QString& reason);
+
+    QTimer* m_timer = nullptr;
+    std::atomic<bool> m_enabled{true};
+    std::atomic<int> m_level{0};
+
+    int m_overloadedSamples = 0;
+    int m_healthySamples = 0;
+    int64_t m_lastDrops = 0;
+
+    static constexpr int kSampleIntervalMs = 500;
+    static constexpr int kDegradeAfterSamples = 2;      ///< 1 s of overload
+    static constexpr int kRecoverAfterSamples = 10;     ///< 5 s of headroom
+    static constexpr int kMaxLevel = static_cast<int>(QualityLevel::ReducedOutputFps);
+};
+
+} // namespace WeaR
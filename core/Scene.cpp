@@ -3,13 +3,101 @@
 // ==============================================================================
 
 #include "Scene.h"
+#include "JobSystem.h"
+#include "QualityGovernor.h"
 
 #include <QPainter>
 #include <QDebug>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 namespace WeaR {
 
+namespace {
+
+// Scenes currently being rendered on this thread, innermost last
+thread_local std::vector<const Scene*> t_renderStack;
+
+// Smallest band worth a job of its own
+constexpr int kMinBandRows = 128;
+
+/**
+ * @brief A pulled frame ready to paint
+ */
+struct RenderLayer {
+    const SceneItem* item = nullptr;
+    QImage frame;
+    std::shared_ptr<const TileMap> tiles;   ///< Null if the format is not classified
+    QPoint offset;                          ///< Canvas position of a direct layer
+    bool direct = false;                    ///< Unscaled, unrotated, opaque-opacity, normal blend
+};
+
+/**
+ * @brief Check if an item draws its frame 1:1 at an integer position
+ */
+bool isDirectLayer(const SceneItem* item, const QImage& frame, QPoint& offset) {
+    const ItemTransform transform = item->transform();
+    if (item->blendMode() != BlendMode::Normal || transform.opacity < 1.0 ||
+        transform.rotation != 0.0 || transform.flipH || transform.flipV ||
+        transform.scale != QPointF(1.0, 1.0) || transform.size.toSize() != frame.size()) {
+        return false;
+    }
+
+    const QPointF position = transform.position;
+    if (position.x() != std::floor(position.x()) || position.y() != std::floor(position.y())) {
+        return false;
+    }
+
+    offset = position.toPoint();
+    return true;
+}
+
+/**
+ * @brief Paint a direct layer tile by tile within one band
+ *
+ * Transparent tiles are skipped, opaque tiles are copied row by row and
+ * only mixed tiles are blended by the painter. The raster engine paints
+ * immediately, so the copies and the painter can share the canvas.
+ */
+void paintTiles(QPainter& painter, uchar* bits, qsizetype bytesPerLine,
+                const QRect& band, const RenderLayer& layer) {
+    const TileMap& map = *layer.tiles;
+
+    for (int row = 0; row < map.rows; ++row) {
+        for (int column = 0; column < map.columns; ++column) {
+            const TileAlpha alpha = map.at(column, row);
+            if (alpha == TileAlpha::Transparent) continue;
+
+            const QRect target = map.tileRect(column, row).translated(layer.offset).intersected(band);
+            if (target.isEmpty()) continue;
+            const QRect source = target.translated(-layer.offset);
+
+            if (alpha == TileAlpha::Opaque) {
+                const size_t rowBytes = static_cast<size_t>(target.width()) * 4;
+                for (int y = 0; y < target.height(); ++y) {
+                    std::memcpy(bits + (target.y() + y) * bytesPerLine + target.x() * 4,
+                                layer.frame.constScanLine(source.y() + y) + source.x() * 4,
+                                rowBytes);
+                }
+            } else {
+                painter.drawImage(target.topLeft(), layer.frame, source);
+            }
+        }
+    }
+}
+
+} // namespace
+
+Scene::RenderScope::RenderScope(const Scene* scene) {
+    t_renderStack.push_back(scene);
+}
+
+Scene::RenderScope::~RenderScope() {
+    t_renderStack.pop_back();
+}
+
 Scene::Scene(QObject* parent)
     : QObject(parent)
     , m_id(QUuid::createUuid())
@@ -68,24 +156,24 @@ SceneItem* Scene::itemAt(int index) const {
     return nullptr;
 }
 
+SceneItem* Scene::hitTest(const QPointF& point) const {
+    QMutexLocker lock(&m_mutex);
+    return m_index.hitTest(point);
+}
+
+QList<SceneItem*> Scene::itemsIntersecting(const QRectF& rect) const {
+    QMutexLocker lock(&m_mutex);
+    return m_index.query(rect);
+}
+
 SceneItem* Scene::itemById(const QUuid& id) const {
     QMutexLocker lock(&m_mutex);
-    for (SceneItem* item : m_items) {
-        if (item->id() == id) {
-            return item;
-        }
-    }
-    return nullptr;
+    return m_index.itemById(id);
 }
 
 SceneItem* Scene::itemByName(const QString& name) const {
     QMutexLocker lock(&m_mutex);
-    for (SceneItem* item : m_items) {
-        if (item->name() == name) {
-            return item;
-        }
-    }
-    return nullptr;
+    return m_index.itemByName(name);
 }
 
 int Scene::addItem(SceneItem* item) {
@@ -94,8 +182,8 @@ int Scene::addItem(SceneItem* item) {
     QMutexLocker lock(&m_mutex);
     
     // Check if already added
-    if (m_items.contains(item)) {
-        return m_items.indexOf(item);
+    if (m_index.contains(item)) {
+        return m_index.layer(item);
     }
     
     // Take ownership
@@ -105,9 +193,21 @@ int Scene::addItem(SceneItem* item) {
     connect(item, &SceneItem::transformChanged, this, &Scene::sceneChanged);
     connect(item, &SceneItem::visibilityChanged, this, &Scene::sceneChanged);
     connect(item, &SceneItem::sourceChanged, this, &Scene::sceneChanged);
+    connect(item, &SceneItem::blendModeChanged, this, &Scene::sceneChanged);
+    
+    // Keep the index current as the item moves or is renamed
+    connect(item, &SceneItem::transformChanged, this, [this, item]() {
+        QMutexLocker indexLock(&m_mutex);
+        m_index.updateBounds(item);
+    });
+    connect(item, &SceneItem::nameChanged, this, [this, item]() {
+        QMutexLocker indexLock(&m_mutex);
+        m_index.rename(item);
+    });
     
     m_items.append(item);
     int index = m_items.size() - 1;
+    m_index.insert(item, index);
     
     lock.unlock();
     
@@ -130,11 +230,13 @@ bool Scene::removeItem(SceneItem* item) {
     
     QMutexLocker lock(&m_mutex);
     
-    int index = m_items.indexOf(item);
+    int index = m_index.layer(item);
     if (index < 0) return false;
     
     QUuid id = item->id();
     m_items.removeAt(index);
+    m_index.remove(item);
+    m_index.renumber(m_items, index, m_items.size() - 1);
     
     lock.unlock();
     
@@ -164,6 +266,7 @@ void Scene::clear() {
         item->deleteLater();
     }
     m_items.clear();
+    m_index.clear();
     
     lock.unlock();
     
@@ -180,6 +283,7 @@ bool Scene::moveItem(int from, int to) {
     }
     
     m_items.move(from, to);
+    m_index.renumber(m_items, std::min(from, to), std::max(from, to));
     
     lock.unlock();
     
@@ -192,9 +296,10 @@ bool Scene::moveItem(int from, int to) {
 void Scene::bringToFront(SceneItem* item) {
     QMutexLocker lock(&m_mutex);
     
-    int index = m_items.indexOf(item);
+    int index = m_index.layer(item);
     if (index >= 0 && index < m_items.size() - 1) {
         m_items.move(index, m_items.size() - 1);
+        m_index.renumber(m_items, index, m_items.size() - 1);
         
         lock.unlock();
         
@@ -206,9 +311,10 @@ void Scene::bringToFront(SceneItem* item) {
 void Scene::sendToBack(SceneItem* item) {
     QMutexLocker lock(&m_mutex);
     
-    int index = m_items.indexOf(item);
+    int index = m_index.layer(item);
     if (index > 0) {
         m_items.move(index, 0);
+        m_index.renumber(m_items, 0, index);
         
         lock.unlock();
         
@@ -217,25 +323,105 @@ void Scene::sendToBack(SceneItem* item) {
     }
 }
 
+QImage::Format Scene::canvasFormat() const {
+    return m_backgroundColor.alpha() == 255 ? QImage::Format_RGB32
+                                            : QImage::Format_ARGB32_Premultiplied;
+}
+
 QImage Scene::render() const {
-    // Create output image with premultiplied alpha for better composition
-    QImage output(m_resolution, QImage::Format_ARGB32_Premultiplied);
-    output.fill(m_backgroundColor);
-    
-    QPainter painter(&output);
-    painter.setRenderHint(QPainter::Antialiasing, true);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-    
-    render(&painter);
+    QImage output(m_resolution, canvasFormat());
+    renderInto(output);
+    return output;
+}
+
+void Scene::renderInto(QImage& canvas) const {
+    if (canvas.isNull()) return;
     
-    painter.end();
+    RenderScope scope(this);
+    QMutexLocker lock(&m_mutex);
     
-    return output;
+    // Pull every on-canvas source once, on this thread; the bands only paint
+    const QList<SceneItem*> onCanvas = m_index.query(QRectF(0, 0, canvas.width(), canvas.height()));
+    std::vector<RenderLayer> layers;
+    layers.reserve(onCanvas.size());
+    int missing = 0;
+    for (const SceneItem* item : onCanvas) {
+        if (item->isVisible()) {
+            QImage frame = item->currentFrame();
+            if (!frame.isNull()) {
+                RenderLayer layer;
+                layer.item = item;
+                layer.frame = std::move(frame);
+                layers.push_back(std::move(layer));
+            } else if (item->hasSource()) {
+                missing++;
+            }
+        }
+    }
+    m_lastMissingFrames = missing;
+    
+    JobSystem& jobs = JobSystem::instance();
+    
+    const bool smoothScaling = QualityGovernor::instance().smoothScaling();
+    
+    // Classify new frames' tiles and prepare static resampled items (both
+    // cached per item until the frame or transform changes)
+    jobs.parallelFor(static_cast<int>(layers.size()), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            RenderLayer& layer = layers[i];
+            layer.tiles = layer.item->tileMap(layer.frame);
+            layer.direct = layer.tiles && isDirectLayer(layer.item, layer.frame, layer.offset);
+            if (!layer.direct) {
+                layer.item->prepareTransformedRaster(layer.frame, smoothScaling);
+            }
+        }
+    }, 1, JobPriority::RealTime);
+    
+    const int height = canvas.height();
+    const int bandCount = std::clamp(height / kMinBandRows, 1, jobs.workerCount() + 1);
+    
+    // Each band is a separate QImage over the canvas rows, so bands can be
+    // painted concurrently without sharing a paint device
+    uchar* bits = canvas.bits();
+    const qsizetype bytesPerLine = canvas.bytesPerLine();
+    jobs.parallelFor(bandCount, [&](int begin, int end) {
+        for (int band = begin; band < end; ++band) {
+            const int top = band * height / bandCount;
+            const int bottom = (band + 1) * height / bandCount;
+            
+            QImage view(bits + top * bytesPerLine, canvas.width(), bottom - top,
+                        bytesPerLine, canvas.format());
+            view.fill(m_backgroundColor);
+            
+            QPainter painter(&view);
+            painter.setRenderHint(QPainter::Antialiasing, true);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, smoothScaling);
+            painter.translate(0, -top);
+            
+            const QRect bandRect(0, top, canvas.width(), bottom - top);
+            for (const RenderLayer& layer : layers) {
+                if (layer.tiles && layer.tiles->isFullyTransparent()) continue;
+                
+                if (layer.direct) {
+                    paintTiles(painter, bits, bytesPerLine, bandRect, layer);
+                } else {
+                    layer.item->render(&painter, layer.frame);
+                }
+            }
+            
+            painter.end();
+        }
+    }, 1, JobPriority::RealTime);
+}
+
+bool Scene::isBeingRendered() const {
+    return std::find(t_renderStack.begin(), t_renderStack.end(), this) != t_renderStack.end();
 }
 
 void Scene::render(QPainter* painter) const {
     if (!painter) return;
     
+    RenderScope scope(this);
     QMutexLocker lock(&m_mutex);
     
     // Render items in order (bottom to top)
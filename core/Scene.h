@@ -5,6 +5,7 @@
 // ==============================================================================
 
 #include "SceneItem.h"
+#include "SceneIndex.h"
 
 #include <QObject>
 #include <QString>
@@ -16,6 +17,7 @@
 #include <QMutex>
 
 #include <memory>
+#include <atomic>
 
 namespace WeaR {
 
@@ -109,6 +111,23 @@ public:
      */
     [[nodiscard]] SceneItem* itemAt(int index) const;
     
+    /**
+     * @brief Get the topmost visible item at a canvas position
+     * @param point Canvas coordinates
+     * @return Item whose transformed shape contains the point, or nullptr
+     */
+    [[nodiscard]] SceneItem* hitTest(const QPointF& point) const;
+    
+    /**
+     * @brief Get the items whose bounds intersect a canvas rectangle
+     * 
+     * For culling and dirty-region updates; served by the scene index.
+     * 
+     * @param rect Canvas rectangle
+     * @return Items (visible or not), bottom to top
+     */
+    [[nodiscard]] QList<SceneItem*> itemsIntersecting(const QRectF& rect) const;
+    
     /**
      * @brief Get item by ID
      * @param id Item UUID
@@ -186,17 +205,62 @@ public:
     // Rendering
     // =========================================================================
     
+    /**
+     * @brief Get the canvas format for compositing this scene
+     * 
+     * RGB32 when the background is opaque, since every composited pixel
+     * is then opaque too and the encoder can read the canvas without an
+     * unpremultiply pass; premultiplied ARGB otherwise.
+     */
+    [[nodiscard]] QImage::Format canvasFormat() const;
+    
     /**
      * @brief Render the scene to an image
      * @return Rendered scene as QImage
      */
     [[nodiscard]] QImage render() const;
     
+    /**
+     * @brief Render the scene into an existing canvas
+     *
+     * The canvas is cleared to the background color first, so pooled
+     * buffers with stale contents can be reused directly.
+     *
+     * @param canvas Target image (resolution-sized, 32-bit format)
+     */
+    void renderInto(QImage& canvas) const;
+    
     /**
      * @brief Render the scene to a painter
      * @param painter Target painter
      */
     void render(QPainter* painter) const;
+    
+    /**
+     * @brief Check if this scene is being rendered on the calling thread
+     * 
+     * Used to break cycles when scenes are nested (see SceneSource).
+     */
+    [[nodiscard]] bool isBeingRendered() const;
+    
+    /**
+     * @brief Get the number of visible sourced items that had no frame
+     * 
+     * Counted by the last renderInto(); 0 means the composite was
+     * complete. Used to detect cold sources after a scene switch.
+     */
+    [[nodiscard]] int lastMissingFrames() const { return m_lastMissingFrames; }
+    
+    /**
+     * @brief Marks a scene as being rendered for the lifetime of the scope
+     */
+    class RenderScope {
+    public:
+        explicit RenderScope(const Scene* scene);
+        ~RenderScope();
+        RenderScope(const RenderScope&) = delete;
+        RenderScope& operator=(const RenderScope&) = delete;
+    };
 
 signals:
     void nameChanged(const QString& name);
@@ -213,7 +277,9 @@ private:
     QColor m_backgroundColor{Qt::black};
     
     QList<SceneItem*> m_items;
+    SceneIndex m_index;                 ///< Lookups and bounds of m_items
     mutable QMutex m_mutex;
+    mutable std::atomic<int> m_lastMissingFrames{0};
 };
 
 } // namespace WeaR
@@ -0,0 +1,1004 @@
+// ==============================================================================
+// WeaR-studio SceneCollection Implementation
+// ==============================================================================
+
+#include "SceneCollection.h"
+#include "SceneManager.h"
+#include "CaptureManager.h"
+#include "PluginManager.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+namespace WeaR {
+
+namespace {
+
+// ==============================================================================
+// Binary Format (version 1)
+//
+//   FileHeader
+//   SceneRecord[sceneCount]
+//   ItemRecord[itemCount]      scenes reference a contiguous run of items
+//   FilterRecord[filterCount]  items reference a contiguous run of filters
+//   string table               UTF-8, referenced by StringRef
+//
+// All integers are little-endian. Records are copied out of the mapped file
+// with memcpy, so they must stay trivially copyable and padding-free.
+// ==============================================================================
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN,
+              "Scene collection records are stored in host order");
+
+constexpr char kMagic[8] = {'W', 'E', 'A', 'R', 'S', 'C', 'N', '\x1A'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr int32_t kNoActiveScene = -1;
+
+constexpr uint32_t kItemVisible = 1u << 0;
+constexpr uint32_t kItemLocked = 1u << 1;
+constexpr uint32_t kItemFlipH = 1u << 2;
+constexpr uint32_t kItemFlipV = 1u << 3;
+constexpr uint32_t kItemHardwareAccel = 1u << 4;
+
+const QString kSceneSourceId = QStringLiteral("wear.source.scene");
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t sceneCount;
+    uint32_t itemCount;
+    uint32_t filterCount;
+    int32_t activeScene;            ///< Index into the scene records
+    uint32_t sceneRecordSize;
+    uint32_t itemRecordSize;
+    uint32_t filterRecordSize;
+    uint32_t reserved;
+    uint64_t scenesOffset;
+    uint64_t itemsOffset;
+    uint64_t filtersOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct SceneRecord {
+    uint8_t id[16];
+    StringRef name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t background;            ///< ARGB
+    uint32_t firstItem;
+    uint32_t itemCount;
+    uint32_t reserved;
+};
+
+struct ItemRecord {
+    uint8_t id[16];
+    StringRef name;
+    StringRef sourceId;
+    StringRef settings;             ///< Compact JSON object
+    StringRef deviceId;
+    double x, y, width, height;
+    double rotation;
+    double scaleX, scaleY;
+    double anchorX, anchorY;
+    double opacity;
+    double fps;
+    int32_t captureRegion[4];       ///< x, y, width, height
+    uint32_t configWidth;
+    uint32_t configHeight;
+    uint32_t flags;
+    uint32_t blendMode;
+    uint32_t firstFilter;
+    uint32_t filterCount;
+};
+
+struct FilterRecord {
+    StringRef pluginId;
+    StringRef parameters;           ///< Compact JSON object
+    uint32_t enabled;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(StringRef) == 8);
+static_assert(sizeof(FileHeader) == 88);
+static_assert(sizeof(SceneRecord) == 48);
+static_assert(sizeof(ItemRecord) == 176);
+static_assert(sizeof(FilterRecord) == 24);
+static_assert(std::is_trivially_copyable_v<FileHeader> &&
+              std::is_trivially_copyable_v<SceneRecord> &&
+              std::is_trivially_copyable_v<ItemRecord> &&
+              std::is_trivially_copyable_v<FilterRecord>);
+
+/**
+ * @brief Deduplicating UTF-8 string table
+ */
+class StringTableWriter {
+public:
+    StringRef add(const QString& string) {
+        return addBytes(string.toUtf8());
+    }
+
+    StringRef addBytes(const QByteArray& bytes) {
+        if (bytes.isEmpty()) return StringRef{0, 0};
+
+        auto it = m_offsets.constFind(bytes);
+        if (it != m_offsets.constEnd()) {
+            return StringRef{it.value(), static_cast<uint32_t>(bytes.size())};
+        }
+
+        const uint32_t offset = static_cast<uint32_t>(m_data.size());
+        m_data.append(bytes);
+        m_offsets.insert(bytes, offset);
+        return StringRef{offset, static_cast<uint32_t>(bytes.size())};
+    }
+
+    [[nodiscard]] const QByteArray& data() const { return m_data; }
+
+private:
+    QByteArray m_data;
+    QHash<QByteArray, uint32_t> m_offsets;
+};
+
+QByteArray compactJson(const QVariantMap& map) {
+    if (map.isEmpty()) return QByteArray();
+    return QJsonDocument(QJsonObject::fromVariantMap(map)).toJson(QJsonDocument::Compact);
+}
+
+QVariantMap parseJson(const QByteArray& json) {
+    if (json.isEmpty()) return QVariantMap();
+    return QJsonDocument::fromJson(json).object().toVariantMap();
+}
+
+void writeUuid(uint8_t (&out)[16], const QUuid& id) {
+    const QByteArray bytes = id.toRfc4122();
+    std::memcpy(out, bytes.constData(), sizeof(out));
+}
+
+QUuid readUuid(const uint8_t (&in)[16]) {
+    return QUuid::fromRfc4122(QByteArrayView(reinterpret_cast<const char*>(in), sizeof(in)));
+}
+
+template <typename T>
+void appendRecord(QByteArray& out, const T& record) {
+    out.append(reinterpret_cast<const char*>(&record), sizeof(T));
+}
+
+/**
+ * @brief Bounds-checked view of a mapped collection
+ */
+class CollectionReader {
+public:
+    CollectionReader(const uchar* data, qint64 size, const FileHeader& header)
+        : m_data(data), m_size(static_cast<uint64_t>(size)), m_header(header) {}
+
+    [[nodiscard]] bool sectionFits(uint64_t offset, uint64_t count, uint64_t recordSize) const {
+        if (offset > m_size) return false;
+        return count == 0 || recordSize <= (m_size - offset) / count;
+    }
+
+    // Records may be larger in newer files; the unknown tail is ignored
+    template <typename T>
+    [[nodiscard]] T record(uint64_t sectionOffset, uint64_t recordSize, uint64_t index) const {
+        T out{};
+        std::memcpy(&out, m_data + sectionOffset + index * recordSize, sizeof(T));
+        return out;
+    }
+
+    [[nodiscard]] bool stringFits(const StringRef& ref) const {
+        return static_cast<uint64_t>(ref.offset) + ref.length <= m_header.stringsSize;
+    }
+
+    [[nodiscard]] QByteArray bytes(const StringRef& ref) const {
+        if (ref.length == 0 || !stringFits(ref)) return QByteArray();
+        return QByteArray(reinterpret_cast<const char*>(m_data + m_header.stringsOffset + ref.offset),
+                          static_cast<qsizetype>(ref.length));
+    }
+
+    [[nodiscard]] QString string(const StringRef& ref) const {
+        if (ref.length == 0 || !stringFits(ref)) return QString();
+        return QString::fromUtf8(reinterpret_cast<const char*>(m_data + m_header.stringsOffset + ref.offset),
+                                 static_cast<qsizetype>(ref.length));
+    }
+
+private:
+    const uchar* m_data;
+    uint64_t m_size;
+    FileHeader m_header;
+};
+
+// ==============================================================================
+// JSON Export Helpers
+// ==============================================================================
+QString blendModeName(BlendMode mode) {
+    switch (mode) {
+        case BlendMode::Normal: return "normal";
+        case BlendMode::Multiply: return "multiply";
+        case BlendMode::Screen: return "screen";
+        case BlendMode::Overlay: return "overlay";
+        case BlendMode::Additive: return "additive";
+    }
+    return "normal";
+}
+
+QJsonObject itemToJson(const ItemData& item) {
+    const ItemTransform& t = item.transform;
+
+    QJsonObject transform{
+        {"x", t.position.x()}, {"y", t.position.y()},
+        {"width", t.size.width()}, {"height", t.size.height()},
+        {"rotation", t.rotation},
+        {"scaleX", t.scale.x()}, {"scaleY", t.scale.y()},
+        {"anchorX", t.anchor.x()}, {"anchorY", t.anchor.y()},
+        {"opacity", t.opacity},
+        {"flipH", t.flipH}, {"flipV", t.flipV}
+    };
+
+    QJsonObject config{
+        {"width", item.config.resolution.width()},
+        {"height", item.config.resolution.height()},
+        {"fps", item.config.fps},
+        {"hardwareAcceleration", item.config.useHardwareAcceleration},
+        {"deviceId", item.config.deviceId}
+    };
+    if (!item.config.captureRegion.isNull()) {
+        const QRect& r = item.config.captureRegion;
+        config.insert("captureRegion", QJsonArray{r.x(), r.y(), r.width(), r.height()});
+    }
+
+    QJsonArray filters;
+    for (const FilterData& filter : item.filters) {
+        filters.append(QJsonObject{
+            {"plugin", filter.pluginId},
+            {"enabled", filter.enabled},
+            {"parameters", QJsonObject::fromVariantMap(filter.parameters)}
+        });
+    }
+
+    return QJsonObject{
+        {"id", item.id.toString(QUuid::WithoutBraces)},
+        {"name", item.name},
+        {"source", QJsonObject{
+            {"id", item.sourceId},
+            {"config", config},
+            {"settings", QJsonObject::fromVariantMap(item.settings)}
+        }},
+        {"transform", transform},
+        {"blendMode", blendModeName(item.blendMode)},
+        {"visible", item.visible},
+        {"locked", item.locked},
+        {"filters", filters}
+    };
+}
+
+} // namespace
+
+// ==============================================================================
+// SceneCollection Singleton
+// ==============================================================================
+SceneCollection& SceneCollection::instance() {
+    static SceneCollection instance;
+    return instance;
+}
+
+SceneCollection::SceneCollection(QObject* parent)
+    : QObject(parent)
+{
+    // Constructed first so the job system outlives m_saveJobs
+    JobSystem::instance();
+
+    // Source settings live in the plugins; they report edits here
+    connect(&PluginManager::instance(), &PluginManager::sourceSettingsChanged, this, [this](ISource* source) {
+        for (Scene* scene : SceneManager::instance().scenes()) {
+            if (!m_watchedScenes.contains(scene->id())) continue;
+            for (SceneItem* item : scene->items()) {
+                if (item->source() == source) {
+                    markDirty(scene);
+                    break;
+                }
+            }
+        }
+    });
+}
+
+SceneCollection::~SceneCollection() {
+    m_saveJobs.wait();
+}
+
+QString SceneCollection::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+           QStringLiteral("/scenes/default.wearscn");
+}
+
+SceneCollectionStatistics SceneCollection::statistics() const {
+    QMutexLocker lock(&m_statsMutex);
+    return m_stats;
+}
+
+// ==============================================================================
+// Snapshot
+// ==============================================================================
+SceneData SceneCollection::snapshotScene(Scene* scene) const {
+    SceneData data;
+    data.id = scene->id();
+    data.name = scene->name();
+    data.resolution = scene->resolution();
+    data.background = scene->backgroundColor();
+
+    const QList<SceneItem*> items = scene->items();
+    data.items.reserve(items.size());
+
+    for (SceneItem* sceneItem : items) {
+        // Items whose plugin was missing on load keep their saved source
+        auto unresolved = m_unresolvedItems.constFind(sceneItem->id());
+
+        ItemData item;
+        if (unresolved != m_unresolvedItems.constEnd() && !sceneItem->hasSource()) {
+            item = unresolved.value();
+        } else if (ISource* source = sceneItem->source()) {
+            item.sourceId = source->info().id;
+            item.config = source->config();
+            item.settings = source->saveSettings();
+        }
+
+        item.id = sceneItem->id();
+        item.name = sceneItem->name();
+        item.transform = sceneItem->transform();
+        item.blendMode = sceneItem->blendMode();
+        item.visible = sceneItem->isVisible();
+        item.locked = sceneItem->isLocked();
+        data.items.append(item);
+    }
+
+    return data;
+}
+
+SceneCollectionData SceneCollection::snapshot() {
+    SceneManager& manager = SceneManager::instance();
+
+    SceneCollectionData data;
+    for (Scene* scene : manager.scenes()) {
+        data.scenes.append(snapshotScene(scene));
+    }
+    if (Scene* active = manager.activeScene()) {
+        data.activeScene = active->id();
+    }
+    return data;
+}
+
+// ==============================================================================
+// Binary Encoding
+// ==============================================================================
+QByteArray SceneCollection::serialize(const SceneCollectionData& data) {
+    StringTableWriter strings;
+    QByteArray scenes;
+    QByteArray items;
+    QByteArray filters;
+
+    uint32_t itemIndex = 0;
+    uint32_t filterIndex = 0;
+    int32_t activeIndex = kNoActiveScene;
+
+    for (int s = 0; s < data.scenes.size(); ++s) {
+        const SceneData& scene = data.scenes[s];
+        if (scene.id == data.activeScene) {
+            activeIndex = s;
+        }
+
+        SceneRecord sceneRecord{};
+        writeUuid(sceneRecord.id, scene.id);
+        sceneRecord.name = strings.add(scene.name);
+        sceneRecord.width = static_cast<uint32_t>(std::max(scene.resolution.width(), 0));
+        sceneRecord.height = static_cast<uint32_t>(std::max(scene.resolution.height(), 0));
+        sceneRecord.background = scene.background.rgba();
+        sceneRecord.firstItem = itemIndex;
+        sceneRecord.itemCount = static_cast<uint32_t>(scene.items.size());
+        appendRecord(scenes, sceneRecord);
+
+        for (const ItemData& item : scene.items) {
+            const ItemTransform& t = item.transform;
+            const QRect& region = item.config.captureRegion;
+
+            ItemRecord itemRecord{};
+            writeUuid(itemRecord.id, item.id);
+            itemRecord.name = strings.add(item.name);
+            itemRecord.sourceId = strings.add(item.sourceId);
+            itemRecord.settings = strings.addBytes(compactJson(item.settings));
+            itemRecord.deviceId = strings.add(item.config.deviceId);
+            itemRecord.x = t.position.x();
+            itemRecord.y = t.position.y();
+            itemRecord.width = t.size.width();
+            itemRecord.height = t.size.height();
+            itemRecord.rotation = t.rotation;
+            itemRecord.scaleX = t.scale.x();
+            itemRecord.scaleY = t.scale.y();
+            itemRecord.anchorX = t.anchor.x();
+            itemRecord.anchorY = t.anchor.y();
+            itemRecord.opacity = t.opacity;
+            itemRecord.fps = item.config.fps;
+            itemRecord.captureRegion[0] = region.x();
+            itemRecord.captureRegion[1] = region.y();
+            itemRecord.captureRegion[2] = region.width();
+            itemRecord.captureRegion[3] = region.height();
+            itemRecord.configWidth = static_cast<uint32_t>(std::max(item.config.resolution.width(), 0));
+            itemRecord.configHeight = static_cast<uint32_t>(std::max(item.config.resolution.height(), 0));
+            itemRecord.flags = (item.visible ? kItemVisible : 0) |
+                               (item.locked ? kItemLocked : 0) |
+                               (t.flipH ? kItemFlipH : 0) |
+                               (t.flipV ? kItemFlipV : 0) |
+                               (item.config.useHardwareAcceleration ? kItemHardwareAccel : 0);
+            itemRecord.blendMode = static_cast<uint32_t>(item.blendMode);
+            itemRecord.firstFilter = filterIndex;
+            itemRecord.filterCount = static_cast<uint32_t>(item.filters.size());
+            appendRecord(items, itemRecord);
+            itemIndex++;
+
+            for (const FilterData& filter : item.filters) {
+                FilterRecord filterRecord{};
+                filterRecord.pluginId = strings.add(filter.pluginId);
+                filterRecord.parameters = strings.addBytes(compactJson(filter.parameters));
+                filterRecord.enabled = filter.enabled ? 1 : 0;
+                appendRecord(filters, filterRecord);
+                filterIndex++;
+            }
+        }
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.headerSize = sizeof(FileHeader);
+    header.sceneCount = static_cast<uint32_t>(data.scenes.size());
+    header.itemCount = itemIndex;
+    header.filterCount = filterIndex;
+    header.activeScene = activeIndex;
+    header.sceneRecordSize = sizeof(SceneRecord);
+    header.itemRecordSize = sizeof(ItemRecord);
+    header.filterRecordSize = sizeof(FilterRecord);
+    header.scenesOffset = sizeof(FileHeader);
+    header.itemsOffset = header.scenesOffset + scenes.size();
+    header.filtersOffset = header.itemsOffset + items.size();
+    header.stringsOffset = header.filtersOffset + filters.size();
+    header.stringsSize = strings.data().size();
+
+    QByteArray out;
+    out.reserve(static_cast<qsizetype>(header.stringsOffset + header.stringsSize));
+    appendRecord(out, header);
+    out.append(scenes);
+    out.append(items);
+    out.append(filters);
+    out.append(strings.data());
+    return out;
+}
+
+bool SceneCollection::deserialize(const uchar* bytes, qint64 size, SceneCollectionData& data) {
+    constexpr qint64 kMinHeaderSize = offsetof(FileHeader, stringsSize) + sizeof(uint64_t);
+
+    if (!bytes || size < kMinHeaderSize || std::memcmp(bytes, kMagic, sizeof(kMagic)) != 0) {
+        qWarning() << "Scene collection: not a scene collection file";
+        return false;
+    }
+
+    FileHeader header{};
+    uint32_t headerSize = 0;
+    std::memcpy(&headerSize, bytes + offsetof(FileHeader, headerSize), sizeof(headerSize));
+    if (headerSize < kMinHeaderSize || headerSize > size) {
+        qWarning() << "Scene collection: invalid header size" << headerSize;
+        return false;
+    }
+    std::memcpy(&header, bytes, std::min<size_t>(headerSize, sizeof(FileHeader)));
+
+    if (header.version == 0 || header.version > kFormatVersion) {
+        qWarning() << "Scene collection: unsupported version" << header.version;
+        return false;
+    }
+
+    if (header.sceneRecordSize < sizeof(SceneRecord) ||
+        header.itemRecordSize < sizeof(ItemRecord) ||
+        header.filterRecordSize < sizeof(FilterRecord)) {
+        qWarning() << "Scene collection: truncated records";
+        return false;
+    }
+
+    CollectionReader reader(bytes, size, header);
+    if (!reader.sectionFits(header.scenesOffset, header.sceneCount, header.sceneRecordSize) ||
+        !reader.sectionFits(header.itemsOffset, header.itemCount, header.itemRecordSize) ||
+        !reader.sectionFits(header.filtersOffset, header.filterCount, header.filterRecordSize) ||
+        !reader.sectionFits(header.stringsOffset, 1, header.stringsSize)) {
+        qWarning() << "Scene collection: file is truncated or corrupt";
+        return false;
+    }
+
+    data = SceneCollectionData();
+    data.scenes.reserve(static_cast<qsizetype>(header.sceneCount));
+
+    for (uint32_t s = 0; s < header.sceneCount; ++s) {
+        const auto sceneRecord = reader.record<SceneRecord>(header.scenesOffset, header.sceneRecordSize, s);
+        if (static_cast<uint64_t>(sceneRecord.firstItem) + sceneRecord.itemCount > header.itemCount) {
+            qWarning() << "Scene collection: scene" << s << "references missing items";
+            return false;
+        }
+
+        SceneData scene;
+        scene.id = readUuid(sceneRecord.id);
+        scene.name = reader.string(sceneRecord.name);
+        scene.resolution = QSize(static_cast<int>(sceneRecord.width), static_cast<int>(sceneRecord.height));
+        scene.background = QColor::fromRgba(sceneRecord.background);
+        scene.items.reserve(static_cast<qsizetype>(sceneRecord.itemCount));
+
+        for (uint32_t i = 0; i < sceneRecord.itemCount; ++i) {
+            const auto r = reader.record<ItemRecord>(header.itemsOffset, header.itemRecordSize,
+                                                     sceneRecord.firstItem + i);
+            if (static_cast<uint64_t>(r.firstFilter) + r.filterCount > header.filterCount) {
+                qWarning() << "Scene collection: item references missing filters";
+                return false;
+            }
+
+            ItemData item;
+            item.id = readUuid(r.id);
+            item.name = reader.string(r.name);
+            item.sourceId = reader.string(r.sourceId);
+            item.settings = parseJson(reader.bytes(r.settings));
+            item.config.deviceId = reader.string(r.deviceId);
+            item.config.fps = r.fps;
+            item.config.resolution = QSize(static_cast<int>(r.configWidth), static_cast<int>(r.configHeight));
+            item.config.captureRegion = QRect(r.captureRegion[0], r.captureRegion[1],
+                                              r.captureRegion[2], r.captureRegion[3]);
+            item.config.useHardwareAcceleration = (r.flags & kItemHardwareAccel) != 0;
+
+            ItemTransform& t = item.transform;
+            t.position = QPointF(r.x, r.y);
+            t.size = QSizeF(r.width, r.height);
+            t.rotation = r.rotation;
+            t.scale = QPointF(r.scaleX, r.scaleY);
+            t.anchor = QPointF(r.anchorX, r.anchorY);
+            t.opacity = r.opacity;
+            t.flipH = (r.flags & kItemFlipH) != 0;
+            t.flipV = (r.flags & kItemFlipV) != 0;
+
+            item.visible = (r.flags & kItemVisible) != 0;
+            item.locked = (r.flags & kItemLocked) != 0;
+            item.blendMode = r.blendMode <= static_cast<uint32_t>(BlendMode::Additive)
+                ? static_cast<BlendMode>(r.blendMode) : BlendMode::Normal;
+
+            for (uint32_t f = 0; f < r.filterCount; ++f) {
+                const auto filterRecord = reader.record<FilterRecord>(
+                    header.filtersOffset, header.filterRecordSize, r.firstFilter + f);
+
+                FilterData filter;
+                filter.pluginId = reader.string(filterRecord.pluginId);
+                filter.parameters = parseJson(reader.bytes(filterRecord.parameters));
+                filter.enabled = filterRecord.enabled != 0;
+                item.filters.append(filter);
+            }
+
+            scene.items.append(item);
+        }
+
+        data.scenes.append(scene);
+    }
+
+    if (header.activeScene >= 0 && static_cast<uint32_t>(header.activeScene) < header.sceneCount) {
+        data.activeScene = data.scenes[header.activeScene].id;
+    }
+
+    return true;
+}
+
+// ==============================================================================
+// JSON Export
+// ==============================================================================
+QByteArray SceneCollection::toJson(const SceneCollectionData& data) {
+    QJsonArray scenes;
+    for (const SceneData& scene : data.scenes) {
+        QJsonArray items;
+        for (const ItemData& item : scene.items) {
+            items.append(itemToJson(item));
+        }
+
+        scenes.append(QJsonObject{
+            {"id", scene.id.toString(QUuid::WithoutBraces)},
+            {"name", scene.name},
+            {"width", scene.resolution.width()},
+            {"height", scene.resolution.height()},
+            {"background", scene.background.name(QColor::HexArgb)},
+            {"items", items}
+        });
+    }
+
+    const QJsonObject root{
+        {"format", "wear-scene-collection"},
+        {"version", static_cast<int>(kFormatVersion)},
+        {"activeScene", data.activeScene.toString(QUuid::WithoutBraces)},
+        {"scenes", scenes}
+    };
+
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+// ==============================================================================
+// Save / Load
+// ==============================================================================
+bool SceneCollection::writeFile(const QString& path, const QByteArray& bytes) {
+    const QFileInfo info(path);
+    if (!QDir().mkpath(info.absolutePath())) {
+        qWarning() << "Scene collection: cannot create directory" << info.absolutePath();
+        return false;
+    }
+
+    // QSaveFile replaces the target only once the new file is complete
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Scene collection: cannot write" << path << "-" << file.errorString();
+        return false;
+    }
+
+    if (file.write(bytes) != bytes.size() || !file.commit()) {
+        qWarning() << "Scene collection: write failed for" << path << "-" << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool SceneCollection::save(const QString& path) {
+    const SceneCollectionData data = snapshot();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QByteArray bytes = serialize(data);
+    const bool success = writeFile(path, bytes);
+
+    if (success) {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats.saves++;
+        m_stats.lastSaveMs = timer.nsecsElapsed() / 1e6;
+        m_stats.lastFileSize = bytes.size();
+    }
+
+    emit saved(path, success);
+    return success;
+}
+
+bool SceneCollection::exportJson(const QString& path) {
+    return writeFile(path, toJson(snapshot()));
+}
+
+bool SceneCollection::load(const QString& path) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Scene collection: cannot open" << path << "-" << file.errorString();
+        return false;
+    }
+
+    SceneCollectionData data;
+    bool valid = false;
+
+    const qint64 size = file.size();
+    if (uchar* mapped = file.map(0, size)) {
+        valid = deserialize(mapped, size, data);
+        file.unmap(mapped);
+    } else {
+        // Mapping can fail on some file systems; read the file instead
+        const QByteArray bytes = file.readAll();
+        valid = deserialize(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size(), data);
+    }
+    file.close();
+
+    if (!valid) {
+        qWarning() << "Scene collection: failed to load" << path;
+        return false;
+    }
+
+    const double decodeMs = timer.nsecsElapsed() / 1e6;
+
+    if (!apply(data)) {
+        return false;
+    }
+
+    {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats.loads++;
+        m_stats.lastLoadMs = decodeMs;
+    }
+
+    qInfo() << "Scene collection: loaded" << data.scenes.size() << "scenes from" << path
+            << "in" << decodeMs << "ms";
+
+    emit loaded(path);
+    return true;
+}
+
+ISource* SceneCollection::resolveSource(const ItemData& item, const QHash<QUuid, Scene*>& scenes) const {
+    if (item.sourceId.isEmpty()) return nullptr;
+
+    if (item.sourceId == kSceneSourceId) {
+        const QUuid savedId = QUuid::fromString(item.settings.value(QStringLiteral("scene")).toString());
+        Scene* nested = scenes.value(savedId);
+        if (!nested) {
+            qWarning() << "Scene collection: nested scene missing for item" << item.name;
+            return nullptr;
+        }
+        return SceneManager::instance().sceneSource(nested);
+    }
+
+    ISource* source = nullptr;
+    CaptureManager& capture = CaptureManager::instance();
+    if (item.sourceId == capture.info().id) {
+        source = &capture;
+    } else {
+        source = PluginManager::instance().createSource(item.sourceId);
+    }
+
+    if (!source) {
+        qWarning() << "Scene collection: source" << item.sourceId << "not available for item" << item.name;
+        return nullptr;
+    }
+
+    // Started by SceneManager once a visible item in a shown scene uses it
+    source->configure(item.config);
+    source->loadSettings(item.settings);
+    return source;
+}
+
+bool SceneCollection::apply(const SceneCollectionData& data) {
+    if (data.scenes.isEmpty()) {
+        qWarning() << "Scene collection: collection has no scenes";
+        return false;
+    }
+
+    SceneManager& manager = SceneManager::instance();
+    const QList<Scene*> previous = manager.scenes();
+
+    // Change signals during the rebuild are not user edits
+    m_loading = true;
+    m_unresolvedItems.clear();
+
+    // Create every scene first so nested scene sources can be resolved,
+    // and so the old scenes can all be removed afterwards
+    QHash<QUuid, Scene*> created;
+    QList<Scene*> ordered;
+    ordered.reserve(data.scenes.size());
+
+    for (const SceneData& sceneData : data.scenes) {
+        Scene* scene = manager.createScene(sceneData.name);
+        if (sceneData.resolution.isValid()) {
+            scene->setResolution(sceneData.resolution);
+        }
+        scene->setBackgroundColor(sceneData.background);
+        created.insert(sceneData.id, scene);
+        ordered.append(scene);
+    }
+
+    for (int s = 0; s < data.scenes.size(); ++s) {
+        Scene* scene = ordered[s];
+
+        for (const ItemData& itemData : data.scenes[s].items) {
+            ISource* source = resolveSource(itemData, created);
+
+            // Sources are shared instances; the item does not own them
+            auto* item = new SceneItem(itemData.name, source);
+            item->setTransform(itemData.transform);
+            item->setBlendMode(itemData.blendMode);
+            item->setVisible(itemData.visible);
+            item->setLocked(itemData.locked);
+            scene->addItem(item);
+
+            if (!source && !itemData.sourceId.isEmpty()) {
+                m_unresolvedItems.insert(item->id(), itemData);
+            }
+        }
+    }
+
+    manager.setActiveScene(created.value(data.activeScene, ordered.first()));
+
+    for (Scene* scene : previous) {
+        manager.removeScene(scene);
+    }
+
+    m_loading = false;
+    m_dirtyScenes.clear();
+    m_sceneCache.clear();
+    return true;
+}
+
+// ==============================================================================
+// Autosave
+// ==============================================================================
+void SceneCollection::enableAutosave(const QString& path, int debounceMs) {
+    m_autosavePath = path.isEmpty() ? defaultPath() : path;
+
+    if (!m_debounce) {
+        m_debounce = new QTimer(this);
+        m_debounce->setSingleShot(true);
+        connect(m_debounce, &QTimer::timeout, this, &SceneCollection::startBackgroundSave);
+
+        SceneManager& manager = SceneManager::instance();
+        connect(&manager, &SceneManager::sceneAdded, this, [this](Scene* scene) {
+            watchScene(scene);
+            markStructureDirty();
+        });
+        connect(&manager, &SceneManager::sceneRemoved, this, [this](const QUuid& id) {
+            m_sceneCache.remove(id);
+            m_dirtyScenes.remove(id);
+            m_watchedScenes.remove(id);
+            markStructureDirty();
+        });
+        connect(&manager, &SceneManager::activeSceneChanged, this, [this]() {
+            markStructureDirty();
+        });
+    }
+    m_debounce->setInterval(debounceMs);
+
+    for (Scene* scene : SceneManager::instance().scenes()) {
+        watchScene(scene);
+    }
+
+    m_autosave = true;
+    qInfo() << "Scene collection: autosaving to" << m_autosavePath;
+}
+
+void SceneCollection::disableAutosave() {
+    m_autosave = false;
+    if (m_debounce) {
+        m_debounce->stop();
+    }
+}
+
+void SceneCollection::flushAutosave() {
+    if (!m_autosave) return;
+
+    if (m_debounce) {
+        m_debounce->stop();
+    }
+    m_saveJobs.wait();
+    m_saveInFlight = false;
+    m_savePending = false;
+
+    // A full snapshot also picks up source settings changed without a scene signal
+    if (save(m_autosavePath)) {
+        m_dirtyScenes.clear();
+    }
+}
+
+void SceneCollection::watchScene(Scene* scene) {
+    if (!scene || m_watchedScenes.contains(scene->id())) return;
+    m_watchedScenes.insert(scene->id());
+
+    auto dirty = [this, scene]() { markDirty(scene); };
+    connect(scene, &Scene::sceneChanged, this, dirty);
+    connect(scene, &Scene::nameChanged, this, dirty);
+    connect(scene, &Scene::resolutionChanged, this, dirty);
+    connect(scene, &Scene::itemRemoved, this, dirty);
+    connect(scene, &Scene::itemsReordered, this, dirty);
+    connect(scene, &Scene::itemAdded, this, [this, scene, dirty](SceneItem* item) {
+        // Name and lock state do not reach Scene::sceneChanged
+        connect(item, &SceneItem::nameChanged, this, dirty);
+        connect(item, &SceneItem::lockedChanged, this, dirty);
+        markDirty(scene);
+    });
+
+    for (SceneItem* item : scene->items()) {
+        connect(item, &SceneItem::nameChanged, this, dirty);
+        connect(item, &SceneItem::lockedChanged, this, dirty);
+    }
+}
+
+void SceneCollection::markDirty(Scene* scene) {
+    if (m_loading) return;
+    m_dirtyScenes.insert(scene->id());
+    scheduleAutosave();
+}
+
+void SceneCollection::markStructureDirty() {
+    if (m_loading) return;
+    scheduleAutosave();
+}
+
+void SceneCollection::scheduleAutosave() {
+    // Restarting the timer coalesces bursts (e.g. dragging an item)
+    if (m_autosave && m_debounce) {
+        m_debounce->start();
+    }
+}
+
+void SceneCollection::startBackgroundSave() {
+    if (!m_autosave) return;
+
+    if (m_saveInFlight) {
+        m_savePending = true;
+        return;
+    }
+
+    // Snapshot on the GUI thread; clean scenes reuse their cached snapshot
+    QElapsedTimer timer;
+    timer.start();
+
+    SceneManager& manager = SceneManager::instance();
+    SceneCollectionData data;
+    int64_t reused = 0;
+
+    for (Scene* scene : manager.scenes()) {
+        const QUuid id = scene->id();
+        auto cached = m_sceneCache.constFind(id);
+        if (cached != m_sceneCache.constEnd() && !m_dirtyScenes.contains(id)) {
+            data.scenes.append(cached.value());
+            reused++;
+            continue;
+        }
+
+        SceneData sceneData = snapshotScene(scene);
+        m_sceneCache.insert(id, sceneData);
+        data.scenes.append(std::move(sceneData));
+    }
+    if (Scene* active = manager.activeScene()) {
+        data.activeScene = active->id();
+    }
+    m_dirtyScenes.clear();
+
+    {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats.scenesReused += reused;
+        m_stats.lastSnapshotMs = timer.nsecsElapsed() / 1e6;
+    }
+
+    // Serialize and write off the GUI and render threads
+    m_saveInFlight = true;
+    const QString path = m_autosavePath;
+    m_saveJobs.run([this, data = std::move(data), path]() {
+        QElapsedTimer writeTimer;
+        writeTimer.start();
+
+        const QByteArray bytes = serialize(data);
+        const bool success = writeFile(path, bytes);
+        const double elapsedMs = writeTimer.nsecsElapsed() / 1e6;
+        const qint64 size = bytes.size();
+
+        QMetaObject::invokeMethod(this, [this, success, elapsedMs, size]() {
+            onBackgroundSaveFinished(success, elapsedMs, size);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SceneCollection::onBackgroundSaveFinished(bool success, double elapsedMs, qint64 size) {
+    if (!m_saveInFlight) return;    // Superseded by flushAutosave()
+    m_saveInFlight = false;
+
+    if (success) {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats.saves++;
+        m_stats.lastSaveMs = elapsedMs;
+        m_stats.lastFileSize = size;
+    }
+
+    emit saved(m_autosavePath, success);
+
+    if (m_savePending) {
+        m_savePending = false;
+        startBackgroundSave();
+    }
+}
+
+} // namespace WeaR
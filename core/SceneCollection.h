@@ -0,0 +1,247 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio SceneCollection
+// Scene persistence: binary collection files, JSON export and autosave
+// ==============================================================================
+
+#include "ISource.h"
+#include "SceneItem.h"
+#include "JobSystem.h"
+
+#include <QObject>
+#include <QString>
+#include <QColor>
+#include <QSize>
+#include <QUuid>
+#include <QVariantMap>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QTimer>
+#include <QByteArray>
+#include <QMutex>
+
+namespace WeaR {
+
+class Scene;
+
+/**
+ * @brief Persisted filter on a scene item
+ */
+struct FilterData {
+    QString pluginId;           ///< Filter plugin identifier
+    QVariantMap parameters;     ///< Filter parameters
+    bool enabled = true;        ///< Filter active
+};
+
+/**
+ * @brief Persisted scene item
+ */
+struct ItemData {
+    QUuid id;                   ///< Item id when saved
+    QString name;               ///< Display name
+    QString sourceId;           ///< Source plugin id (empty = no source)
+    SourceConfig config;        ///< Source configuration
+    QVariantMap settings;       ///< Source-specific settings (ISource::saveSettings)
+    ItemTransform transform;    ///< Placement
+    BlendMode blendMode = BlendMode::Normal;
+    bool visible = true;
+    bool locked = false;
+    QList<FilterData> filters;  ///< Filter chain, in order
+};
+
+/**
+ * @brief Persisted scene
+ */
+struct SceneData {
+    QUuid id;                   ///< Scene id when saved (for nested scene references)
+    QString name;               ///< Display name
+    QSize resolution;           ///< Canvas size
+    QColor background;          ///< Background colour
+    QList<ItemData> items;      ///< Items, bottom to top
+};
+
+/**
+ * @brief Persisted scene collection
+ */
+struct SceneCollectionData {
+    QList<SceneData> scenes;    ///< Scenes, in list order
+    QUuid activeScene;          ///< Scene shown on load
+};
+
+/**
+ * @brief Scene collection statistics
+ */
+struct SceneCollectionStatistics {
+    int64_t saves = 0;              ///< Collections written
+    int64_t loads = 0;              ///< Collections read
+    int64_t scenesReused = 0;       ///< Autosave snapshots reusing a clean scene
+    double lastSaveMs = 0.0;        ///< Serialize + write time of the last save
+    double lastLoadMs = 0.0;        ///< Map + decode time of the last load
+    double lastSnapshotMs = 0.0;    ///< GUI-thread time of the last autosave snapshot
+    qint64 lastFileSize = 0;        ///< Size of the last file written
+};
+
+/**
+ * @brief Saves and restores the SceneManager's scenes
+ *
+ * The binary format (.wearscn) is a header followed by fixed-size scene,
+ * item and filter records and a string table. Records are little-endian
+ * PODs that reference strings by offset, so a load maps the file and
+ * copies records out directly instead of parsing it field by field.
+ * The header stores the record sizes; a newer writer may grow records
+ * and older readers ignore the tail.
+ *
+ * Autosave marks scenes dirty from their change signals and, after a
+ * short debounce, snapshots them on the GUI thread (reusing the cached
+ * snapshot of unchanged scenes). Serialization and the file write run
+ * on a background job and never touch the render loop.
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class SceneCollection : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the SceneCollection instance
+     */
+    static SceneCollection& instance();
+
+    // Prevent copying
+    SceneCollection(const SceneCollection&) = delete;
+    SceneCollection& operator=(const SceneCollection&) = delete;
+
+    ~SceneCollection() override;
+
+    /**
+     * @brief Default collection path in the application data directory
+     */
+    [[nodiscard]] static QString defaultPath();
+
+    // =========================================================================
+    // Save / Load
+    // =========================================================================
+
+    /**
+     * @brief Write the current scenes to a binary collection (blocking)
+     * @param path Target file (written atomically)
+     * @return true on success
+     */
+    bool save(const QString& path);
+
+    /**
+     * @brief Replace the current scenes with a binary collection
+     * @param path Collection file
+     * @return true on success; on failure the current scenes are kept
+     */
+    bool load(const QString& path);
+
+    /**
+     * @brief Write the current scenes as indented JSON
+     * @param path Target file
+     * @return true on success
+     */
+    bool exportJson(const QString& path);
+
+    /**
+     * @brief Capture the current scenes
+     */
+    [[nodiscard]] SceneCollectionData snapshot();
+
+    /**
+     * @brief Encode a collection in the binary format
+     */
+    [[nodiscard]] static QByteArray serialize(const SceneCollectionData& data);
+
+    /**
+     * @brief Decode a binary collection
+     * @param bytes File contents (e.g. a mapped file)
+     * @param size Size in bytes
+     * @param data Decoded collection
+     * @return true if the data is a valid collection
+     */
+    static bool deserialize(const uchar* bytes, qint64 size, SceneCollectionData& data);
+
+    /**
+     * @brief Encode a collection as JSON
+     */
+    [[nodiscard]] static QByteArray toJson(const SceneCollectionData& data);
+
+    // =========================================================================
+    // Autosave
+    // =========================================================================
+
+    /**
+     * @brief Enable background autosave
+     * @param path Target file (empty = defaultPath())
+     * @param debounceMs Quiet time after a change before saving
+     */
+    void enableAutosave(const QString& path = QString(), int debounceMs = 2000);
+
+    /**
+     * @brief Disable autosave (pending changes are not written)
+     */
+    void disableAutosave();
+
+    [[nodiscard]] bool isAutosaveEnabled() const { return m_autosave; }
+
+    /**
+     * @brief Write pending changes now and wait for the write to finish
+     */
+    void flushAutosave();
+
+    /**
+     * @brief Get statistics
+     */
+    [[nodiscard]] SceneCollectionStatistics statistics() const;
+
+signals:
+    /**
+     * @brief Emitted after a collection was written
+     * @param path Target file
+     * @param success Write result
+     */
+    void saved(const QString& path, bool success);
+
+    /**
+     * @brief Emitted after a collection was loaded
+     */
+    void loaded(const QString& path);
+
+private:
+    SceneCollection(QObject* parent = nullptr);
+
+    void watchScene(Scene* scene);
+    void markDirty(Scene* scene);
+    void markStructureDirty();
+    void scheduleAutosave();
+    void startBackgroundSave();
+    void onBackgroundSaveFinished(bool success, double elapsedMs, qint64 size);
+
+    SceneData snapshotScene(Scene* scene) const;
+    bool apply(const SceneCollectionData& data);
+    ISource* resolveSource(const ItemData& item, const QHash<QUuid, Scene*>& scenes) const;
+
+    static bool writeFile(const QString& path, const QByteArray& bytes);
+
+    // Autosave state (GUI thread)
+    bool m_autosave = false;
+    bool m_loading = false;
+    bool m_saveInFlight = false;
+    bool m_savePending = false;
+    QString m_autosavePath;
+    QTimer* m_debounce = nullptr;
+    QSet<QUuid> m_dirtyScenes;
+    QHash<QUuid, SceneData> m_sceneCache;
+    QSet<QUuid> m_watchedScenes;
+    QHash<QUuid, ItemData> m_unresolvedItems;  ///< Items whose source was unavailable on load
+
+    JobGroup m_saveJobs{JobPriority::Background};
+
+    mutable QMutex m_statsMutex;
+    SceneCollectionStatistics m_stats;
+};
+
+} // namespace WeaR
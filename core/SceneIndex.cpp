@@ -0,0 +1,453 @@
+// ==============================================================================
+// WeaR-studio SceneIndex Implementation
+// ==============================================================================
+
+#include "SceneIndex.h"
+#include "SceneItem.h"
+
+#include <QPolygonF>
+
+#include <algorithm>
+#include <limits>
+
+namespace WeaR {
+
+namespace {
+
+// Node fan-out; a node below the minimum is dissolved and its items reinserted
+constexpr size_t kMaxEntries = 16;
+constexpr size_t kMinEntries = 6;
+
+// Own union/intersection: QRectF ignores zero-sized rectangles, but an
+// item without a size still has a position
+QRectF unite(const QRectF& a, const QRectF& b) {
+    return QRectF(QPointF(std::min(a.left(), b.left()), std::min(a.top(), b.top())),
+                  QPointF(std::max(a.right(), b.right()), std::max(a.bottom(), b.bottom())));
+}
+
+bool overlaps(const QRectF& a, const QRectF& b) {
+    return a.left() <= b.right() && b.left() <= a.right() &&
+           a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+qreal area(const QRectF& rect) {
+    return rect.width() * rect.height();
+}
+
+qreal enlargement(const QRectF& rect, const QRectF& added) {
+    return area(unite(rect, added)) - area(rect);
+}
+
+} // namespace
+
+// ==============================================================================
+// R-tree nodes
+// ==============================================================================
+struct SceneIndex::Entry {
+    QRectF rect;                    ///< Item bounds, or the child's bounds
+    SceneItem* item = nullptr;      ///< Leaf entries
+    std::unique_ptr<Node> child;    ///< Internal entries
+};
+
+struct SceneIndex::Node {
+    bool leaf = true;
+    Node* parent = nullptr;
+    std::vector<Entry> entries;
+
+    QRectF bounds() const {
+        if (entries.empty()) return QRectF();
+        QRectF result = entries.front().rect;
+        for (size_t i = 1; i < entries.size(); ++i) {
+            result = unite(result, entries[i].rect);
+        }
+        return result;
+    }
+
+    Entry* entryFor(const Node* node) {
+        for (Entry& entry : entries) {
+            if (entry.child.get() == node) return &entry;
+        }
+        return nullptr;
+    }
+};
+
+SceneIndex::SceneIndex()
+    : m_root(std::make_unique<Node>())
+{
+}
+
+SceneIndex::~SceneIndex() = default;
+
+// ==============================================================================
+// Membership
+// ==============================================================================
+void SceneIndex::insert(SceneItem* item, int layer) {
+    if (!item || m_records.contains(item)) return;
+
+    Record& record = m_records[item];
+    record.bounds = itemBounds(item);
+    record.name = item->name();
+    record.layer = layer;
+
+    m_byId.insert(item->id(), item);
+    m_byName.insert(record.name, item);
+    insertEntry(item, record.bounds);
+}
+
+void SceneIndex::remove(SceneItem* item) {
+    auto it = m_records.find(item);
+    if (it == m_records.end()) return;
+
+    const QString name = it->name;
+    removeEntry(item);
+    m_byId.remove(item->id());
+    m_byName.remove(name, item);
+    m_records.remove(item);
+}
+
+void SceneIndex::clear() {
+    m_records.clear();
+    m_byId.clear();
+    m_byName.clear();
+    m_root = std::make_unique<Node>();
+}
+
+// ==============================================================================
+// Lookups
+// ==============================================================================
+SceneItem* SceneIndex::itemById(const QUuid& id) const {
+    return m_byId.value(id, nullptr);
+}
+
+SceneItem* SceneIndex::itemByName(const QString& name) const {
+    SceneItem* result = nullptr;
+    int lowest = std::numeric_limits<int>::max();
+
+    for (SceneItem* item : m_byName.values(name)) {
+        const int itemLayer = m_records.value(item).layer;
+        if (itemLayer < lowest) {
+            lowest = itemLayer;
+            result = item;
+        }
+    }
+    return result;
+}
+
+int SceneIndex::layer(const SceneItem* item) const {
+    auto it = m_records.constFind(item);
+    return it == m_records.cend() ? -1 : it->layer;
+}
+
+void SceneIndex::renumber(const QList<SceneItem*>& items, int from, int to) {
+    from = std::max(from, 0);
+    to = std::min(to, static_cast<int>(items.size()) - 1);
+
+    for (int i = from; i <= to; ++i) {
+        auto it = m_records.find(items.at(i));
+        if (it != m_records.end()) {
+            it->layer = i;
+        }
+    }
+}
+
+void SceneIndex::rename(SceneItem* item) {
+    auto it = m_records.find(item);
+    if (it == m_records.end() || it->name == item->name()) return;
+
+    m_byName.remove(it->name, item);
+    it->name = item->name();
+    m_byName.insert(it->name, item);
+}
+
+// ==============================================================================
+// Spatial queries
+// ==============================================================================
+QRectF SceneIndex::itemBounds(const SceneItem* item) {
+    const ItemTransform transform = item->transform();
+    return transform.toQTransform().mapRect(QRectF(QPointF(0, 0), transform.size));
+}
+
+void SceneIndex::updateBounds(SceneItem* item) {
+    auto it = m_records.find(item);
+    if (it == m_records.end()) return;
+
+    const QRectF bounds = itemBounds(item);
+    if (bounds == it->bounds) return;
+
+    removeEntry(item);
+    it = m_records.find(item);
+    it->bounds = bounds;
+    insertEntry(item, bounds);
+}
+
+QRectF SceneIndex::bounds(const SceneItem* item) const {
+    return m_records.value(item).bounds;
+}
+
+QList<SceneItem*> SceneIndex::query(const QRectF& rect) const {
+    QList<SceneItem*> result;
+
+    std::vector<const Node*> stack{m_root.get()};
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+
+        for (const Entry& entry : node->entries) {
+            if (!overlaps(entry.rect, rect)) continue;
+
+            if (node->leaf) {
+                result.append(entry.item);
+            } else {
+                stack.push_back(entry.child.get());
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [this](SceneItem* a, SceneItem* b) {
+        return m_records.value(a).layer < m_records.value(b).layer;
+    });
+    return result;
+}
+
+SceneItem* SceneIndex::hitTest(const QPointF& point) const {
+    const QList<SceneItem*> candidates = query(QRectF(point, QSizeF(0, 0)));
+
+    // Topmost first; bounds of rotated items are larger than their shape
+    for (auto it = candidates.crbegin(); it != candidates.crend(); ++it) {
+        SceneItem* item = *it;
+        if (!item->isVisible()) continue;
+
+        const ItemTransform transform = item->transform();
+        const QPolygonF shape = transform.toQTransform().map(
+            QPolygonF(QRectF(QPointF(0, 0), transform.size)));
+        if (shape.containsPoint(point, Qt::OddEvenFill)) {
+            return item;
+        }
+    }
+    return nullptr;
+}
+
+int SceneIndex::depth() const {
+    int levels = 1;
+    for (const Node* node = m_root.get(); !node->leaf; node = node->entries.front().child.get()) {
+        levels++;
+    }
+    return levels;
+}
+
+// ==============================================================================
+// R-tree maintenance
+// ==============================================================================
+SceneIndex::Node* SceneIndex::chooseLeaf(const QRectF& rect) const {
+    Node* node = m_root.get();
+
+    // Descend into the child that grows least, then the smallest one
+    while (!node->leaf) {
+        Entry* best = nullptr;
+        qreal bestGrowth = 0;
+        qreal bestArea = 0;
+        for (Entry& entry : node->entries) {
+            const qreal growth = enlargement(entry.rect, rect);
+            const qreal entryArea = area(entry.rect);
+            if (!best || growth < bestGrowth || (growth == bestGrowth && entryArea < bestArea)) {
+                best = &entry;
+                bestGrowth = growth;
+                bestArea = entryArea;
+            }
+        }
+        node = best->child.get();
+    }
+    return node;
+}
+
+void SceneIndex::insertEntry(SceneItem* item, const QRectF& rect) {
+    Node* leaf = chooseLeaf(rect);
+
+    Entry entry;
+    entry.rect = rect;
+    entry.item = item;
+    leaf->entries.push_back(std::move(entry));
+    m_records[item].leaf = leaf;
+
+    if (leaf->entries.size() > kMaxEntries) {
+        split(leaf);
+    } else {
+        adjustUpwards(leaf);
+    }
+}
+
+void SceneIndex::removeEntry(SceneItem* item) {
+    Node* leaf = m_records.value(item).leaf;
+    if (!leaf) return;
+
+    auto it = std::find_if(leaf->entries.begin(), leaf->entries.end(),
+                           [item](const Entry& entry) { return entry.item == item; });
+    if (it == leaf->entries.end()) return;
+
+    leaf->entries.erase(it);
+    m_records[item].leaf = nullptr;
+    condense(leaf);
+}
+
+void SceneIndex::adjustUpwards(Node* node) {
+    while (Node* parent = node->parent) {
+        if (Entry* entry = parent->entryFor(node)) {
+            entry->rect = node->bounds();
+        }
+        node = parent;
+    }
+}
+
+void SceneIndex::split(Node* node) {
+    std::vector<Entry> pool = std::move(node->entries);
+    node->entries.clear();
+
+    // Quadratic seeds: the pair that would waste the most area together
+    size_t seedA = 0;
+    size_t seedB = 1;
+    qreal worst = -std::numeric_limits<qreal>::max();
+    for (size_t i = 0; i < pool.size(); ++i) {
+        for (size_t j = i + 1; j < pool.size(); ++j) {
+            const qreal waste = area(unite(pool[i].rect, pool[j].rect)) -
+                                area(pool[i].rect) - area(pool[j].rect);
+            if (waste > worst) {
+                worst = waste;
+                seedA = i;
+                seedB = j;
+            }
+        }
+    }
+
+    auto sibling = std::make_unique<Node>();
+    sibling->leaf = node->leaf;
+    Node* other = sibling.get();
+
+    auto assign = [this](Node* target, Entry&& entry) {
+        if (entry.child) {
+            entry.child->parent = target;
+        } else {
+            m_records[entry.item].leaf = target;
+        }
+        target->entries.push_back(std::move(entry));
+    };
+
+    QRectF boundsA = pool[seedA].rect;
+    QRectF boundsB = pool[seedB].rect;
+    assign(node, std::move(pool[seedA]));
+    assign(other, std::move(pool[seedB]));
+
+    size_t remaining = pool.size() - 2;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        if (i == seedA || i == seedB) continue;
+
+        Entry& entry = pool[i];
+        bool toA;
+        if (node->entries.size() + remaining <= kMinEntries) {
+            toA = true;
+        } else if (other->entries.size() + remaining <= kMinEntries) {
+            toA = false;
+        } else {
+            const qreal growthA = enlargement(boundsA, entry.rect);
+            const qreal growthB = enlargement(boundsB, entry.rect);
+            if (growthA != growthB) {
+                toA = growthA < growthB;
+            } else if (area(boundsA) != area(boundsB)) {
+                toA = area(boundsA) < area(boundsB);
+            } else {
+                toA = node->entries.size() <= other->entries.size();
+            }
+        }
+
+        if (toA) {
+            boundsA = unite(boundsA, entry.rect);
+            assign(node, std::move(entry));
+        } else {
+            boundsB = unite(boundsB, entry.rect);
+            assign(other, std::move(entry));
+        }
+        remaining--;
+    }
+
+    if (node == m_root.get()) {
+        // Grow the tree by one level
+        auto root = std::make_unique<Node>();
+        root->leaf = false;
+        node->parent = root.get();
+        other->parent = root.get();
+
+        Entry first;
+        first.rect = boundsA;
+        first.child = std::move(m_root);
+        Entry second;
+        second.rect = boundsB;
+        second.child = std::move(sibling);
+        root->entries.push_back(std::move(first));
+        root->entries.push_back(std::move(second));
+        m_root = std::move(root);
+        return;
+    }
+
+    Node* parent = node->parent;
+    other->parent = parent;
+    if (Entry* entry = parent->entryFor(node)) {
+        entry->rect = boundsA;
+    }
+
+    Entry entry;
+    entry.rect = boundsB;
+    entry.child = std::move(sibling);
+    parent->entries.push_back(std::move(entry));
+
+    if (parent->entries.size() > kMaxEntries) {
+        split(parent);
+    } else {
+        adjustUpwards(parent);
+    }
+}
+
+void SceneIndex::condense(Node* node) {
+    std::vector<std::pair<SceneItem*, QRectF>> orphans;
+
+    // Dissolve underfull nodes on the way up and tighten the rest
+    Node* current = node;
+    while (current != m_root.get()) {
+        Node* parent = current->parent;
+        auto it = std::find_if(parent->entries.begin(), parent->entries.end(),
+                               [current](const Entry& entry) { return entry.child.get() == current; });
+
+        if (current->entries.size() < kMinEntries) {
+            std::unique_ptr<Node> detached = std::move(it->child);
+            parent->entries.erase(it);
+            collect(detached.get(), orphans);
+        } else {
+            it->rect = current->bounds();
+        }
+        current = parent;
+    }
+
+    // Drop roots with a single child
+    while (!m_root->leaf && m_root->entries.size() == 1) {
+        std::unique_ptr<Node> child = std::move(m_root->entries.front().child);
+        child->parent = nullptr;
+        m_root = std::move(child);
+    }
+    if (!m_root->leaf && m_root->entries.empty()) {
+        m_root = std::make_unique<Node>();
+    }
+
+    for (const auto& [item, rect] : orphans) {
+        insertEntry(item, rect);
+    }
+}
+
+void SceneIndex::collect(Node* node, std::vector<std::pair<SceneItem*, QRectF>>& items) const {
+    for (Entry& entry : node->entries) {
+        if (node->leaf) {
+            items.emplace_back(entry.item, entry.rect);
+        } else {
+            collect(entry.child.get(), items);
+        }
+    }
+}
+
+} // namespace WeaR
@@ -0,0 +1,156 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio SceneIndex
+// Item lookups by id, name and layer, and an R-tree of item bounds
+// ==============================================================================
+
+#include <QHash>
+#include <QMultiHash>
+#include <QList>
+#include <QRectF>
+#include <QPointF>
+#include <QString>
+#include <QUuid>
+
+#include <memory>
+#include <vector>
+
+namespace WeaR {
+
+class SceneItem;
+
+/**
+ * @brief Index over the items of one scene
+ *
+ * Keeps hash maps from id and name to item, each item's layer (its index
+ * in the scene's item list), and an R-tree of the items' transformed
+ * bounding boxes. Lookups by id, name and layer are O(1); hit tests and
+ * rectangle queries (culling, dirty regions) are O(log n) plus the number
+ * of results. Bounds are updated incrementally as items move.
+ *
+ * Not thread-safe; the owning Scene guards it with its item mutex.
+ */
+class SceneIndex {
+public:
+    SceneIndex();
+    ~SceneIndex();
+
+    SceneIndex(const SceneIndex&) = delete;
+    SceneIndex& operator=(const SceneIndex&) = delete;
+
+    // =========================================================================
+    // Membership
+    // =========================================================================
+
+    /**
+     * @brief Add an item
+     * @param item Item to index
+     * @param layer Index of the item in the scene's item list
+     */
+    void insert(SceneItem* item, int layer);
+
+    /**
+     * @brief Remove an item (layers of other items are not changed)
+     */
+    void remove(SceneItem* item);
+
+    /**
+     * @brief Remove all items
+     */
+    void clear();
+
+    [[nodiscard]] bool contains(const SceneItem* item) const { return m_records.contains(item); }
+    [[nodiscard]] int count() const { return static_cast<int>(m_records.size()); }
+
+    // =========================================================================
+    // Lookups
+    // =========================================================================
+
+    [[nodiscard]] SceneItem* itemById(const QUuid& id) const;
+
+    /**
+     * @brief Get the bottom-most item with a name
+     */
+    [[nodiscard]] SceneItem* itemByName(const QString& name) const;
+
+    /**
+     * @brief Get an item's index in the scene's item list
+     * @return Layer, -1 if the item is not indexed
+     */
+    [[nodiscard]] int layer(const SceneItem* item) const;
+
+    /**
+     * @brief Refresh layers after the item list changed
+     * @param items Scene item list
+     * @param from First index whose item may have changed
+     * @param to Last index whose item may have changed
+     */
+    void renumber(const QList<SceneItem*>& items, int from, int to);
+
+    /**
+     * @brief Re-key an item after its name changed
+     */
+    void rename(SceneItem* item);
+
+    // =========================================================================
+    // Spatial queries
+    // =========================================================================
+
+    /**
+     * @brief Re-read an item's bounds after its transform changed
+     */
+    void updateBounds(SceneItem* item);
+
+    /**
+     * @brief Get the indexed bounds of an item
+     */
+    [[nodiscard]] QRectF bounds(const SceneItem* item) const;
+
+    /**
+     * @brief Get the items whose bounds intersect a rectangle
+     * @return Items ordered bottom to top
+     */
+    [[nodiscard]] QList<SceneItem*> query(const QRectF& rect) const;
+
+    /**
+     * @brief Get the topmost visible item whose transformed shape
+     *        contains a point
+     */
+    [[nodiscard]] SceneItem* hitTest(const QPointF& point) const;
+
+    /**
+     * @brief Height of the R-tree (1 = a single leaf)
+     */
+    [[nodiscard]] int depth() const;
+
+    /**
+     * @brief Axis-aligned bounds of an item's transformed rectangle
+     */
+    [[nodiscard]] static QRectF itemBounds(const SceneItem* item);
+
+private:
+    struct Node;
+    struct Entry;
+
+    struct Record {
+        QRectF bounds;
+        QString name;
+        int layer = 0;
+        Node* leaf = nullptr;
+    };
+
+    void insertEntry(SceneItem* item, const QRectF& rect);
+    void removeEntry(SceneItem* item);
+    Node* chooseLeaf(const QRectF& rect) const;
+    void split(Node* node);
+    void condense(Node* node);
+    void adjustUpwards(Node* node);
+    void collect(Node* node, std::vector<std::pair<SceneItem*, QRectF>>& items) const;
+
+    QHash<const SceneItem*, Record> m_records;
+    QHash<QUuid, SceneItem*> m_byId;
+    QMultiHash<QString, SceneItem*> m_byName;
+    std::unique_ptr<Node> m_root;
+};
+
+} // namespace WeaR
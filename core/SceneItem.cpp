@@ -3,12 +3,36 @@
 // ==============================================================================
 
 #include "SceneItem.h"
+#include "FrameConverter.h"
+#include "SourceActivation.h"
+#include "SceneManager.h"
 
 #include <QPainter>
 #include <QDebug>
+#include <QSet>
+
+#include <cmath>
 
 namespace WeaR {
 
+namespace {
+
+/**
+ * @brief Items holding a transformed raster, for shedding
+ */
+struct RasterRegistry {
+    QMutex mutex;
+    QSet<const SceneItem*> items;
+};
+
+/// Never destroyed: items may be deleted during static destruction
+RasterRegistry& rasterRegistry() {
+    static auto* registry = new RasterRegistry;
+    return *registry;
+}
+
+} // namespace
+
 SceneItem::SceneItem(ISource* source, QObject* parent)
     : QObject(parent)
     , m_id(QUuid::createUuid())
@@ -39,7 +63,13 @@ SceneItem::SceneItem(const QString& name, ISource* source, QObject* parent)
 }
 
 SceneItem::~SceneItem() {
+    {
+        QMutexLocker lock(&rasterRegistry().mutex);
+        rasterRegistry().items.remove(this);
+    }
+    
     if (m_ownsSource && m_source) {
+        SourceActivation::instance().forget(m_source);
         delete m_source;
     }
 }
@@ -54,20 +84,36 @@ void SceneItem::setName(const QString& name) {
 void SceneItem::setSource(ISource* source) {
     if (m_source != source) {
         if (m_ownsSource && m_source) {
+            SourceActivation::instance().forget(m_source);
             delete m_source;
         }
         m_source = source;
         m_ownsSource = true;
         
+        // Frames of the old source must not be shown
+        m_jitterBuffer.reset();
+        {
+            QMutexLocker lock(&m_jitterMutex);
+            m_jitterTick = 0;
+            m_jitterFrame = VideoFrame();
+        }
+        
         // Update size from new source
+        bool sizeChanged = false;
         if (m_source) {
             QSize srcSize = m_source->nativeResolution();
             if (srcSize.isValid() && m_transform.size.isEmpty()) {
                 m_transform.size = QSizeF(srcSize);
+                sizeChanged = true;
             }
         }
         
         emit sourceChanged();
+        
+        // The bounds changed too (the scene index and hit testing follow this)
+        if (sizeChanged) {
+            emit transformChanged();
+        }
     }
 }
 
@@ -119,9 +165,37 @@ void SceneItem::setLocked(bool locked) {
     }
 }
 
+void SceneItem::setBlendMode(BlendMode mode) {
+    if (m_blendMode != mode) {
+        m_blendMode = mode;
+        emit blendModeChanged(mode);
+    }
+}
+
 QImage SceneItem::currentFrame() const {
+    VideoFrame frame = currentVideoFrame();
+    if (!frame.isPlanar()) {
+        return frame.softwareFrame;
+    }
+    
+    // Planar sources are converted here, at the last consumer that needs RGB.
+    // A source frame repeated over several ticks is converted once, so its
+    // image keeps one cacheKey for the tile map and the raster cache
+    const std::shared_ptr<const void>& owner = frame.planes.owner;
+    QMutexLocker lock(&m_convertMutex);
+    if (!m_converted.isNull() &&
+        !m_convertedOwner.owner_before(owner) && !owner.owner_before(m_convertedOwner)) {
+        return m_converted;
+    }
+    
+    m_converted = FrameConverter::toImage(frame.planes);
+    m_convertedOwner = owner;
+    return m_converted;
+}
+
+VideoFrame SceneItem::currentVideoFrame() const {
     if (!m_source || !m_visible) {
-        return QImage();
+        return VideoFrame();
     }
     
     // Get frame from source
@@ -129,24 +203,103 @@ QImage SceneItem::currentFrame() const {
     
     if (frame.isHardwareFrame) {
         // For hardware frames, we'd need to convert - not implemented yet
-        // Return empty for now, or use the software fallback
-        return frame.softwareFrame;
+        // Use the software fallback only
+        VideoFrame fallback;
+        fallback.softwareFrame = frame.softwareFrame;
+        fallback.timestamp = frame.timestamp;
+        fallback.hasTimestamp = frame.hasTimestamp;
+        fallback.frameNumber = frame.frameNumber;
+        frame = fallback;
     }
     
-    return frame.softwareFrame;
+    // Unbuffered (unstamped or hardware-only) frames are shown as they come
+    m_videoBuffered = m_jitterBuffer.push(frame, FrameJitterBuffer::clockUs());
+    if (!m_videoBuffered) {
+        return frame;
+    }
+    
+    // One selection per render tick; outside the render loop select now
+    const SceneManager& manager = SceneManager::instance();
+    const uint64_t tick = manager.renderTick();
+    
+    QMutexLocker lock(&m_jitterMutex);
+    if (tick != 0 && tick == m_jitterTick && m_jitterFrame.isValid()) {
+        return m_jitterFrame;
+    }
+    
+    const int64_t now = FrameJitterBuffer::clockUs();
+    int64_t canvasUs = manager.canvasClockUs();
+    if (canvasUs <= 0 || now - canvasUs > kStaleTickUs) {
+        canvasUs = now;
+    }
+    
+    VideoFrame selected = m_jitterBuffer.select(canvasUs);
+    if (!selected.isValid()) {
+        selected = frame;
+    }
+    m_jitterTick = tick;
+    m_jitterFrame = selected;
+    return selected;
+}
+
+AudioFrame SceneItem::currentAudioFrame() const {
+    if (!m_source || !m_visible) {
+        return AudioFrame();
+    }
+    
+    AudioFrame frame = m_source->captureAudioFrame();
+    if (frame.isValid() && m_videoBuffered) {
+        frame.timestamp += m_jitterBuffer.latencyTargetUs();
+    }
+    return frame;
+}
+
+void SceneItem::setFrameLatencyTargetMs(int ms) {
+    m_jitterBuffer.setLatencyTargetUs(ms < 0 ? -1 : static_cast<int64_t>(ms) * 1000);
+}
+
+FrameJitterStatistics SceneItem::frameTiming() const {
+    return m_jitterBuffer.statistics();
+}
+
+std::shared_ptr<const TileMap> SceneItem::tileMap(const QImage& frame) const {
+    QMutexLocker lock(&m_tileMutex);
+    
+    if (!m_tileMap || m_tileKey != frame.cacheKey()) {
+        m_tileMap = TileClassifier::classify(frame);
+        m_tileKey = frame.cacheKey();
+    }
+    return m_tileMap;
 }
 
 void SceneItem::render(QPainter* painter) const {
     if (!painter || !m_visible) return;
     
-    QImage frame = currentFrame();
-    if (frame.isNull()) return;
+    render(painter, currentFrame());
+}
+
+void SceneItem::render(QPainter* painter, const QImage& frame) const {
+    if (!painter || frame.isNull()) return;
+    
+    // A prepared raster replaces the resample when the painter only
+    // translates by whole pixels
+    QImage raster;
+    QPoint rasterOffset;
+    const QTransform device = painter->transform();
+    const bool useRaster = device.type() <= QTransform::TxTranslate &&
+                           device.dx() == std::floor(device.dx()) &&
+                           device.dy() == std::floor(device.dy()) &&
+                           transformedRaster(frame,
+                                             painter->testRenderHint(QPainter::SmoothPixmapTransform),
+                                             raster, rasterOffset);
     
     painter->save();
     
     // Apply transform
-    QTransform t = m_transform.toQTransform();
-    painter->setTransform(t, true);
+    if (!useRaster) {
+        QTransform t = m_transform.toQTransform();
+        painter->setTransform(t, true);
+    }
     
     // Apply opacity
     if (m_transform.opacity < 1.0) {
@@ -172,6 +325,13 @@ void SceneItem::render(QPainter* painter) const {
             break;
     }
     
+    if (useRaster) {
+        // Already transformed and resampled: a single blend
+        painter->drawImage(rasterOffset, raster);
+        painter->restore();
+        return;
+    }
+    
     // Scale frame to target size if different
     QRectF targetRect(0, 0, m_transform.size.width(), m_transform.size.height());
     
@@ -186,4 +346,141 @@ void SceneItem::render(QPainter* painter) const {
     painter->restore();
 }
 
+// ==============================================================================
+// Transformed Raster Cache
+// ==============================================================================
+bool SceneItem::RasterKey::operator==(const RasterKey& other) const {
+    return frameKey == other.frameKey && frameSize == other.frameSize &&
+           smooth == other.smooth &&
+           position == other.position && size == other.size &&
+           rotation == other.rotation && scale == other.scale &&
+           anchor == other.anchor && flipH == other.flipH && flipV == other.flipV;
+}
+
+SceneItem::RasterKey SceneItem::rasterKey(const QImage& frame, bool smooth) const {
+    RasterKey key;
+    key.frameKey = frame.cacheKey();
+    key.frameSize = frame.size();
+    key.smooth = smooth;
+    key.position = m_transform.position;
+    key.size = m_transform.size;
+    key.rotation = m_transform.rotation;
+    key.scale = m_transform.scale;
+    key.anchor = m_transform.anchor;
+    key.flipH = m_transform.flipH;
+    key.flipV = m_transform.flipV;
+    return key;
+}
+
+bool SceneItem::needsResample(const QImage& frame) const {
+    return m_transform.rotation != 0.0 || m_transform.flipH || m_transform.flipV ||
+           m_transform.scale != QPointF(1.0, 1.0) ||
+           frame.size() != m_transform.size.toSize();
+}
+
+void SceneItem::prepareTransformedRaster(const QImage& frame, bool smooth) const {
+    QMutexLocker lock(&m_rasterMutex);
+    
+    if (frame.isNull() || !needsResample(frame)) {
+        m_rasterKey = RasterKey();
+        dropRasterLocked();
+        return;
+    }
+    
+    const RasterKey key = rasterKey(frame, smooth);
+    
+    // First sight of this frame and transform: video changes every tick,
+    // so only cache once the same input comes back
+    if (!(key == m_rasterKey)) {
+        m_rasterKey = key;
+        dropRasterLocked();
+        return;
+    }
+    if (!m_raster.isNull()) return;
+    
+    const QTransform t = m_transform.toQTransform();
+    const QRectF targetRect(0, 0, m_transform.size.width(), m_transform.size.height());
+    const QRect bounds = t.mapRect(targetRect).toAlignedRect();
+    if (bounds.isEmpty() ||
+        static_cast<int64_t>(bounds.width()) * bounds.height() > kMaxRasterPixels) {
+        return;
+    }
+    
+    // Without room in the budget the item keeps resampling every render
+    const int stage = rasterMemoryStage();
+    const int64_t bytes = static_cast<int64_t>(bounds.width()) * bounds.height() * 4;
+    if (!MemoryGovernor::instance().reserve(stage, bytes)) return;
+    MemoryReservation reservation(stage, bytes);
+    
+    QImage raster(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+    if (raster.isNull()) return;
+    raster.fill(Qt::transparent);
+    
+    QPainter painter(&raster);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+    painter.translate(-bounds.topLeft());
+    painter.setTransform(t, true);
+    if (frame.size() != m_transform.size.toSize()) {
+        painter.drawImage(targetRect, frame);
+    } else {
+        painter.drawImage(0, 0, frame);
+    }
+    painter.end();
+    
+    m_raster = raster;
+    m_rasterOffset = bounds.topLeft();
+    m_rasterReservation = std::move(reservation);
+    
+    QMutexLocker registryLock(&rasterRegistry().mutex);
+    rasterRegistry().items.insert(this);
+}
+
+void SceneItem::dropRasterLocked() const {
+    m_raster = QImage();
+    m_rasterReservation.reset();
+}
+
+int SceneItem::rasterMemoryStage() {
+    static const int stage = MemoryGovernor::instance().registerStage(
+        QStringLiteral("Transformed rasters"), MemoryClass::Thumbnail,
+        [](int64_t bytesWanted) { return shedRasters(bytesWanted); }
+    );
+    return stage;
+}
+
+int64_t SceneItem::shedRasters(int64_t bytesWanted) {
+    RasterRegistry& registry = rasterRegistry();
+    QMutexLocker lock(&registry.mutex);
+    
+    // Items busy with their raster are skipped; they hold the registry
+    // lock after their own, so waiting here could deadlock
+    int64_t freed = 0;
+    for (auto it = registry.items.begin(); it != registry.items.end() && freed < bytesWanted;) {
+        const SceneItem* item = *it;
+        if (!item->m_rasterMutex.tryLock()) {
+            ++it;
+            continue;
+        }
+        freed += item->m_rasterReservation.bytes();
+        item->dropRasterLocked();
+        item->m_rasterMutex.unlock();
+        it = registry.items.erase(it);
+    }
+    return freed;
+}
+
+bool SceneItem::transformedRaster(const QImage& frame, bool smooth,
+                                  QImage& raster, QPoint& offset) const {
+    QMutexLocker lock(&m_rasterMutex);
+    
+    if (m_raster.isNull() || !(m_rasterKey == rasterKey(frame, smooth))) {
+        return false;
+    }
+    
+    raster = m_raster;
+    offset = m_rasterOffset;
+    return true;
+}
+
 } // namespace WeaR
@@ -5,6 +5,9 @@
 // ==============================================================================
 
 #include "ISource.h"
+#include "TileClassifier.h"
+#include "FrameJitterBuffer.h"
+#include "MemoryGovernor.h"
 
 #include <QObject>
 #include <QString>
@@ -14,7 +17,9 @@
 #include <QSizeF>
 #include <QTransform>
 #include <QImage>
+#include <QMutex>
 
+#include <atomic>
 #include <memory>
 
 namespace WeaR {
@@ -244,7 +249,7 @@ public:
     /**
      * @brief Set blend mode
      */
-    void setBlendMode(BlendMode mode) { m_blendMode = mode; }
+    void setBlendMode(BlendMode mode);
     
     /**
      * @brief Get the current frame from the source
@@ -252,17 +257,86 @@ public:
      */
     [[nodiscard]] QImage currentFrame() const;
     
+    /**
+     * @brief Get the current frame from the source without converting it
+     * 
+     * Software frames pass through the item's jitter buffer: during a
+     * render tick the frame whose PTS is due at the tick (minus the
+     * latency target) is returned, and every call in the same tick gets
+     * the same frame.
+     * 
+     * @return Source frame; planar frames are left in YUV
+     */
+    [[nodiscard]] VideoFrame currentVideoFrame() const;
+    
+    /**
+     * @brief Get the source's audio, delayed like its video
+     * 
+     * While the source's video goes through the jitter buffer it is shown
+     * one latency target late; the audio timestamp is moved by the same
+     * amount, so a mixer scheduling by timestamp keeps the two in sync.
+     * 
+     * @return Source audio (invalid if the source has none)
+     */
+    [[nodiscard]] AudioFrame currentAudioFrame() const;
+    
+    /**
+     * @brief Override the frame latency target for this item's source
+     * @param ms Latency target in milliseconds, -1 for the global default
+     * @see SceneManager::setFrameLatencyTargetMs()
+     */
+    void setFrameLatencyTargetMs(int ms);
+    
+    /**
+     * @brief Get the frame timing statistics of this item's source
+     */
+    [[nodiscard]] FrameJitterStatistics frameTiming() const;
+    
+    /**
+     * @brief Get the tile alpha classification of a frame from this item
+     * 
+     * Classified once per source frame (by QImage::cacheKey()) and cached,
+     * so static overlays are scanned only when they change.
+     * 
+     * @param frame Frame previously obtained from currentFrame()
+     * @return Tile map, null if the frame format cannot be classified
+     */
+    [[nodiscard]] std::shared_ptr<const TileMap> tileMap(const QImage& frame) const;
+    
+    /**
+     * @brief Prepare the transformed raster of a static frame
+     * 
+     * Rotated, flipped or scaled items are resampled on every render.
+     * When the same frame (QImage::cacheKey()) comes back with the same
+     * transform, it is resampled once into a cached raster and later
+     * renders only blend that raster. Call once per frame, before the
+     * frame is rendered (possibly from several threads). Rasters are
+     * accounted with the MemoryGovernor and dropped under pressure.
+     * 
+     * @param frame Frame previously obtained from currentFrame()
+     * @param smooth Resample with SmoothPixmapTransform
+     */
+    void prepareTransformedRaster(const QImage& frame, bool smooth) const;
+    
     /**
      * @brief Render this item to a painter
      * @param painter QPainter to render to
      */
     void render(QPainter* painter) const;
+    
+    /**
+     * @brief Render an already captured frame with this item's transform
+     * @param painter QPainter to render to
+     * @param frame Frame previously obtained from currentFrame()
+     */
+    void render(QPainter* painter, const QImage& frame) const;
 
 signals:
     void nameChanged(const QString& name);
     void transformChanged();
     void visibilityChanged(bool visible);
     void lockedChanged(bool locked);
+    void blendModeChanged(WeaR::BlendMode mode);
     void sourceChanged();
 
 private:
@@ -276,6 +350,57 @@ private:
     
     bool m_visible = true;
     bool m_locked = false;
+    
+    // Transformed raster cache
+    struct RasterKey {
+        qint64 frameKey = 0;
+        QSize frameSize;
+        bool smooth = false;
+        QPointF position;
+        QSizeF size;
+        double rotation = 0.0;
+        QPointF scale;
+        QPointF anchor;
+        bool flipH = false;
+        bool flipV = false;
+        
+        bool operator==(const RasterKey& other) const;
+    };
+    
+    RasterKey rasterKey(const QImage& frame, bool smooth) const;
+    bool needsResample(const QImage& frame) const;
+    bool transformedRaster(const QImage& frame, bool smooth, QImage& raster, QPoint& offset) const;
+    void dropRasterLocked() const;
+    static int rasterMemoryStage();
+    static int64_t shedRasters(int64_t bytesWanted);
+    
+    mutable QMutex m_rasterMutex;
+    mutable RasterKey m_rasterKey;
+    mutable QImage m_raster;
+    mutable QPoint m_rasterOffset;
+    mutable MemoryReservation m_rasterReservation;
+    
+    static constexpr int64_t kMaxRasterPixels = 3840LL * 2160;
+    
+    // Tile classification of the last frame
+    mutable QMutex m_tileMutex;
+    mutable qint64 m_tileKey = 0;
+    mutable std::shared_ptr<const TileMap> m_tileMap;
+    
+    // RGB conversion of the last planar frame; the weak reference pins the
+    // owner's control block, so a match is always the same source frame
+    mutable QMutex m_convertMutex;
+    mutable std::weak_ptr<const void> m_convertedOwner;
+    mutable QImage m_converted;
+    
+    // Timestamped source frames, selected once per render tick
+    mutable FrameJitterBuffer m_jitterBuffer;
+    mutable QMutex m_jitterMutex;
+    mutable uint64_t m_jitterTick = 0;
+    mutable VideoFrame m_jitterFrame;
+    mutable std::atomic<bool> m_videoBuffered{false};  ///< Video is delayed by m_jitterBuffer
+    
+    static constexpr int64_t kStaleTickUs = 100000;    ///< Older tick times are not "now"
 };
 
 } // namespace WeaR
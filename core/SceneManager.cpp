@@ -5,11 +5,18 @@
 
 #include "SceneManager.h"
 #include "EncoderManager.h"
+#include "FrameConverter.h"
+#include "QualityGovernor.h"
+#include "SourceActivation.h"
+#include "ThreadPolicy.h"
 
 #include <QDebug>
 #include <QDateTime>
+#include <QMetaMethod>
 #include <QPainter>
 
+#include <algorithm>
+
 namespace WeaR {
 
 // ==============================================================================
@@ -23,14 +30,53 @@ SceneManager& SceneManager::instance() {
 SceneManager::SceneManager(QObject* parent)
     : QObject(parent)
 {
+    // Constructed first so it outlives the scenes' items
+    SourceActivation& activation = SourceActivation::instance();
+    
+    // References are keyed by pointer; a deleted source's address may be reused
+    connect(&activation, &SourceActivation::sourceForgotten, this, [this](ISource* source) {
+        m_sourceReferences.remove(source);
+    });
+    
     // Create render timer
     m_renderTimer = new QTimer(this);
     m_renderTimer->setTimerType(Qt::PreciseTimer);
     connect(m_renderTimer, &QTimer::timeout, this, &SceneManager::onRenderTick);
     
+    // Per-frame notifications coalesced to 10 Hz
+    m_frameMailbox = new ActivityMailbox(100, this);
+    connect(m_frameMailbox, &ActivityMailbox::summaryReady, this, &SceneManager::renderActivity);
+    m_frameMailbox->setEnabled(false);
+    
     // Initialize frame timer
     m_frameTimer.start();
     
+    // The last frame and preview copies are the first thing to go under
+    // memory pressure
+    m_previewMemoryStage = MemoryGovernor::instance().registerStage(
+        QStringLiteral("Preview frames"), MemoryClass::Preview,
+        [this](int64_t) {
+            QMutexLocker lock(&m_frameMutex);
+            const int64_t freed = m_lastFrameReservation.bytes();
+            m_lastFrame = QImage();
+            m_lastFrameReservation.reset();
+            return freed;
+        }
+    );
+    
+    // Preloaded composites can be re-rendered, so they go before thumbnails
+    m_preloadMemoryStage = MemoryGovernor::instance().registerStage(
+        QStringLiteral("Preloaded scenes"), MemoryClass::Thumbnail,
+        [this](int64_t) {
+            QMutexLocker lock(&m_frameMutex);
+            const int64_t freed = m_preloadedBytes;
+            m_preloadedFrames.clear();
+            m_preloadedBytes = 0;
+            MemoryGovernor::instance().release(m_preloadMemoryStage, freed);
+            return freed;
+        }
+    );
+    
     // Create default scene
     createScene(QStringLiteral("Scene 1"));
     if (!m_scenes.isEmpty()) {
@@ -40,9 +86,32 @@ SceneManager::SceneManager(QObject* parent)
     qDebug() << "SceneManager initialized";
 }
 
+void SceneManager::connectNotify(const QMetaMethod& signal) {
+    Q_UNUSED(signal);
+    if (m_frameMailbox) {
+        m_frameMailbox->setEnabled(isSignalConnected(QMetaMethod::fromSignal(&SceneManager::renderActivity)));
+    }
+}
+
+void SceneManager::disconnectNotify(const QMetaMethod& signal) {
+    Q_UNUSED(signal);
+    if (m_frameMailbox) {
+        m_frameMailbox->setEnabled(isSignalConnected(QMetaMethod::fromSignal(&SceneManager::renderActivity)));
+    }
+}
+
 SceneManager::~SceneManager() {
     stopRenderLoop();
     
+    {
+        QMutexLocker lock(&m_frameMutex);
+        m_lastFrame = QImage();
+        m_lastFrameReservation.reset();
+        m_preloadedFrames.clear();
+    }
+    MemoryGovernor::instance().unregisterStage(m_previewMemoryStage);
+    MemoryGovernor::instance().unregisterStage(m_preloadMemoryStage);
+    
     // Delete all scenes
     qDeleteAll(m_scenes);
     m_scenes.clear();
@@ -71,10 +140,7 @@ void SceneManager::setTargetFps(double fps) {
         m_stats.targetFps = fps;
         
         // Update timer interval if running
-        if (m_renderLoopRunning) {
-            int intervalMs = static_cast<int>(1000.0 / fps);
-            m_renderTimer->setInterval(intervalMs);
-        }
+        updateRenderRate();
         
         qDebug() << "Target FPS set to:" << fps;
     }
@@ -86,7 +152,74 @@ void SceneManager::setPreviewCallback(PreviewFrameCallback callback) {
 }
 
 void SceneManager::setEncoderOutputEnabled(bool enabled) {
-    m_encoderOutputEnabled = enabled;
+    if (m_encoderOutputEnabled.exchange(enabled) == enabled) return;
+    
+    // The encoder needs frames at full rate while its output is enabled
+    if (enabled) {
+        acquireRenderConsumer(QStringLiteral("Encoder"));
+    } else {
+        releaseRenderConsumer(QStringLiteral("Encoder"));
+    }
+}
+
+void SceneManager::setCompositorMode(CompositorMode mode) {
+    if (m_compositorMode == mode) return;
+    
+    m_compositorMode = mode;
+    if (mode == CompositorMode::Yuv) {
+        if (!m_yuvCompositor) {
+            m_yuvCompositor = std::make_unique<YuvCompositor>();
+        }
+        
+        QString reason;
+        if (m_activeScene && !YuvCompositor::canComposite(m_activeScene, &reason)) {
+            qDebug() << "Active scene will be composited in RGB:" << reason;
+        }
+    } else {
+        m_yuvCompositor.reset();
+    }
+    
+    qDebug() << "Compositor mode set to:" << (mode == CompositorMode::Yuv ? "YUV" : "RGB");
+}
+
+CompositorComparison SceneManager::compareCompositors() {
+    if (!m_activeScene) return CompositorComparison();
+    
+    if (!m_yuvCompositor) {
+        m_yuvCompositor = std::make_unique<YuvCompositor>();
+    }
+    
+    const CompositorComparison result = m_yuvCompositor->compareWithRgb(m_activeScene);
+    if (result.valid) {
+        qDebug() << "Compositor comparison: RGB" << result.rgbMs << "ms, YUV" << result.yuvMs
+                 << "ms, PSNR Y/U/V" << result.psnrY << result.psnrU << result.psnrV << "dB";
+    }
+    return result;
+}
+
+void SceneManager::setFrameLatencyTargetMs(int ms) {
+    FrameJitterBuffer::setDefaultLatencyTargetUs(static_cast<int64_t>(std::max(ms, 0)) * 1000);
+    qDebug() << "Frame latency target set to:" << std::max(ms, 0) << "ms";
+}
+
+int SceneManager::frameLatencyTargetMs() const {
+    return static_cast<int>(FrameJitterBuffer::defaultLatencyTargetUs() / 1000);
+}
+
+QList<SourceTiming> SceneManager::sourceTimingStatistics() const {
+    QList<SourceTiming> result;
+    if (!m_activeScene) return result;
+    
+    for (SceneItem* item : m_activeScene->items()) {
+        if (!item->source()) continue;
+        
+        SourceTiming entry;
+        entry.itemName = item->name();
+        entry.sourceName = item->source()->name();
+        entry.timing = item->frameTiming();
+        result.append(entry);
+    }
+    return result;
 }
 
 // ==============================================================================
@@ -106,6 +239,17 @@ Scene* SceneManager::createScene(const QString& name) {
         m_scenes.append(scene);
     }
     
+    // Visibility, source and item changes decide which sources run
+    connect(scene, &Scene::sceneChanged, this, &SceneManager::scheduleSourceActivation);
+    connect(scene, &Scene::itemRemoved, this, &SceneManager::scheduleSourceActivation);
+    
+    // Edits of the shown scene reach the preview while the loop idles
+    connect(scene, &Scene::sceneChanged, this, [this, scene]() {
+        if (scene == m_activeScene) {
+            requestRender();
+        }
+    });
+    
     emit sceneAdded(scene);
     
     qDebug() << "Scene created:" << sceneName;
@@ -129,6 +273,7 @@ bool SceneManager::removeScene(Scene* scene) {
     
     QUuid id = scene->id();
     m_scenes.removeAt(index);
+    SceneSource* nested = m_sceneSources.take(id);
     
     // If active scene was removed, switch to another
     if (m_activeScene == scene) {
@@ -138,6 +283,24 @@ bool SceneManager::removeScene(Scene* scene) {
     
     lock.unlock();
     
+    m_warmScenes.removeAll(id);
+    m_outputScenes.remove(id);
+    dropPreloadedFrame(id);
+    
+    // Items nesting the removed scene lose their source with it
+    if (nested) {
+        for (Scene* host : scenes()) {
+            for (SceneItem* item : host->items()) {
+                if (item->source() == nested) {
+                    item->setSource(nullptr);
+                }
+            }
+        }
+        SourceActivation::instance().forget(nested);
+        nested->deleteLater();
+    }
+    scheduleSourceActivation();
+    
     emit sceneRemoved(id);
     scene->deleteLater();
     
@@ -165,10 +328,38 @@ void SceneManager::setActiveScene(Scene* scene) {
             return;
         }
         
+        Scene* previous = m_activeScene;
         m_activeScene = scene;
         
         lock.unlock();
         
+        if (scene) {
+            // Measure until the first complete composite; a preloaded
+            // composite covers for sources that are still cold
+            if (m_renderLoopRunning) {
+                QImage preloaded;
+                {
+                    QMutexLocker frameLock(&m_frameMutex);
+                    preloaded = m_preloadedFrames.value(scene->id());
+                }
+                m_switchWarm = !preloaded.isNull() || m_warmScenes.contains(scene->id());
+                m_switchPending = true;
+                m_switchTimer.start();
+                
+                if (!preloaded.isNull()) {
+                    outputToPreview(preloaded);
+                }
+            }
+            m_warmScenes.removeAll(scene->id());
+        }
+        
+        // The scene being left stays warm while the policy allows;
+        // sources of the new scene start now, others begin to linger
+        touchWarmScene(previous);
+        trimWarmScenes();
+        updateSourceActivation();
+        requestRender();
+        
         emit activeSceneChanged(scene);
         
         qDebug() << "Active scene changed to:" 
@@ -196,28 +387,332 @@ Scene* SceneManager::sceneById(const QUuid& id) const {
     return nullptr;
 }
 
+SceneSource* SceneManager::sceneSource(Scene* scene) {
+    if (!scene) return nullptr;
+    
+    QMutexLocker lock(&m_sceneMutex);
+    
+    SceneSource*& source = m_sceneSources[scene->id()];
+    if (!source) {
+        source = new SceneSource(scene, this);
+        source->start();
+    }
+    return source;
+}
+
+// ==============================================================================
+// Scene Preloading
+// ==============================================================================
+bool SceneManager::preloadScene(Scene* scene) {
+    {
+        QMutexLocker lock(&m_sceneMutex);
+        if (!scene || !m_scenes.contains(scene)) return false;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    // Hold the scene like an output so its sources start now
+    acquireSceneOutput(scene);
+    
+    // Rendering once pulls a frame from every source (decoders, image
+    // loads, text layout, nested composites) and yields the first composite
+    QImage composite = scene->render();
+    const int missing = scene->lastMissingFrames();
+    
+    if (scene != m_activeScene) {
+        const int64_t bytes = composite.sizeInBytes();
+        if (MemoryGovernor::instance().reserve(m_preloadMemoryStage, bytes)) {
+            dropPreloadedFrame(scene->id());
+            
+            QMutexLocker lock(&m_frameMutex);
+            m_preloadedFrames.insert(scene->id(), composite);
+            m_preloadedBytes += bytes;
+        }
+        
+        touchWarmScene(scene);
+        trimWarmScenes();
+    }
+    
+    // From here the warm set (or the linger time) keeps the sources running
+    releaseSceneOutput(scene);
+    
+    qDebug() << "Scene preloaded:" << scene->name() << "in" << timer.elapsed() << "ms"
+             << (missing > 0 ? QString("(%1 sources not ready)").arg(missing) : QString());
+    
+    return missing == 0;
+}
+
+void SceneManager::setWarmScenePolicy(int sceneCount, int64_t memoryBudget) {
+    m_warmSceneLimit = std::max(sceneCount, 0);
+    m_warmMemoryBudget = std::max<int64_t>(memoryBudget, 0);
+    trimWarmScenes();
+    updateSourceActivation();
+    
+    qDebug() << "Warm scenes:" << m_warmSceneLimit << "within" << m_warmMemoryBudget / (1024 * 1024) << "MB";
+}
+
+bool SceneManager::isSceneWarm(Scene* scene) const {
+    return scene && m_warmScenes.contains(scene->id());
+}
+
+void SceneManager::collectSources(Scene* scene, QSet<ISource*>& sources, QSet<const Scene*>& visited) {
+    if (!scene || visited.contains(scene)) return;
+    visited.insert(scene);
+    
+    for (SceneItem* item : scene->items()) {
+        ISource* source = item->source();
+        if (!source) continue;
+        
+        // Nested scenes contribute the sources they show
+        if (auto* nested = dynamic_cast<SceneSource*>(source)) {
+            collectSources(nested->scene(), sources, visited);
+        } else {
+            sources.insert(source);
+        }
+    }
+}
+
+int64_t SceneManager::warmCost(Scene* scene) const {
+    QSet<ISource*> sources;
+    QSet<const Scene*> visited;
+    collectSources(scene, sources, visited);
+    
+    // Rough estimate: one 32-bit frame buffered per running source
+    int64_t bytes = 0;
+    for (ISource* source : sources) {
+        const QSize size = source->nativeResolution();
+        if (size.isValid()) {
+            bytes += static_cast<int64_t>(size.width()) * size.height() * 4;
+        }
+    }
+    
+    QMutexLocker lock(&m_frameMutex);
+    return bytes + m_preloadedFrames.value(scene->id()).sizeInBytes();
+}
+
+void SceneManager::touchWarmScene(Scene* scene) {
+    if (!scene || scene == m_activeScene || sceneById(scene->id()) != scene) return;
+    
+    m_warmScenes.removeAll(scene->id());
+    m_warmScenes.prepend(scene->id());
+}
+
+void SceneManager::trimWarmScenes() {
+    QList<QUuid> kept;
+    QList<Scene*> cooled;
+    int64_t used = 0;
+    
+    for (const QUuid& id : std::as_const(m_warmScenes)) {
+        Scene* scene = sceneById(id);
+        if (!scene || scene == m_activeScene) continue;
+        
+        const int64_t cost = warmCost(scene);
+        if (kept.size() < m_warmSceneLimit && used + cost <= m_warmMemoryBudget) {
+            kept.append(id);
+            used += cost;
+        } else {
+            cooled.append(scene);
+        }
+    }
+    m_warmScenes = kept;
+    
+    // Cooled scenes lose their hold at the next activation update
+    for (Scene* scene : cooled) {
+        dropPreloadedFrame(scene->id());
+        qDebug() << "Scene cooled:" << scene->name();
+    }
+    
+    QMutexLocker lock(&m_statsMutex);
+    m_stats.warmScenes = static_cast<int>(m_warmScenes.size());
+}
+
+// ==============================================================================
+// Source Activation
+// ==============================================================================
+void SceneManager::acquireSceneOutput(Scene* scene) {
+    if (!scene) return;
+    m_outputScenes[scene->id()]++;
+    updateSourceActivation();
+}
+
+void SceneManager::releaseSceneOutput(Scene* scene) {
+    if (!scene) return;
+    
+    auto it = m_outputScenes.find(scene->id());
+    if (it == m_outputScenes.end()) return;
+    
+    if (--it.value() <= 0) {
+        m_outputScenes.erase(it);
+    }
+    updateSourceActivation();
+}
+
+void SceneManager::scheduleSourceActivation() {
+    if (m_activationScheduled) return;
+    
+    // Coalesce bursts (loading a collection, toggling many items)
+    m_activationScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        if (m_activationScheduled) {
+            updateSourceActivation();
+        }
+    });
+}
+
+void SceneManager::countVisibleSources(Scene* scene, QHash<ISource*, int>& references,
+                                       QSet<const Scene*>& visited) {
+    if (!scene || visited.contains(scene)) return;
+    visited.insert(scene);
+    
+    for (SceneItem* item : scene->items()) {
+        ISource* source = item->source();
+        if (!source || !item->isVisible()) continue;
+        
+        if (auto* nested = dynamic_cast<SceneSource*>(source)) {
+            countVisibleSources(nested->scene(), references, visited);
+        } else {
+            references[source]++;
+        }
+    }
+}
+
+void SceneManager::updateSourceActivation() {
+    m_activationScheduled = false;
+    
+    // Scenes shown by an output: the active and warm scenes while anything
+    // consumes frames, plus scenes held explicitly (multiview, preloading)
+    QList<Scene*> outputs;
+    if (!m_renderConsumers.isEmpty()) {
+        outputs.append(m_activeScene);
+        for (const QUuid& id : std::as_const(m_warmScenes)) {
+            outputs.append(sceneById(id));
+        }
+    }
+    for (auto it = m_outputScenes.cbegin(); it != m_outputScenes.cend(); ++it) {
+        outputs.append(sceneById(it.key()));
+    }
+    
+    // One reference per visible item showing the source
+    QHash<ISource*, int> wanted;
+    for (Scene* scene : outputs) {
+        QSet<const Scene*> visited;
+        countVisibleSources(scene, wanted, visited);
+    }
+    
+    SourceActivation& activation = SourceActivation::instance();
+    
+    // Acquire before releasing so shared sources never drop to zero
+    for (auto it = wanted.cbegin(); it != wanted.cend(); ++it) {
+        for (int held = m_sourceReferences.value(it.key()); held < it.value(); ++held) {
+            activation.acquire(it.key());
+        }
+    }
+    for (auto it = m_sourceReferences.cbegin(); it != m_sourceReferences.cend(); ++it) {
+        // Never release more than the activation table still holds
+        const int excess = std::min(it.value() - wanted.value(it.key()), activation.references(it.key()));
+        for (int i = 0; i < excess; ++i) {
+            activation.release(it.key());
+        }
+    }
+    m_sourceReferences = wanted;
+    
+    // Sources that are running but shown nowhere start to linger too
+    QSet<ISource*> all;
+    for (Scene* scene : scenes()) {
+        QSet<const Scene*> visited;
+        collectSources(scene, all, visited);
+    }
+    for (ISource* source : std::as_const(all)) {
+        if (!wanted.contains(source)) {
+            activation.track(source);
+        }
+    }
+}
+
+void SceneManager::dropPreloadedFrame(const QUuid& id) {
+    QMutexLocker lock(&m_frameMutex);
+    auto it = m_preloadedFrames.find(id);
+    if (it == m_preloadedFrames.end()) return;
+    
+    const int64_t bytes = it->sizeInBytes();
+    m_preloadedFrames.erase(it);
+    m_preloadedBytes -= bytes;
+    MemoryGovernor::instance().release(m_preloadMemoryStage, bytes);
+}
+
+QImage SceneManager::sceneSwitchFrame(const QImage& frame) {
+    Scene* scene = m_activeScene;
+    const bool complete = !scene || scene->lastMissingFrames() == 0;
+    
+    if (!complete && m_switchTimer.elapsed() < kSwitchTimeoutMs) {
+        // Still cold: repeat the preloaded composite rather than a partial one
+        QMutexLocker lock(&m_frameMutex);
+        auto it = m_preloadedFrames.constFind(scene->id());
+        return it != m_preloadedFrames.constEnd() ? it.value() : frame;
+    }
+    
+    m_switchPending = false;
+    const double latencyMs = m_switchTimer.nsecsElapsed() / 1e6;
+    
+    {
+        QMutexLocker lock(&m_statsMutex);
+        m_stats.sceneSwitches++;
+        if (m_switchWarm) {
+            m_stats.warmSwitches++;
+        }
+        m_stats.lastSwitchLatencyMs = latencyMs;
+        m_switchLatencyTotalMs += latencyMs;
+        m_stats.averageSwitchLatencyMs = m_switchLatencyTotalMs / m_stats.sceneSwitches;
+    }
+    
+    if (complete) {
+        qDebug() << "Scene switch: first complete frame after" << latencyMs << "ms"
+                 << (m_switchWarm ? "(warm)" : "(cold)");
+    } else {
+        qWarning() << "Scene switch:" << scene->lastMissingFrames()
+                   << "sources still without frames after" << latencyMs << "ms";
+    }
+    
+    // The live composite has taken over
+    if (scene) {
+        dropPreloadedFrame(scene->id());
+    }
+    return frame;
+}
+
 // ==============================================================================
 // Render Loop Control
 // ==============================================================================
 bool SceneManager::startRenderLoop() {
     if (m_renderLoopRunning) return true;
     
-    int intervalMs = static_cast<int>(1000.0 / m_targetFps);
-    m_renderTimer->setInterval(intervalMs);
-    m_renderTimer->start();
-    
     m_renderLoopRunning = true;
     m_frameTimer.restart();
     m_lastFrameTime = 0;
     
+    // The compositor runs on this (GUI) thread; keep the executable's name
+    if (!m_compositorRoleApplied) {
+        ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Render, QStringLiteral("WeaR-Studio"));
+        m_compositorRoleApplied = true;
+    }
+    
     // Reset statistics
     {
         QMutexLocker lock(&m_statsMutex);
         m_stats = RenderStatistics();
         m_stats.targetFps = m_targetFps;
+        m_stats.warmScenes = static_cast<int>(m_warmScenes.size());
         m_renderTimes.clear();
+        m_switchLatencyTotalMs = 0.0;
     }
     
+    // Full rate with consumers, idle rate (or stopped) without
+    m_idle = false;
+    updateRenderRate();
+    
+    QualityGovernor::instance().start();
+    
     emit renderLoopStarted();
     
     qDebug() << "Render loop started at" << m_targetFps << "FPS";
@@ -231,6 +726,8 @@ void SceneManager::stopRenderLoop() {
     m_renderTimer->stop();
     m_renderLoopRunning = false;
     
+    QualityGovernor::instance().stop();
+    
     emit renderLoopStopped();
     
     qDebug() << "Render loop stopped";
@@ -240,15 +737,104 @@ void SceneManager::onRenderTick() {
     doRender();
 }
 
+// ==============================================================================
+// Render Consumers
+// ==============================================================================
+void SceneManager::acquireRenderConsumer(const QString& name) {
+    m_renderConsumers[name]++;
+    updateRenderRate();
+}
+
+void SceneManager::releaseRenderConsumer(const QString& name) {
+    auto it = m_renderConsumers.find(name);
+    if (it == m_renderConsumers.end()) return;
+    
+    if (--it.value() <= 0) {
+        m_renderConsumers.erase(it);
+    }
+    updateRenderRate();
+}
+
+int SceneManager::renderConsumerCount() const {
+    int count = 0;
+    for (int references : m_renderConsumers) {
+        count += references;
+    }
+    return count;
+}
+
+void SceneManager::setIdleFps(double fps) {
+    if (fps < 0 || fps > m_targetFps) return;
+    
+    m_idleFps = fps;
+    updateRenderRate();
+    
+    qDebug() << "Idle FPS set to:" << fps;
+}
+
+void SceneManager::requestRender() {
+    if (!m_renderLoopRunning || !m_idle || m_renderRequested) return;
+    
+    m_renderRequested = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_renderRequested = false;
+        if (m_renderLoopRunning) {
+            doRender();
+        }
+    });
+}
+
+void SceneManager::updateRenderRate() {
+    if (!m_renderLoopRunning) return;
+    
+    const bool idle = m_renderConsumers.isEmpty();
+    const double fps = idle ? m_idleFps : m_targetFps;
+    
+    if (fps > 0) {
+        m_renderTimer->setInterval(static_cast<int>(1000.0 / fps));
+        if (!m_renderTimer->isActive()) {
+            m_renderTimer->start();
+        }
+    } else {
+        // Nothing is watching: render only on request
+        m_renderTimer->stop();
+    }
+    
+    if (m_idle.exchange(idle) != idle) {
+        {
+            QMutexLocker lock(&m_statsMutex);
+            m_stats.idle = idle;
+        }
+        
+        qDebug() << (idle ? "Render loop idle at" : "Render loop active at") << fps << "FPS";
+        emit idleChanged(idle);
+        scheduleSourceActivation();
+    }
+}
+
 QImage SceneManager::renderFrame() {
     if (!m_activeScene) {
         // Return black frame
-        QImage frame(m_outputResolution, QImage::Format_ARGB32_Premultiplied);
+        QImage frame(m_outputResolution, QImage::Format_RGB32);
         frame.fill(Qt::black);
         return frame;
     }
     
-    return m_activeScene->render();
+    // Reuse a pooled canvas; recreate the pool when the resolution or the
+    // canvas format (opaque or not) changes
+    const QSize resolution = m_activeScene->resolution();
+    const QImage::Format format = m_activeScene->canvasFormat();
+    if (!m_canvasPool || m_canvasPool->size() != resolution || m_canvasPool->format() != format) {
+        m_canvasPool = std::make_unique<CanvasPool>(resolution, format);
+    }
+    
+    QImage canvas = m_canvasPool->acquire();
+    if (canvas.isNull()) {
+        return m_activeScene->render();
+    }
+    
+    m_activeScene->renderInto(canvas);
+    return canvas;
 }
 
 QImage SceneManager::lastFrame() const {
@@ -268,26 +854,74 @@ void SceneManager::doRender() {
     QElapsedTimer renderTimer;
     renderTimer.start();
     
+    // New tick: nested scene composites are rendered again (at most once)
+    m_canvasClockUs = FrameJitterBuffer::clockUs();
+    ++m_renderTick;
+    
     // Calculate time since last frame
     int64_t currentTime = m_frameTimer.elapsed();
     int64_t deltaTime = currentTime - m_lastFrameTime;
     m_lastFrameTime = currentTime;
     
-    // Render the active scene
-    QImage frame = renderFrame();
+    // In YUV mode supported scenes skip RGB entirely; a measured scene
+    // switch stays on the RGB path, where the preloaded composite lives
+    PlanarFrame planar;
+    if (m_compositorMode == CompositorMode::Yuv && m_activeScene && !m_switchPending) {
+        planar = m_yuvCompositor->composite(m_activeScene);
+        
+        QMutexLocker lock(&m_statsMutex);
+        if (planar.isValid()) {
+            m_stats.yuvFrames++;
+        } else {
+            m_stats.yuvFallbacks++;
+        }
+    }
     
-    // Store the frame
-    {
-        QMutexLocker lock(&m_frameMutex);
-        m_lastFrame = frame;
+    // Render the active scene
+    QImage frame;
+    if (!planar.isValid()) {
+        frame = renderFrame();
+        if (m_switchPending) {
+            frame = sceneSwitchFrame(frame);
+        }
     }
     
-    // Output to preview
-    outputToPreview(frame);
+    // The quality governor may thin out preview and encoder frames
+    const QualityGovernor& quality = QualityGovernor::instance();
+    const uint64_t tick = m_renderTick;
+    
+    // Store the frame for the preview, unless preview memory is being shed
+    if (tick % quality.previewFrameDivisor() == 0) {
+        // The preview still needs RGB; the encoder takes the planes
+        if (planar.isValid()) {
+            frame = FrameConverter::toImage(planar);
+        }
+        
+        MemoryGovernor& governor = MemoryGovernor::instance();
+        const int64_t frameBytes = frame.sizeInBytes();
+        const bool keepPreview = !governor.isShedding(MemoryClass::Preview) &&
+                                 governor.reserve(m_previewMemoryStage, frameBytes);
+        {
+            QMutexLocker lock(&m_frameMutex);
+            m_lastFrameReservation = keepPreview
+                ? MemoryReservation(m_previewMemoryStage, frameBytes)
+                : MemoryReservation();
+            m_lastFrame = keepPreview ? frame : QImage();
+        }
+        
+        // Output to preview
+        if (keepPreview) {
+            outputToPreview(frame);
+        }
+    }
     
     // Output to encoder
-    if (m_encoderOutputEnabled) {
-        outputToEncoder(frame);
+    if (m_encoderOutputEnabled && tick % quality.outputFrameDivisor() == 0) {
+        if (planar.isValid()) {
+            outputToEncoder(planar);
+        } else {
+            outputToEncoder(frame);
+        }
     }
     
     // Update statistics
@@ -295,6 +929,7 @@ void SceneManager::doRender() {
     {
         QMutexLocker lock(&m_statsMutex);
         m_stats.framesRendered++;
+        m_stats.canvasFallbacks = m_canvasPool ? m_canvasPool->fallbackCount() : 0;
         
         // Calculate rolling average render time
         m_renderTimes.append(renderTime);
@@ -313,6 +948,11 @@ void SceneManager::doRender() {
     }
     
     emit frameRendered(m_stats.framesRendered);
+    const int64_t frameBytes = planar.isValid()
+        ? static_cast<int64_t>(planar.size.width()) * planar.size.height() * 3 / 2
+        : frame.sizeInBytes();
+    m_frameMailbox->post(frameBytes, renderTime > 1000.0 / m_targetFps,
+                         m_stats.framesRendered);
 }
 
 void SceneManager::outputToEncoder(const QImage& frame) {
@@ -325,6 +965,16 @@ void SceneManager::outputToEncoder(const QImage& frame) {
     EncoderManager::instance().pushFrame(frame, pts);
 }
 
+void SceneManager::outputToEncoder(const PlanarFrame& frame) {
+    if (!frame.isValid()) return;
+    
+    // Get timestamp
+    int64_t pts = m_frameTimer.elapsed() * 1000;  // Convert to microseconds
+    
+    // Already I420: the encoder references the planes when the size matches
+    EncoderManager::instance().pushFrame(frame, pts);
+}
+
 void SceneManager::outputToPreview(const QImage& frame) {
     PreviewFrameCallback callback;
     {
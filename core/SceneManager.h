@@ -6,12 +6,20 @@
 
 #include "Scene.h"
 #include "SceneItem.h"
+#include "SceneSource.h"
+#include "MemoryGovernor.h"
+#include "CanvasPool.h"
+#include "ActivityMailbox.h"
+#include "YuvCompositor.h"
+#include "FrameJitterBuffer.h"
 
 #include <QObject>
 #include <QMutex>
 #include <QTimer>
 #include <QImage>
 #include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
 
 #include <memory>
 #include <atomic>
@@ -28,6 +36,14 @@ enum class RenderTarget {
     Both        ///< Both preview and stream
 };
 
+/**
+ * @brief Compositor used for the render loop
+ */
+enum class CompositorMode {
+    Rgb,        ///< Composite in ARGB; the encoder converts to YUV
+    Yuv         ///< Composite in I420 and feed the encoder directly
+};
+
 /**
  * @brief Render loop statistics
  */
@@ -37,6 +53,24 @@ struct RenderStatistics {
     double averageRenderTimeMs = 0.0; ///< Average render time
     double targetFps = 60.0;        ///< Target FPS
     int64_t droppedFrames = 0;      ///< Frames dropped due to timing
+    int64_t canvasFallbacks = 0;    ///< Frames that found no free pooled canvas (current pool)
+    bool idle = false;              ///< No consumers; rendering at the idle rate
+    int64_t sceneSwitches = 0;      ///< Measured active scene changes
+    int64_t warmSwitches = 0;       ///< Switches to a preloaded or warm scene
+    double lastSwitchLatencyMs = 0.0;    ///< Switch to first complete composite
+    double averageSwitchLatencyMs = 0.0; ///< Mean switch latency
+    int warmScenes = 0;             ///< Inactive scenes kept warm
+    int64_t yuvFrames = 0;          ///< Frames composited in YUV
+    int64_t yuvFallbacks = 0;       ///< YUV-mode frames composited in RGB (unsupported scene)
+};
+
+/**
+ * @brief Frame timing of one item's source
+ */
+struct SourceTiming {
+    QString itemName;               ///< Scene item name
+    QString sourceName;             ///< Source name
+    FrameJitterStatistics timing;   ///< Repeat/skip statistics
 };
 
 /**
@@ -130,6 +164,50 @@ public:
      * @brief Check if encoder output is enabled
      */
     [[nodiscard]] bool isEncoderOutputEnabled() const { return m_encoderOutputEnabled; }
+    
+    /**
+     * @brief Select the compositor
+     * 
+     * In YUV mode supported scenes are composited straight into I420 and
+     * handed to the encoder without an RGB to YUV conversion; the preview
+     * gets an RGB copy on preview ticks. Scenes with rotated, flipped or
+     * blended items fall back to the RGB compositor frame by frame.
+     */
+    void setCompositorMode(CompositorMode mode);
+    
+    /**
+     * @brief Get the compositor mode
+     */
+    [[nodiscard]] CompositorMode compositorMode() const { return m_compositorMode; }
+    
+    /**
+     * @brief Composite the active scene with both compositors and compare
+     *        time and quality (PSNR of the YUV result against the RGB one)
+     */
+    [[nodiscard]] CompositorComparison compareCompositors();
+    
+    /**
+     * @brief Set how far source frames are shown behind the canvas clock
+     * 
+     * Items buffer a few timestamped frames from their source and each
+     * tick shows the frame whose PTS is due at (tick - latency). A larger
+     * target absorbs more delivery jitter at the cost of delay. Items
+     * with their own target keep it.
+     * 
+     * @param ms Latency target in milliseconds
+     */
+    void setFrameLatencyTargetMs(int ms);
+    
+    /**
+     * @brief Get the default frame latency target in milliseconds
+     */
+    [[nodiscard]] int frameLatencyTargetMs() const;
+    
+    /**
+     * @brief Get the frame timing (repeat/skip ratio) of the active
+     *        scene's sources
+     */
+    [[nodiscard]] QList<SourceTiming> sourceTimingStatistics() const;
 
     // =========================================================================
     // Scene Management
@@ -178,6 +256,98 @@ public:
      * @brief Get scene by ID
      */
     [[nodiscard]] Scene* sceneById(const QUuid& id) const;
+    
+    /**
+     * @brief Get the source adapter for nesting a scene in another scene
+     * 
+     * One adapter exists per scene and is owned by the manager, so items
+     * referencing it stay valid even if the scene is removed (they then
+     * show nothing).
+     * 
+     * @code
+     *   Scene* lowerThird = scene.createScene("Lower Third");
+     *   mainScene->addItem("Lower Third", scene.sceneSource(lowerThird));
+     * @endcode
+     * 
+     * @param scene Scene to expose
+     * @return Source adapter, null if scene is null
+     */
+    SceneSource* sceneSource(Scene* scene);
+
+    // =========================================================================
+    // Scene Preloading (GUI thread)
+    // =========================================================================
+    
+    /**
+     * @brief Prepare a scene so switching to it shows no cold frames
+     * 
+     * Starts the scene's stopped sources, pulls a frame from each and
+     * renders its first composite. After setActiveScene() the composite
+     * stands in for the live one until every source delivers. The scene
+     * then stays warm according to the warm scene policy.
+     * 
+     * @param scene Scene to preload
+     * @return true if every visible source already produced a frame
+     */
+    bool preloadScene(Scene* scene);
+    
+    /**
+     * @brief Set how many recently used scenes keep their sources running
+     * 
+     * When a scene is left it joins the warm set; scenes beyond the count
+     * or the memory budget are cooled: sources that no warm or active
+     * scene uses are stopped after the SourceActivation linger time.
+     * 
+     * @param sceneCount Inactive scenes kept warm (0 = cool immediately)
+     * @param memoryBudget Estimated bytes of source and composite buffers
+     */
+    void setWarmScenePolicy(int sceneCount, int64_t memoryBudget);
+    
+    /**
+     * @brief Get the number of inactive scenes kept warm
+     */
+    [[nodiscard]] int warmSceneLimit() const { return m_warmSceneLimit; }
+    
+    /**
+     * @brief Get the warm scene memory budget in bytes
+     */
+    [[nodiscard]] int64_t warmMemoryBudget() const { return m_warmMemoryBudget; }
+    
+    /**
+     * @brief Check if a scene is in the warm set
+     */
+    [[nodiscard]] bool isSceneWarm(Scene* scene) const;
+
+    // =========================================================================
+    // Source Activation (GUI thread)
+    // =========================================================================
+    
+    /**
+     * @brief Show a scene in an additional output (multiview, projector, ...)
+     * 
+     * Sources run only while a visible item shows them in a scene that
+     * some output displays: the active scene and the warm scenes while
+     * there are render consumers, and scenes held through this call.
+     * Activation is reference counted in SourceActivation, which stops
+     * unreferenced sources after its linger time. Reference counted per
+     * scene.
+     * 
+     * @param scene Scene to keep active
+     */
+    void acquireSceneOutput(Scene* scene);
+    
+    /**
+     * @brief Stop showing a scene in an additional output
+     */
+    void releaseSceneOutput(Scene* scene);
+    
+    /**
+     * @brief Recompute source references from the scene graph now
+     * 
+     * Runs automatically (coalesced) when items, visibility, the active
+     * scene or the render consumers change.
+     */
+    void updateSourceActivation();
 
     // =========================================================================
     // Render Loop Control
@@ -199,6 +369,55 @@ public:
      */
     [[nodiscard]] bool isRenderLoopRunning() const { return m_renderLoopRunning; }
     
+    // =========================================================================
+    // Render Consumers (GUI thread)
+    // =========================================================================
+    
+    /**
+     * @brief Register a consumer of rendered frames
+     * 
+     * While at least one consumer (visible preview, encoder output, ...)
+     * is registered, the loop renders at the target frame rate. With none,
+     * it drops to the idle rate. Reference counted per name.
+     * 
+     * @param name Consumer name (e.g. "Preview")
+     */
+    void acquireRenderConsumer(const QString& name);
+    
+    /**
+     * @brief Unregister a consumer of rendered frames
+     * @param name Consumer name passed to acquireRenderConsumer()
+     */
+    void releaseRenderConsumer(const QString& name);
+    
+    /**
+     * @brief Get the number of registered consumer references
+     */
+    [[nodiscard]] int renderConsumerCount() const;
+    
+    /**
+     * @brief Set the frame rate used while there are no consumers
+     * @param fps Idle rate, 0 to render only on requestRender()
+     */
+    void setIdleFps(double fps);
+    
+    /**
+     * @brief Get the idle frame rate
+     */
+    [[nodiscard]] double idleFps() const { return m_idleFps; }
+    
+    /**
+     * @brief Check if the loop is idling (no consumers)
+     */
+    [[nodiscard]] bool isIdle() const { return m_idle; }
+    
+    /**
+     * @brief Render one frame soon, even while idle
+     * 
+     * Requests are coalesced; does nothing while rendering at full rate.
+     */
+    void requestRender();
+    
     /**
      * @brief Force render a single frame
      * @return Rendered frame
@@ -214,6 +433,24 @@ public:
      * @brief Get render statistics
      */
     [[nodiscard]] RenderStatistics statistics() const;
+    
+    /**
+     * @brief Get the current render tick
+     * 
+     * Incremented once per render loop iteration; per-frame caches use it
+     * to do work at most once per tick. 0 until the first tick.
+     */
+    [[nodiscard]] uint64_t renderTick() const { return m_renderTick; }
+    
+    /**
+     * @brief Get the time of the current render tick on the pipeline clock
+     * 
+     * Items select source frames against this time, so all items of a
+     * tick agree on "now". 0 until the first tick.
+     * 
+     * @see FrameJitterBuffer::clockUs()
+     */
+    [[nodiscard]] int64_t canvasClockUs() const { return m_canvasClockUs; }
 
 signals:
     /**
@@ -236,6 +473,14 @@ signals:
      */
     void frameRendered(int64_t frameNumber);
     
+    /**
+     * @brief Rate-limited summary of rendered frames (10 Hz)
+     * 
+     * count = frames, bytes = frame bytes, flagged = frames that missed
+     * the frame budget, lastValue = newest frame number.
+     */
+    void renderActivity(const WeaR::ActivitySummary& summary);
+    
     /**
      * @brief Emitted when render loop starts
      */
@@ -245,6 +490,16 @@ signals:
      * @brief Emitted when render loop stops
      */
     void renderLoopStopped();
+    
+    /**
+     * @brief Emitted when the loop enters or leaves idle mode
+     */
+    void idleChanged(bool idle);
+
+protected:
+    // Deliver activity summaries only while someone listens
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
 
 private slots:
     void onRenderTick();
@@ -256,12 +511,28 @@ private:
     // Render implementation
     void doRender();
     void outputToEncoder(const QImage& frame);
+    void outputToEncoder(const PlanarFrame& frame);
     void outputToPreview(const QImage& frame);
+    void updateRenderRate();
+    
+    // Preloading
+    void touchWarmScene(Scene* scene);
+    void trimWarmScenes();
+    void dropPreloadedFrame(const QUuid& id);
+    QImage sceneSwitchFrame(const QImage& frame);
+    int64_t warmCost(Scene* scene) const;
+    static void collectSources(Scene* scene, QSet<ISource*>& sources, QSet<const Scene*>& visited);
+    
+    // Source activation
+    void scheduleSourceActivation();
+    static void countVisibleSources(Scene* scene, QHash<ISource*, int>& references,
+                                    QSet<const Scene*>& visited);
     
     // Scenes
     QList<Scene*> m_scenes;
     Scene* m_activeScene = nullptr;
     mutable QMutex m_sceneMutex;
+    QHash<QUuid, SceneSource*> m_sceneSources;
     
     // Output settings
     QSize m_outputResolution{1920, 1080};
@@ -270,21 +541,55 @@ private:
     // Render loop
     QTimer* m_renderTimer = nullptr;
     std::atomic<bool> m_renderLoopRunning{false};
+    bool m_compositorRoleApplied = false;       ///< GUI thread got ThreadRole::Render
+    std::atomic<uint64_t> m_renderTick{0};
+    std::atomic<int64_t> m_canvasClockUs{0};
+    
+    // Render-on-demand
+    QHash<QString, int> m_renderConsumers;
+    double m_idleFps = 0.0;
+    std::atomic<bool> m_idle{false};
+    bool m_renderRequested = false;
     QElapsedTimer m_frameTimer;
     int64_t m_lastFrameTime = 0;
     
+    // Scene preloading
+    QList<QUuid> m_warmScenes;              ///< Most recently left first
+    int m_warmSceneLimit = 2;
+    int64_t m_warmMemoryBudget = 256LL * 1024 * 1024;
+    QHash<QUuid, QImage> m_preloadedFrames; ///< Guarded by m_frameMutex
+    int64_t m_preloadedBytes = 0;
+    int m_preloadMemoryStage = -1;
+    QElapsedTimer m_switchTimer;
+    bool m_switchPending = false;
+    bool m_switchWarm = false;
+    double m_switchLatencyTotalMs = 0.0;
+    
+    static constexpr int kSwitchTimeoutMs = 2000;   ///< Give up waiting for cold sources
+    
+    // Source activation
+    QHash<ISource*, int> m_sourceReferences;    ///< References held in SourceActivation
+    QHash<QUuid, int> m_outputScenes;           ///< Scenes held by extra outputs
+    bool m_activationScheduled = false;
+    
     // Output
     PreviewFrameCallback m_previewCallback;
-    std::atomic<bool> m_encoderOutputEnabled{true};
+    std::atomic<bool> m_encoderOutputEnabled{false};
     
     // Frame buffer
+    std::unique_ptr<CanvasPool> m_canvasPool;
+    std::unique_ptr<YuvCompositor> m_yuvCompositor;
+    CompositorMode m_compositorMode = CompositorMode::Rgb;
     QImage m_lastFrame;
+    MemoryReservation m_lastFrameReservation;
+    int m_previewMemoryStage = -1;
     mutable QMutex m_frameMutex;
     
     // Statistics
     RenderStatistics m_stats;
     mutable QMutex m_statsMutex;
     QList<double> m_renderTimes;
+    ActivityMailbox* m_frameMailbox = nullptr;
 };
 
 } // namespace WeaR
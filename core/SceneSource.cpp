@@ -0,0 +1,219 @@
+// ==============================================================================
+// WeaR-studio SceneSource Implementation
+// ==============================================================================
+
+#include "SceneSource.h"
+#include "Scene.h"
+#include "SceneManager.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QPainter>
+
+#include <algorithm>
+
+namespace WeaR {
+
+SceneSource::SceneSource(Scene* scene, QObject* parent)
+    : QObject(parent)
+    , m_scene(scene)
+{
+    if (m_scene) {
+        m_config.resolution = m_scene->resolution();
+
+        // Any structural change invalidates the cached composite
+        connect(m_scene, &Scene::sceneChanged, this, [this]() {
+            ++m_sceneRevision;
+        });
+    }
+}
+
+SceneSource::~SceneSource() {
+    stop();
+}
+
+// ==============================================================================
+// IPlugin Interface
+// ==============================================================================
+PluginInfo SceneSource::info() const {
+    return PluginInfo{
+        .id = QStringLiteral("wear.source.scene"),
+        .name = name(),
+        .description = QStringLiteral("Shows another scene as a layer"),
+        .version = version(),
+        .author = QStringLiteral("WeaR-studio"),
+        .website = QString(),
+        .type = PluginType::Source,
+        .capabilities = capabilities()
+    };
+}
+
+QString SceneSource::name() const {
+    return m_scene ? QString("Scene: %1").arg(m_scene->name()) : QStringLiteral("Scene");
+}
+
+PluginCapability SceneSource::capabilities() const {
+    return PluginCapability::HasVideo | PluginCapability::HasPreview;
+}
+
+// ==============================================================================
+// ISource Interface
+// ==============================================================================
+bool SceneSource::configure(const SourceConfig& config) {
+    QMutexLocker lock(&m_mutex);
+    m_config = config;
+    return true;
+}
+
+SourceConfig SceneSource::config() const {
+    QMutexLocker lock(&m_mutex);
+    return m_config;
+}
+
+QVariantMap SceneSource::saveSettings() const {
+    // The scene is resolved by id when a collection is loaded
+    QVariantMap settings;
+    if (m_scene) {
+        settings.insert(QStringLiteral("scene"), m_scene->id().toString(QUuid::WithoutBraces));
+    }
+    return settings;
+}
+
+bool SceneSource::start() {
+    m_running = true;
+    return true;
+}
+
+void SceneSource::stop() {
+    m_running = false;
+
+    QMutexLocker lock(&m_mutex);
+    m_composite = QImage();
+    m_compositeKeys.clear();
+    m_compositeTick = 0;
+    m_cropView.clear();
+}
+
+VideoFrame SceneSource::captureVideoFrame() {
+    VideoFrame frame;
+    if (!m_scene) return frame;
+
+    // Cycle: this scene is already being composed further up the stack
+    if (m_scene->isBeingRendered()) {
+        if (!m_cycleReported.exchange(true)) {
+            qWarning() << "Nested scene cycle detected, skipping:" << m_scene->name();
+        }
+        return frame;
+    }
+
+    // Report the next cycle again once this one is resolved
+    m_cycleReported = false;
+
+    QMutexLocker lock(&m_mutex);
+
+    // Every item referencing this scene during one tick shares one render
+    const uint64_t tick = SceneManager::instance().renderTick();
+    if (tick == 0 || tick != m_compositeTick || m_composite.isNull()) {
+        m_composite = compose();
+        m_compositeTick = tick;
+    } else {
+        ++m_cacheHits;
+    }
+
+    if (m_composite.isNull()) return frame;
+
+    frame.softwareFrame = m_composite;
+    frame.isHardwareFrame = false;
+    frame.timestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+    frame.hasTimestamp = true;
+    frame.frameNumber = m_frameNumber++;
+
+    return m_cropView.crop(frame, m_config.captureRegion);
+}
+
+QSize SceneSource::nativeResolution() const {
+    return m_scene ? m_scene->resolution() : QSize();
+}
+
+double SceneSource::nativeFps() const {
+    return SceneManager::instance().targetFps();
+}
+
+// ==============================================================================
+// Scene Source Specific API
+// ==============================================================================
+bool SceneSource::wouldCreateCycle(const Scene* host, const Scene* nested) {
+    if (!host || !nested) return false;
+    if (host == nested) return true;
+
+    // Depth-first walk of the scenes reachable from the nested scene
+    std::vector<const Scene*> pending{nested};
+    std::vector<const Scene*> visited;
+
+    while (!pending.empty()) {
+        const Scene* scene = pending.back();
+        pending.pop_back();
+
+        if (std::find(visited.begin(), visited.end(), scene) != visited.end()) continue;
+        visited.push_back(scene);
+
+        for (const SceneItem* item : scene->items()) {
+            auto* source = dynamic_cast<SceneSource*>(item->source());
+            if (!source || !source->scene()) continue;
+            if (source->scene() == host) return true;
+            pending.push_back(source->scene());
+        }
+    }
+
+    return false;
+}
+
+QImage SceneSource::compose() {
+    Scene::RenderScope scope(m_scene);
+
+    // Capture first: nested frames tell us whether anything changed
+    const QList<SceneItem*> items = m_scene->items();
+    std::vector<QImage> frames;
+    std::vector<qint64> keys;
+    frames.reserve(items.size());
+    keys.reserve(items.size());
+
+    for (const SceneItem* item : items) {
+        QImage frame = item->isVisible() ? item->currentFrame() : QImage();
+        keys.push_back(frame.isNull() ? 0 : frame.cacheKey());
+        frames.push_back(std::move(frame));
+    }
+
+    // Same frames, same layout: the previous composite is still correct
+    if (!m_composite.isNull() && keys == m_compositeKeys &&
+        m_sceneRevision == m_compositeRevision &&
+        m_composite.size() == m_scene->resolution()) {
+        ++m_cacheHits;
+        return m_composite;
+    }
+
+    // A nested scene is a layer: transparent wherever its items are not,
+    // whatever background it has when shown on its own
+    QImage output(m_scene->resolution(), QImage::Format_ARGB32_Premultiplied);
+    output.fill(Qt::transparent);
+
+    QPainter painter(&output);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    for (int i = 0; i < items.size(); ++i) {
+        if (!frames[i].isNull()) {
+            items[i]->render(&painter, frames[i]);
+        }
+    }
+
+    painter.end();
+
+    m_compositeKeys = std::move(keys);
+    m_compositeRevision = m_sceneRevision;
+    ++m_renderCount;
+
+    return output;
+}
+
+} // namespace WeaR
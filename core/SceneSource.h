@@ -0,0 +1,130 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio SceneSource
+// Exposes a Scene as an ISource so scenes can be nested in other scenes
+// ==============================================================================
+
+#include "IPlugin.h"
+#include "ISource.h"
+#include "Scene.h"
+
+#include <QObject>
+#include <QPointer>
+#include <QImage>
+#include <QMutex>
+
+#include <atomic>
+#include <vector>
+
+namespace WeaR {
+
+/**
+ * @brief Adapter presenting a Scene's composite as a video source
+ *
+ * Lets a group of items (e.g. a lower third) be built once and placed in
+ * any number of scenes. Obtain instances via SceneManager::sceneSource(),
+ * which keeps one adapter per scene so that every item referencing the
+ * scene shares the same composite:
+ *
+ * - The composite is rendered at most once per render tick
+ * - If no nested item produced a new frame and the scene did not change,
+ *   the previous composite is returned without painting
+ * - Rendering a scene that is already being rendered on this thread
+ *   (A contains B contains A) yields an empty frame instead of recursing
+ * - The composite is transparent where the scene has no items; the
+ *   scene's own background only applies when it is shown on its own
+ */
+class SceneSource : public QObject, public ISource {
+    Q_OBJECT
+    Q_INTERFACES(WeaR::ISource)
+
+public:
+    /**
+     * @brief Create an adapter for a scene
+     * @param scene Scene to expose (not owned)
+     * @param parent Parent object
+     */
+    explicit SceneSource(Scene* scene, QObject* parent = nullptr);
+    ~SceneSource() override;
+
+    // =========================================================================
+    // IPlugin Interface
+    // =========================================================================
+    [[nodiscard]] PluginInfo info() const override;
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString version() const override { return QStringLiteral("0.1"); }
+    [[nodiscard]] PluginType type() const override { return PluginType::Source; }
+    [[nodiscard]] PluginCapability capabilities() const override;
+
+    bool initialize() override { return true; }
+    void shutdown() override { stop(); }
+    [[nodiscard]] bool isActive() const override { return !m_scene.isNull(); }
+
+    // =========================================================================
+    // ISource Interface
+    // =========================================================================
+    bool configure(const SourceConfig& config) override;
+    [[nodiscard]] SourceConfig config() const override;
+
+    bool start() override;
+    void stop() override;
+    [[nodiscard]] bool isRunning() const override { return m_running; }
+
+    [[nodiscard]] VideoFrame captureVideoFrame() override;
+
+    [[nodiscard]] QSize nativeResolution() const override;
+    [[nodiscard]] double nativeFps() const override;
+    [[nodiscard]] QSize outputResolution() const override { return nativeResolution(); }
+    [[nodiscard]] double outputFps() const override { return nativeFps(); }
+    [[nodiscard]] QVariantMap saveSettings() const override;
+
+    // =========================================================================
+    // Scene Source Specific API
+    // =========================================================================
+
+    /**
+     * @brief Get the nested scene (null if it was deleted)
+     */
+    [[nodiscard]] Scene* scene() const { return m_scene; }
+
+    /**
+     * @brief Check whether nesting a scene inside another would form a cycle
+     * @param host Scene that would contain the item
+     * @param nested Scene that would be shown by the item
+     * @return true if host is reachable from nested (or they are the same)
+     */
+    [[nodiscard]] static bool wouldCreateCycle(const Scene* host, const Scene* nested);
+
+    /**
+     * @brief Number of times the composite was actually painted
+     */
+    [[nodiscard]] int64_t renderCount() const { return m_renderCount; }
+
+    /**
+     * @brief Number of requests served from the cached composite
+     */
+    [[nodiscard]] int64_t cacheHitCount() const { return m_cacheHits; }
+
+private:
+    QImage compose();
+
+    QPointer<Scene> m_scene;
+    SourceConfig m_config;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_cycleReported{false};  ///< Cycle already logged (until it is resolved)
+
+    // Composite cache
+    QImage m_composite;
+    uint64_t m_compositeTick = 0;          ///< Render tick the composite belongs to
+    std::atomic<uint64_t> m_sceneRevision{0};  ///< Incremented on Scene::sceneChanged
+    uint64_t m_compositeRevision = 0;
+    std::vector<qint64> m_compositeKeys;   ///< Item frame cache keys of the composite
+    CroppedViewCache m_cropView;           ///< Keeps the region view of an unchanged composite
+    int64_t m_frameNumber = 0;
+    mutable QMutex m_mutex;
+
+    std::atomic<int64_t> m_renderCount{0};
+    std::atomic<int64_t> m_cacheHits{0};
+};
+
+} // namespace WeaR
@@ -0,0 +1,160 @@
+// ==============================================================================
+// WeaR-studio SourceActivation Implementation
+// ==============================================================================
+
+#include "SourceActivation.h"
+
+#include <QDebug>
+#include <QList>
+
+#include <algorithm>
+
+namespace WeaR {
+
+// ==============================================================================
+// SourceActivation Singleton
+// ==============================================================================
+SourceActivation& SourceActivation::instance() {
+    static SourceActivation instance;
+    return instance;
+}
+
+SourceActivation::SourceActivation(QObject* parent)
+    : QObject(parent)
+{
+    m_sweepTimer = new QTimer(this);
+    m_sweepTimer->setInterval(kSweepIntervalMs);
+    connect(m_sweepTimer, &QTimer::timeout, this, &SourceActivation::sweep);
+
+    m_clock.start();
+}
+
+SourceActivation::~SourceActivation() = default;
+
+// ==============================================================================
+// References
+// ==============================================================================
+void SourceActivation::acquire(ISource* source) {
+    if (!source) return;
+
+    Entry& entry = m_entries[source];
+    if (entry.references++ > 0) return;
+
+    if (entry.releasedAt >= 0) {
+        // Re-referenced while lingering: nothing to restart
+        entry.releasedAt = -1;
+        if (source->isRunning()) {
+            m_revived++;
+            return;
+        }
+    }
+
+    if (!source->isRunning()) {
+        if (source->start()) {
+            m_starts++;
+            qDebug() << "Source activated:" << source->name();
+            emit sourceActivationChanged(source, true);
+        } else {
+            qWarning() << "Failed to start source" << source->name();
+        }
+    }
+}
+
+void SourceActivation::release(ISource* source) {
+    auto it = m_entries.find(source);
+    if (it == m_entries.end() || it->references <= 0) {
+        qWarning() << "SourceActivation: release without acquire";
+        return;
+    }
+
+    if (--it->references == 0) {
+        it->releasedAt = m_clock.elapsed();
+        scheduleSweep();
+    }
+}
+
+void SourceActivation::track(ISource* source) {
+    if (!source || m_entries.contains(source)) return;
+
+    Entry entry;
+    entry.releasedAt = m_clock.elapsed();
+    m_entries.insert(source, entry);
+    scheduleSweep();
+}
+
+void SourceActivation::forget(ISource* source) {
+    m_entries.remove(source);
+    emit sourceForgotten(source);
+}
+
+int SourceActivation::references(ISource* source) const {
+    return m_entries.value(source).references;
+}
+
+void SourceActivation::setLingerMs(int ms) {
+    m_lingerMs = std::max(ms, 0);
+    qDebug() << "Source linger time set to:" << m_lingerMs << "ms";
+}
+
+SourceActivationStatistics SourceActivation::statistics() const {
+    SourceActivationStatistics stats;
+    stats.tracked = static_cast<int>(m_entries.size());
+    for (const Entry& entry : m_entries) {
+        if (entry.references > 0) {
+            stats.active++;
+        } else if (entry.releasedAt >= 0) {
+            stats.lingering++;
+        }
+    }
+    stats.starts = m_starts;
+    stats.stops = m_stops;
+    stats.revived = m_revived;
+    return stats;
+}
+
+// ==============================================================================
+// Linger
+// ==============================================================================
+void SourceActivation::scheduleSweep() {
+    if (!m_sweepTimer->isActive()) {
+        m_sweepTimer->start();
+    }
+}
+
+void SourceActivation::sweep() {
+    const qint64 now = m_clock.elapsed();
+    bool lingering = false;
+    QList<ISource*> expired;
+
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->references > 0 || it->releasedAt < 0) continue;
+
+        if (now - it->releasedAt < m_lingerMs) {
+            lingering = true;
+            continue;
+        }
+
+        // Stay tracked with no pending stop until referenced again
+        it->releasedAt = -1;
+        expired.append(it.key());
+    }
+
+    if (!lingering) {
+        m_sweepTimer->stop();
+    }
+
+    // Stopped outside the iteration: slots may acquire or forget sources
+    for (ISource* source : expired) {
+        auto it = m_entries.constFind(source);
+        if (it == m_entries.constEnd() || it->references > 0) continue;
+
+        if (source->isRunning()) {
+            source->stop();
+            m_stops++;
+            qDebug() << "Source deactivated:" << source->name();
+            emit sourceActivationChanged(source, false);
+        }
+    }
+}
+
+} // namespace WeaR
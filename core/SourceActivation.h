@@ -0,0 +1,135 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio SourceActivation
+// Reference-counted source start/stop with linger
+// ==============================================================================
+
+#include "ISource.h"
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QElapsedTimer>
+
+namespace WeaR {
+
+/**
+ * @brief Source activation statistics
+ */
+struct SourceActivationStatistics {
+    int tracked = 0;            ///< Sources known to the activation table
+    int active = 0;             ///< Sources with at least one reference
+    int lingering = 0;          ///< Unreferenced sources waiting to be stopped
+    int64_t starts = 0;         ///< Sources started on acquire
+    int64_t stops = 0;          ///< Sources stopped after lingering
+    int64_t revived = 0;        ///< Pending stops cancelled by a new reference
+};
+
+/**
+ * @brief Starts sources while they are referenced and stops them after
+ *
+ * Whoever needs a source's frames (a visible item in a scene shown by an
+ * output, a properties preview, ...) holds a reference. The first
+ * reference starts a stopped source; when the last one is released the
+ * source keeps running for the linger time and is then stopped, so an
+ * item toggled on and off quickly does not restart its capture or
+ * decoder every time.
+ *
+ * Only sources that were referenced or explicitly tracked are ever
+ * stopped. All calls are made from the GUI thread.
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class SourceActivation : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the SourceActivation instance
+     */
+    static SourceActivation& instance();
+
+    // Prevent copying
+    SourceActivation(const SourceActivation&) = delete;
+    SourceActivation& operator=(const SourceActivation&) = delete;
+
+    ~SourceActivation() override;
+
+    /**
+     * @brief Add a reference, starting the source if it is stopped
+     */
+    void acquire(ISource* source);
+
+    /**
+     * @brief Drop a reference; the last one schedules a stop
+     */
+    void release(ISource* source);
+
+    /**
+     * @brief Take over an unreferenced source
+     *
+     * A running source with no references is stopped after the linger
+     * time, as if its last reference had just been released.
+     */
+    void track(ISource* source);
+
+    /**
+     * @brief Remove a source without stopping it (e.g. before deleting it)
+     *
+     * Emits sourceForgotten() so holders of references drop the pointer.
+     */
+    void forget(ISource* source);
+
+    /**
+     * @brief Get the reference count of a source
+     */
+    [[nodiscard]] int references(ISource* source) const;
+
+    /**
+     * @brief Set how long unreferenced sources keep running
+     * @param ms Linger time (0 = stop on the next sweep)
+     */
+    void setLingerMs(int ms);
+    [[nodiscard]] int lingerMs() const { return m_lingerMs; }
+
+    /**
+     * @brief Get statistics
+     */
+    [[nodiscard]] SourceActivationStatistics statistics() const;
+
+signals:
+    /**
+     * @brief Emitted when a source is started or stopped
+     */
+    void sourceActivationChanged(WeaR::ISource* source, bool active);
+
+    /**
+     * @brief Emitted when a source is forgotten (it is about to be deleted)
+     */
+    void sourceForgotten(WeaR::ISource* source);
+
+private:
+    SourceActivation(QObject* parent = nullptr);
+
+    struct Entry {
+        int references = 0;
+        qint64 releasedAt = -1;     ///< Clock time of the last release, -1 while referenced
+    };
+
+    void sweep();
+    void scheduleSweep();
+
+    QHash<ISource*, Entry> m_entries;
+    QTimer* m_sweepTimer = nullptr;
+    QElapsedTimer m_clock;
+    int m_lingerMs = 3000;
+
+    int64_t m_starts = 0;
+    int64_t m_stops = 0;
+    int64_t m_revived = 0;
+
+    static constexpr int kSweepIntervalMs = 250;
+};
+
+} // namespace WeaR
@@ -4,10 +4,14 @@
 // ==============================================================================
 
 #include "StreamManager.h"
+#include "MemoryGovernor.h"
+#include "ThreadPolicy.h"
+#include "IngestSelector.h"
 
 #include <QDebug>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QMetaMethod>
 
 // FFmpeg headers (C linkage)
 extern "C" {
@@ -23,21 +27,40 @@ extern "C" {
 
 namespace WeaR {
 
+namespace {
+
+constexpr int kBondedAvioBufferSize = 32 * 1024;
+
+/**
+ * @brief AVIO write callback feeding the muxer output to a BondedTransport
+ */
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+int bondedWrite(void* opaque, const uint8_t* buf, int size) {
+#else
+int bondedWrite(void* opaque, uint8_t* buf, int size) {
+#endif
+    return static_cast<BondedTransport*>(opaque)->write(buf, size) ? size : AVERROR(EIO);
+}
+
+} // namespace
+
 // ==============================================================================
 // Packet wrapper for queue
 // ==============================================================================
 struct QueuedPacket {
     AVPacket* packet = nullptr;
     bool isKeyframe = false;
+    MemoryReservation reservation;  // Released with the packet
     
     QueuedPacket() = default;
     
-    QueuedPacket(AVPacket* pkt, bool keyframe) 
-        : packet(pkt), isKeyframe(keyframe) {}
+    QueuedPacket(AVPacket* pkt, bool keyframe, MemoryReservation r = MemoryReservation()) 
+        : packet(pkt), isKeyframe(keyframe), reservation(std::move(r)) {}
     
     // Move semantics
     QueuedPacket(QueuedPacket&& other) noexcept 
-        : packet(other.packet), isKeyframe(other.isKeyframe) {
+        : packet(other.packet), isKeyframe(other.isKeyframe)
+        , reservation(std::move(other.reservation)) {
         other.packet = nullptr;
     }
     
@@ -46,6 +69,7 @@ struct QueuedPacket {
             if (packet) av_packet_free(&packet);
             packet = other.packet;
             isKeyframe = other.isKeyframe;
+            reservation = std::move(other.reservation);
             other.packet = nullptr;
         }
         return *this;
@@ -65,18 +89,25 @@ struct QueuedPacket {
 // ==============================================================================
 class StreamManager::Impl {
 public:
-    Impl(StreamManager* parent) : m_parent(parent) {}
+    Impl(StreamManager* parent) : m_parent(parent) {
+        // Encoded packets are never shed (dropping them corrupts the GOP),
+        // but they count against the budget so other stages shed first
+        m_memoryStage = MemoryGovernor::instance().registerStage(
+            QStringLiteral("Stream packet queue"), MemoryClass::StreamFrames);
+    }
     
     ~Impl() {
         stop();
         cleanup();
+        MemoryGovernor::instance().unregisterStage(m_memoryStage);
     }
     
     bool configure(const StreamSettings& settings) {
         QMutexLocker lock(&m_mutex);
         
         if (m_state == StreamState::Streaming || 
-            m_state == StreamState::Connecting) {
+            m_state == StreamState::Connecting ||
+            m_state == StreamState::Standby) {
             qWarning() << "Cannot configure while streaming";
             return false;
         }
@@ -122,19 +153,27 @@ public:
         
         if (m_state == StreamState::Streaming) return true;
         
-        if (m_settings.url.isEmpty()) {
-            qWarning() << "No stream URL configured";
-            return false;
+        // Go-live: time to first byte is measured from here
+        m_goLiveTimer.start();
+        m_firstByteSent = false;
+        m_publish = true;
+        
+        // Connected or connecting already: the output thread takes over
+        if (m_running) {
+            m_queueCondition.wakeAll();
+            return true;
         }
         
-        // Transition to connecting
-        setState(StreamState::Connecting);
+        return launchOutput();
+    }
+    
+    bool prewarm() {
+        QMutexLocker lock(&m_mutex);
         
-        // Start output thread
-        m_running = true;
-        m_outputThread = std::thread(&Impl::outputLoop, this);
+        if (m_running) return true;
         
-        return true;
+        m_publish = false;
+        return launchOutput();
     }
     
     bool start(const QString& url, const QString& streamKey) {
@@ -148,6 +187,7 @@ public:
             QMutexLocker lock(&m_mutex);
             if (m_state == StreamState::Stopped) return;
             m_running = false;
+            m_publish = false;
         }
         
         // Wake up output thread
@@ -177,6 +217,7 @@ public:
     bool isConnected() const {
         auto s = m_state.load();
         return s == StreamState::Streaming || 
+               s == StreamState::Standby ||
                s == StreamState::Connecting ||
                s == StreamState::Reconnecting;
     }
@@ -230,6 +271,10 @@ public:
         StreamStatistics stats = m_stats;
         stats.state = m_state;
         
+        if (m_bonded) {
+            stats.bondedLinks = m_bonded->statistics();
+        }
+        
         // Calculate stream duration
         if (m_streamStartTime > 0 && m_state == StreamState::Streaming) {
             stats.streamDurationMs = QDateTime::currentMSecsSinceEpoch() - m_streamStartTime;
@@ -250,9 +295,48 @@ public:
     }
 
 private:
-    bool initializeOutput() {
-        QString url = m_settings.fullUrl();
-        qDebug() << "Connecting to:" << url;
+    bool launchOutput() {
+        if (m_settings.url.isEmpty()) {
+            qWarning() << "No stream URL configured";
+            return false;
+        }
+        
+        // A thread that ended in the Error state is still joinable
+        if (m_outputThread.joinable()) {
+            m_outputThread.join();
+        }
+        
+        // Transition to connecting
+        setState(StreamState::Connecting);
+        
+        // A new session picks its ingest again
+        m_ingestUrl.clear();
+        
+        // Start output thread
+        m_running = true;
+        m_outputThread = std::thread(&Impl::outputLoop, this);
+        
+        return true;
+    }
+    
+    bool openConnection() {
+        // Best regional ingest, chosen once per session: reconnects and
+        // standby renewals go back to the same one without probing.
+        // Bonded streams reach the ingest from the receiver, not from here.
+        QString ingest = m_settings.url;
+        if (m_settings.autoSelectIngest && !m_settings.bonding.enabled) {
+            if (m_ingestUrl.isEmpty()) {
+                m_ingestUrl = IngestSelector::instance().selectUrl(m_settings.service, m_settings.url,
+                                                                   m_settings.videoBitrate);
+            }
+            ingest = m_ingestUrl;
+        }
+        
+        QString url = m_settings.fullUrl(ingest);
+        qDebug() << "Connecting to:" << ingest;
+        
+        QElapsedTimer connectTimer;
+        connectTimer.start();
         
         // Allocate output context
         int ret = avformat_alloc_output_context2(
@@ -264,32 +348,6 @@ private:
             return false;
         }
         
-        // Create video stream
-        m_videoStream = avformat_new_stream(m_formatContext, nullptr);
-        if (!m_videoStream) {
-            qCritical() << "Failed to create video stream";
-            return false;
-        }
-        
-        m_videoStream->id = 0;
-        m_videoStream->time_base = AVRational{1, 1000};  // FLV uses milliseconds
-        
-        // Copy codec parameters to stream
-        if (m_codecpar) {
-            ret = avcodec_parameters_copy(m_videoStream->codecpar, m_codecpar);
-            if (ret < 0) {
-                logAvError("Failed to copy codec parameters", ret);
-                return false;
-            }
-        } else {
-            // Set default parameters if none provided
-            m_videoStream->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
-            m_videoStream->codecpar->codec_id = AV_CODEC_ID_H264;
-            m_videoStream->codecpar->width = m_settings.videoWidth;
-            m_videoStream->codecpar->height = m_settings.videoHeight;
-            m_videoStream->codecpar->bit_rate = m_settings.videoBitrate * 1000;
-        }
-        
         // Set up RTMP connection options
         AVDictionary* options = nullptr;
         
@@ -305,8 +363,14 @@ private:
         av_dict_set(&options, "rtmp_live", "live", 0);
         av_dict_set(&options, "rtmp_buffer", "1000", 0);  // 1 second buffer
         
-        // Open output
-        if (!(m_formatContext->oformat->flags & AVFMT_NOFILE)) {
+        // Open output: TCP connect and RTMP handshake, connect and publish
+        if (m_settings.bonding.enabled) {
+            av_dict_free(&options);
+            
+            if (!openBondedOutput(url)) {
+                return false;
+            }
+        } else if (!(m_formatContext->oformat->flags & AVFMT_NOFILE)) {
             ret = avio_open2(
                 &m_formatContext->pb, 
                 url.toUtf8().constData(),
@@ -321,6 +385,77 @@ private:
                 logAvError("Failed to open output URL", ret);
                 return false;
             }
+        } else {
+            av_dict_free(&options);
+        }
+        
+        m_connectedAtMs = QDateTime::currentMSecsSinceEpoch();
+        {
+            QMutexLocker lock(&m_statsMutex);
+            m_stats.connectTimeMs = connectTimer.nsecsElapsed() / 1e6;
+        }
+        
+        qDebug() << "Connected to RTMP server in" << connectTimer.elapsed() << "ms";
+        return true;
+    }
+    
+    bool openBondedOutput(const QString& url) {
+        // The receiver publishes to url; the muxer writes into the links
+        auto transport = std::make_unique<BondedTransport>(m_settings.bonding);
+        if (!transport->open(url, m_settings.connectTimeout * 1000)) {
+            emit m_parent->streamError("No bonded link reached the receiver");
+            return false;
+        }
+        
+        auto* buffer = static_cast<unsigned char*>(av_malloc(kBondedAvioBufferSize));
+        if (!buffer) return false;
+        
+        AVIOContext* pb = avio_alloc_context(buffer, kBondedAvioBufferSize, 1, transport.get(),
+                                             nullptr, &bondedWrite, nullptr);
+        if (!pb) {
+            av_free(buffer);
+            return false;
+        }
+        
+        m_formatContext->pb = pb;
+        m_formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        
+        QMutexLocker lock(&m_statsMutex);
+        m_bonded = std::move(transport);
+        return true;
+    }
+    
+    bool writeHeader() {
+        // Create video stream
+        m_videoStream = avformat_new_stream(m_formatContext, nullptr);
+        if (!m_videoStream) {
+            qCritical() << "Failed to create video stream";
+            return false;
+        }
+        
+        m_videoStream->id = 0;
+        m_videoStream->time_base = AVRational{1, 1000};  // FLV uses milliseconds
+        
+        // Copy codec parameters to stream (set while connecting, at the latest)
+        int ret = 0;
+        {
+            QMutexLocker lock(&m_mutex);
+            if (m_codecpar) {
+                ret = avcodec_parameters_copy(m_videoStream->codecpar, m_codecpar);
+            } else {
+                qWarning() << "No codec parameters from the encoder; the stream header has no SPS/PPS";
+                
+                // Set default parameters if none provided
+                m_videoStream->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+                m_videoStream->codecpar->codec_id = AV_CODEC_ID_H264;
+                m_videoStream->codecpar->width = m_settings.videoWidth;
+                m_videoStream->codecpar->height = m_settings.videoHeight;
+                m_videoStream->codecpar->bit_rate = m_settings.videoBitrate * 1000;
+            }
+        }
+        if (ret < 0) {
+            logAvError("Failed to copy codec parameters", ret);
+            return false;
         }
         
         // Write stream header
@@ -332,8 +467,6 @@ private:
         
         m_headerWritten = true;
         m_streamStartTime = QDateTime::currentMSecsSinceEpoch();
-        
-        qDebug() << "Connected to RTMP server successfully";
         return true;
     }
     
@@ -348,13 +481,29 @@ private:
             
             // Close output
             if (m_formatContext->pb) {
-                avio_closep(&m_formatContext->pb);
+                if (m_formatContext->flags & AVFMT_FLAG_CUSTOM_IO) {
+                    avio_flush(m_formatContext->pb);
+                    av_freep(&m_formatContext->pb->buffer);
+                    avio_context_free(&m_formatContext->pb);
+                } else {
+                    avio_closep(&m_formatContext->pb);
+                }
             }
             
             avformat_free_context(m_formatContext);
             m_formatContext = nullptr;
         }
         
+        // End the bonded session once the muxer is done with it
+        std::unique_ptr<BondedTransport> bonded;
+        {
+            QMutexLocker lock(&m_statsMutex);
+            bonded = std::move(m_bonded);
+        }
+        if (bonded) {
+            bonded->close();
+        }
+        
         m_videoStream = nullptr;
         
         // Clear packet queue
@@ -365,6 +514,17 @@ private:
     }
     
     bool queuePacket(AVPacket* packet, bool isKeyframe) {
+        // Standby: nothing is published until go-live
+        if (!m_publish) {
+            av_packet_free(&packet);
+            return false;
+        }
+        
+        // Never refused: a lost inter-frame corrupts the GOP until the
+        // next keyframe, so the other stages shed instead
+        MemoryGovernor::instance().reserveAlways(m_memoryStage, packet->size);
+        MemoryReservation reservation(m_memoryStage, packet->size);
+        
         QMutexLocker lock(&m_queueMutex);
         
         // Check queue size limit
@@ -376,7 +536,7 @@ private:
             return false;
         }
         
-        m_packetQueue.emplace_back(packet, isKeyframe);
+        m_packetQueue.emplace_back(packet, isKeyframe, std::move(reservation));
         m_queueCondition.wakeOne();
         
         return true;
@@ -384,6 +544,7 @@ private:
     
     void outputLoop() {
         qDebug() << "Stream output thread started";
+        ThreadPolicy::instance().applyToCurrentThread(ThreadRole::Network, QStringLiteral("WeaR stream out"));
         
         int reconnectAttempts = 0;
         
@@ -392,12 +553,12 @@ private:
             if (m_state == StreamState::Connecting || 
                 m_state == StreamState::Reconnecting) {
                 
-                if (initializeOutput()) {
-                    setState(StreamState::Streaming);
-                    emit m_parent->connected();
+                if (openConnection()) {
+                    setState(StreamState::Standby);
                     reconnectAttempts = 0;
                 } else {
                     // Connection failed
+                    cleanup();
                     reconnectAttempts++;
                     
                     if (m_settings.maxReconnectAttempts > 0 &&
@@ -417,6 +578,31 @@ private:
                 }
             }
             
+            // Connected ahead of time: wait for go-live
+            if (m_state == StreamState::Standby) {
+                if (m_publish) {
+                    setState(StreamState::Streaming);
+                    emit m_parent->connected();
+                    emit m_parent->keyframeRequested();
+                    continue;
+                }
+                
+                // Ingests drop idle publishers; renew the connection first.
+                // Not when bonded: idle links stay up, and a new transport
+                // would start a new session (and ingest connection) at the receiver
+                if (!m_settings.bonding.enabled &&
+                    QDateTime::currentMSecsSinceEpoch() - m_connectedAtMs > kStandbyRenewMs) {
+                    qDebug() << "Renewing standby stream connection";
+                    cleanup();
+                    setState(StreamState::Connecting);
+                    continue;
+                }
+                
+                QMutexLocker lock(&m_queueMutex);
+                m_queueCondition.wait(&m_queueMutex, 100);
+                continue;
+            }
+            
             // Process packets
             QueuedPacket queuedPacket;
             
@@ -434,6 +620,21 @@ private:
             
             if (!queuedPacket.packet) continue;
             
+            // Publishing starts on a keyframe; the header goes out with it
+            if (!m_headerWritten) {
+                if (!queuedPacket.isKeyframe) {
+                    QMutexLocker lock(&m_statsMutex);
+                    m_stats.packetsBeforeKeyframe++;
+                    continue;
+                }
+                if (!writeHeader()) {
+                    qWarning() << "Stream header failed, attempting reconnection...";
+                    cleanup();
+                    setState(StreamState::Reconnecting);
+                    continue;
+                }
+            }
+            
             // Send packet
             if (!sendPacket(queuedPacket.packet, queuedPacket.isKeyframe)) {
                 // Send failed - attempt reconnection
@@ -443,6 +644,17 @@ private:
                 
                 QMutexLocker lock(&m_statsMutex);
                 m_stats.reconnectCount++;
+                continue;
+            }
+            
+            if (!m_firstByteSent) {
+                m_firstByteSent = true;
+                const double ttfbMs = m_goLiveTimer.nsecsElapsed() / 1e6;
+                {
+                    QMutexLocker lock(&m_statsMutex);
+                    m_stats.timeToFirstByteMs = ttfbMs;
+                }
+                qDebug() << "First keyframe on ingest" << ttfbMs << "ms after go-live";
             }
         }
         
@@ -509,6 +721,7 @@ private:
         }
         
         emit m_parent->packetSent(packet->pts, packet->size);
+        m_parent->m_packetMailbox->post(packet->size, (packet->flags & AV_PKT_FLAG_KEY) != 0, packet->pts);
         
         return true;
     }
@@ -549,12 +762,24 @@ private:
     AVStream* m_videoStream = nullptr;
     AVCodecParameters* m_codecpar = nullptr;
     
+    // Bonded uplink (output thread; guarded by m_statsMutex for statistics())
+    std::unique_ptr<BondedTransport> m_bonded;
+    
     // Flags
     bool m_headerWritten = false;
     int64_t m_streamStartTime = 0;
+    int64_t m_connectedAtMs = 0;
+    QString m_ingestUrl;                    ///< Ingest chosen for this session (output thread)
+    
+    // Go-live
+    std::atomic<bool> m_publish{false};     ///< Publish packets (false = standby)
+    QElapsedTimer m_goLiveTimer;
+    std::atomic<bool> m_firstByteSent{false};
+    static constexpr int64_t kStandbyRenewMs = 20000;
     
     // Packet queue
     std::deque<QueuedPacket> m_packetQueue;
+    int m_memoryStage = -1;
     
     // Statistics
     StreamStatistics m_stats;
@@ -572,7 +797,20 @@ StreamManager& StreamManager::instance() {
 StreamManager::StreamManager(QObject* parent)
     : QObject(parent)
     , m_impl(std::make_unique<Impl>(this))
+    , m_packetMailbox(new ActivityMailbox(100, this))
 {
+    connect(m_packetMailbox, &ActivityMailbox::summaryReady, this, &StreamManager::sendActivity);
+    m_packetMailbox->setEnabled(false);
+}
+
+void StreamManager::connectNotify(const QMetaMethod& signal) {
+    Q_UNUSED(signal);
+    m_packetMailbox->setEnabled(isSignalConnected(QMetaMethod::fromSignal(&StreamManager::sendActivity)));
+}
+
+void StreamManager::disconnectNotify(const QMetaMethod& signal) {
+    Q_UNUSED(signal);
+    m_packetMailbox->setEnabled(isSignalConnected(QMetaMethod::fromSignal(&StreamManager::sendActivity)));
 }
 
 StreamManager::~StreamManager() = default;
@@ -589,6 +827,10 @@ bool StreamManager::setCodecParameters(const AVCodecParameters* codecpar) {
     return m_impl->setCodecParameters(codecpar);
 }
 
+bool StreamManager::prewarm() {
+    return m_impl->prewarm();
+}
+
 bool StreamManager::startStream() {
     return m_impl->start();
 }
@@ -4,6 +4,9 @@
 // RTMP streaming output using FFmpeg libavformat
 // ==============================================================================
 
+#include "ActivityMailbox.h"
+#include "BondedTransport.h"
+
 #include <QObject>
 #include <QMutex>
 #include <QQueue>
@@ -30,6 +33,7 @@ namespace WeaR {
 enum class StreamState {
     Stopped,        ///< Not streaming
     Connecting,     ///< Establishing connection
+    Standby,        ///< Connected ahead of time, not publishing yet
     Streaming,      ///< Actively streaming
     Reconnecting,   ///< Connection lost, attempting to reconnect
     Error           ///< Unrecoverable error
@@ -55,6 +59,8 @@ struct StreamSettings {
     QString url;                ///< Full RTMP URL (or base URL for services)
     QString streamKey;          ///< Stream key/token
     StreamService service = StreamService::Custom;
+    bool autoSelectIngest = true; ///< Probe the service's ingest list and use the best
+    BondedSettings bonding;     ///< Stripe the stream over several uplinks via a bond receiver
     
     // Timeouts (in seconds)
     int connectTimeout = 10;    ///< Connection timeout
@@ -80,10 +86,18 @@ struct StreamSettings {
      * @brief Get the full RTMP URL including stream key
      */
     [[nodiscard]] QString fullUrl() const {
-        if (streamKey.isEmpty()) return url;
+        return fullUrl(url);
+    }
+    
+    /**
+     * @brief Get the full RTMP URL for another ingest of the same service
+     * @param ingestUrl Base URL of the ingest
+     */
+    [[nodiscard]] QString fullUrl(const QString& ingestUrl) const {
+        if (streamKey.isEmpty()) return ingestUrl;
         
-        QString separator = url.endsWith('/') ? "" : "/";
-        return url + separator + streamKey;
+        QString separator = ingestUrl.endsWith('/') ? "" : "/";
+        return ingestUrl + separator + streamKey;
     }
     
     /**
@@ -105,6 +119,22 @@ struct StreamSettings {
                 return QString();
         }
     }
+    
+    /**
+     * @brief Get the service whose preset ingest URL this is
+     * @return Matching service, Custom for any other URL
+     */
+    [[nodiscard]] static StreamService serviceForUrl(const QString& url) {
+        const QString trimmed = url.trimmed();
+        for (StreamService service : {StreamService::Twitch, StreamService::YouTube,
+                                      StreamService::Facebook, StreamService::Kick,
+                                      StreamService::TikTok}) {
+            if (trimmed == getServiceUrl(service) || trimmed == getServiceUrl(service) + '/') {
+                return service;
+            }
+        }
+        return StreamService::Custom;
+    }
 };
 
 /**
@@ -119,6 +149,10 @@ struct StreamStatistics {
     double currentBitrateKbps = 0;  ///< Current bitrate
     double averageLatencyMs = 0;    ///< Average send latency
     int reconnectCount = 0;         ///< Number of reconnections
+    double connectTimeMs = 0;       ///< TCP connect and RTMP handshake of the last connection
+    double timeToFirstByteMs = 0;   ///< Go-live request to the first media packet written (includes ingest selection and connect unless prewarmed)
+    int64_t packetsBeforeKeyframe = 0; ///< Packets discarded while waiting for a keyframe
+    QList<BondedLinkStatistics> bondedLinks; ///< Per-uplink state when bonding
     StreamState state = StreamState::Stopped;
 };
 
@@ -199,8 +233,30 @@ public:
     // Stream Control
     // =========================================================================
     
+    /**
+     * @brief Connect to the configured URL without publishing
+     * 
+     * Runs the TCP connect and RTMP handshake on the output thread and
+     * then waits in the Standby state, so a later startStream() only has
+     * to write the header. Call it before opening the encoder to overlap
+     * the two, or ahead of time to keep a standby connection (renewed
+     * periodically so the ingest does not time it out). Ingest selection,
+     * once per session, happens here too.
+     * 
+     * When bonding, the receiver publishes to the ingest as soon as the
+     * session starts, so the prewarm covers that handshake as well; the
+     * bonded connection is kept as is rather than renewed.
+     * 
+     * @return true if the connection was initiated (or already exists)
+     */
+    bool prewarm();
+    
     /**
      * @brief Start streaming to configured URL
+     * 
+     * Publishing starts on the first keyframe; keyframeRequested() asks
+     * the encoder for one. Uses a prewarmed connection when there is one.
+     * 
      * @return true if connection was initiated
      */
     bool startStream();
@@ -233,7 +289,7 @@ public:
     [[nodiscard]] bool isStreaming() const;
     
     /**
-     * @brief Check if connected (streaming or connecting)
+     * @brief Check if connected (streaming, standby or connecting)
      * @return true if connection is active
      */
     [[nodiscard]] bool isConnected() const;
@@ -310,6 +366,15 @@ signals:
      */
     void packetSent(int64_t pts, int size);
     
+    /**
+     * @brief Rate-limited summary of sent packets (10 Hz, GUI thread)
+     * 
+     * count = packets, bytes = bytes written, flagged = keyframes,
+     * lastValue = PTS of the newest packet. Prefer this over
+     * packetSent() for UI updates.
+     */
+    void sendActivity(const WeaR::ActivitySummary& summary);
+    
     /**
      * @brief Emitted on streaming error
      * @param error Error description
@@ -321,6 +386,20 @@ signals:
      * @param attempt Current attempt number
      */
     void reconnecting(int attempt);
+    
+    /**
+     * @brief Emitted (from the output thread) when publishing waits for a
+     *        keyframe, on go-live and after a reconnect
+     * 
+     * Connect to EncoderManager::requestKeyframe() with a direct
+     * connection to start without waiting for the next scheduled one.
+     */
+    void keyframeRequested();
+
+protected:
+    // Deliver activity summaries only while someone listens
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
 
 private:
     // Private constructor for singleton
@@ -329,6 +408,9 @@ private:
     // Internal implementation
     class Impl;
     std::unique_ptr<Impl> m_impl;
+    
+    // Coalesced packet notifications for the GUI thread
+    ActivityMailbox* m_packetMailbox = nullptr;
 };
 
 } // namespace WeaR
@@ -0,0 +1,348 @@
+// ==============================================================================
+// WeaR-studio ThreadPolicy Implementation
+// ==============================================================================
+
+#include "ThreadPolicy.h"
+
+#include <QDebug>
+#include <QSettings>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace WeaR {
+
+namespace {
+
+QString cpuList(const QList<int>& cpus) {
+    QStringList parts;
+    for (int cpu : cpus) {
+        parts << QString::number(cpu);
+    }
+    return parts.join(',');
+}
+
+#if defined(Q_OS_LINUX)
+QString errorText(int error) {
+    return QString::fromLocal8Bit(std::strerror(error));
+}
+#endif
+
+/// Whether threads may be given a higher than normal priority
+bool canRaisePriority() {
+#if defined(Q_OS_LINUX)
+    // Root, or an RLIMIT_NICE grant reaching nice -5 (ceiling is 20 - limit)
+    rlimit limit{};
+    if (geteuid() == 0) return true;
+    return getrlimit(RLIMIT_NICE, &limit) == 0 &&
+           (limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur >= 25);
+#else
+    // Above-normal thread priorities need no privilege on Windows
+    return true;
+#endif
+}
+
+SchedulingClass schedulingClassFromName(const QString& name, SchedulingClass fallback) {
+    if (name == QLatin1String("normal")) return SchedulingClass::Normal;
+    if (name == QLatin1String("fifo")) return SchedulingClass::Fifo;
+    if (name == QLatin1String("rr")) return SchedulingClass::RoundRobin;
+    return fallback;
+}
+
+#if defined(Q_OS_WIN)
+int windowsPriority(const ThreadRoleConfig& config) {
+    if (config.schedulingClass != SchedulingClass::Normal) {
+        return config.realtimePriority >= 50 ? THREAD_PRIORITY_TIME_CRITICAL
+                                             : THREAD_PRIORITY_HIGHEST;
+    }
+    if (config.niceLevel <= -10) return THREAD_PRIORITY_HIGHEST;
+    if (config.niceLevel < 0) return THREAD_PRIORITY_ABOVE_NORMAL;
+    if (config.niceLevel == 0) return THREAD_PRIORITY_NORMAL;
+    if (config.niceLevel < 10) return THREAD_PRIORITY_BELOW_NORMAL;
+    return THREAD_PRIORITY_LOWEST;
+}
+#endif
+
+} // namespace
+
+// ==============================================================================
+// ThreadPolicy Singleton
+// ==============================================================================
+ThreadPolicy& ThreadPolicy::instance() {
+    static ThreadPolicy instance;
+    return instance;
+}
+
+ThreadPolicy::ThreadPolicy(QObject* parent)
+    : QObject(parent)
+{
+    // Defaults: frame work ahead of everything else only where the process
+    // may raise priorities (an unprivileged Linux process is always refused
+    // a negative nice); background work always yields
+    const int frameNice = canRaisePriority() ? -5 : 0;
+
+    ThreadRoleConfig render;
+    render.niceLevel = frameNice;
+
+    // Decoders work ahead of playback, so they yield to the compositor
+    ThreadRoleConfig decode;
+    decode.niceLevel = frameNice + 5;
+
+    ThreadRoleConfig encode;
+    encode.niceLevel = frameNice;
+
+    ThreadRoleConfig network;
+    network.niceLevel = frameNice;
+
+    ThreadRoleConfig background;
+    background.niceLevel = 10;
+
+    m_configs.insert(static_cast<int>(ThreadRole::Render), render);
+    m_configs.insert(static_cast<int>(ThreadRole::Decode), decode);
+    m_configs.insert(static_cast<int>(ThreadRole::Encode), encode);
+    m_configs.insert(static_cast<int>(ThreadRole::Network), network);
+    m_configs.insert(static_cast<int>(ThreadRole::Background), background);
+}
+
+ThreadPolicy::~ThreadPolicy() = default;
+
+void ThreadPolicy::setRoleConfig(ThreadRole role, const ThreadRoleConfig& config) {
+    QMutexLocker lock(&m_mutex);
+    m_configs.insert(static_cast<int>(role), config);
+}
+
+ThreadRoleConfig ThreadPolicy::roleConfig(ThreadRole role) const {
+    QMutexLocker lock(&m_mutex);
+    return m_configs.value(static_cast<int>(role));
+}
+
+void ThreadPolicy::loadSettings() {
+    QSettings settings;
+    settings.beginGroup(QStringLiteral("ThreadPolicy"));
+
+    for (ThreadRole role : {ThreadRole::Render, ThreadRole::Decode, ThreadRole::Encode,
+                            ThreadRole::Network, ThreadRole::Background}) {
+        const QString group = roleName(role);
+        if (!settings.childGroups().contains(group)) continue;
+
+        settings.beginGroup(group);
+        ThreadRoleConfig config = roleConfig(role);
+        if (settings.contains(QStringLiteral("cpus"))) {
+            config.cpus.clear();
+            const QStringList cpus = settings.value(QStringLiteral("cpus")).toString()
+                                         .split(',', Qt::SkipEmptyParts);
+            for (const QString& cpu : cpus) {
+                bool ok = false;
+                const int index = cpu.trimmed().toInt(&ok);
+                if (ok) {
+                    config.cpus.append(index);
+                }
+            }
+        }
+        config.niceLevel = std::clamp(settings.value(QStringLiteral("nice"), config.niceLevel).toInt(), -20, 19);
+        config.schedulingClass = schedulingClassFromName(
+            settings.value(QStringLiteral("scheduling")).toString().toLower(), config.schedulingClass);
+        config.realtimePriority = std::clamp(
+            settings.value(QStringLiteral("realtimePriority"), config.realtimePriority).toInt(), 0, 99);
+        settings.endGroup();
+
+        setRoleConfig(role, config);
+        qDebug() << "Thread policy for" << group << "from settings:" << describe(config);
+    }
+
+    settings.endGroup();
+}
+
+// ==============================================================================
+// Application
+// ==============================================================================
+ThreadPolicyStatus ThreadPolicy::applyToCurrentThread(ThreadRole role, const QString& threadName) {
+    const ThreadRoleConfig config = roleConfig(role);
+
+    ThreadPolicyStatus status;
+    status.role = role;
+    status.threadName = threadName.isEmpty()
+        ? QString("thread %1").arg(reinterpret_cast<quintptr>(QThread::currentThreadId()))
+        : threadName;
+    status.requested = describe(config);
+
+    QStringList effective;
+
+#if defined(Q_OS_LINUX)
+    const pthread_t self = pthread_self();
+
+    if (!threadName.isEmpty()) {
+        // Kernel limit: 15 characters plus terminator
+        pthread_setname_np(self, threadName.left(15).toUtf8().constData());
+    }
+
+    // CPU set
+    if (!config.cpus.isEmpty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        int valid = 0;
+        for (int cpu : config.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+                valid++;
+            }
+        }
+
+        const int rc = valid > 0 ? pthread_setaffinity_np(self, sizeof(set), &set) : EINVAL;
+        if (rc == 0) {
+            effective << QString("cpus %1").arg(cpuList(config.cpus));
+        } else {
+            status.degraded = true;
+            effective << QString("cpus all (%1)").arg(errorText(rc));
+        }
+    }
+
+    // Real-time class, if permitted
+    bool realtime = false;
+    if (config.schedulingClass != SchedulingClass::Normal) {
+        const int policy = config.schedulingClass == SchedulingClass::Fifo ? SCHED_FIFO : SCHED_RR;
+        sched_param param{};
+        param.sched_priority = std::clamp(config.realtimePriority,
+                                          sched_get_priority_min(policy),
+                                          sched_get_priority_max(policy));
+
+        const int rc = pthread_setschedparam(self, policy, &param);
+        if (rc == 0) {
+            realtime = true;
+            effective << QString("%1 %2")
+                .arg(policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR")
+                .arg(param.sched_priority);
+        } else {
+            // EPERM without CAP_SYS_NICE or an RLIMIT_RTPRIO grant
+            status.degraded = true;
+            effective << QString("real-time refused (%1)").arg(errorText(rc));
+        }
+    }
+
+    // Nice level (per thread on Linux)
+    if (!realtime && config.niceLevel != 0) {
+        const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, tid, config.niceLevel) == 0) {
+            effective << QString("nice %1").arg(config.niceLevel);
+        } else {
+            // Raising priority needs CAP_SYS_NICE or RLIMIT_NICE; keep the default
+            const int error = errno;
+            status.degraded = true;
+            effective << QString("nice %1 (%2)")
+                .arg(getpriority(PRIO_PROCESS, tid))
+                .arg(errorText(error));
+        }
+    }
+#elif defined(Q_OS_WIN)
+    HANDLE thread = GetCurrentThread();
+
+    if (!threadName.isEmpty()) {
+        SetThreadDescription(thread, reinterpret_cast<PCWSTR>(threadName.utf16()));
+    }
+
+    if (!config.cpus.isEmpty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : config.cpus) {
+            if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+                mask |= DWORD_PTR(1) << cpu;
+            }
+        }
+
+        if (mask != 0 && SetThreadAffinityMask(thread, mask) != 0) {
+            effective << QString("cpus %1").arg(cpuList(config.cpus));
+        } else {
+            status.degraded = true;
+            effective << QString("cpus all (error %1)").arg(GetLastError());
+        }
+    }
+
+    const int priority = windowsPriority(config);
+    if (SetThreadPriority(thread, priority)) {
+        effective << QString("thread priority %1").arg(priority);
+    } else {
+        status.degraded = true;
+        effective << QString("thread priority %1 (error %2)")
+            .arg(GetThreadPriority(thread))
+            .arg(GetLastError());
+    }
+#else
+    status.degraded = !config.cpus.isEmpty() || config.niceLevel != 0 ||
+                      config.schedulingClass != SchedulingClass::Normal;
+    effective << "not supported on this platform";
+#endif
+
+    status.effective = effective.isEmpty() ? QStringLiteral("default") : effective.join(", ");
+
+    qInfo() << "Thread policy:" << status.threadName << "as" << roleName(role)
+            << "->" << status.effective << (status.degraded ? "(degraded)" : "");
+
+    QMutexLocker lock(&m_mutex);
+    m_statuses.insert(status.threadName, status);
+    return status;
+}
+
+// ==============================================================================
+// Diagnostics
+// ==============================================================================
+QList<ThreadPolicyStatus> ThreadPolicy::diagnostics() const {
+    QMutexLocker lock(&m_mutex);
+
+    QList<ThreadPolicyStatus> result = m_statuses.values();
+    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+        if (a.role != b.role) return a.role < b.role;
+        return a.threadName < b.threadName;
+    });
+    return result;
+}
+
+QString ThreadPolicy::diagnosticsText() const {
+    QStringList lines;
+    for (const ThreadPolicyStatus& status : diagnostics()) {
+        lines << QString("%1 [%2]: %3%4")
+            .arg(status.threadName)
+            .arg(roleName(status.role))
+            .arg(status.effective)
+            .arg(status.degraded ? QString(" (requested %1)").arg(status.requested) : QString());
+    }
+    return lines.join('\n');
+}
+
+QString ThreadPolicy::roleName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::Render: return "Render";
+        case ThreadRole::Decode: return "Decode";
+        case ThreadRole::Encode: return "Encode";
+        case ThreadRole::Network: return "Network";
+        case ThreadRole::Background: return "Background";
+    }
+    return "Unknown";
+}
+
+QString ThreadPolicy::describe(const ThreadRoleConfig& config) {
+    QStringList parts;
+    if (!config.cpus.isEmpty()) {
+        parts << QString("cpus %1").arg(cpuList(config.cpus));
+    }
+    if (config.schedulingClass == SchedulingClass::Fifo) {
+        parts << QString("SCHED_FIFO %1").arg(config.realtimePriority);
+    } else if (config.schedulingClass == SchedulingClass::RoundRobin) {
+        parts << QString("SCHED_RR %1").arg(config.realtimePriority);
+    }
+    parts << QString("nice %1").arg(config.niceLevel);
+    return parts.join(", ");
+}
+
+} // namespace WeaR
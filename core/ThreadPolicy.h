@@ -0,0 +1,149 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio ThreadPolicy
+// Per-role CPU affinity and scheduling for pipeline threads
+// ==============================================================================
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+
+namespace WeaR {
+
+/**
+ * @brief Role of a pipeline thread
+ */
+enum class ThreadRole {
+    Render = 0,     ///< Compositing (GUI thread) and real-time jobs
+    Decode,         ///< Media decoding ahead of playback
+    Encode,         ///< Video/audio encoding
+    Network,        ///< Stream output
+    Background      ///< Saving, thumbnails and other deferrable work
+};
+
+/**
+ * @brief OS scheduling class requested for a role
+ */
+enum class SchedulingClass {
+    Normal = 0,     ///< Time-sharing, adjusted by niceLevel
+    Fifo,           ///< Real-time SCHED_FIFO
+    RoundRobin      ///< Real-time SCHED_RR
+};
+
+/**
+ * @brief Requested policy of one role
+ */
+struct ThreadRoleConfig {
+    QList<int> cpus;                ///< Allowed CPUs (empty = all)
+    int niceLevel = 0;              ///< -20 (highest) .. 19 (lowest), also the real-time fallback
+    SchedulingClass schedulingClass = SchedulingClass::Normal;
+    int realtimePriority = 0;       ///< 1..99 for Fifo/RoundRobin
+};
+
+/**
+ * @brief Policy actually in effect on one thread
+ */
+struct ThreadPolicyStatus {
+    ThreadRole role = ThreadRole::Background;
+    QString threadName;
+    QString requested;              ///< Human-readable requested policy
+    QString effective;              ///< Human-readable effective policy
+    bool degraded = false;          ///< Part of the request was refused
+};
+
+/**
+ * @brief Applies per-role thread policies
+ *
+ * Each pipeline thread calls applyToCurrentThread() with its role when
+ * it starts. The role's CPU set, nice level and real-time class are
+ * applied where the OS and the process privileges allow:
+ *
+ * - Linux: pthread affinity, per-thread nice and SCHED_FIFO/SCHED_RR.
+ *   Without CAP_SYS_NICE / RLIMIT_RTPRIO the real-time request falls
+ *   back to nice, and a negative nice falls back to the default.
+ * - Windows: thread affinity mask and thread priority levels.
+ *
+ * Every application is recorded, so diagnostics() shows what each
+ * thread actually got.
+ *
+ * By default no role asks for more than normal priority unless the
+ * process is allowed to raise it, so an unprivileged run is not
+ * degraded. Policies can be overridden per role in the application
+ * settings (see loadSettings()).
+ *
+ * Thread-safe Singleton pattern for application-wide access.
+ */
+class ThreadPolicy : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to the ThreadPolicy instance
+     */
+    static ThreadPolicy& instance();
+
+    // Prevent copying
+    ThreadPolicy(const ThreadPolicy&) = delete;
+    ThreadPolicy& operator=(const ThreadPolicy&) = delete;
+
+    ~ThreadPolicy() override;
+
+    /**
+     * @brief Set the policy of a role
+     *
+     * Takes effect for threads that start afterwards.
+     */
+    void setRoleConfig(ThreadRole role, const ThreadRoleConfig& config);
+
+    /**
+     * @brief Get the policy of a role
+     */
+    [[nodiscard]] ThreadRoleConfig roleConfig(ThreadRole role) const;
+
+    /**
+     * @brief Override role policies from the application settings
+     *
+     * Reads the "ThreadPolicy/<role>" groups of QSettings, with the keys
+     * cpus ("0,2,4"), nice, scheduling ("normal", "fifo" or "rr") and
+     * realtimePriority. Missing keys keep the default. Call before the
+     * pipeline threads start.
+     */
+    void loadSettings();
+
+    /**
+     * @brief Apply a role's policy to the calling thread
+     * @param role Role of the thread
+     * @param threadName Name shown in debuggers and diagnostics (empty keeps it)
+     * @return Effective policy
+     */
+    ThreadPolicyStatus applyToCurrentThread(ThreadRole role, const QString& threadName = QString());
+
+    /**
+     * @brief Get the effective policy of every thread that applied one
+     */
+    [[nodiscard]] QList<ThreadPolicyStatus> diagnostics() const;
+
+    /**
+     * @brief Multi-line summary of diagnostics()
+     */
+    [[nodiscard]] QString diagnosticsText() const;
+
+    /**
+     * @brief Get display name of a role
+     */
+    [[nodiscard]] static QString roleName(ThreadRole role);
+
+private:
+    ThreadPolicy(QObject* parent = nullptr);
+
+    static QString describe(const ThreadRoleConfig& config);
+
+    QHash<int, ThreadRoleConfig> m_configs;
+    QHash<QString, ThreadPolicyStatus> m_statuses;  ///< Keyed by thread name
+    mutable QMutex m_mutex;
+};
+
+} // namespace WeaR
@@ -0,0 +1,139 @@
+// ==============================================================================
+// WeaR-studio TileClassifier Implementation
+// ==============================================================================
+
+#include "TileClassifier.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WEAR_TILE_SSE2 1
+#include <emmintrin.h>
+#else
+#define WEAR_TILE_SSE2 0
+#endif
+
+namespace WeaR {
+
+namespace {
+
+constexpr uint32_t kAlphaMask = 0xFF000000u;
+
+/**
+ * @brief AND and OR of a run of pixels
+ *
+ * The alpha byte of the AND is 0xFF only if every pixel is opaque; the
+ * alpha byte of the OR is 0 only if every pixel is transparent.
+ */
+void accumulateScalar(const uint32_t* pixels, int count, uint32_t& all, uint32_t& any) {
+    for (int i = 0; i < count; ++i) {
+        all &= pixels[i];
+        any |= pixels[i];
+    }
+}
+
+#if WEAR_TILE_SSE2
+void accumulate(const uint32_t* pixels, int count, uint32_t& all, uint32_t& any) {
+    __m128i vectorAll = _mm_set1_epi32(-1);
+    __m128i vectorAny = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i + 4));
+        vectorAll = _mm_and_si128(vectorAll, _mm_and_si128(a, b));
+        vectorAny = _mm_or_si128(vectorAny, _mm_or_si128(a, b));
+    }
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+        vectorAll = _mm_and_si128(vectorAll, a);
+        vectorAny = _mm_or_si128(vectorAny, a);
+    }
+
+    alignas(16) uint32_t lanesAll[4];
+    alignas(16) uint32_t lanesAny[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanesAll), vectorAll);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanesAny), vectorAny);
+    for (int lane = 0; lane < 4; ++lane) {
+        all &= lanesAll[lane];
+        any |= lanesAny[lane];
+    }
+
+    accumulateScalar(pixels + i, count - i, all, any);
+}
+#else
+void accumulate(const uint32_t* pixels, int count, uint32_t& all, uint32_t& any) {
+    accumulateScalar(pixels, count, all, any);
+}
+#endif
+
+TileAlpha classifyTile(const QImage& image, const QRect& rect) {
+    uint32_t all = 0xFFFFFFFFu;
+    uint32_t any = 0;
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        const auto* row = reinterpret_cast<const uint32_t*>(image.constScanLine(y)) + rect.x();
+        accumulate(row, rect.width(), all, any);
+
+        // Some alpha and not all opaque: nothing more to learn
+        if ((any & kAlphaMask) != 0 && (all & kAlphaMask) != kAlphaMask) {
+            return TileAlpha::Mixed;
+        }
+    }
+
+    if ((all & kAlphaMask) == kAlphaMask) return TileAlpha::Opaque;
+    if ((any & kAlphaMask) == 0) return TileAlpha::Transparent;
+    return TileAlpha::Mixed;
+}
+
+} // namespace
+
+bool TileClassifier::canClassify(const QImage& image) {
+    switch (image.format()) {
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::shared_ptr<const TileMap> TileClassifier::classify(const QImage& image, int tileSize) {
+    if (image.isNull() || !canClassify(image) || tileSize <= 0) return nullptr;
+
+    auto map = std::make_shared<TileMap>();
+    map->imageSize = image.size();
+    map->tileSize = tileSize;
+    map->columns = (image.width() + tileSize - 1) / tileSize;
+    map->rows = (image.height() + tileSize - 1) / tileSize;
+
+    const size_t count = static_cast<size_t>(map->columns) * map->rows;
+
+    // No alpha channel: opaque without looking at a pixel
+    if (image.format() == QImage::Format_RGB32) {
+        map->tiles.assign(count, TileAlpha::Opaque);
+        map->opaqueTiles = static_cast<int>(count);
+        return map;
+    }
+
+    map->tiles.resize(count);
+    for (int row = 0; row < map->rows; ++row) {
+        for (int column = 0; column < map->columns; ++column) {
+            const TileAlpha alpha = classifyTile(image, map->tileRect(column, row));
+            map->tiles[static_cast<size_t>(row) * map->columns + column] = alpha;
+            if (alpha == TileAlpha::Opaque) {
+                map->opaqueTiles++;
+            } else if (alpha == TileAlpha::Transparent) {
+                map->transparentTiles++;
+            }
+        }
+    }
+    return map;
+}
+
+bool TileClassifier::hasSimd() {
+    return WEAR_TILE_SSE2 != 0;
+}
+
+} // namespace WeaR
@@ -0,0 +1,97 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio TileClassifier
+// Per-tile alpha classification of 32-bit frames
+// ==============================================================================
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace WeaR {
+
+/**
+ * @brief Alpha content of one tile
+ */
+enum class TileAlpha : uint8_t {
+    Transparent,    ///< Every pixel has alpha 0
+    Opaque,         ///< Every pixel has alpha 255
+    Mixed           ///< Anything else
+};
+
+/**
+ * @brief Alpha classification of a frame in square tiles
+ *
+ * Edge tiles are cropped to the frame.
+ */
+struct TileMap {
+    QSize imageSize;
+    int tileSize = 0;
+    int columns = 0;
+    int rows = 0;
+    std::vector<TileAlpha> tiles;   ///< Row-major, columns * rows entries
+    int opaqueTiles = 0;
+    int transparentTiles = 0;
+
+    [[nodiscard]] TileAlpha at(int column, int row) const {
+        return tiles[static_cast<size_t>(row) * columns + column];
+    }
+
+    /**
+     * @brief Frame rectangle covered by a tile
+     */
+    [[nodiscard]] QRect tileRect(int column, int row) const {
+        return QRect(column * tileSize, row * tileSize, tileSize, tileSize)
+            .intersected(QRect(QPoint(0, 0), imageSize));
+    }
+
+    [[nodiscard]] bool isFullyOpaque() const {
+        return opaqueTiles == columns * rows;
+    }
+
+    [[nodiscard]] bool isFullyTransparent() const {
+        return transparentTiles == columns * rows;
+    }
+};
+
+/**
+ * @brief Classifies frames into transparent, opaque and mixed tiles
+ *
+ * Lets the compositor skip fully transparent regions of overlays, copy
+ * opaque regions instead of blending them, and blend only the rest.
+ * RGB32 frames are opaque by definition and are not scanned; ARGB32 and
+ * ARGB32_Premultiplied frames are scanned with SSE2 where available.
+ *
+ * All functions are thread-safe.
+ */
+class TileClassifier {
+public:
+    TileClassifier() = delete;
+
+    static constexpr int kDefaultTileSize = 64;
+
+    /**
+     * @brief Check if a frame's format can be classified
+     */
+    [[nodiscard]] static bool canClassify(const QImage& image);
+
+    /**
+     * @brief Classify a frame
+     * @param image Frame in RGB32, ARGB32 or ARGB32_Premultiplied
+     * @param tileSize Tile edge in pixels
+     * @return Tile map, null for other formats or a null image
+     */
+    [[nodiscard]] static std::shared_ptr<const TileMap> classify(const QImage& image,
+                                                                 int tileSize = kDefaultTileSize);
+
+    /**
+     * @brief Check if the SIMD scan path is compiled in
+     */
+    [[nodiscard]] static bool hasSimd();
+};
+
+} // namespace WeaR
@@ -0,0 +1,618 @@
+// ==============================================================================
+// WeaR-studio YuvCompositor Implementation
+// ==============================================================================
+
+#include "YuvCompositor.h"
+#include "Scene.h"
+#include "SceneItem.h"
+#include "JobSystem.h"
+#include "MemoryGovernor.h"
+#include "QualityGovernor.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// FFmpeg headers (C linkage)
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace WeaR {
+
+namespace {
+
+constexpr int kPlaneAlignment = 32;
+constexpr int kMinBandRows = 128;
+constexpr int kStatsWindow = 60;
+constexpr uint64_t kIdleFrames = 60;    ///< Frames before an unused item's layer is dropped
+
+int alignUp(int value, int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Y, U, V and optional A planes (4:2:0) in one allocation
+ *
+ * Sizes are always even.
+ */
+struct PlaneBuffer {
+    QSize size;
+    bool hasAlpha = false;
+    uint8_t* data[4] = {};
+    int linesize[4] = {};
+    int64_t bytes = 0;
+    MemoryReservation reservation;      ///< Canvases only: accounted while alive
+
+    PlaneBuffer(const QSize& planeSize, bool alpha)
+        : size(planeSize)
+        , hasAlpha(alpha)
+    {
+        const int width = size.width();
+        const int height = size.height();
+        linesize[0] = alignUp(width, kPlaneAlignment);
+        linesize[1] = linesize[2] = alignUp(width / 2, kPlaneAlignment);
+        linesize[3] = alpha ? linesize[0] : 0;
+
+        const size_t lumaBytes = static_cast<size_t>(linesize[0]) * height;
+        const size_t chromaBytes = static_cast<size_t>(linesize[1]) * (height / 2);
+        const size_t total = lumaBytes * (alpha ? 2 : 1) + chromaBytes * 2;
+
+        m_storage.reset(new uint8_t[total + kPlaneAlignment]);
+        const auto address = reinterpret_cast<uintptr_t>(m_storage.get());
+        uint8_t* base = m_storage.get() + (kPlaneAlignment - address % kPlaneAlignment) % kPlaneAlignment;
+
+        data[0] = base;
+        data[1] = base + lumaBytes;
+        data[2] = data[1] + chromaBytes;
+        data[3] = alpha ? data[2] + chromaBytes : nullptr;
+        bytes = static_cast<int64_t>(total);
+    }
+
+private:
+    std::unique_ptr<uint8_t[]> m_storage;
+};
+
+/**
+ * @brief Per-item converted layer, reused across frames
+ */
+struct ItemLayer {
+    std::shared_ptr<PlaneBuffer> buffer;
+    SwsContext* scaler = nullptr;
+    qint64 imageKey = 0;                ///< QImage::cacheKey() of the converted image (0 = none)
+    uint64_t lastUsed = 0;
+
+    ItemLayer() = default;
+    ItemLayer(const ItemLayer&) = delete;
+    ItemLayer& operator=(const ItemLayer&) = delete;
+
+    ~ItemLayer() {
+        if (scaler) {
+            sws_freeContext(scaler);
+        }
+    }
+
+    void ensureBuffer(const QSize& size, bool alpha) {
+        if (!buffer || buffer->size != size || buffer->hasAlpha != alpha) {
+            buffer = std::make_shared<PlaneBuffer>(size, alpha);
+            imageKey = 0;
+        }
+    }
+};
+
+/**
+ * @brief One layer ready to blend
+ */
+struct Layer {
+    QRect target;                       ///< Canvas rectangle (even-aligned)
+    const uint8_t* data[4] = {};        ///< Y, U, V, A (A null = opaque)
+    int linesize[4] = {};
+    int opacity = 256;                  ///< 0-256
+    std::shared_ptr<const void> keepAlive;
+};
+
+/**
+ * @brief Round a rectangle outwards to even coordinates
+ */
+QRect evenRect(const QRectF& rect) {
+    const int left = qRound(rect.left()) & ~1;
+    const int top = qRound(rect.top()) & ~1;
+    const int right = (qRound(rect.right()) + 1) & ~1;
+    const int bottom = (qRound(rect.bottom()) + 1) & ~1;
+    return QRect(left, top, std::max(right - left, 2), std::max(bottom - top, 2));
+}
+
+AVPixelFormat toAVPixelFormat(FramePixelFormat format) {
+    return format == FramePixelFormat::NV12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+}
+
+/**
+ * @brief BT.601 limited-range YUV of a colour composited over black
+ */
+void colourToYuv(const QColor& colour, uint8_t yuv[3]) {
+    const double alpha = colour.alphaF();
+    const double r = colour.redF() * alpha;
+    const double g = colour.greenF() * alpha;
+    const double b = colour.blueF() * alpha;
+
+    yuv[0] = static_cast<uint8_t>(std::lround(16.0 + 65.481 * r + 128.553 * g + 24.966 * b));
+    yuv[1] = static_cast<uint8_t>(std::lround(128.0 - 37.797 * r - 74.203 * g + 112.0 * b));
+    yuv[2] = static_cast<uint8_t>(std::lround(128.0 + 112.0 * r - 93.786 * g - 18.214 * b));
+}
+
+/**
+ * @brief Blend one row: d += (s - d) * a
+ * @param alpha Per-sample alpha (null = opaque)
+ * @param opacity Layer opacity, 0-256
+ */
+void blendRow(uint8_t* dst, const uint8_t* src, const uint8_t* alpha, int width, int opacity) {
+    if (!alpha) {
+        if (opacity >= 256) {
+            std::memcpy(dst, src, width);
+            return;
+        }
+        for (int x = 0; x < width; ++x) {
+            dst[x] = static_cast<uint8_t>(dst[x] + (((src[x] - dst[x]) * opacity) >> 8));
+        }
+        return;
+    }
+
+    for (int x = 0; x < width; ++x) {
+        const int a = ((alpha[x] + (alpha[x] >> 7)) * opacity) >> 8;
+        if (a == 0) continue;
+        dst[x] = static_cast<uint8_t>(dst[x] + (((src[x] - dst[x]) * a) >> 8));
+    }
+}
+
+/**
+ * @brief Blend one chroma row with the alpha of the two luma rows it covers
+ */
+void blendChromaRow(uint8_t* dst, const uint8_t* src, const uint8_t* alpha0,
+                    const uint8_t* alpha1, int width, int opacity) {
+    if (!alpha0) {
+        blendRow(dst, src, nullptr, width, opacity);
+        return;
+    }
+
+    for (int x = 0; x < width; ++x) {
+        const int sum = alpha0[2 * x] + alpha0[2 * x + 1] + alpha1[2 * x] + alpha1[2 * x + 1];
+        const int average = (sum + 2) >> 2;
+        const int a = ((average + (average >> 7)) * opacity) >> 8;
+        if (a == 0) continue;
+        dst[x] = static_cast<uint8_t>(dst[x] + (((src[x] - dst[x]) * a) >> 8));
+    }
+}
+
+/**
+ * @brief Blend the part of a layer inside rows [top, bottom) of the canvas
+ */
+void blendLayer(const Layer& layer, PlaneBuffer& canvas, int top, int bottom) {
+    const QRect clip = layer.target.intersected(
+        QRect(0, top, canvas.size.width(), bottom - top));
+    if (clip.isEmpty()) return;
+
+    // Everything is even-aligned, so chroma offsets are exact halves
+    const int sx = clip.x() - layer.target.x();
+    const int sy = clip.y() - layer.target.y();
+    const int width = clip.width();
+    const uint8_t* alpha = layer.data[3];
+
+    for (int y = 0; y < clip.height(); ++y) {
+        const int row = sy + y;
+        blendRow(canvas.data[0] + (clip.y() + y) * canvas.linesize[0] + clip.x(),
+                 layer.data[0] + row * layer.linesize[0] + sx,
+                 alpha ? alpha + row * layer.linesize[3] + sx : nullptr,
+                 width, layer.opacity);
+    }
+
+    for (int y = 0; y < clip.height() / 2; ++y) {
+        const int row = sy / 2 + y;
+        const int dstRow = clip.y() / 2 + y;
+        const uint8_t* alpha0 = alpha ? alpha + (sy + 2 * y) * layer.linesize[3] + sx : nullptr;
+        const uint8_t* alpha1 = alpha0 ? alpha0 + layer.linesize[3] : nullptr;
+
+        for (int plane = 1; plane <= 2; ++plane) {
+            blendChromaRow(canvas.data[plane] + dstRow * canvas.linesize[plane] + clip.x() / 2,
+                           layer.data[plane] + row * layer.linesize[plane] + sx / 2,
+                           alpha0, alpha1, width / 2, layer.opacity);
+        }
+    }
+}
+
+/**
+ * @brief PSNR of one plane in dB (99 for identical planes)
+ */
+double planePsnr(const uint8_t* a, int aStride, const uint8_t* b, int bStride, int width, int height) {
+    double sum = 0.0;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* rowA = a + y * aStride;
+        const uint8_t* rowB = b + y * bStride;
+        for (int x = 0; x < width; ++x) {
+            const int diff = rowA[x] - rowB[x];
+            sum += diff * diff;
+        }
+    }
+    if (sum == 0.0) return 99.0;
+
+    const double mse = sum / (static_cast<double>(width) * height);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+} // namespace
+
+// ==============================================================================
+// YuvCompositor Private Implementation
+// ==============================================================================
+struct YuvCompositor::Impl {
+    int slotCount = 6;
+    std::vector<std::shared_ptr<PlaneBuffer>> canvases;
+    QHash<const SceneItem*, std::shared_ptr<ItemLayer>> itemLayers;
+    SwsContext* referenceScaler = nullptr;
+    uint64_t frameCounter = 0;
+
+    YuvCompositorStatistics stats;
+    std::deque<double> compositeTimes;
+
+    ~Impl() {
+        if (referenceScaler) {
+            sws_freeContext(referenceScaler);
+        }
+    }
+
+    std::shared_ptr<PlaneBuffer> acquireCanvas(const QSize& size) {
+        // Free canvases of another size are of no further use
+        canvases.erase(std::remove_if(canvases.begin(), canvases.end(),
+            [&](const std::shared_ptr<PlaneBuffer>& canvas) {
+                return canvas.use_count() == 1 && canvas->size != size;
+            }), canvases.end());
+
+        for (const auto& canvas : canvases) {
+            if (canvas.use_count() == 1) {
+                return canvas;
+            }
+        }
+
+        // All slots still held by the encoder or preview: allocate, and
+        // only keep the canvas if the pool has room
+        auto canvas = std::make_shared<PlaneBuffer>(size, false);
+
+        // Canvases travel to the encoder by reference, so they are the
+        // frame memory of the YUV path; accounted while any holder keeps
+        // them, never shed
+        static const int memoryStage = MemoryGovernor::instance().registerStage(
+            QStringLiteral("YUV canvases"), MemoryClass::StreamFrames);
+        if (MemoryGovernor::instance().reserve(memoryStage, canvas->bytes)) {
+            canvas->reservation = MemoryReservation(memoryStage, canvas->bytes);
+        }
+
+        if (static_cast<int>(canvases.size()) < slotCount) {
+            canvases.push_back(canvas);
+        }
+        return canvas;
+    }
+
+    std::shared_ptr<ItemLayer> itemLayer(const SceneItem* item) {
+        std::shared_ptr<ItemLayer>& layer = itemLayers[item];
+        if (!layer) {
+            layer = std::make_shared<ItemLayer>();
+        }
+        layer->lastUsed = frameCounter;
+        return layer;
+    }
+
+    static void useBuffer(const std::shared_ptr<ItemLayer>& state, Layer& layer) {
+        const PlaneBuffer& buffer = *state->buffer;
+        for (int i = 0; i < 4; ++i) {
+            layer.data[i] = buffer.data[i];
+            layer.linesize[i] = buffer.linesize[i];
+        }
+        layer.keepAlive = state->buffer;
+    }
+
+    bool preparePlanar(const SceneItem* item, const PlanarFrame& planes, Layer& layer,
+                       std::vector<std::function<void()>>& conversions, int flags) {
+        // Already in the canvas layout: blend straight from the source
+        if (planes.format == FramePixelFormat::I420 && planes.size == layer.target.size()) {
+            for (int i = 0; i < 3; ++i) {
+                layer.data[i] = planes.data[i];
+                layer.linesize[i] = planes.linesize[i];
+            }
+            layer.keepAlive = planes.owner;
+            return true;
+        }
+
+        std::shared_ptr<ItemLayer> state = itemLayer(item);
+        state->ensureBuffer(layer.target.size(), false);
+        state->imageKey = 0;
+        useBuffer(state, layer);
+
+        conversions.push_back([state, planes, flags]() {
+            PlaneBuffer& buffer = *state->buffer;
+            state->scaler = sws_getCachedContext(
+                state->scaler,
+                planes.size.width(), planes.size.height(), toAVPixelFormat(planes.format),
+                buffer.size.width(), buffer.size.height(), AV_PIX_FMT_YUV420P,
+                flags, nullptr, nullptr, nullptr
+            );
+            if (!state->scaler) {
+                qWarning() << "Failed to create YUV layer scaler";
+                return;
+            }
+
+            const uint8_t* src[4] = { planes.data[0], planes.data[1], planes.data[2], nullptr };
+            const int srcStride[4] = { planes.linesize[0], planes.linesize[1], planes.linesize[2], 0 };
+            sws_scale(state->scaler, src, srcStride, 0, planes.size.height(),
+                      buffer.data, buffer.linesize);
+        });
+        return true;
+    }
+
+    bool prepareImage(const SceneItem* item, const QImage& image, Layer& layer,
+                      std::vector<std::function<void()>>& conversions, int flags) {
+        if (image.isNull()) return false;
+
+        const bool alpha = image.hasAlphaChannel();
+        std::shared_ptr<ItemLayer> state = itemLayer(item);
+        state->ensureBuffer(layer.target.size(), alpha);
+        useBuffer(state, layer);
+
+        // Same image at the same size: the converted planes are still valid
+        if (state->imageKey == image.cacheKey()) {
+            stats.layerCacheHits++;
+            return true;
+        }
+        stats.layerCacheMisses++;
+        state->imageKey = image.cacheKey();
+
+        conversions.push_back([state, image, alpha, flags]() {
+            // The scaler takes straight BGRA; premultiplied and other
+            // formats are converted once, here, on a cache miss
+            QImage source = image;
+            const QImage::Format packed = alpha ? QImage::Format_ARGB32 : QImage::Format_RGB32;
+            if (source.format() != packed) {
+                source = source.convertToFormat(packed);
+            }
+
+            PlaneBuffer& buffer = *state->buffer;
+            state->scaler = sws_getCachedContext(
+                state->scaler,
+                source.width(), source.height(), AV_PIX_FMT_BGRA,
+                buffer.size.width(), buffer.size.height(),
+                alpha ? AV_PIX_FMT_YUVA420P : AV_PIX_FMT_YUV420P,
+                flags, nullptr, nullptr, nullptr
+            );
+            if (!state->scaler) {
+                qWarning() << "Failed to create RGB layer scaler";
+                state->imageKey = 0;
+                return;
+            }
+
+            const uint8_t* src[4] = { source.constBits(), nullptr, nullptr, nullptr };
+            const int srcStride[4] = { static_cast<int>(source.bytesPerLine()), 0, 0, 0 };
+            sws_scale(state->scaler, src, srcStride, 0, source.height(),
+                      buffer.data, buffer.linesize);
+        });
+        return true;
+    }
+
+    void dropIdleLayers() {
+        for (auto it = itemLayers.begin(); it != itemLayers.end();) {
+            if (frameCounter - it.value()->lastUsed > kIdleFrames) {
+                it = itemLayers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        int64_t bytes = 0;
+        for (const auto& layer : itemLayers) {
+            if (layer->buffer) bytes += layer->buffer->bytes;
+        }
+        stats.cachedLayerBytes = bytes;
+    }
+
+    void recordCompositeTime(double ms) {
+        compositeTimes.push_back(ms);
+        if (compositeTimes.size() > static_cast<size_t>(kStatsWindow)) {
+            compositeTimes.pop_front();
+        }
+
+        double sum = 0;
+        for (double t : compositeTimes) sum += t;
+        stats.averageCompositeMs = sum / compositeTimes.size();
+    }
+};
+
+// ==============================================================================
+// YuvCompositor
+// ==============================================================================
+YuvCompositor::YuvCompositor(int slotCount)
+    : m_impl(std::make_unique<Impl>())
+{
+    m_impl->slotCount = std::max(slotCount, 1);
+}
+
+YuvCompositor::~YuvCompositor() = default;
+
+bool YuvCompositor::canComposite(const Scene* scene, QString* reason) {
+    auto fail = [reason](const QString& what) {
+        if (reason) *reason = what;
+        return false;
+    };
+
+    if (!scene) return fail(QStringLiteral("no scene"));
+
+    for (const SceneItem* item : scene->items()) {
+        if (!item->isVisible()) continue;
+
+        const ItemTransform transform = item->transform();
+        if (std::fmod(transform.rotation, 360.0) != 0.0) {
+            return fail(QStringLiteral("rotated item '%1'").arg(item->name()));
+        }
+        if (transform.flipH || transform.flipV ||
+            transform.scale.x() <= 0.0 || transform.scale.y() <= 0.0) {
+            return fail(QStringLiteral("flipped item '%1'").arg(item->name()));
+        }
+        if (item->blendMode() != BlendMode::Normal) {
+            return fail(QStringLiteral("blend mode on item '%1'").arg(item->name()));
+        }
+    }
+    return true;
+}
+
+PlanarFrame YuvCompositor::composite(const Scene* scene) {
+    if (!canComposite(scene)) return PlanarFrame();
+
+    const QSize size(scene->resolution().width() & ~1, scene->resolution().height() & ~1);
+    if (size.isEmpty()) return PlanarFrame();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Impl& d = *m_impl;
+    d.frameCounter++;
+
+    std::shared_ptr<PlaneBuffer> canvas = d.acquireCanvas(size);
+    const QRect bounds(QPoint(0, 0), size);
+    const int flags = QualityGovernor::instance().smoothScaling() ? SWS_BILINEAR : SWS_FAST_BILINEAR;
+
+    // Pull every source once, on this thread; conversions and bands run
+    // on the job system
+    Scene::RenderScope scope(scene);
+    std::vector<Layer> layers;
+    std::vector<std::function<void()>> conversions;
+
+    for (const SceneItem* item : scene->itemsIntersecting(QRectF(bounds))) {
+        if (!item->isVisible()) continue;
+
+        const ItemTransform transform = item->transform();
+        Layer layer;
+        layer.target = evenRect(transform.toQTransform().mapRect(
+            QRectF(QPointF(0, 0), transform.size)));
+        layer.opacity = qRound(std::clamp(transform.opacity, 0.0, 1.0) * 256);
+        if (layer.opacity == 0 || transform.size.isEmpty() || !layer.target.intersects(bounds)) {
+            continue;
+        }
+
+        const VideoFrame frame = item->currentVideoFrame();
+        const bool prepared = frame.isPlanar()
+            ? d.preparePlanar(item, frame.planes, layer, conversions, flags)
+            : d.prepareImage(item, frame.softwareFrame, layer, conversions, flags);
+        if (prepared) {
+            layers.push_back(std::move(layer));
+        }
+    }
+
+    JobSystem& jobs = JobSystem::instance();
+    jobs.parallelFor(static_cast<int>(conversions.size()), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            conversions[i]();
+        }
+    }, 1, JobPriority::RealTime);
+
+    uint8_t background[3];
+    colourToYuv(scene->backgroundColor(), background);
+
+    const int height = size.height();
+    const int bandCount = std::clamp(height / kMinBandRows, 1, jobs.workerCount() + 1);
+
+    // Bands start on even rows so every chroma row belongs to one band
+    jobs.parallelFor(bandCount, [&](int begin, int end) {
+        for (int band = begin; band < end; ++band) {
+            const int top = (band * height / bandCount) & ~1;
+            const int bottom = band + 1 == bandCount ? height : ((band + 1) * height / bandCount) & ~1;
+
+            for (int y = top; y < bottom; ++y) {
+                std::memset(canvas->data[0] + y * canvas->linesize[0], background[0], size.width());
+            }
+            for (int y = top / 2; y < bottom / 2; ++y) {
+                std::memset(canvas->data[1] + y * canvas->linesize[1], background[1], size.width() / 2);
+                std::memset(canvas->data[2] + y * canvas->linesize[2], background[2], size.width() / 2);
+            }
+
+            for (const Layer& layer : layers) {
+                blendLayer(layer, *canvas, top, bottom);
+            }
+        }
+    }, 1, JobPriority::RealTime);
+
+    d.dropIdleLayers();
+    d.stats.framesComposited++;
+    d.recordCompositeTime(timer.nsecsElapsed() / 1e6);
+
+    PlanarFrame frame;
+    frame.format = FramePixelFormat::I420;
+    frame.size = size;
+    for (int i = 0; i < 3; ++i) {
+        frame.data[i] = canvas->data[i];
+        frame.linesize[i] = canvas->linesize[i];
+    }
+    frame.owner = canvas;
+    return frame;
+}
+
+CompositorComparison YuvCompositor::compareWithRgb(const Scene* scene) {
+    CompositorComparison result;
+    if (!canComposite(scene)) return result;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // RGB path: composite, then convert the way the encoder does
+    const QImage rgb = scene->render();
+    const QSize size(rgb.width() & ~1, rgb.height() & ~1);
+    if (size.isEmpty()) return result;
+
+    PlaneBuffer reference(size, false);
+    Impl& d = *m_impl;
+    d.referenceScaler = sws_getCachedContext(
+        d.referenceScaler,
+        size.width(), size.height(), AV_PIX_FMT_BGRA,
+        size.width(), size.height(), AV_PIX_FMT_YUV420P,
+        SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (!d.referenceScaler) {
+        qWarning() << "Failed to create reference scaler";
+        return result;
+    }
+
+    const uint8_t* src[4] = { rgb.constBits(), nullptr, nullptr, nullptr };
+    const int srcStride[4] = { static_cast<int>(rgb.bytesPerLine()), 0, 0, 0 };
+    sws_scale(d.referenceScaler, src, srcStride, 0, size.height(),
+              reference.data, reference.linesize);
+    result.rgbMs = timer.nsecsElapsed() / 1e6;
+
+    timer.restart();
+    const PlanarFrame yuv = composite(scene);
+    result.yuvMs = timer.nsecsElapsed() / 1e6;
+    if (!yuv.isValid() || yuv.size != size) return result;
+
+    result.psnrY = planePsnr(yuv.data[0], yuv.linesize[0], reference.data[0], reference.linesize[0],
+                             size.width(), size.height());
+    result.psnrU = planePsnr(yuv.data[1], yuv.linesize[1], reference.data[1], reference.linesize[1],
+                             size.width() / 2, size.height() / 2);
+    result.psnrV = planePsnr(yuv.data[2], yuv.linesize[2], reference.data[2], reference.linesize[2],
+                             size.width() / 2, size.height() / 2);
+    result.valid = true;
+    return result;
+}
+
+YuvCompositorStatistics YuvCompositor::statistics() const {
+    return m_impl->stats;
+}
+
+void YuvCompositor::clearCache() {
+    m_impl->itemLayers.clear();
+    m_impl->canvases.clear();
+    m_impl->stats.cachedLayerBytes = 0;
+}
+
+} // namespace WeaR
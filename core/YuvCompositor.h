@@ -0,0 +1,115 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio YuvCompositor
+// Scene compositing directly into I420 planes for the encoder
+// ==============================================================================
+
+#include "ISource.h"
+
+#include <QString>
+
+#include <memory>
+#include <cstdint>
+
+namespace WeaR {
+
+class Scene;
+
+/**
+ * @brief YUV compositor statistics
+ */
+struct YuvCompositorStatistics {
+    int64_t framesComposited = 0;   ///< Frames produced
+    int64_t layerCacheHits = 0;     ///< RGB layers reused from the previous frame
+    int64_t layerCacheMisses = 0;   ///< RGB layers converted to YUVA
+    int64_t cachedLayerBytes = 0;   ///< Bytes held by converted item layers
+    double averageCompositeMs = 0.0; ///< Average composite time (last 60 frames)
+};
+
+/**
+ * @brief Result of compositing one frame both ways
+ */
+struct CompositorComparison {
+    bool valid = false;             ///< Both paths produced a frame
+    double rgbMs = 0.0;             ///< RGB composite plus RGB to I420 conversion
+    double yuvMs = 0.0;             ///< YUV composite
+    double psnrY = 0.0;             ///< dB, YUV result against the converted RGB result
+    double psnrU = 0.0;
+    double psnrV = 0.0;
+};
+
+/**
+ * @brief Composites a scene into an I420 canvas
+ *
+ * The RGB path composites in ARGB and the encoder converts the result to
+ * YUV, so YUV sources (camera, media, capture) are converted twice. This
+ * compositor blends every layer straight into Y, U and V planes:
+ *
+ * - Planar sources are scaled/re-laid out in YUV, or used as-is when
+ *   they already are I420 at the target size
+ * - RGB layers (images, text, nested scenes) are converted to YUVA and
+ *   kept per item until the image or its size changes, so static layers
+ *   cost only the blend
+ * - Alpha is applied per luma sample and averaged per 2x2 block for
+ *   chroma; layer rectangles are aligned to even coordinates
+ * - Bands of rows are blended concurrently on the job system
+ *
+ * Rotation, flips and non-normal blend modes are not supported; use
+ * canComposite() and fall back to the RGB path for such scenes.
+ * Colour conversion uses BT.601 limited range, like the encoder's scaler.
+ *
+ * Canvases come from a small pool and are handed out as PlanarFrames
+ * that keep their buffer alive, so they can go to the encoder directly.
+ * Not thread-safe; use from the render thread.
+ */
+class YuvCompositor {
+public:
+    /**
+     * @brief Create a compositor
+     * @param slotCount Pooled canvases
+     */
+    explicit YuvCompositor(int slotCount = 6);
+    ~YuvCompositor();
+
+    YuvCompositor(const YuvCompositor&) = delete;
+    YuvCompositor& operator=(const YuvCompositor&) = delete;
+
+    /**
+     * @brief Check if every visible item of a scene can be composited in YUV
+     * @param scene Scene to check
+     * @param reason Receives the first unsupported feature (optional)
+     */
+    [[nodiscard]] static bool canComposite(const Scene* scene, QString* reason = nullptr);
+
+    /**
+     * @brief Composite a scene
+     * @param scene Scene to composite
+     * @return I420 frame at the scene resolution (rounded down to even),
+     *         invalid if the scene is not supported
+     */
+    [[nodiscard]] PlanarFrame composite(const Scene* scene);
+
+    /**
+     * @brief Composite a scene with both compositors and compare
+     *
+     * The RGB result is converted to I420 the way the encoder would, and
+     * the YUV result is measured against it.
+     */
+    [[nodiscard]] CompositorComparison compareWithRgb(const Scene* scene);
+
+    /**
+     * @brief Get statistics
+     */
+    [[nodiscard]] YuvCompositorStatistics statistics() const;
+
+    /**
+     * @brief Drop converted layers and pooled canvases
+     */
+    void clearCache();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace WeaR
@@ -82,6 +82,7 @@ QWidget* ColorSourcePlugin::settingsWidget() {
             colorButton->setStyleSheet(
                 QString("background-color: %1").arg(newColor.name())
             );
+            if (m_host) m_host->notifySourceSettingsChanged(this);
         }
     });
     
@@ -91,6 +92,7 @@ QWidget* ColorSourcePlugin::settingsWidget() {
     
     QObject::connect(animatedCheck, &QCheckBox::toggled, [this](bool checked) {
         setAnimated(checked);
+        if (m_host) m_host->notifySourceSettingsChanged(this);
     });
     
     layout->addWidget(new QLabel("Color Source Settings"));
@@ -130,6 +132,7 @@ bool ColorSourcePlugin::start() {
 
 void ColorSourcePlugin::stop() {
     m_running = false;
+    m_cropView.clear();
 }
 
 VideoFrame ColorSourcePlugin::captureVideoFrame() {
@@ -147,9 +150,11 @@ VideoFrame ColorSourcePlugin::captureVideoFrame() {
     frame.softwareFrame = m_currentFrame;
     frame.isHardwareFrame = false;
     frame.timestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+    frame.hasTimestamp = true;
     frame.frameNumber = m_frameNumber++;
     
-    return frame;
+    // Region of interest is a zero-copy view into the generated frame
+    return m_cropView.crop(frame, m_config.captureRegion);
 }
 
 QSize ColorSourcePlugin::nativeResolution() const {
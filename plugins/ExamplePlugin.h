@@ -6,6 +6,7 @@
 
 #include <IPlugin.h>
 #include <ISource.h>
+#include <IPluginHost.h>
 
 #include <QObject>
 #include <QtPlugin>
@@ -40,6 +41,7 @@ public:
     [[nodiscard]] PluginType type() const override { return PluginType::Source; }
     [[nodiscard]] PluginCapability capabilities() const override;
     
+    void attachHost(IPluginHost* host) override { m_host = host; }
     bool initialize() override;
     void shutdown() override;
     [[nodiscard]] bool isActive() const override { return m_initialized; }
@@ -91,6 +93,7 @@ public:
 private:
     void generateFrame();
     
+    IPluginHost* m_host = nullptr;
     bool m_initialized = false;
     bool m_running = false;
     QString m_lastError;
@@ -100,6 +103,7 @@ private:
     bool m_animated = false;
     
     QImage m_currentFrame;
+    CroppedViewCache m_cropView;
     int64_t m_frameNumber = 0;
     float m_hue = 0.0f;
 };
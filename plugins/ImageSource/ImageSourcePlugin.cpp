@@ -0,0 +1,299 @@
+// ==============================================================================
+// WeaR-studio Image Source Plugin Implementation
+// ==============================================================================
+
+#include "ImageSourcePlugin.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QFileDialog>
+
+namespace WeaR {
+
+ImageSourcePlugin::ImageSourcePlugin(QObject* parent)
+    : QObject(parent)
+{
+    // Default configuration
+    m_config.resolution = QSize(1920, 1080);
+    m_config.fps = 30.0;
+}
+
+ImageSourcePlugin::~ImageSourcePlugin() {
+    shutdown();
+}
+
+// ==============================================================================
+// IPlugin Interface
+// ==============================================================================
+PluginInfo ImageSourcePlugin::info() const {
+    return PluginInfo{
+        .id = QStringLiteral("wear.source.image"),
+        .name = QStringLiteral("Image Source"),
+        .description = QStringLiteral("Shows still images and animated image sequences"),
+        .version = QStringLiteral("0.1"),
+        .author = QStringLiteral("WeaR-studio"),
+        .website = QStringLiteral("https://github.com/wear-studio"),
+        .type = PluginType::Source,
+        .capabilities = capabilities()
+    };
+}
+
+PluginCapability ImageSourcePlugin::capabilities() const {
+    return PluginCapability::HasVideo
+         | PluginCapability::HasSettings
+         | PluginCapability::HasPreview
+         | PluginCapability::SupportsAsync;
+}
+
+bool ImageSourcePlugin::initialize() {
+    if (!m_host) {
+        m_lastError = "No plugin host (the image cache lives in the application)";
+        qWarning() << "Image source:" << m_lastError;
+        return false;
+    }
+    m_initialized = true;
+    return true;
+}
+
+void ImageSourcePlugin::shutdown() {
+    stop();
+    m_initialized = false;
+}
+
+QWidget* ImageSourcePlugin::settingsWidget() {
+    QWidget* widget = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(widget);
+
+    // File selection
+    QHBoxLayout* fileLayout = new QHBoxLayout();
+    QLineEdit* pathEdit = new QLineEdit(filePath());
+    pathEdit->setReadOnly(true);
+    QPushButton* browseButton = new QPushButton("Browse...");
+
+    QObject::connect(browseButton, &QPushButton::clicked, [this, pathEdit]() {
+        QString path = QFileDialog::getOpenFileName(
+            nullptr, "Select Image", QString(),
+            "Images (*.png *.jpg *.jpeg *.bmp *.gif *.apng *.webp);;All Files (*)"
+        );
+        if (!path.isEmpty()) {
+            setFilePath(path);
+            pathEdit->setText(path);
+            if (m_host) m_host->notifySourceSettingsChanged(this);
+        }
+    });
+
+    fileLayout->addWidget(pathEdit);
+    fileLayout->addWidget(browseButton);
+
+    layout->addWidget(new QLabel("Image Source Settings"));
+    layout->addLayout(fileLayout);
+    layout->addStretch();
+
+    return widget;
+}
+
+// ==============================================================================
+// ISource Interface
+// ==============================================================================
+bool ImageSourcePlugin::configure(const SourceConfig& config) {
+    const bool pathChanged = m_filePath.isEmpty() && config.deviceId != m_config.deviceId;
+    m_config = config;
+
+    if (pathChanged) {
+        refreshKey();
+    }
+    return true;
+}
+
+bool ImageSourcePlugin::start() {
+    if (m_running) return true;
+
+    if (!m_initialized) {
+        if (!initialize()) {
+            return false;
+        }
+    }
+
+    refreshKey();
+    if (!m_key.isValid()) {
+        m_lastError = QString("Image file not found: %1").arg(filePath());
+        qWarning() << "Image source:" << m_lastError;
+        return false;
+    }
+
+    m_frameIndex = 0;
+    m_loopsPlayed = 0;
+    m_nextFrameMs = m_sequence.delayMs(0);
+    m_frameNumber = 0;
+    m_clock.start();
+
+    // Usually a cache hit; otherwise the first frame decodes in the background
+    m_currentImage = QImage();
+    showImage(m_host->lookupImage(m_key, 0));
+    if (m_sequence.isAnimated()) {
+        m_host->prefetchImage(m_key, 1);
+    }
+
+    m_running = true;
+    return true;
+}
+
+void ImageSourcePlugin::stop() {
+    m_running = false;
+
+    // The decoded frames stay in the shared cache for the next activation
+    m_currentImage = QImage();
+    m_cropView.clear();
+}
+
+VideoFrame ImageSourcePlugin::captureVideoFrame() {
+    VideoFrame frame;
+    if (!m_running) return frame;
+
+    // Pick up edits to the file on disk without stat'ing every frame
+    if (m_keyAge.hasExpired(kKeyRefreshMs)) {
+        refreshKey();
+    }
+
+    if (m_sequence.isAnimated()) {
+        advanceSequence();
+    }
+
+    // Keep the previous frame until the wanted one is decoded
+    showImage(m_host->lookupImage(m_key, m_frameIndex));
+
+    if (m_currentImage.isNull()) return frame;
+
+    frame.softwareFrame = m_currentImage;
+    frame.isHardwareFrame = false;
+    frame.timestamp = m_shownTimestamp;
+    frame.hasTimestamp = true;
+    frame.frameNumber = m_shownFrameNumber;
+
+    // Region of interest is a zero-copy view into the cached image, the
+    // same view for as long as the image is unchanged
+    return m_cropView.crop(frame, m_config.captureRegion);
+}
+
+void ImageSourcePlugin::showImage(const QImage& image) {
+    if (image.isNull() || image.cacheKey() == m_currentImage.cacheKey()) return;
+
+    // A still keeps one frame number and timestamp however often it is
+    // captured; only a new picture counts as a new frame downstream
+    m_currentImage = image;
+    m_shownFrameNumber = m_frameNumber++;
+    m_shownTimestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+}
+
+QSize ImageSourcePlugin::nativeResolution() const {
+    if (m_targetSize.isValid()) return m_targetSize;
+    if (m_sequence.nativeSize.isValid()) return m_sequence.nativeSize;
+    return m_config.resolution;
+}
+
+double ImageSourcePlugin::nativeFps() const {
+    if (!m_sequence.isAnimated()) return m_config.fps;
+    return 1000.0 / m_sequence.delayMs(m_frameIndex);
+}
+
+QSize ImageSourcePlugin::outputResolution() const {
+    return nativeResolution();
+}
+
+// ==============================================================================
+// Image Source Specific API
+// ==============================================================================
+void ImageSourcePlugin::setFilePath(const QString& path) {
+    if (m_filePath == path) return;
+    m_filePath = path;
+    refreshKey();
+
+    m_frameIndex = 0;
+    m_loopsPlayed = 0;
+    m_nextFrameMs = m_clock.isValid() ? m_clock.elapsed() + m_sequence.delayMs(0) : 0;
+}
+
+QString ImageSourcePlugin::filePath() const {
+    return m_filePath.isEmpty() ? m_config.deviceId : m_filePath;
+}
+
+QVariantMap ImageSourcePlugin::saveSettings() const {
+    QVariantMap settings;
+    settings.insert(QStringLiteral("file"), filePath());
+    if (m_targetSize.isValid()) {
+        settings.insert(QStringLiteral("targetWidth"), m_targetSize.width());
+        settings.insert(QStringLiteral("targetHeight"), m_targetSize.height());
+    }
+    return settings;
+}
+
+bool ImageSourcePlugin::loadSettings(const QVariantMap& settings) {
+    if (settings.contains(QStringLiteral("file"))) {
+        setFilePath(settings.value(QStringLiteral("file")).toString());
+    }
+    if (settings.contains(QStringLiteral("targetWidth"))) {
+        setTargetSize(QSize(settings.value(QStringLiteral("targetWidth")).toInt(),
+                            settings.value(QStringLiteral("targetHeight")).toInt()));
+    }
+    return true;
+}
+
+void ImageSourcePlugin::setTargetSize(const QSize& size) {
+    if (m_targetSize == size) return;
+    m_targetSize = size;
+    refreshKey();
+}
+
+void ImageSourcePlugin::refreshKey() {
+    m_keyAge.start();
+
+    ImageKey key = ImageCache::keyFor(filePath(), m_targetSize);
+    if (key.path == m_key.path && key.modifiedMs == m_key.modifiedMs &&
+        key.targetSize == m_key.targetSize) {
+        return;
+    }
+
+    m_key = key;
+    if (m_key.isValid() && m_host) {
+        m_sequence = m_host->imageSequenceInfo(m_key);
+    } else {
+        m_sequence = ImageSequenceInfo();
+    }
+
+    if (m_frameIndex >= m_sequence.frameCount) {
+        m_frameIndex = 0;
+    }
+}
+
+void ImageSourcePlugin::advanceSequence() {
+    const int64_t now = m_clock.elapsed();
+    if (now < m_nextFrameMs) return;
+
+    // Delays are learned as frames decode
+    m_sequence = m_host->imageSequenceInfo(m_key);
+
+    // Catch up on frames missed while the render loop was stalled
+    while (now >= m_nextFrameMs) {
+        if (m_frameIndex + 1 >= m_sequence.frameCount) {
+            // loopCount: -1 forever, otherwise number of extra repetitions
+            if (m_sequence.loopCount >= 0 && m_loopsPlayed >= m_sequence.loopCount) {
+                m_nextFrameMs = INT64_MAX;
+                return;
+            }
+            ++m_loopsPlayed;
+            m_frameIndex = 0;
+        } else {
+            ++m_frameIndex;
+        }
+        m_nextFrameMs += m_sequence.delayMs(m_frameIndex);
+    }
+
+    m_host->prefetchImage(m_key, m_frameIndex + 1);
+}
+
+} // namespace WeaR
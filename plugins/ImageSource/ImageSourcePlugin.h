@@ -0,0 +1,138 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio Image Source Plugin
+// Still images and animated image sequences (PNG, JPEG, GIF, APNG, WebP)
+// ==============================================================================
+
+#include <IPlugin.h>
+#include <ISource.h>
+#include <IPluginHost.h>
+#include <ImageCache.h>
+
+#include <QObject>
+#include <QtPlugin>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QWidget>
+
+namespace WeaR {
+
+/**
+ * @brief Image source plugin - shows a still image or animation
+ *
+ * Decoded frames come from the application's ImageCache (through the
+ * plugin host), so the same file used by several items or scenes is
+ * decoded once, and re-activating the
+ * source does not decode it again. captureVideoFrame() never blocks: it
+ * keeps showing the previous frame until the next one is decoded, and
+ * prefetches upcoming frames of a sequence in the background.
+ */
+class ImageSourcePlugin : public QObject, public ISource {
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID WEAR_SOURCE_IID FILE "ImageSourcePlugin.json")
+    Q_INTERFACES(WeaR::ISource)
+
+public:
+    explicit ImageSourcePlugin(QObject* parent = nullptr);
+    ~ImageSourcePlugin() override;
+
+    // =========================================================================
+    // IPlugin Interface
+    // =========================================================================
+    [[nodiscard]] PluginInfo info() const override;
+    [[nodiscard]] QString name() const override { return QStringLiteral("Image Source"); }
+    [[nodiscard]] QString version() const override { return QStringLiteral("0.1"); }
+    [[nodiscard]] PluginType type() const override { return PluginType::Source; }
+    [[nodiscard]] PluginCapability capabilities() const override;
+
+    void attachHost(IPluginHost* host) override { m_host = host; }
+    bool initialize() override;
+    void shutdown() override;
+    [[nodiscard]] bool isActive() const override { return m_initialized; }
+
+    QWidget* settingsWidget() override;
+    [[nodiscard]] QString lastError() const override { return m_lastError; }
+
+    // =========================================================================
+    // ISource Interface
+    // =========================================================================
+    bool configure(const SourceConfig& config) override;
+    [[nodiscard]] SourceConfig config() const override { return m_config; }
+
+    bool start() override;
+    void stop() override;
+    [[nodiscard]] bool isRunning() const override { return m_running; }
+
+    [[nodiscard]] VideoFrame captureVideoFrame() override;
+
+    [[nodiscard]] QSize nativeResolution() const override;
+    [[nodiscard]] double nativeFps() const override;
+    [[nodiscard]] QSize outputResolution() const override;
+    [[nodiscard]] double outputFps() const override { return nativeFps(); }
+
+    [[nodiscard]] QVariantMap saveSettings() const override;
+    bool loadSettings(const QVariantMap& settings) override;
+
+    // =========================================================================
+    // Image Source Specific API
+    // =========================================================================
+
+    /**
+     * @brief Set the image file
+     *
+     * SourceConfig::deviceId is used as the file path if this is never called.
+     */
+    void setFilePath(const QString& path);
+
+    /**
+     * @brief Get the image file path
+     */
+    [[nodiscard]] QString filePath() const;
+
+    /**
+     * @brief Set the decode size (invalid = native size)
+     *
+     * Decoding at the displayed size keeps large images from occupying
+     * the cache at full resolution.
+     */
+    void setTargetSize(const QSize& size);
+
+    /**
+     * @brief Get the decode size
+     */
+    [[nodiscard]] QSize targetSize() const { return m_targetSize; }
+
+private:
+    void refreshKey();
+    void advanceSequence();
+    void showImage(const QImage& image);
+
+    IPluginHost* m_host = nullptr;
+    bool m_initialized = false;
+    bool m_running = false;
+    QString m_lastError;
+
+    SourceConfig m_config;
+    QString m_filePath;
+    QSize m_targetSize;
+
+    // Cache lookup state
+    ImageKey m_key;
+    ImageSequenceInfo m_sequence;
+    QElapsedTimer m_keyAge;             ///< Time since the file was last stat'ed
+
+    // Playback
+    QImage m_currentImage;
+    CroppedViewCache m_cropView;        ///< Region view of m_currentImage
+    int m_frameIndex = 0;
+    int m_loopsPlayed = 0;
+    int64_t m_nextFrameMs = 0;          ///< Playback time the next frame is due
+    QElapsedTimer m_clock;
+    int64_t m_frameNumber = 0;          ///< Number of the next new picture
+    int64_t m_shownFrameNumber = 0;     ///< Number of m_currentImage
+    int64_t m_shownTimestamp = 0;       ///< Time m_currentImage was first shown (us)
+
+    static constexpr int kKeyRefreshMs = 1000;
+};
+
+} // namespace WeaR
@@ -0,0 +1,1009 @@
+// ==============================================================================
+// WeaR-studio Media Source Plugin Implementation
+// ==============================================================================
+
+#include "MediaSourcePlugin.h"
+#include "ThreadPolicy.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QFileDialog>
+
+// FFmpeg headers (C linkage)
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/channel_layout.h>
+#include <libswscale/swscale.h>
+#include <libswresample/swresample.h>
+}
+
+#include <algorithm>
+
+namespace WeaR {
+
+// ==============================================================================
+// Keyframe index cache (shared by all playbacks of the same file)
+// ==============================================================================
+namespace {
+
+QMutex s_indexCacheMutex;
+QHash<QString, std::shared_ptr<KeyframeIndex>> s_indexCache;
+
+QString indexCacheKey(const QString& path) {
+    QFileInfo info(path);
+    return QString("%1|%2|%3")
+        .arg(info.absoluteFilePath())
+        .arg(info.lastModified().toMSecsSinceEpoch())
+        .arg(info.size());
+}
+
+std::shared_ptr<KeyframeIndex> cachedIndex(const QString& key) {
+    QMutexLocker lock(&s_indexCacheMutex);
+    return s_indexCache.value(key);
+}
+
+void publishIndex(const QString& key, std::shared_ptr<KeyframeIndex> index) {
+    QMutexLocker lock(&s_indexCacheMutex);
+    s_indexCache.insert(key, std::move(index));
+}
+
+int64_t wallClockUs() {
+    return QDateTime::currentMSecsSinceEpoch() * 1000;
+}
+
+// 4:2:0 formats handed to the compositor without conversion
+bool isPlanarFormat(AVPixelFormat format) {
+    return format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_NV12;
+}
+
+} // namespace
+
+int64_t KeyframeIndex::keyframeAtOrBefore(int64_t positionUs) const {
+    auto it = std::upper_bound(keyframesUs.begin(), keyframesUs.end(), positionUs);
+    if (it == keyframesUs.begin()) return 0;
+    return *(it - 1);
+}
+
+// ==============================================================================
+// Frame pool - recycles AVFrame shells handed out as planar frames
+// ==============================================================================
+// Pixel memory itself comes from the decoder's internal buffer pools; a
+// pooled frame holds a reference to it until the last VideoFrame that
+// points at it is released, then the shell goes back to the free list.
+class MediaSourcePlugin::FramePool : public std::enable_shared_from_this<FramePool> {
+public:
+    ~FramePool() {
+        for (AVFrame* frame : m_free) {
+            av_frame_free(&frame);
+        }
+    }
+
+    AVFrame* acquire() {
+        QMutexLocker lock(&m_mutex);
+        if (m_free.empty()) {
+            return av_frame_alloc();
+        }
+        AVFrame* frame = m_free.back();
+        m_free.pop_back();
+        return frame;
+    }
+
+    void release(AVFrame* frame) {
+        if (!frame) return;
+        av_frame_unref(frame);
+        QMutexLocker lock(&m_mutex);
+        m_free.push_back(frame);
+    }
+
+    /**
+     * @brief Wrap a pooled frame so it returns to the pool when unreferenced
+     */
+    std::shared_ptr<const void> share(AVFrame* frame) {
+        std::shared_ptr<FramePool> self = shared_from_this();
+        return std::shared_ptr<const void>(frame, [self](const void* p) {
+            self->release(static_cast<AVFrame*>(const_cast<void*>(p)));
+        });
+    }
+
+private:
+    QMutex m_mutex;
+    std::vector<AVFrame*> m_free;
+};
+
+MediaSourcePlugin::MediaSourcePlugin(QObject* parent)
+    : QObject(parent)
+{
+    // Default configuration
+    m_config.resolution = QSize(1920, 1080);
+    m_config.fps = 30.0;
+}
+
+MediaSourcePlugin::~MediaSourcePlugin() {
+    shutdown();
+}
+
+// ==============================================================================
+// IPlugin Interface
+// ==============================================================================
+PluginInfo MediaSourcePlugin::info() const {
+    return PluginInfo{
+        .id = QStringLiteral("wear.source.media"),
+        .name = QStringLiteral("Media Source"),
+        .description = QStringLiteral("Plays video and audio files with looping and seeking"),
+        .version = QStringLiteral("0.1"),
+        .author = QStringLiteral("WeaR-studio"),
+        .website = QStringLiteral("https://github.com/wear-studio"),
+        .type = PluginType::Source,
+        .capabilities = capabilities()
+    };
+}
+
+PluginCapability MediaSourcePlugin::capabilities() const {
+    return PluginCapability::HasVideo
+         | PluginCapability::HasAudio
+         | PluginCapability::HasSettings
+         | PluginCapability::HasPreview
+         | PluginCapability::SupportsAsync
+         | PluginCapability::ThreadSafe;
+}
+
+bool MediaSourcePlugin::initialize() {
+    if (m_initialized) return true;
+
+    m_framePool = std::make_shared<FramePool>();
+    m_initialized = true;
+    return true;
+}
+
+void MediaSourcePlugin::shutdown() {
+    stop();
+    m_initialized = false;
+}
+
+QWidget* MediaSourcePlugin::settingsWidget() {
+    QWidget* widget = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(widget);
+
+    // File selection
+    QHBoxLayout* fileLayout = new QHBoxLayout();
+    QLineEdit* pathEdit = new QLineEdit(filePath());
+    pathEdit->setReadOnly(true);
+    QPushButton* browseButton = new QPushButton("Browse...");
+
+    QObject::connect(browseButton, &QPushButton::clicked, [this, pathEdit]() {
+        QString path = QFileDialog::getOpenFileName(
+            nullptr, "Select Media File", QString(),
+            "Media Files (*.mp4 *.mkv *.mov *.webm *.flv *.avi *.mp3 *.wav *.aac);;All Files (*)"
+        );
+        if (!path.isEmpty()) {
+            setFilePath(path);
+            pathEdit->setText(path);
+            if (m_running) {
+                stop();
+                start();
+            }
+            if (m_host) m_host->notifySourceSettingsChanged(this);
+        }
+    });
+
+    fileLayout->addWidget(pathEdit);
+    fileLayout->addWidget(browseButton);
+
+    // Looping checkbox
+    QCheckBox* loopCheck = new QCheckBox("Loop");
+    loopCheck->setChecked(m_looping);
+
+    QObject::connect(loopCheck, &QCheckBox::toggled, [this](bool checked) {
+        setLooping(checked);
+        if (m_host) m_host->notifySourceSettingsChanged(this);
+    });
+
+    layout->addWidget(new QLabel("Media Source Settings"));
+    layout->addLayout(fileLayout);
+    layout->addWidget(loopCheck);
+    layout->addStretch();
+
+    return widget;
+}
+
+QString MediaSourcePlugin::lastError() const {
+    QMutexLocker lock(&m_configMutex);
+    return m_lastError;
+}
+
+// ==============================================================================
+// ISource Interface
+// ==============================================================================
+bool MediaSourcePlugin::configure(const SourceConfig& config) {
+    QMutexLocker lock(&m_configMutex);
+    m_config = config;
+    return true;
+}
+
+SourceConfig MediaSourcePlugin::config() const {
+    QMutexLocker lock(&m_configMutex);
+    return m_config;
+}
+
+bool MediaSourcePlugin::start() {
+    if (m_running) return true;
+
+    // A worker that gave up on its own (open or read failure) is still
+    // joinable; reap it before starting another
+    if (m_decodeThread.joinable()) {
+        stop();
+    }
+
+    if (!m_initialized) {
+        if (!initialize()) {
+            return false;
+        }
+    }
+
+    if (filePath().isEmpty()) {
+        setError("No media file set");
+        return false;
+    }
+
+    // Reset presentation state
+    m_currentFrame = VideoFrame();
+    m_currentPtsUs = -1;
+    m_frameNumber = 0;
+    m_clock.invalidate();
+    m_clockOffsetUs = 0;
+    m_clockResetUs = -1;
+    m_seekRequestUs = -1;
+
+    m_running = true;
+    m_decodeThread = std::thread(&MediaSourcePlugin::decodeLoop, this);
+
+    return true;
+}
+
+void MediaSourcePlugin::stop() {
+    if (!m_running && !m_decodeThread.joinable()) return;
+
+    m_running = false;
+    m_queueNotFull.wakeAll();
+
+    if (m_decodeThread.joinable()) {
+        m_decodeThread.join();
+    }
+
+    {
+        QMutexLocker lock(&m_queueMutex);
+        m_frameQueue.clear();
+    }
+    {
+        QMutexLocker lock(&m_audioMutex);
+        m_audioSamples.clear();
+    }
+
+    m_headFrames.clear();
+    m_currentFrame = VideoFrame();
+    m_cropView.clear();
+}
+
+VideoFrame MediaSourcePlugin::captureVideoFrame() {
+    if (!m_running) return VideoFrame();
+
+    {
+        // The clock is read by captureAudioFrame() too; it only changes
+        // under the queue lock
+        QMutexLocker lock(&m_queueMutex);
+
+        // Apply a clock reset requested by a seek on the worker thread
+        int64_t resetUs = m_clockResetUs.exchange(-1);
+        if (resetUs >= 0) {
+            m_clockOffsetUs = resetUs;
+            m_clock.invalidate();
+            m_currentPtsUs = -1;
+        }
+
+        // Start the clock when the first frame is available so decoder
+        // startup latency doesn't make playback skip ahead
+        if (!m_clock.isValid()) {
+            if (m_frameQueue.empty()) return m_currentFrame;
+            m_clockOffsetUs = std::max(m_clockOffsetUs, m_frameQueue.front().ptsUs);
+            m_clock.start();
+            m_wallStartUs = wallClockUs() - m_clockOffsetUs;
+        }
+
+        // Present the newest frame that is due
+        const int64_t position = playbackPositionUs();
+        bool advanced = false;
+        while (!m_frameQueue.empty() &&
+               (m_frameQueue.front().ptsUs <= position || m_currentPtsUs < 0)) {
+            m_currentFrame = std::move(m_frameQueue.front().frame);
+            m_currentPtsUs = m_frameQueue.front().ptsUs;
+            m_frameQueue.pop_front();
+            advanced = true;
+        }
+
+        if (advanced) {
+            m_currentFrame.timestamp = m_wallStartUs + m_currentPtsUs;
+            m_currentFrame.hasTimestamp = true;
+            m_currentFrame.frameNumber = m_frameNumber++;
+            m_queueNotFull.wakeOne();
+        }
+    }
+
+    QRect region;
+    {
+        QMutexLocker lock(&m_configMutex);
+        region = m_config.captureRegion;
+    }
+
+    // Region of interest is a zero-copy view into the decoded frame, the
+    // same view while the frame is repeated
+    return m_cropView.crop(m_currentFrame, region);
+}
+
+AudioFrame MediaSourcePlugin::captureAudioFrame() {
+    AudioFrame frame;
+    frame.sampleRate = kAudioSampleRate;
+    frame.channels = kAudioChannels;
+
+    if (!m_running) return frame;
+
+    int64_t position;
+    {
+        QMutexLocker lock(&m_queueMutex);
+        if (!m_clock.isValid()) return frame;
+        position = playbackPositionUs();
+    }
+
+    QMutexLocker lock(&m_audioMutex);
+    if (m_audioSamples.empty() || m_audioFrontPtsUs > position) return frame;
+
+    // Hand out every sample that is due according to the video clock
+    int64_t dueFrames = (position - m_audioFrontPtsUs) * kAudioSampleRate / 1000000;
+    size_t dueSamples = static_cast<size_t>(std::max<int64_t>(dueFrames, 1)) * kAudioChannels;
+    dueSamples = std::min(dueSamples, m_audioSamples.size());
+
+    frame.samples.assign(m_audioSamples.begin(), m_audioSamples.begin() + dueSamples);
+    frame.timestamp = m_wallStartUs + m_audioFrontPtsUs;
+
+    m_audioSamples.erase(m_audioSamples.begin(), m_audioSamples.begin() + dueSamples);
+    m_audioFrontPtsUs += static_cast<int64_t>(dueSamples / kAudioChannels) * 1000000 / kAudioSampleRate;
+
+    return frame;
+}
+
+QSize MediaSourcePlugin::nativeResolution() const {
+    QMutexLocker lock(&m_configMutex);
+    return m_nativeSize.isValid() ? m_nativeSize : m_config.resolution;
+}
+
+double MediaSourcePlugin::nativeFps() const {
+    QMutexLocker lock(&m_configMutex);
+    return m_nativeFps;
+}
+
+QSize MediaSourcePlugin::outputResolution() const {
+    return nativeResolution();
+}
+
+// ==============================================================================
+// Media Source Specific API
+// ==============================================================================
+void MediaSourcePlugin::setFilePath(const QString& path) {
+    QMutexLocker lock(&m_configMutex);
+    m_filePath = path;
+}
+
+QString MediaSourcePlugin::filePath() const {
+    QMutexLocker lock(&m_configMutex);
+    return m_filePath.isEmpty() ? m_config.deviceId : m_filePath;
+}
+
+QVariantMap MediaSourcePlugin::saveSettings() const {
+    QVariantMap settings;
+    settings.insert(QStringLiteral("file"), filePath());
+    settings.insert(QStringLiteral("looping"), isLooping());
+    return settings;
+}
+
+bool MediaSourcePlugin::loadSettings(const QVariantMap& settings) {
+    if (settings.contains(QStringLiteral("file"))) {
+        setFilePath(settings.value(QStringLiteral("file")).toString());
+    }
+    setLooping(settings.value(QStringLiteral("looping"), true).toBool());
+    return true;
+}
+
+void MediaSourcePlugin::seek(int64_t positionMs) {
+    m_seekRequestUs = std::max<int64_t>(positionMs, 0) * 1000;
+    m_queueNotFull.wakeAll();
+}
+
+void MediaSourcePlugin::setDecodeAheadFrames(int frames) {
+    QMutexLocker lock(&m_queueMutex);
+    m_maxQueuedFrames = std::clamp(frames, 2, 120);
+    m_queueNotFull.wakeAll();
+}
+
+// ==============================================================================
+// Decode Worker
+// ==============================================================================
+void MediaSourcePlugin::decodeLoop() {
+    qDebug() << "Media decode thread started";
+    if (m_host) {
+        m_host->applyThreadRole(ThreadRole::Decode, QStringLiteral("WeaR media"));
+    }
+
+    if (!openMedia()) {
+        closeMedia();
+        m_running = false;
+        return;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    bool finished = false;
+
+    while (m_running && packet) {
+        // User seek: jump to the keyframe at or before the target
+        int64_t seekUs = m_seekRequestUs.exchange(-1);
+        if (seekUs >= 0) {
+            int64_t keyframeUs = m_keyframeIndex ? m_keyframeIndex->keyframeAtOrBefore(seekUs) : 0;
+            m_loopOffsetUs = 0;
+            if (seekDecoder(keyframeUs)) {
+                m_skipUntilUs = seekUs - 1;
+                m_clockResetUs = seekUs;
+                finished = false;
+            }
+            // Skipping ahead leaves holes in the observed keyframes; only a
+            // pass that starts at the head of the file can complete the index
+            m_observedKeyframes.clear();
+            m_observedContiguous = (keyframeUs == 0);
+
+            // Same for the loop head: restart an unfinished head only from 0
+            if (!m_headComplete) {
+                m_headFrames.clear();
+                m_headPassValid = (seekUs == 0);
+            }
+            continue;
+        }
+
+        if (finished) {
+            // End of a non-looping file: idle until stopped or seeked
+            QMutexLocker lock(&m_queueMutex);
+            m_queueNotFull.wait(&m_queueMutex, 50);
+            continue;
+        }
+
+        int ret = av_read_frame(m_formatContext, packet);
+
+        if (ret == AVERROR_EOF) {
+            flushDecoders();
+
+            // After a gap-free pass the demuxer has seen every keyframe
+            if (m_observedContiguous && (!m_keyframeIndex || !m_keyframeIndex->complete)) {
+                auto index = std::make_shared<KeyframeIndex>();
+                index->keyframesUs = m_observedKeyframes;
+                std::sort(index->keyframesUs.begin(), index->keyframesUs.end());
+                index->complete = true;
+                publishIndex(indexCacheKey(filePath()), index);
+                m_keyframeIndex = index;
+            }
+
+            if (m_looping) {
+                restartLoop();
+            } else {
+                finished = true;
+                QMetaObject::invokeMethod(this, [this]() {
+                    emit playbackFinished();
+                }, Qt::QueuedConnection);
+            }
+            continue;
+        }
+
+        if (ret < 0) {
+            char errbuf[256];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            setError(QString("Failed to read media: %1").arg(errbuf));
+            break;
+        }
+
+        if (packet->stream_index == m_videoStreamIndex) {
+            if ((packet->flags & AV_PKT_FLAG_KEY) && packet->pts != AV_NOPTS_VALUE &&
+                !(m_keyframeIndex && m_keyframeIndex->complete)) {
+                AVStream* stream = m_formatContext->streams[m_videoStreamIndex];
+                int64_t start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+                m_observedKeyframes.push_back(
+                    av_rescale_q(packet->pts - start, stream->time_base, AV_TIME_BASE_Q));
+            }
+            decodeVideoPacket(packet);
+        } else if (packet->stream_index == m_audioStreamIndex) {
+            decodeAudioPacket(packet);
+        }
+
+        av_packet_unref(packet);
+    }
+
+    av_packet_free(&packet);
+    closeMedia();
+
+    qDebug() << "Media decode thread stopped";
+}
+
+void MediaSourcePlugin::restartLoop() {
+    // Media duration from the last frame we decoded
+    int64_t frameDurationUs = static_cast<int64_t>(1000000.0 / std::max(nativeFps(), 1.0));
+    int64_t loopLengthUs = m_lastVideoPtsUs + frameDurationUs;
+    if (m_videoStreamIndex < 0) {
+        loopLengthUs = std::max<int64_t>(m_durationUs, frameDurationUs);
+    }
+
+    m_loopOffsetUs += loopLengthUs;
+
+    // Present the cached head of the file immediately; the decoder resumes
+    // after the last cached frame once the seek has completed
+    int64_t lastHeadPtsUs = -1;
+    {
+        QMutexLocker lock(&m_queueMutex);
+        for (const DecodedFrame& head : m_headFrames) {
+            DecodedFrame copy = head;
+            copy.ptsUs = head.ptsUs + m_loopOffsetUs;
+            m_frameQueue.push_back(std::move(copy));
+            lastHeadPtsUs = head.ptsUs;
+        }
+    }
+
+    if (seekDecoder(0)) {
+        m_skipUntilUs = lastHeadPtsUs;
+    }
+
+    // The next pass demuxes from the head of the file again
+    m_observedKeyframes.clear();
+    m_observedContiguous = true;
+    m_headPassValid = true;
+}
+
+bool MediaSourcePlugin::openMedia() {
+    QString path = filePath();
+    QByteArray utf8Path = path.toUtf8();
+
+    int ret = avformat_open_input(&m_formatContext, utf8Path.constData(), nullptr, nullptr);
+    if (ret < 0) {
+        setError(QString("Failed to open media file: %1").arg(path));
+        return false;
+    }
+
+    ret = avformat_find_stream_info(m_formatContext, nullptr);
+    if (ret < 0) {
+        setError("Failed to read stream info");
+        return false;
+    }
+
+    m_videoStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    m_audioStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+
+    if (m_videoStreamIndex < 0 && m_audioStreamIndex < 0) {
+        setError("Media file has no video or audio stream");
+        return false;
+    }
+
+    if (m_videoStreamIndex >= 0 && !openDecoder(m_videoStreamIndex, &m_videoContext, true)) {
+        m_videoStreamIndex = -1;
+    }
+
+    if (m_audioStreamIndex >= 0 && !openDecoder(m_audioStreamIndex, &m_audioContext, false)) {
+        m_audioStreamIndex = -1;
+    }
+
+    // Resampler to the pipeline's audio format
+    if (m_audioContext) {
+        AVChannelLayout outLayout = AV_CHANNEL_LAYOUT_STEREO;
+        ret = swr_alloc_set_opts2(
+            &m_swrContext,
+            &outLayout, AV_SAMPLE_FMT_FLT, kAudioSampleRate,
+            &m_audioContext->ch_layout, m_audioContext->sample_fmt, m_audioContext->sample_rate,
+            0, nullptr
+        );
+        if (ret < 0 || swr_init(m_swrContext) < 0) {
+            qWarning() << "Failed to initialize audio resampler, audio disabled";
+            swr_free(&m_swrContext);
+            m_audioStreamIndex = -1;
+        }
+    }
+
+    if (m_formatContext->duration != AV_NOPTS_VALUE) {
+        m_durationUs = m_formatContext->duration;
+    }
+
+    {
+        QMutexLocker lock(&m_configMutex);
+        if (m_videoContext) {
+            m_nativeSize = QSize(m_videoContext->width, m_videoContext->height);
+            AVRational rate = av_guess_frame_rate(
+                m_formatContext, m_formatContext->streams[m_videoStreamIndex], nullptr);
+            if (rate.num > 0 && rate.den > 0) {
+                m_nativeFps = av_q2d(rate);
+            }
+        }
+    }
+
+    loadKeyframeIndex();
+
+    m_headFrames.clear();
+    m_headComplete = false;
+    m_headPassValid = true;
+    m_skipUntilUs = -1;
+    m_loopOffsetUs = 0;
+    m_lastVideoPtsUs = 0;
+    m_observedContiguous = true;
+
+    qDebug() << "Media opened:" << path
+             << m_nativeSize << "@" << m_nativeFps << "fps"
+             << "keyframes cached:" << (m_keyframeIndex ? m_keyframeIndex->keyframesUs.size() : 0);
+
+    return true;
+}
+
+void MediaSourcePlugin::closeMedia() {
+    if (m_swsContext) {
+        sws_freeContext(m_swsContext);
+        m_swsContext = nullptr;
+    }
+
+    if (m_swrContext) {
+        swr_free(&m_swrContext);
+    }
+
+    if (m_videoContext) {
+        avcodec_free_context(&m_videoContext);
+    }
+
+    if (m_audioContext) {
+        avcodec_free_context(&m_audioContext);
+    }
+
+    if (m_formatContext) {
+        avformat_close_input(&m_formatContext);
+    }
+
+    m_videoStreamIndex = -1;
+    m_audioStreamIndex = -1;
+    m_observedKeyframes.clear();
+}
+
+bool MediaSourcePlugin::openDecoder(int streamIndex, AVCodecContext** context, bool frameThreading) {
+    AVStream* stream = m_formatContext->streams[streamIndex];
+
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec) {
+        qWarning() << "No decoder for stream" << streamIndex;
+        return false;
+    }
+
+    *context = avcodec_alloc_context3(codec);
+    if (!*context) return false;
+
+    if (avcodec_parameters_to_context(*context, stream->codecpar) < 0) {
+        avcodec_free_context(context);
+        return false;
+    }
+
+    (*context)->pkt_timebase = stream->time_base;
+
+    if (frameThreading) {
+        // Frame threading: each thread decodes a different frame
+        (*context)->thread_count = 0;  // auto
+        (*context)->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+
+    int ret = avcodec_open2(*context, codec, nullptr);
+    if (ret < 0) {
+        char errbuf[256];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        qWarning() << "Failed to open decoder:" << errbuf;
+        avcodec_free_context(context);
+        return false;
+    }
+
+    return true;
+}
+
+void MediaSourcePlugin::loadKeyframeIndex() {
+    QString key = indexCacheKey(filePath());
+
+    m_keyframeIndex = cachedIndex(key);
+    if (m_keyframeIndex && m_keyframeIndex->complete) return;
+
+    if (m_videoStreamIndex < 0) return;
+
+    // Containers with a seek index (MP4, MKV cues) give us every keyframe
+    // up front; others are completed from demuxed packets on the first pass
+    AVStream* stream = m_formatContext->streams[m_videoStreamIndex];
+    int64_t start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    int entries = avformat_index_get_entries_count(stream);
+
+    auto index = std::make_shared<KeyframeIndex>();
+    for (int i = 0; i < entries; ++i) {
+        const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+        if (entry && (entry->flags & AVINDEX_KEYFRAME)) {
+            index->keyframesUs.push_back(
+                av_rescale_q(entry->timestamp - start, stream->time_base, AV_TIME_BASE_Q));
+        }
+    }
+
+    if (!index->keyframesUs.empty()) {
+        std::sort(index->keyframesUs.begin(), index->keyframesUs.end());
+        index->complete = true;
+        publishIndex(key, index);
+        m_keyframeIndex = index;
+    }
+}
+
+bool MediaSourcePlugin::seekDecoder(int64_t keyframeUs) {
+    int64_t target = keyframeUs;
+    if (m_formatContext->start_time != AV_NOPTS_VALUE) {
+        target += m_formatContext->start_time;
+    }
+
+    int ret = av_seek_frame(m_formatContext, -1, target, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        char errbuf[256];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        qWarning() << "Media seek failed:" << errbuf;
+        return false;
+    }
+
+    if (m_videoContext) avcodec_flush_buffers(m_videoContext);
+    if (m_audioContext) avcodec_flush_buffers(m_audioContext);
+
+    // A user seek discards everything buffered; a loop restart keeps the
+    // tail of the previous loop plus the head frames already queued
+    if (m_loopOffsetUs == 0) {
+        {
+            QMutexLocker lock(&m_queueMutex);
+            m_frameQueue.clear();
+        }
+        QMutexLocker lock(&m_audioMutex);
+        m_audioSamples.clear();
+    }
+
+    return true;
+}
+
+void MediaSourcePlugin::decodeVideoPacket(const AVPacket* packet) {
+    if (!m_videoContext) return;
+
+    int ret = avcodec_send_packet(m_videoContext, packet);
+    if (ret < 0 && ret != AVERROR_EOF) return;
+
+    AVFrame* decoded = m_framePool->acquire();
+    while (m_running) {
+        ret = avcodec_receive_frame(m_videoContext, decoded);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF || ret < 0) {
+            break;
+        }
+
+        enqueueVideoFrame(decoded);
+
+        // Pixel data now belongs to the queued frame (or was dropped)
+        m_framePool->release(decoded);
+        decoded = m_framePool->acquire();
+    }
+    m_framePool->release(decoded);
+}
+
+void MediaSourcePlugin::decodeAudioPacket(const AVPacket* packet) {
+    if (!m_audioContext || !m_swrContext) return;
+
+    int ret = avcodec_send_packet(m_audioContext, packet);
+    if (ret < 0 && ret != AVERROR_EOF) return;
+
+    AVFrame* decoded = av_frame_alloc();
+    while (decoded) {
+        ret = avcodec_receive_frame(m_audioContext, decoded);
+        if (ret < 0) break;
+
+        enqueueAudioFrame(decoded);
+        av_frame_unref(decoded);
+    }
+    av_frame_free(&decoded);
+}
+
+void MediaSourcePlugin::flushDecoders() {
+    decodeVideoPacket(nullptr);
+    decodeAudioPacket(nullptr);
+
+    // Decoders must be reset after draining before they accept new input
+    if (m_videoContext) avcodec_flush_buffers(m_videoContext);
+    if (m_audioContext) avcodec_flush_buffers(m_audioContext);
+}
+
+bool MediaSourcePlugin::enqueueVideoFrame(AVFrame* decoded) {
+    int64_t mediaPtsUs = frameTimeUs(decoded, m_videoStreamIndex);
+
+    // Frames before a seek target or already served from the head cache
+    if (mediaPtsUs <= m_skipUntilUs) {
+        return false;
+    }
+    m_skipUntilUs = -1;
+    m_lastVideoPtsUs = mediaPtsUs;
+
+    // Remember the first frames of the file for instant loop restarts, but
+    // only from a pass that has decoded the file contiguously from its start
+    bool keepHead = false;
+    if (!m_headComplete && m_headPassValid) {
+        keepHead = static_cast<int>(m_headFrames.size()) < m_maxHeadFrames;
+        m_headComplete = !keepHead;
+    }
+
+    // The head is kept for the whole session, so it must not hold on to
+    // the decoder's buffers; copy planar frames before wrapFrame takes them
+    DecodedFrame head;
+    if (keepHead) {
+        head.frame = copyPlanarFrame(decoded);
+        head.ptsUs = mediaPtsUs;
+    }
+
+    DecodedFrame entry;
+    entry.frame = wrapFrame(decoded);
+    entry.ptsUs = mediaPtsUs + m_loopOffsetUs;
+    if (!entry.frame.isValid()) return false;
+
+    if (keepHead) {
+        // Converted frames are already private QImages
+        if (!head.frame.isValid()) head.frame = entry.frame;
+        m_headFrames.push_back(std::move(head));
+    }
+
+    // Wait for room in the decode-ahead queue
+    QMutexLocker lock(&m_queueMutex);
+    while (m_running && m_seekRequestUs < 0 &&
+           static_cast<int>(m_frameQueue.size()) >= m_maxQueuedFrames) {
+        m_queueNotFull.wait(&m_queueMutex, 50);
+    }
+
+    if (!m_running || m_seekRequestUs >= 0) {
+        return false;
+    }
+
+    m_frameQueue.push_back(std::move(entry));
+    return true;
+}
+
+void MediaSourcePlugin::enqueueAudioFrame(AVFrame* decoded) {
+    int outCount = swr_get_out_samples(m_swrContext, decoded->nb_samples);
+    if (outCount <= 0) return;
+
+    std::vector<float> converted(static_cast<size_t>(outCount) * kAudioChannels);
+    uint8_t* outData[1] = { reinterpret_cast<uint8_t*>(converted.data()) };
+
+    int frames = swr_convert(
+        m_swrContext, outData, outCount,
+        const_cast<const uint8_t**>(decoded->extended_data), decoded->nb_samples
+    );
+    if (frames <= 0) return;
+
+    int64_t ptsUs = frameTimeUs(decoded, m_audioStreamIndex);
+    if (ptsUs <= m_skipUntilUs && m_loopOffsetUs == 0) return;
+
+    QMutexLocker lock(&m_audioMutex);
+
+    if (m_audioSamples.empty()) {
+        m_audioFrontPtsUs = ptsUs + m_loopOffsetUs;
+    }
+
+    m_audioSamples.insert(m_audioSamples.end(),
+                          converted.begin(), converted.begin() + frames * kAudioChannels);
+
+    // Bound the buffer if nobody is pulling audio
+    if (m_audioSamples.size() > kMaxAudioSamples) {
+        size_t excess = m_audioSamples.size() - kMaxAudioSamples;
+        excess -= excess % kAudioChannels;
+        m_audioSamples.erase(m_audioSamples.begin(), m_audioSamples.begin() + excess);
+        m_audioFrontPtsUs += static_cast<int64_t>(excess / kAudioChannels) * 1000000 / kAudioSampleRate;
+    }
+}
+
+VideoFrame MediaSourcePlugin::wrapFrame(AVFrame* decoded) {
+    VideoFrame frame;
+    frame.isHardwareFrame = false;
+
+    const AVPixelFormat format = static_cast<AVPixelFormat>(decoded->format);
+
+    // 4:2:0 YUV goes out as-is, referencing the decoder's buffers
+    if (isPlanarFormat(format)) {
+        AVFrame* pooled = m_framePool->acquire();
+        if (!pooled) return frame;
+        av_frame_move_ref(pooled, decoded);
+        return sharePlanarFrame(pooled);
+    }
+
+    // Everything else is converted to BGRA on this worker thread
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    const bool hasAlpha = desc && (desc->flags & AV_PIX_FMT_FLAG_ALPHA);
+
+    m_swsContext = sws_getCachedContext(
+        m_swsContext,
+        decoded->width, decoded->height, format,
+        decoded->width, decoded->height, AV_PIX_FMT_BGRA,
+        SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (!m_swsContext) return frame;
+
+    QImage image(decoded->width, decoded->height,
+                 hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    if (image.isNull()) return frame;
+
+    uint8_t* dst[1] = { image.bits() };
+    int dstStride[1] = { static_cast<int>(image.bytesPerLine()) };
+    sws_scale(m_swsContext, decoded->data, decoded->linesize, 0, decoded->height, dst, dstStride);
+
+    if (hasAlpha) {
+        image.convertTo(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    frame.softwareFrame = image;
+    return frame;
+}
+
+VideoFrame MediaSourcePlugin::copyPlanarFrame(const AVFrame* decoded) {
+    if (!isPlanarFormat(static_cast<AVPixelFormat>(decoded->format))) return VideoFrame();
+
+    AVFrame* pooled = m_framePool->acquire();
+    if (!pooled) return VideoFrame();
+
+    pooled->format = decoded->format;
+    pooled->width = decoded->width;
+    pooled->height = decoded->height;
+    if (av_frame_get_buffer(pooled, 0) < 0 || av_frame_copy(pooled, decoded) < 0) {
+        m_framePool->release(pooled);
+        return VideoFrame();
+    }
+    return sharePlanarFrame(pooled);
+}
+
+VideoFrame MediaSourcePlugin::sharePlanarFrame(AVFrame* pooled) {
+    VideoFrame frame;
+    frame.isHardwareFrame = false;
+
+    PlanarFrame& planes = frame.planes;
+    planes.format = (pooled->format == AV_PIX_FMT_NV12) ? FramePixelFormat::NV12 : FramePixelFormat::I420;
+    planes.size = QSize(pooled->width, pooled->height);
+    for (int i = 0; i < 3; ++i) {
+        planes.data[i] = pooled->data[i];
+        planes.linesize[i] = pooled->linesize[i];
+    }
+    planes.owner = m_framePool->share(pooled);
+    return frame;
+}
+
+int64_t MediaSourcePlugin::frameTimeUs(const AVFrame* frame, int streamIndex) const {
+    AVStream* stream = m_formatContext->streams[streamIndex];
+    int64_t pts = frame->best_effort_timestamp;
+    if (pts == AV_NOPTS_VALUE) pts = frame->pts;
+    if (pts == AV_NOPTS_VALUE) return m_lastVideoPtsUs;
+
+    int64_t start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    return av_rescale_q(pts - start, stream->time_base, AV_TIME_BASE_Q);
+}
+
+void MediaSourcePlugin::setError(const QString& error) {
+    qWarning() << "Media source:" << error;
+    QMutexLocker lock(&m_configMutex);
+    m_lastError = error;
+}
+
+int64_t MediaSourcePlugin::playbackPositionUs() const {
+    if (!m_clock.isValid()) return m_clockOffsetUs;
+    return m_clockOffsetUs + m_clock.nsecsElapsed() / 1000;
+}
+
+} // namespace WeaR
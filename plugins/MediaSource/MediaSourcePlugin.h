@@ -0,0 +1,265 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio Media Source Plugin
+// Video/audio file playback using FFmpeg with threaded decode-ahead
+// ==============================================================================
+
+#include <IPlugin.h>
+#include <ISource.h>
+#include <IPluginHost.h>
+
+#include <QObject>
+#include <QtPlugin>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QWidget>
+
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <vector>
+
+// Forward declarations for FFmpeg types (avoid including headers in .h)
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVFrame;
+struct AVPacket;
+struct SwsContext;
+struct SwrContext;
+
+namespace WeaR {
+
+/**
+ * @brief Sorted keyframe timestamps of a media file's video stream
+ *
+ * Built once per file (path + modification time) and shared by every
+ * playback of that file, so loop restarts and seeks can jump straight
+ * to the right keyframe without probing the container again.
+ */
+struct KeyframeIndex {
+    std::vector<int64_t> keyframesUs;  ///< Keyframe PTS in microseconds, ascending
+    bool complete = false;             ///< True once the whole file was scanned
+
+    /**
+     * @brief Find the last keyframe at or before a position
+     * @param positionUs Target position in microseconds
+     * @return Keyframe PTS, or 0 if the index is empty
+     */
+    [[nodiscard]] int64_t keyframeAtOrBefore(int64_t positionUs) const;
+};
+
+/**
+ * @brief Media file source plugin - plays video/audio files
+ *
+ * Decoding runs on a dedicated worker thread with FFmpeg frame threading
+ * and fills a bounded decode-ahead queue of pooled frames. The render
+ * thread only picks the frame that is due, so captureVideoFrame() never
+ * blocks on the decoder.
+ *
+ * YUV 4:2:0 output is handed out as a planar frame that references the
+ * decoder's buffers (no RGBA conversion); other formats are converted to
+ * BGRA on the worker thread. The first frames of the file are kept so a
+ * loop restart is presented instantly while the decoder seeks.
+ */
+class MediaSourcePlugin : public QObject, public ISource {
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID WEAR_SOURCE_IID FILE "MediaSourcePlugin.json")
+    Q_INTERFACES(WeaR::ISource)
+
+public:
+    explicit MediaSourcePlugin(QObject* parent = nullptr);
+    ~MediaSourcePlugin() override;
+
+    // =========================================================================
+    // IPlugin Interface
+    // =========================================================================
+    [[nodiscard]] PluginInfo info() const override;
+    [[nodiscard]] QString name() const override { return QStringLiteral("Media Source"); }
+    [[nodiscard]] QString version() const override { return QStringLiteral("0.1"); }
+    [[nodiscard]] PluginType type() const override { return PluginType::Source; }
+    [[nodiscard]] PluginCapability capabilities() const override;
+
+    void attachHost(IPluginHost* host) override { m_host = host; }
+    bool initialize() override;
+    void shutdown() override;
+    [[nodiscard]] bool isActive() const override { return m_initialized; }
+
+    QWidget* settingsWidget() override;
+    [[nodiscard]] QString lastError() const override;
+
+    // =========================================================================
+    // ISource Interface
+    // =========================================================================
+    bool configure(const SourceConfig& config) override;
+    [[nodiscard]] SourceConfig config() const override;
+
+    bool start() override;
+    void stop() override;
+    [[nodiscard]] bool isRunning() const override { return m_running; }
+
+    [[nodiscard]] VideoFrame captureVideoFrame() override;
+    [[nodiscard]] AudioFrame captureAudioFrame() override;
+
+    [[nodiscard]] QSize nativeResolution() const override;
+    [[nodiscard]] double nativeFps() const override;
+    [[nodiscard]] QSize outputResolution() const override;
+    [[nodiscard]] double outputFps() const override { return nativeFps(); }
+
+    [[nodiscard]] QVariantMap saveSettings() const override;
+    bool loadSettings(const QVariantMap& settings) override;
+
+    // =========================================================================
+    // Media Source Specific API
+    // =========================================================================
+
+    /**
+     * @brief Set the media file to play
+     *
+     * Takes effect on the next start(). SourceConfig::deviceId is used
+     * as the file path if this is never called.
+     */
+    void setFilePath(const QString& path);
+
+    /**
+     * @brief Get the media file path
+     */
+    [[nodiscard]] QString filePath() const;
+
+    /**
+     * @brief Set whether playback restarts at the end of the file
+     */
+    void setLooping(bool looping) { m_looping = looping; }
+
+    /**
+     * @brief Check if playback loops
+     */
+    [[nodiscard]] bool isLooping() const { return m_looping; }
+
+    /**
+     * @brief Seek to a position
+     *
+     * Jumps to the nearest keyframe at or before the position using the
+     * cached keyframe index, then decodes forward to the exact frame.
+     *
+     * @param positionMs Position in milliseconds
+     */
+    void seek(int64_t positionMs);
+
+    /**
+     * @brief Get the media duration in milliseconds (0 if unknown)
+     */
+    [[nodiscard]] int64_t durationMs() const { return m_durationUs / 1000; }
+
+    /**
+     * @brief Set how many decoded frames may be buffered ahead
+     */
+    void setDecodeAheadFrames(int frames);
+
+signals:
+    /**
+     * @brief Emitted when playback reaches the end of a non-looping file
+     */
+    void playbackFinished();
+
+private:
+    /**
+     * @brief A decoded frame waiting to be presented
+     */
+    struct DecodedFrame {
+        VideoFrame frame;
+        int64_t ptsUs = 0;      ///< Media time of the frame (loop offset applied)
+    };
+
+    class FramePool;
+
+    // Worker thread
+    void decodeLoop();
+    void restartLoop();
+    bool openMedia();
+    void closeMedia();
+    bool openDecoder(int streamIndex, AVCodecContext** context, bool frameThreading);
+    void loadKeyframeIndex();
+    bool seekDecoder(int64_t keyframeUs);
+    void decodeVideoPacket(const AVPacket* packet);
+    void decodeAudioPacket(const AVPacket* packet);
+    void flushDecoders();
+    bool enqueueVideoFrame(AVFrame* decoded);
+    void enqueueAudioFrame(AVFrame* decoded);
+    VideoFrame wrapFrame(AVFrame* decoded);
+    VideoFrame copyPlanarFrame(const AVFrame* decoded);
+    VideoFrame sharePlanarFrame(AVFrame* pooled);
+    int64_t frameTimeUs(const AVFrame* frame, int streamIndex) const;
+    void setError(const QString& error);
+
+    // Presentation clock
+    int64_t playbackPositionUs() const;
+
+    // State
+    IPluginHost* m_host = nullptr;
+    bool m_initialized = false;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_looping{true};
+    SourceConfig m_config;
+    QString m_filePath;
+    QString m_lastError;
+    mutable QMutex m_configMutex;
+
+    // Worker
+    std::thread m_decodeThread;
+    std::atomic<int64_t> m_seekRequestUs{-1};
+
+    // FFmpeg objects (owned by the worker thread while running)
+    AVFormatContext* m_formatContext = nullptr;
+    AVCodecContext* m_videoContext = nullptr;
+    AVCodecContext* m_audioContext = nullptr;
+    SwsContext* m_swsContext = nullptr;
+    SwrContext* m_swrContext = nullptr;
+    int m_videoStreamIndex = -1;
+    int m_audioStreamIndex = -1;
+    std::shared_ptr<FramePool> m_framePool;
+    std::shared_ptr<KeyframeIndex> m_keyframeIndex;
+    std::vector<int64_t> m_observedKeyframes;
+    bool m_observedContiguous = true;   ///< No user seek since this pass began
+
+    // Media info
+    std::atomic<int64_t> m_durationUs{0};
+    QSize m_nativeSize;
+    double m_nativeFps = 30.0;
+
+    // Decode-ahead queue
+    std::deque<DecodedFrame> m_frameQueue;
+    int m_maxQueuedFrames = 8;
+    mutable QMutex m_queueMutex;
+    QWaitCondition m_queueNotFull;
+
+    // Loop head cache: first frames of the file, presented on loop restart
+    std::vector<DecodedFrame> m_headFrames;
+    int m_maxHeadFrames = 6;
+    bool m_headComplete = false;
+    bool m_headPassValid = true;    ///< This pass decodes contiguously from media time 0
+    int64_t m_skipUntilUs = -1;     ///< Drop decoded frames up to this media PTS
+    int64_t m_loopOffsetUs = 0;     ///< Added to PTS of frames from later loops
+    int64_t m_lastVideoPtsUs = 0;   ///< Last decoded video PTS (without loop offset)
+
+    // Presentation (render thread)
+    VideoFrame m_currentFrame;
+    CroppedViewCache m_cropView;    ///< Region view of m_currentFrame
+    int64_t m_currentPtsUs = -1;
+    int64_t m_frameNumber = 0;
+    QElapsedTimer m_clock;          ///< Guarded by m_queueMutex (read by the audio path)
+    int64_t m_clockOffsetUs = 0;    ///< Media time at m_clock start, guarded by m_queueMutex
+    std::atomic<int64_t> m_clockResetUs{-1};  ///< Pending clock reset from a seek
+    std::atomic<int64_t> m_wallStartUs{0};    ///< Wall time at media time 0
+
+    // Audio output (interleaved float, 48 kHz stereo)
+    std::deque<float> m_audioSamples;
+    int64_t m_audioFrontPtsUs = 0;  ///< Media time of the first queued sample
+    mutable QMutex m_audioMutex;
+    static constexpr int kAudioSampleRate = 48000;
+    static constexpr int kAudioChannels = 2;
+    static constexpr size_t kMaxAudioSamples = kAudioSampleRate * kAudioChannels;  ///< 1 second
+};
+
+} // namespace WeaR
@@ -0,0 +1,150 @@
+// ==============================================================================
+// WeaR-studio Glyph Atlas Implementation
+// ==============================================================================
+
+#include "GlyphAtlas.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cstring>
+
+namespace WeaR {
+
+namespace {
+
+/**
+ * @brief Decode the code point at index i and advance past it
+ */
+char32_t nextCodepoint(const QString& text, qsizetype& i) {
+    const QChar c = text.at(i++);
+    if (c.isHighSurrogate() && i < text.size() && text.at(i).isLowSurrogate()) {
+        return QChar::surrogateToUcs4(c, text.at(i++));
+    }
+    return c.unicode();
+}
+
+} // namespace
+
+void GlyphAtlas::setStyle(const QFont& font, const QColor& color) {
+    if (font == m_font && color == m_color && !m_atlas.isNull()) return;
+
+    m_font = font;
+    m_color = color;
+
+    QFontMetrics metrics(m_font);
+    m_lineHeight = metrics.height();
+    m_ascent = metrics.ascent();
+
+    m_glyphs.clear();
+    m_cursorX = 0;
+    m_cursorY = 0;
+    m_atlas = QImage(kAtlasWidth, m_lineHeight + kPadding, QImage::Format_ARGB32_Premultiplied);
+    m_atlas.fill(Qt::transparent);
+}
+
+const AtlasGlyph& GlyphAtlas::glyph(char32_t codepoint) {
+    auto it = m_glyphs.constFind(codepoint);
+    if (it != m_glyphs.constEnd()) return *it;
+
+    const QString text = QString::fromUcs4(&codepoint, 1);
+    QFontMetrics metrics(m_font);
+    const QRect bounds = metrics.boundingRect(text);
+
+    AtlasGlyph glyph;
+    glyph.advance = metrics.horizontalAdvance(text);
+    glyph.offsetX = std::min(0, bounds.left());
+    const int width = std::max(glyph.advance, bounds.right() + 1) - glyph.offsetX;
+
+    // Shelf packing: every shelf is one line high
+    if (width > 0) {
+        if (m_cursorX + width + kPadding > kAtlasWidth) {
+            m_cursorX = 0;
+            m_cursorY += m_lineHeight + kPadding;
+        }
+        if (m_cursorY + m_lineHeight > m_atlas.height()) {
+            growAtlas();
+        }
+
+        glyph.source = QRect(m_cursorX, m_cursorY, std::min(width, kAtlasWidth), m_lineHeight);
+
+        QPainter painter(&m_atlas);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+        painter.setFont(m_font);
+        painter.setPen(m_color);
+        painter.setClipRect(glyph.source);
+        painter.drawText(m_cursorX - glyph.offsetX, m_cursorY + m_ascent, text);
+        painter.end();
+
+        m_cursorX += width + kPadding;
+    }
+
+    return *m_glyphs.insert(codepoint, glyph);
+}
+
+void GlyphAtlas::addText(const QString& text) {
+    for (qsizetype i = 0; i < text.size();) {
+        glyph(nextCodepoint(text, i));
+    }
+}
+
+int GlyphAtlas::textWidth(const QString& text) {
+    int width = 0;
+    for (qsizetype i = 0; i < text.size();) {
+        width += glyph(nextCodepoint(text, i)).advance;
+    }
+    return width;
+}
+
+int GlyphAtlas::draw(QImage& target, int x, int y, const QString& text) {
+    for (qsizetype i = 0; i < text.size();) {
+        const AtlasGlyph& g = glyph(nextCodepoint(text, i));
+        if (!g.source.isEmpty()) {
+            blitGlyph(target, x + g.offsetX, y, g.source);
+        }
+        x += g.advance;
+    }
+    return x;
+}
+
+void GlyphAtlas::blitGlyph(QImage& target, int x, int y, const QRect& source) const {
+    // Clip the glyph cell against the target
+    const QRect dest = QRect(x, y, source.width(), source.height()) & target.rect();
+    if (dest.isEmpty()) return;
+
+    const int srcX = source.x() + (dest.x() - x);
+    const int srcY = source.y() + (dest.y() - y);
+
+    for (int row = 0; row < dest.height(); ++row) {
+        const uint32_t* src = reinterpret_cast<const uint32_t*>(m_atlas.constScanLine(srcY + row)) + srcX;
+        uint32_t* dst = reinterpret_cast<uint32_t*>(target.scanLine(dest.y() + row)) + dest.x();
+
+        for (int col = 0; col < dest.width(); ++col) {
+            const uint32_t s = src[col];
+            const uint32_t alpha = s >> 24;
+            if (alpha == 0) continue;
+            if (alpha == 255) {
+                dst[col] = s;
+                continue;
+            }
+
+            // Premultiplied source-over, two channels at a time
+            const uint32_t inv = 255 - alpha;
+            const uint32_t d = dst[col];
+            uint32_t rb = (d & 0x00ff00ff) * inv;
+            uint32_t ag = ((d >> 8) & 0x00ff00ff) * inv;
+            rb = ((rb + ((rb >> 8) & 0x00ff00ff) + 0x00800080) >> 8) & 0x00ff00ff;
+            ag = (ag + ((ag >> 8) & 0x00ff00ff) + 0x00800080) & 0xff00ff00;
+            dst[col] = s + (rb | ag);
+        }
+    }
+}
+
+void GlyphAtlas::growAtlas() {
+    QImage grown(kAtlasWidth, m_atlas.height() * 2, QImage::Format_ARGB32_Premultiplied);
+    grown.fill(Qt::transparent);
+    std::memcpy(grown.bits(), m_atlas.constBits(), m_atlas.sizeInBytes());
+    m_atlas = grown;
+}
+
+} // namespace WeaR
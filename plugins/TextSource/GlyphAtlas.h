@@ -0,0 +1,98 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio Glyph Atlas
+// Rasterizes glyphs once and blits them from a shared texture
+// ==============================================================================
+
+#include <QImage>
+#include <QFont>
+#include <QFontMetrics>
+#include <QColor>
+#include <QHash>
+#include <QRect>
+#include <QString>
+
+namespace WeaR {
+
+/**
+ * @brief A glyph's location in the atlas
+ */
+struct AtlasGlyph {
+    QRect source;       ///< Rectangle in the atlas image
+    int offsetX = 0;    ///< Left edge of the cell relative to the pen position
+    int advance = 0;    ///< Horizontal advance in pixels
+};
+
+/**
+ * @brief Cache of pre-rasterized glyphs for one font and color
+ *
+ * Each character is drawn with QPainter exactly once, into a growing
+ * atlas image. Text is then composed by copying glyph rectangles, which
+ * avoids font shaping and rasterization on every frame.
+ *
+ * Glyphs are laid out per character (no ligatures or complex shaping),
+ * which is what tickers and chat overlays need.
+ */
+class GlyphAtlas {
+public:
+    GlyphAtlas() = default;
+
+    /**
+     * @brief Set font and color; clears the atlas if either changed
+     */
+    void setStyle(const QFont& font, const QColor& color);
+
+    /**
+     * @brief Get a glyph, rasterizing it on first use
+     */
+    const AtlasGlyph& glyph(char32_t codepoint);
+
+    /**
+     * @brief Make sure every character of a string is in the atlas
+     */
+    void addText(const QString& text);
+
+    /**
+     * @brief Total advance of a string in pixels
+     */
+    [[nodiscard]] int textWidth(const QString& text);
+
+    /**
+     * @brief Draw a string by copying glyphs from the atlas
+     *
+     * The target must be Format_ARGB32_Premultiplied. Glyphs are blended
+     * over the existing pixels (source-over).
+     *
+     * @param target Destination image
+     * @param x Left edge of the first glyph
+     * @param y Top of the line
+     * @param text Text to draw
+     * @return X position after the last glyph
+     */
+    int draw(QImage& target, int x, int y, const QString& text);
+
+    [[nodiscard]] int lineHeight() const { return m_lineHeight; }
+    [[nodiscard]] const QImage& image() const { return m_atlas; }
+    [[nodiscard]] int glyphCount() const { return m_glyphs.size(); }
+
+private:
+    void blitGlyph(QImage& target, int x, int y, const QRect& source) const;
+    void growAtlas();
+
+    QFont m_font;
+    QColor m_color{Qt::white};
+    int m_lineHeight = 0;
+    int m_ascent = 0;
+
+    QImage m_atlas;
+    QHash<char32_t, AtlasGlyph> m_glyphs;
+
+    // Shelf packing cursor
+    int m_cursorX = 0;
+    int m_cursorY = 0;
+
+    static constexpr int kAtlasWidth = 1024;
+    static constexpr int kPadding = 1;
+};
+
+} // namespace WeaR
@@ -0,0 +1,366 @@
+// ==============================================================================
+// WeaR-studio Text Source Plugin Implementation
+// ==============================================================================
+
+#include "TextSourcePlugin.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QFontDialog>
+#include <QColorDialog>
+
+#include <algorithm>
+#include <cstring>
+
+namespace WeaR {
+
+TextSourcePlugin::TextSourcePlugin(QObject* parent)
+    : QObject(parent)
+{
+    // Default configuration
+    m_config.resolution = QSize(1920, 80);
+    m_config.fps = 60.0;
+
+    m_atlas.setStyle(m_font, m_color);
+}
+
+TextSourcePlugin::~TextSourcePlugin() {
+    shutdown();
+}
+
+// ==============================================================================
+// IPlugin Interface
+// ==============================================================================
+PluginInfo TextSourcePlugin::info() const {
+    return PluginInfo{
+        .id = QStringLiteral("wear.source.text"),
+        .name = QStringLiteral("Text Source"),
+        .description = QStringLiteral("Renders text overlays and scrolling tickers"),
+        .version = QStringLiteral("0.1"),
+        .author = QStringLiteral("WeaR-studio"),
+        .website = QStringLiteral("https://github.com/wear-studio"),
+        .type = PluginType::Source,
+        .capabilities = capabilities()
+    };
+}
+
+PluginCapability TextSourcePlugin::capabilities() const {
+    return PluginCapability::HasVideo
+         | PluginCapability::HasSettings
+         | PluginCapability::HasPreview
+         | PluginCapability::ThreadSafe;
+}
+
+bool TextSourcePlugin::initialize() {
+    m_initialized = true;
+    return true;
+}
+
+void TextSourcePlugin::shutdown() {
+    stop();
+    m_initialized = false;
+}
+
+QWidget* TextSourcePlugin::settingsWidget() {
+    QWidget* widget = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(widget);
+
+    QPlainTextEdit* textEdit = new QPlainTextEdit(text());
+    QObject::connect(textEdit, &QPlainTextEdit::textChanged, [this, textEdit]() {
+        setText(textEdit->toPlainText());
+        if (m_host) m_host->notifySourceSettingsChanged(this);
+    });
+
+    QHBoxLayout* styleLayout = new QHBoxLayout();
+    QPushButton* fontButton = new QPushButton("Font...");
+    QPushButton* colorButton = new QPushButton("Color...");
+
+    QObject::connect(fontButton, &QPushButton::clicked, [this]() {
+        bool ok = false;
+        QFont font = QFontDialog::getFont(&ok, m_font, nullptr, "Select Font");
+        if (ok) {
+            setStyle(font, m_color);
+            if (m_host) m_host->notifySourceSettingsChanged(this);
+        }
+    });
+
+    QObject::connect(colorButton, &QPushButton::clicked, [this]() {
+        QColor color = QColorDialog::getColor(m_color, nullptr, "Select Color",
+                                              QColorDialog::ShowAlphaChannel);
+        if (color.isValid()) {
+            setStyle(m_font, color);
+            if (m_host) m_host->notifySourceSettingsChanged(this);
+        }
+    });
+
+    styleLayout->addWidget(fontButton);
+    styleLayout->addWidget(colorButton);
+
+    QCheckBox* tickerCheck = new QCheckBox("Scroll as ticker");
+    tickerCheck->setChecked(isTicker());
+    QObject::connect(tickerCheck, &QCheckBox::toggled, [this](bool checked) {
+        setTicker(checked, m_tickerSpeed);
+        if (m_host) m_host->notifySourceSettingsChanged(this);
+    });
+
+    layout->addWidget(new QLabel("Text Source Settings"));
+    layout->addWidget(textEdit);
+    layout->addLayout(styleLayout);
+    layout->addWidget(tickerCheck);
+    layout->addStretch();
+
+    return widget;
+}
+
+// ==============================================================================
+// ISource Interface
+// ==============================================================================
+bool TextSourcePlugin::configure(const SourceConfig& config) {
+    QMutexLocker lock(&m_mutex);
+    m_config = config;
+    return true;
+}
+
+SourceConfig TextSourcePlugin::config() const {
+    QMutexLocker lock(&m_mutex);
+    return m_config;
+}
+
+bool TextSourcePlugin::start() {
+    if (m_running) return true;
+
+    if (!m_initialized) {
+        if (!initialize()) {
+            return false;
+        }
+    }
+
+    m_frameNumber = 0;
+    m_clock.start();
+    m_running = true;
+    return true;
+}
+
+void TextSourcePlugin::stop() {
+    m_running = false;
+
+    QMutexLocker lock(&m_mutex);
+    m_cropView.clear();
+}
+
+VideoFrame TextSourcePlugin::captureVideoFrame() {
+    VideoFrame frame;
+    if (!m_running) return frame;
+
+    QMutexLocker lock(&m_mutex);
+
+    // Unchanged static text is returned as-is (shared, no copy)
+    frame.softwareFrame = m_ticker ? tickerFrame() : m_canvas;
+    if (frame.softwareFrame.isNull()) return VideoFrame();
+
+    frame.isHardwareFrame = false;
+    frame.timestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+    frame.hasTimestamp = true;
+    frame.frameNumber = m_frameNumber++;
+
+    return m_cropView.crop(frame, m_config.captureRegion);
+}
+
+QSize TextSourcePlugin::nativeResolution() const {
+    QMutexLocker lock(&m_mutex);
+    if (m_ticker) {
+        return QSize(m_config.resolution.width(), m_atlas.lineHeight());
+    }
+    return m_canvas.isNull() ? QSize(1, m_atlas.lineHeight()) : m_canvas.size();
+}
+
+QVariantMap TextSourcePlugin::saveSettings() const {
+    QMutexLocker lock(&m_mutex);
+
+    QVariantMap settings;
+    settings.insert(QStringLiteral("text"), m_text);
+    settings.insert(QStringLiteral("font"), m_font.toString());
+    settings.insert(QStringLiteral("color"), m_color.name(QColor::HexArgb));
+    settings.insert(QStringLiteral("ticker"), m_ticker);
+    settings.insert(QStringLiteral("tickerSpeed"), m_tickerSpeed);
+    return settings;
+}
+
+bool TextSourcePlugin::loadSettings(const QVariantMap& settings) {
+    QFont font = m_font;
+    if (settings.contains(QStringLiteral("font"))) {
+        font.fromString(settings.value(QStringLiteral("font")).toString());
+    }
+    const QColor color(settings.value(QStringLiteral("color"), m_color.name(QColor::HexArgb)).toString());
+
+    setStyle(font, color.isValid() ? color : m_color);
+    setTicker(settings.value(QStringLiteral("ticker"), false).toBool(),
+              settings.value(QStringLiteral("tickerSpeed"), 120.0).toDouble());
+    setText(settings.value(QStringLiteral("text")).toString());
+    return true;
+}
+
+// ==============================================================================
+// Text Source Specific API
+// ==============================================================================
+void TextSourcePlugin::setText(const QString& text) {
+    QMutexLocker lock(&m_mutex);
+    if (text == m_text) return;
+
+    m_text = text;
+    relayout();
+}
+
+QString TextSourcePlugin::text() const {
+    QMutexLocker lock(&m_mutex);
+    return m_text;
+}
+
+void TextSourcePlugin::setStyle(const QFont& font, const QColor& color) {
+    QMutexLocker lock(&m_mutex);
+    if (font == m_font && color == m_color) return;
+
+    m_font = font;
+    m_color = color;
+    m_atlas.setStyle(m_font, m_color);
+
+    // Every glyph changed
+    m_fullRedraw = true;
+    relayout();
+}
+
+void TextSourcePlugin::setTicker(bool enabled, double pixelsPerSecond) {
+    QMutexLocker lock(&m_mutex);
+    m_tickerSpeed = pixelsPerSecond;
+    if (m_ticker == enabled) return;
+
+    m_ticker = enabled;
+    m_fullRedraw = true;
+    relayout();
+}
+
+bool TextSourcePlugin::isTicker() const {
+    QMutexLocker lock(&m_mutex);
+    return m_ticker;
+}
+
+// ==============================================================================
+// Layout and Drawing
+// ==============================================================================
+void TextSourcePlugin::relayout() {
+    if (m_ticker) {
+        rebuildStrip();
+        m_lines.clear();
+        return;
+    }
+
+    const QStringList lines = m_text.split('\n');
+    const int lineHeight = m_atlas.lineHeight();
+
+    std::vector<int> widths;
+    widths.reserve(lines.size());
+    int maxWidth = 1;
+    for (const QString& line : lines) {
+        widths.push_back(m_atlas.textWidth(line));
+        maxWidth = std::max(maxWidth, widths.back());
+    }
+
+    const QSize size(maxWidth, std::max(1, static_cast<int>(lines.size())) * lineHeight);
+
+    // A new canvas size means everything moves; otherwise only touch the
+    // lines whose text changed
+    if (m_fullRedraw || m_canvas.size() != size) {
+        m_canvas = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        m_canvas.fill(Qt::transparent);
+        m_lines = lines;
+        m_lineWidths = widths;
+        for (int i = 0; i < m_lines.size(); ++i) {
+            redrawLine(i);
+        }
+        m_fullRedraw = false;
+        return;
+    }
+
+    const QStringList previous = m_lines;
+    m_lines = lines;
+    m_lineWidths = widths;
+
+    for (int i = 0; i < m_lines.size(); ++i) {
+        if (i >= previous.size() || previous.at(i) != m_lines.at(i)) {
+            redrawLine(i);
+        }
+    }
+}
+
+void TextSourcePlugin::redrawLine(int index) {
+    const int lineHeight = m_atlas.lineHeight();
+    const int top = index * lineHeight;
+    if (top + lineHeight > m_canvas.height()) return;
+
+    // Clear the line band, then copy the glyphs in
+    for (int y = top; y < top + lineHeight; ++y) {
+        std::memset(m_canvas.scanLine(y), 0, m_canvas.bytesPerLine());
+    }
+    m_atlas.draw(m_canvas, 0, top, m_lines.at(index));
+}
+
+void TextSourcePlugin::rebuildStrip() {
+    QString line = m_text;
+    line.replace('\n', QStringLiteral("   "));
+
+    const int width = m_atlas.textWidth(line) + kTickerGap;
+    m_strip = QImage(width, m_atlas.lineHeight(), QImage::Format_ARGB32_Premultiplied);
+    m_strip.fill(Qt::transparent);
+    m_atlas.draw(m_strip, 0, 0, line);
+
+    m_fullRedraw = false;
+}
+
+QImage TextSourcePlugin::tickerFrame() {
+    if (m_strip.isNull()) return QImage();
+
+    const QSize size(std::max(1, m_config.resolution.width()), m_strip.height());
+
+    // Reuse an output buffer the compositor no longer references
+    QImage* target = nullptr;
+    for (QImage& buffer : m_tickerBuffers) {
+        if (buffer.size() == size && buffer.isDetached()) {
+            target = &buffer;
+            break;
+        }
+    }
+    if (!target) {
+        target = &m_tickerBuffers[m_frameNumber & 1];
+        *target = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    }
+
+    const int stripWidth = m_strip.width();
+    const int offset = static_cast<int>(
+        static_cast<int64_t>(m_clock.elapsed() * m_tickerSpeed / 1000.0) % stripWidth);
+
+    // Each row is copied from the strip starting at the scroll offset,
+    // wrapping around to the start of the strip
+    for (int y = 0; y < size.height(); ++y) {
+        const uint32_t* src = reinterpret_cast<const uint32_t*>(m_strip.constScanLine(y));
+        uint32_t* dst = reinterpret_cast<uint32_t*>(target->scanLine(y));
+
+        int x = 0;
+        int srcX = offset;
+        while (x < size.width()) {
+            const int run = std::min(size.width() - x, stripWidth - srcX);
+            std::memcpy(dst + x, src + srcX, run * sizeof(uint32_t));
+            x += run;
+            srcX = 0;
+        }
+    }
+
+    return *target;
+}
+
+} // namespace WeaR
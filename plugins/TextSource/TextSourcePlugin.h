@@ -0,0 +1,159 @@
+#pragma once
+// ==============================================================================
+// WeaR-studio Text Source Plugin
+// Static text, chat-style overlays and scrolling tickers
+// ==============================================================================
+
+#include "GlyphAtlas.h"
+
+#include <IPlugin.h>
+#include <ISource.h>
+#include <IPluginHost.h>
+
+#include <QObject>
+#include <QtPlugin>
+#include <QImage>
+#include <QFont>
+#include <QColor>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QWidget>
+
+#include <vector>
+
+namespace WeaR {
+
+/**
+ * @brief Text source plugin - renders text through a glyph atlas
+ *
+ * Glyphs are rasterized once into a GlyphAtlas. Line layouts are only
+ * rebuilt when the text changes, and only lines whose content changed
+ * are redrawn into the cached canvas, so an unchanged overlay costs
+ * nothing per frame.
+ *
+ * In ticker mode the text is drawn once into a cached strip and each
+ * frame is an offset copy out of that strip (one memcpy per row, with
+ * wrap-around), independent of how much text is scrolling.
+ */
+class TextSourcePlugin : public QObject, public ISource {
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID WEAR_SOURCE_IID FILE "TextSourcePlugin.json")
+    Q_INTERFACES(WeaR::ISource)
+
+public:
+    explicit TextSourcePlugin(QObject* parent = nullptr);
+    ~TextSourcePlugin() override;
+
+    // =========================================================================
+    // IPlugin Interface
+    // =========================================================================
+    [[nodiscard]] PluginInfo info() const override;
+    [[nodiscard]] QString name() const override { return QStringLiteral("Text Source"); }
+    [[nodiscard]] QString version() const override { return QStringLiteral("0.1"); }
+    [[nodiscard]] PluginType type() const override { return PluginType::Source; }
+    [[nodiscard]] PluginCapability capabilities() const override;
+
+    void attachHost(IPluginHost* host) override { m_host = host; }
+    bool initialize() override;
+    void shutdown() override;
+    [[nodiscard]] bool isActive() const override { return m_initialized; }
+
+    QWidget* settingsWidget() override;
+    [[nodiscard]] QString lastError() const override { return m_lastError; }
+
+    // =========================================================================
+    // ISource Interface
+    // =========================================================================
+    bool configure(const SourceConfig& config) override;
+    [[nodiscard]] SourceConfig config() const override;
+
+    bool start() override;
+    void stop() override;
+    [[nodiscard]] bool isRunning() const override { return m_running; }
+
+    [[nodiscard]] VideoFrame captureVideoFrame() override;
+
+    [[nodiscard]] QSize nativeResolution() const override;
+    [[nodiscard]] double nativeFps() const override { return 60.0; }
+    [[nodiscard]] QSize outputResolution() const override { return nativeResolution(); }
+    [[nodiscard]] double outputFps() const override { return 60.0; }
+
+    [[nodiscard]] QVariantMap saveSettings() const override;
+    bool loadSettings(const QVariantMap& settings) override;
+
+    // =========================================================================
+    // Text Source Specific API
+    // =========================================================================
+
+    /**
+     * @brief Set the text; lines are separated by '\n'
+     *
+     * Only lines that differ from the previous text are redrawn.
+     */
+    void setText(const QString& text);
+
+    /**
+     * @brief Get the text
+     */
+    [[nodiscard]] QString text() const;
+
+    /**
+     * @brief Set font and color (clears the glyph atlas)
+     */
+    void setStyle(const QFont& font, const QColor& color);
+
+    /**
+     * @brief Enable ticker mode
+     *
+     * The text is shown on a single line scrolling right to left across
+     * the configured width (SourceConfig::resolution).
+     *
+     * @param enabled Scroll the text
+     * @param pixelsPerSecond Scroll speed
+     */
+    void setTicker(bool enabled, double pixelsPerSecond = 120.0);
+
+    /**
+     * @brief Check if ticker mode is enabled
+     */
+    [[nodiscard]] bool isTicker() const;
+
+private:
+    void relayout();
+    void redrawLine(int index);
+    void rebuildStrip();
+    QImage tickerFrame();
+
+    IPluginHost* m_host = nullptr;
+    bool m_initialized = false;
+    bool m_running = false;
+    QString m_lastError;
+    mutable QMutex m_mutex;
+
+    SourceConfig m_config;
+    QFont m_font{QStringLiteral("Arial"), 32, QFont::Bold};
+    QColor m_color{Qt::white};
+    GlyphAtlas m_atlas;
+
+    // Static layout
+    QString m_text;
+    QStringList m_lines;            ///< Lines currently drawn in m_canvas
+    std::vector<int> m_lineWidths;
+    QImage m_canvas;
+    bool m_fullRedraw = true;
+
+    // Ticker
+    bool m_ticker = false;
+    double m_tickerSpeed = 120.0;   ///< Pixels per second
+    QImage m_strip;                 ///< Whole ticker text plus gap, one line high
+    QImage m_tickerBuffers[2];      ///< Output frames, reused when not in use
+    QElapsedTimer m_clock;
+
+    CroppedViewCache m_cropView;    ///< Keeps the region view of unchanged text
+    int64_t m_frameNumber = 0;
+
+    static constexpr int kTickerGap = 64;   ///< Space before the text repeats
+};
+
+} // namespace WeaR
@@ -0,0 +1,94 @@
+// ==============================================================================
+// WeaR-studio Bond Receiver Entry Point
+// ==============================================================================
+//
+// Usage:
+//   WeaR-BondReceiver [--listen address] [--port 7935] [--secret secret]
+//                     [--forward url] [--reorder-timeout ms] [--stats seconds]
+//
+// Listens on loopback unless --listen is given; any other address needs a
+// secret (--secret or the WEAR_BOND_SECRET environment variable), which
+// senders enter in the Bond Secret field. Without --forward, each session
+// is forwarded to the rtmp:// or rtmps:// URL its sender asked for.
+// Loopback test: run with --forward file:out.flv and point a sender at
+// 127.0.0.1 with links bound to 127.0.0.1, 127.0.0.2, ... and per-link
+// rate limits ("127.0.0.2@3000" in the Bond Receiver fields).
+// ==============================================================================
+
+#include <BondedReceiver.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QTimer>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("WeaR Bond Receiver");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Reassembles bonded WeaR Studio uplinks and forwards the stream.");
+    parser.addHelpOption();
+
+    QCommandLineOption listenOption("listen", "Address to listen on (default: 127.0.0.1).", "address");
+    QCommandLineOption portOption("port", "Port to listen on (default: 7935).", "port", "7935");
+    QCommandLineOption secretOption("secret", "Shared secret senders must present "
+                                    "(default: $WEAR_BOND_SECRET; required off loopback).", "secret");
+    QCommandLineOption forwardOption("forward", "Forward every session here instead of the sender's URL.", "url");
+    QCommandLineOption reorderOption("reorder-timeout", "Wait for a missing chunk (ms, default: 5000).", "ms", "5000");
+    QCommandLineOption statsOption("stats", "Print session statistics every N seconds (0 = off).", "seconds", "5");
+    parser.addOptions({listenOption, portOption, secretOption, forwardOption, reorderOption, statsOption});
+    parser.process(app);
+
+    avformat_network_init();
+
+    WeaR::BondedReceiverSettings settings;
+    settings.listenAddress = parser.value(listenOption);
+    settings.port = static_cast<quint16>(parser.value(portOption).toUInt());
+    settings.secret = parser.isSet(secretOption)
+        ? parser.value(secretOption) : qEnvironmentVariable("WEAR_BOND_SECRET");
+    settings.forwardUrl = parser.value(forwardOption);
+    settings.reorderTimeoutMs = parser.value(reorderOption).toInt();
+
+    WeaR::BondedReceiver receiver;
+    if (!receiver.listen(settings)) {
+        return 1;
+    }
+
+    QObject::connect(&receiver, &WeaR::BondedReceiver::sessionStarted,
+                     [](quint64 id, const QString& url) {
+        qDebug() << "Session" << QString::number(id, 16) << "forwarding to" << url;
+    });
+    QObject::connect(&receiver, &WeaR::BondedReceiver::sessionEnded,
+                     [](quint64 id, const QString& reason) {
+        qDebug() << "Session" << QString::number(id, 16) << "ended:" << reason;
+    });
+
+    QTimer statsTimer;
+    const int statsSeconds = parser.value(statsOption).toInt();
+    if (statsSeconds > 0) {
+        QObject::connect(&statsTimer, &QTimer::timeout, [&receiver]() {
+            for (const WeaR::BondedSessionStatistics& stats : receiver.statistics()) {
+                qDebug().noquote()
+                    << QString("Session %1: %2 links, %3 MB forwarded, %4 out of order, "
+                               "%5 duplicates, %6 waiting, max gap %7 ms")
+                           .arg(QString::number(stats.sessionId, 16))
+                           .arg(stats.links)
+                           .arg(stats.bytesForwarded / (1024.0 * 1024.0), 0, 'f', 1)
+                           .arg(stats.outOfOrder)
+                           .arg(stats.duplicates)
+                           .arg(stats.reorderChunks)
+                           .arg(stats.maxGapWaitMs, 0, 'f', 0);
+            }
+        });
+        statsTimer.start(statsSeconds * 1000);
+    }
+
+    int result = app.exec();
+    avformat_network_deinit();
+    return result;
+}
@@ -0,0 +1,165 @@
+// ==============================================================================
+// WeaR-studio Format Conversion Benchmark
+// ==============================================================================
+//
+// Usage:
+//   WeaR-ConvertBench [--size WxH] [--layers count] [--frames count]
+//
+// Composites a scene-like frame (opaque background, translucent layers)
+// and converts it to I420 with the encoder's scaler settings, three ways:
+// - Unpremultiply: premultiplied ARGB canvas converted to ARGB32 before
+//   the scaler, as the encoder used to
+// - Premultiplied: the same canvas handed to the scaler as BGRA, the path
+//   scenes with a translucent background take now
+// - RGB32: opaque scenes composited into RGB32 and handed over as is
+// Reports the mean composite and conversion time per frame.
+// ==============================================================================
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+
+#include <algorithm>
+#include <vector>
+
+// FFmpeg headers (C linkage)
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+struct Timing {
+    double compositeMs = 0.0;   ///< Mean canvas fill and layer blending
+    double convertMs = 0.0;     ///< Mean QImage format conversion and scaler
+};
+
+/**
+ * @brief Translucent layer with a gradient, like a text or image overlay
+ */
+QImage makeLayer(const QSize& size, int index) {
+    QImage layer(size, QImage::Format_ARGB32_Premultiplied);
+    layer.fill(Qt::transparent);
+
+    QPainter painter(&layer);
+    QLinearGradient gradient(0, 0, size.width(), size.height());
+    gradient.setColorAt(0.0, QColor::fromHsv((index * 70) % 360, 200, 230, 220));
+    gradient.setColorAt(1.0, QColor::fromHsv((index * 70 + 120) % 360, 180, 180, 90));
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setBrush(gradient);
+    painter.setPen(Qt::NoPen);
+    painter.drawRoundedRect(layer.rect().adjusted(4, 4, -4, -4), 24, 24);
+    return layer;
+}
+
+Timing run(QImage::Format canvasFormat, bool unpremultiply, const QSize& size,
+           const std::vector<QImage>& layers, int frames) {
+    Timing timing;
+
+    SwsContext* scaler = sws_getContext(size.width(), size.height(), AV_PIX_FMT_BGRA,
+                                        size.width(), size.height(), AV_PIX_FMT_YUV420P,
+                                        SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    AVFrame* yuv = av_frame_alloc();
+    if (!scaler || !yuv) {
+        qCritical() << "Failed to create the scaler";
+        sws_freeContext(scaler);
+        av_frame_free(&yuv);
+        return timing;
+    }
+    yuv->format = AV_PIX_FMT_YUV420P;
+    yuv->width = size.width();
+    yuv->height = size.height();
+    av_frame_get_buffer(yuv, 32);
+
+    QImage canvas(size, canvasFormat);
+    QElapsedTimer timer;
+    qint64 compositeNs = 0;
+    qint64 convertNs = 0;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        timer.start();
+        canvas.fill(QColor(24, 24, 32));
+        QPainter painter(&canvas);
+        for (size_t i = 0; i < layers.size(); ++i) {
+            // Layers drift so no frame is identical to the last
+            const int x = static_cast<int>((frame * 7 + i * 211) % std::max(size.width() - layers[i].width(), 1));
+            const int y = static_cast<int>((frame * 3 + i * 137) % std::max(size.height() - layers[i].height(), 1));
+            painter.drawImage(x, y, layers[i]);
+        }
+        painter.end();
+        compositeNs += timer.nsecsElapsed();
+
+        timer.start();
+        const QImage input = unpremultiply ? canvas.convertToFormat(QImage::Format_ARGB32) : canvas;
+        const uint8_t* src[1] = { input.constBits() };
+        const int srcStride[1] = { static_cast<int>(input.bytesPerLine()) };
+        sws_scale(scaler, src, srcStride, 0, size.height(), yuv->data, yuv->linesize);
+        convertNs += timer.nsecsElapsed();
+    }
+
+    sws_freeContext(scaler);
+    av_frame_free(&yuv);
+
+    timing.compositeMs = compositeNs / 1e6 / frames;
+    timing.convertMs = convertNs / 1e6 / frames;
+    return timing;
+}
+
+void report(const char* name, const Timing& timing) {
+    qInfo().noquote() << QString("%1 composite %2 ms, to I420 %3 ms, total %4 ms per frame")
+                             .arg(QString::fromLatin1(name), -14)
+                             .arg(timing.compositeMs, 0, 'f', 2).arg(timing.convertMs, 0, 'f', 2)
+                             .arg(timing.compositeMs + timing.convertMs, 0, 'f', 2);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("WeaR Conversion Benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures canvas format and RGB to YUV conversion cost per frame.");
+    parser.addHelpOption();
+
+    QCommandLineOption sizeOption("size", "Canvas size (default: 1920x1080).", "WxH", "1920x1080");
+    QCommandLineOption layersOption("layers", "Translucent layers per frame (default: 4).", "count", "4");
+    QCommandLineOption framesOption("frames", "Frames per run (default: 300).", "count", "300");
+    parser.addOptions({sizeOption, layersOption, framesOption});
+    parser.process(app);
+
+    const QStringList dimensions = parser.value(sizeOption).split('x');
+    const QSize size(dimensions.value(0).toInt() & ~1, dimensions.value(1).toInt() & ~1);
+    if (size.isEmpty()) {
+        qCritical() << "Invalid size:" << parser.value(sizeOption);
+        return 1;
+    }
+    const int frames = std::max(parser.value(framesOption).toInt(), 1);
+
+    std::vector<QImage> layers;
+    for (int i = 0; i < parser.value(layersOption).toInt(); ++i) {
+        layers.push_back(makeLayer(QSize(size.width() / 3, size.height() / 3), i));
+    }
+
+    // Warm caches and the scaler's lazy tables before measuring
+    run(QImage::Format_RGB32, false, size, layers, 5);
+
+    const Timing before = run(QImage::Format_ARGB32_Premultiplied, true, size, layers, frames);
+    report("Unpremultiply:", before);
+    const Timing premultiplied = run(QImage::Format_ARGB32_Premultiplied, false, size, layers, frames);
+    report("Premultiplied:", premultiplied);
+    const Timing opaque = run(QImage::Format_RGB32, false, size, layers, frames);
+    report("RGB32:", opaque);
+
+    const double beforeMs = before.compositeMs + before.convertMs;
+    qInfo().noquote() << QString("Saved %1 ms per frame (%2%) for opaque scenes")
+                             .arg(beforeMs - opaque.compositeMs - opaque.convertMs, 0, 'f', 2)
+                             .arg(100.0 * (1.0 - (opaque.compositeMs + opaque.convertMs) / std::max(beforeMs, 1e-9)),
+                                  0, 'f', 0);
+    return 0;
+}
@@ -0,0 +1,189 @@
+// ==============================================================================
+// WeaR-studio Ingest Selection Harness
+// ==============================================================================
+//
+// Usage:
+//   WeaR-IngestHarness [--listener delay[:kbps]]... [--screen count]
+//                      [--bitrate kbps] [--rounds count]
+//
+// Starts local stand-in ingests and runs IngestSelector::selectUrl() on
+// them several times. Each --listener answers the RTMP handshake after
+// `delay` ms and, with `kbps`, reads uploads at that rate (e.g. "40:3000").
+// --screen adds plain listeners so the list is long enough to be screened
+// first, like Twitch's directory. The first round probes; later rounds
+// must come from the cached screening and results and return at once.
+//
+// Loopback connects complete in the kernel, so the delays show up in the
+// handshake time, not the RTT; add per-port delay with tc netem to make
+// the selection itself depend on them.
+// ==============================================================================
+
+#include <IngestSelector.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+constexpr int kHandshakeSize = 1536;
+
+/**
+ * @brief Stand-in ingest with a slow handshake answer and a capped read rate
+ */
+class DelayedListener : public QObject {
+public:
+    DelayedListener(int delayMs, int rateKbps, QObject* parent = nullptr)
+        : QObject(parent)
+        , m_delayMs(delayMs)
+        , m_rateKbps(rateKbps)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, &DelayedListener::accept);
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost, 0); }
+    [[nodiscard]] quint16 port() const { return m_server.serverPort(); }
+    [[nodiscard]] int delayMs() const { return m_delayMs; }
+    [[nodiscard]] int rateKbps() const { return m_rateKbps; }
+
+private:
+    void accept() {
+        while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QObject::destroyed, this, [this, socket]() {
+                m_handshakes.remove(socket);
+            });
+
+            // A small receive window lets the read rate pace the sender
+            if (m_rateKbps > 0) {
+                socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 8 * 1024);
+                socket->setReadBufferSize(8 * 1024);
+
+                auto* pacer = new QTimer(socket);
+                const qint64 bytesPerTick = std::max<qint64>(m_rateKbps * 1000 / 8 / 100, 1);
+                connect(pacer, &QTimer::timeout, socket, [this, socket, bytesPerTick]() {
+                    consume(socket, bytesPerTick);
+                });
+                pacer->start(10);
+            } else {
+                connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    consume(socket, socket->bytesAvailable());
+                });
+            }
+        }
+    }
+
+    void consume(QTcpSocket* socket, qint64 budget) {
+        QByteArray& handshake = m_handshakes[socket];
+        const bool answered = handshake.size() > kHandshakeSize;
+
+        const QByteArray data = socket->read(budget);
+        if (answered) return;
+        handshake += data;
+        if (handshake.size() <= kHandshakeSize) return;
+
+        // S0 + S1 + S2 (echoing C1) after the artificial delay
+        QByteArray answer(1 + 2 * kHandshakeSize, '\0');
+        answer[0] = 3;
+        for (int i = 9; i <= kHandshakeSize; ++i) {
+            answer[i] = static_cast<char>(QRandomGenerator::global()->bounded(256));
+        }
+        answer.replace(1 + kHandshakeSize, kHandshakeSize, handshake.mid(1, kHandshakeSize));
+
+        QTimer::singleShot(m_delayMs, socket, [socket, answer]() {
+            socket->write(answer);
+        });
+    }
+
+    QTcpServer m_server;
+    int m_delayMs = 0;
+    int m_rateKbps = 0;
+    QHash<QTcpSocket*, QByteArray> m_handshakes;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("WeaR Ingest Harness");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs ingest selection against local listeners with artificial delay.");
+    parser.addHelpOption();
+
+    QCommandLineOption listenerOption("listener", "Stand-in ingest: handshake delay in ms, "
+                                      "optionally :kbps read rate (repeatable).", "delay[:kbps]");
+    QCommandLineOption screenOption("screen", "Extra plain listeners, to exercise screening (default: 0).",
+                                    "count", "0");
+    QCommandLineOption bitrateOption("bitrate", "Stream bitrate the ingest must sustain (default: 6000).",
+                                     "kbps", "6000");
+    QCommandLineOption roundsOption("rounds", "Selections to run (default: 3).", "count", "3");
+    parser.addOptions({listenerOption, screenOption, bitrateOption, roundsOption});
+    parser.process(app);
+
+    QStringList specs = parser.values(listenerOption);
+    if (specs.isEmpty()) {
+        specs = {QStringLiteral("0"), QStringLiteral("60"), QStringLiteral("150"), QStringLiteral("0:1500")};
+    }
+    for (int i = 0; i < parser.value(screenOption).toInt(); ++i) {
+        specs.append(QStringLiteral("0"));
+    }
+
+    QList<DelayedListener*> listeners;
+    QList<WeaR::IngestEndpoint> endpoints;
+    for (const QString& spec : specs) {
+        const QStringList parts = spec.split(':');
+        auto* listener = new DelayedListener(parts.value(0).toInt(), parts.value(1).toInt(), &app);
+        if (!listener->listen()) {
+            qCritical() << "Failed to start a listener";
+            return 1;
+        }
+        listeners.append(listener);
+        endpoints.append(WeaR::IngestEndpoint{
+            spec, QString("rtmp://127.0.0.1:%1/app").arg(listener->port())});
+    }
+
+    WeaR::IngestSelector& selector = WeaR::IngestSelector::instance();
+    selector.setEndpoints(WeaR::StreamService::Custom, endpoints);
+
+    // Selection blocks, so it runs beside the listeners' event loop
+    const int rounds = parser.value(roundsOption).toInt();
+    const int bitrate = parser.value(bitrateOption).toInt();
+    std::thread runner([&]() {
+        for (int round = 1; round <= rounds; ++round) {
+            QElapsedTimer timer;
+            timer.start();
+            const QString url = selector.selectUrl(WeaR::StreamService::Custom, QString(), bitrate);
+            qInfo().noquote() << QString("Round %1: %2 in %3 ms")
+                                     .arg(round).arg(url.isEmpty() ? "(none)" : url)
+                                     .arg(timer.nsecsElapsed() / 1e6, 0, 'f', 1);
+        }
+
+        for (int i = 0; i < endpoints.size(); ++i) {
+            const WeaR::IngestProbeResult result = selector.cachedResult(endpoints[i].url);
+            qInfo().noquote() << QString("  %1 delay %2 ms, cap %3 kbps: %4")
+                .arg(endpoints[i].url).arg(listeners[i]->delayMs()).arg(listeners[i]->rateKbps())
+                .arg(result.url.isEmpty()
+                     ? QStringLiteral("screened out")
+                     : QString("RTT %1 ms, handshake %2 ms, %3 kbps%4")
+                           .arg(result.rttMs, 0, 'f', 2).arg(result.handshakeMs, 0, 'f', 1)
+                           .arg(result.throughputKbps, 0, 'f', 0)
+                           .arg(result.rtmp ? "" : " (no RTMP answer)"));
+        }
+
+        QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+    });
+
+    const int exitCode = app.exec();
+    runner.join();
+    return exitCode;
+}
@@ -0,0 +1,152 @@
+// ==============================================================================
+// WeaR-studio Activity Mailbox Benchmark
+// ==============================================================================
+//
+// Usage:
+//   WeaR-MailboxBench [--threads count] [--rate events/s] [--seconds count]
+//
+// Worker threads post per-frame/per-packet events at a fixed rate, and
+// the events reach the main thread in two ways: a queued call per event
+// (how the render, encode and send stages used to notify the GUI), then
+// an ActivityMailbox. For each, it reports the producer-side cost per
+// event, the wakeups of the main thread and how long the main thread
+// took to account for every event after the producers stopped.
+// ==============================================================================
+
+#include <ActivityMailbox.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QEventLoop>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct RunResult {
+    int64_t posted = 0;         ///< Events posted by the producers
+    int64_t received = 0;       ///< Events accounted on the main thread
+    int64_t wakeups = 0;        ///< Deliveries to the main thread
+    double postNs = 0.0;        ///< Mean producer time per event
+    double drainMs = 0.0;       ///< Last event posted to every event accounted
+};
+
+RunResult run(bool useMailbox, int threads, int rate, int seconds) {
+    RunResult result;
+    QObject receiver;
+    WeaR::ActivityMailbox mailbox(100);
+    QEventLoop loop;
+
+    std::atomic<int64_t> posted{0};
+    std::atomic<int64_t> postNs{0};
+    Clock::time_point producersDone;
+    bool finished = false;
+
+    // Main thread only
+    auto checkDrained = [&]() {
+        if (finished && result.received == posted.load()) {
+            result.drainMs = std::chrono::duration<double, std::milli>(Clock::now() - producersDone).count();
+            loop.quit();
+        }
+    };
+
+    QObject::connect(&mailbox, &WeaR::ActivityMailbox::summaryReady, &receiver,
+                     [&](const WeaR::ActivitySummary& summary) {
+        result.received += summary.count;
+        result.wakeups++;
+        checkDrained();
+    });
+
+    std::thread runner([&]() {
+        std::vector<std::thread> producers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&]() {
+                const auto period = std::chrono::nanoseconds(1000000000LL / rate);
+                const auto end = Clock::now() + std::chrono::seconds(seconds);
+                int64_t spentNs = 0;
+
+                for (auto next = Clock::now(); next < end; next += period) {
+                    std::this_thread::sleep_until(next);
+
+                    const auto start = Clock::now();
+                    if (useMailbox) {
+                        mailbox.post(4096, false, 0);
+                    } else {
+                        QMetaObject::invokeMethod(&receiver, [&]() {
+                            result.received++;
+                            result.wakeups++;
+                            checkDrained();
+                        }, Qt::QueuedConnection);
+                    }
+                    spentNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                    posted.fetch_add(1, std::memory_order_relaxed);
+                }
+                postNs += spentNs;
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+
+        // Queued behind every per-event call of this thread
+        producersDone = Clock::now();
+        QMetaObject::invokeMethod(&receiver, [&]() {
+            finished = true;
+            checkDrained();
+        }, Qt::QueuedConnection);
+    });
+
+    loop.exec();
+    runner.join();
+
+    result.posted = posted.load();
+    result.postNs = static_cast<double>(postNs.load()) / std::max<int64_t>(result.posted, 1);
+    return result;
+}
+
+void report(const char* name, const RunResult& result) {
+    qInfo().noquote() << QString("%1: %2 events, %3 main-thread wakeups (%4 events each), "
+                                 "%5 ns per post, caught up %6 ms after the last event")
+                             .arg(QString::fromLatin1(name), -8).arg(result.posted).arg(result.wakeups)
+                             .arg(static_cast<double>(result.received) / std::max<int64_t>(result.wakeups, 1), 0, 'f', 1)
+                             .arg(result.postNs, 0, 'f', 0).arg(result.drainMs, 0, 'f', 1);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("WeaR Mailbox Benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compares per-event queued calls with ActivityMailbox summaries.");
+    parser.addHelpOption();
+
+    QCommandLineOption threadsOption("threads", "Producer threads (default: 3, render/encode/send).",
+                                     "count", "3");
+    QCommandLineOption rateOption("rate", "Events per second per thread (default: 2000).", "events/s", "2000");
+    QCommandLineOption secondsOption("seconds", "Duration of each run (default: 3).", "count", "3");
+    parser.addOptions({threadsOption, rateOption, secondsOption});
+    parser.process(app);
+
+    const int threads = std::max(parser.value(threadsOption).toInt(), 1);
+    const int rate = std::max(parser.value(rateOption).toInt(), 1);
+    const int seconds = std::max(parser.value(secondsOption).toInt(), 1);
+
+    const RunResult queued = run(false, threads, rate, seconds);
+    report("Queued", queued);
+    const RunResult mailbox = run(true, threads, rate, seconds);
+    report("Mailbox", mailbox);
+
+    qInfo().noquote() << QString("Main-thread wakeups reduced %1x")
+                             .arg(static_cast<double>(queued.wakeups) / std::max<int64_t>(mailbox.wakeups, 1),
+                                  0, 'f', 0);
+    return 0;
+}
@@ -9,10 +9,15 @@
 #include <SceneManager.h>
 #include <StreamManager.h>
 #include <EncoderManager.h>
+#include <BroadcastDelay.h>
+#include <IngestSelector.h>
 #include <CaptureManager.h>
 #include <PluginManager.h>
 #include <Scene.h>
 #include <SceneItem.h>
+#include <ThreadPolicy.h>
+#include <SceneCollection.h>
+#include <SourceActivation.h>
 
 #include <QMenuBar>
 #include <QMenu>
@@ -24,14 +29,35 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
+#include <QSpinBox>
 #include <QPushButton>
 #include <QGroupBox>
 #include <QMessageBox>
 #include <QInputDialog>
+#include <QFileDialog>
+#include <QFile>
+#include <QSettings>
+#include <QUrl>
 #include <QDebug>
 
+#include <algorithm>
+#include <utility>
+
 namespace WeaR {
 
+namespace {
+
+// Fold a 10 Hz summary into the window shown by the 1 s statistics update
+void accumulate(ActivitySummary& window, const ActivitySummary& summary) {
+    window.count += summary.count;
+    window.bytes += summary.bytes;
+    window.flagged += summary.flagged;
+    window.lastValue = summary.lastValue;
+    window.intervalMs += summary.intervalMs;
+}
+
+} // namespace
+
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
 {
@@ -45,6 +71,9 @@ MainWindow::MainWindow(QWidget* parent)
 }
 
 MainWindow::~MainWindow() {
+    // Write pending scene changes before the scenes go away
+    SceneCollection::instance().flushAutosave();
+    
     // Stop streaming if running
     StreamManager::instance().stopStream();
     
@@ -84,6 +113,15 @@ void MainWindow::setupMenuBar() {
     newSceneAction->setShortcut(QKeySequence::New);
     connect(newSceneAction, &QAction::triggered, this, &MainWindow::onAddScene);
     
+    QAction* exportAction = fileMenu->addAction("&Export Scene Collection...");
+    connect(exportAction, &QAction::triggered, [this]() {
+        QString path = QFileDialog::getSaveFileName(this, "Export Scene Collection",
+                                                    "scenes.json", "JSON (*.json)");
+        if (!path.isEmpty() && !SceneCollection::instance().exportJson(path)) {
+            QMessageBox::warning(this, "Export Failed", "Could not write " + path);
+        }
+    });
+    
     fileMenu->addSeparator();
     
     QAction* settingsAction = fileMenu->addAction("&Settings...");
@@ -111,6 +149,40 @@ void MainWindow::setupMenuBar() {
     stopAction->setShortcut(QKeySequence("F6"));
     connect(stopAction, &QAction::triggered, this, &MainWindow::onStopStreaming);
     
+    streamMenu->addSeparator();
+    
+    // Compositor: YUV skips the RGB to YUV conversion for supported scenes
+    QAction* yuvAction = streamMenu->addAction("Composite in &YUV");
+    yuvAction->setCheckable(true);
+    yuvAction->setChecked(QSettings().value(QStringLiteral("Render/compositor")).toString() == "yuv");
+    connect(yuvAction, &QAction::toggled, [](bool yuv) {
+        SceneManager::instance().setCompositorMode(yuv ? CompositorMode::Yuv : CompositorMode::Rgb);
+        QSettings().setValue(QStringLiteral("Render/compositor"), yuv ? "yuv" : "rgb");
+    });
+    
+    QAction* compareAction = streamMenu->addAction("&Compare Compositors...");
+    connect(compareAction, &QAction::triggered, [this]() {
+        QString reason;
+        Scene* scene = SceneManager::instance().activeScene();
+        if (!YuvCompositor::canComposite(scene, &reason)) {
+            QMessageBox::information(this, "Compare Compositors",
+                                     "The active scene cannot be composited in YUV: " + reason);
+            return;
+        }
+        
+        const CompositorComparison result = SceneManager::instance().compareCompositors();
+        if (!result.valid) {
+            QMessageBox::warning(this, "Compare Compositors", "The comparison produced no frame.");
+            return;
+        }
+        QMessageBox::information(this, "Compare Compositors",
+            QString("RGB composite and conversion: %1 ms\n"
+                    "YUV composite: %2 ms\n"
+                    "PSNR Y/U/V: %3 / %4 / %5 dB")
+                .arg(result.rgbMs, 0, 'f', 2).arg(result.yuvMs, 0, 'f', 2)
+                .arg(result.psnrY, 0, 'f', 1).arg(result.psnrU, 0, 'f', 1).arg(result.psnrV, 0, 'f', 1));
+    });
+    
     // Help menu
     QMenu* helpMenu = menuBar()->addMenu("&Help");
     
@@ -162,6 +234,7 @@ void MainWindow::createScenesDock() {
     // Scene list
     m_scenesList = new QListWidget();
     m_scenesList->setAlternatingRowColors(false);
+    m_scenesList->setMouseTracking(true);  // itemEntered() preloads hovered scenes
     layout->addWidget(m_scenesList);
     
     // Buttons
@@ -239,16 +312,45 @@ void MainWindow::createControlsDock() {
     m_streamUrlEdit = new QLineEdit();
     m_streamUrlEdit->setPlaceholderText("rtmp://live.twitch.tv/app");
     m_streamUrlEdit->setText("rtmp://live.twitch.tv/app");
+    m_streamUrlEdit->setToolTip("Several ingest URLs, comma separated: the one with the best "
+                                "RTT and throughput is used. A service's preset URL probes "
+                                "that service's ingests.");
     
     QLabel* keyLabel = new QLabel("Stream Key:");
     m_streamKeyEdit = new QLineEdit();
     m_streamKeyEdit->setPlaceholderText("Enter stream key");
     m_streamKeyEdit->setEchoMode(QLineEdit::Password);
     
+    QLabel* delayLabel = new QLabel("Stream Delay:");
+    m_streamDelaySpin = new QSpinBox();
+    m_streamDelaySpin->setRange(0, 300);
+    m_streamDelaySpin->setSuffix(" s");
+    m_streamDelaySpin->setSpecialValueText("Off");
+    m_streamDelaySpin->setToolTip("Lowering the delay while live skips ahead at the next keyframe");
+    
     streamLayout->addWidget(urlLabel);
     streamLayout->addWidget(m_streamUrlEdit);
     streamLayout->addWidget(keyLabel);
     streamLayout->addWidget(m_streamKeyEdit);
+    QLabel* bondLabel = new QLabel("Bond Receiver:");
+    m_bondReceiverEdit = new QLineEdit();
+    m_bondReceiverEdit->setPlaceholderText("host:port (empty = direct)");
+    
+    m_bondSecretEdit = new QLineEdit();
+    m_bondSecretEdit->setPlaceholderText("Bond receiver secret");
+    m_bondSecretEdit->setEchoMode(QLineEdit::Password);
+    
+    m_bondLinksEdit = new QLineEdit();
+    m_bondLinksEdit->setPlaceholderText("Uplink addresses, e.g. 10.0.0.5, 192.168.8.100");
+    m_bondLinksEdit->setToolTip("Local interface address per uplink, comma separated; "
+                                "address@kbps limits a link (for testing)");
+    
+    streamLayout->addWidget(delayLabel);
+    streamLayout->addWidget(m_streamDelaySpin);
+    streamLayout->addWidget(bondLabel);
+    streamLayout->addWidget(m_bondReceiverEdit);
+    streamLayout->addWidget(m_bondSecretEdit);
+    streamLayout->addWidget(m_bondLinksEdit);
     
     layout->addWidget(streamGroup);
     
@@ -278,6 +380,7 @@ void MainWindow::setupConnections() {
     // Scene management
     connect(m_scenesList, &QListWidget::currentItemChanged,
             this, &MainWindow::onSceneSelected);
+    connect(m_scenesList, &QListWidget::itemEntered, this, &MainWindow::onSceneHovered);
     connect(m_addSceneBtn, &QPushButton::clicked, this, &MainWindow::onAddScene);
     connect(m_removeSceneBtn, &QPushButton::clicked, this, &MainWindow::onRemoveScene);
     
@@ -296,10 +399,32 @@ void MainWindow::setupConnections() {
         }
     });
     connect(m_settingsBtn, &QPushButton::clicked, this, &MainWindow::onSettingsClicked);
+    connect(m_streamDelaySpin, &QSpinBox::valueChanged, [](int seconds) {
+        BroadcastDelay::instance().setDelayMs(seconds * 1000);
+    });
+    connect(&BroadcastDelay::instance(), &BroadcastDelay::drained, this, [this]() {
+        if (m_drainingDelay) {
+            finishStopStreaming();
+        }
+    });
     
     // Stream state changes
     connect(&StreamManager::instance(), &StreamManager::stateChanged,
             this, &MainWindow::updateStreamState);
+    
+    // Pipeline activity arrives as rate-limited summaries, never per frame
+    // or per packet
+    connect(&SceneManager::instance(), &SceneManager::renderActivity,
+            this, [this](const ActivitySummary& summary) { accumulate(m_renderActivity, summary); });
+    connect(&EncoderManager::instance(), &EncoderManager::encodeActivity,
+            this, [this](const ActivitySummary& summary) { accumulate(m_encodeActivity, summary); });
+    connect(&StreamManager::instance(), &StreamManager::sendActivity,
+            this, [this](const ActivitySummary& summary) { accumulate(m_sendActivity, summary); });
+    
+    // Publishing starts without waiting for the next scheduled keyframe
+    connect(&StreamManager::instance(), &StreamManager::keyframeRequested,
+            &EncoderManager::instance(), &EncoderManager::requestKeyframe,
+            Qt::DirectConnection);
 }
 
 void MainWindow::initializeManagers() {
@@ -318,6 +443,18 @@ void MainWindow::initializeManagers() {
     encSettings.bitrate = 6000;
     EncoderManager::instance().configure(encSettings);
     
+    SceneManager& scenes = SceneManager::instance();
+    QSettings settings;
+    if (settings.value(QStringLiteral("Render/compositor")).toString() == "yuv") {
+        scenes.setCompositorMode(CompositorMode::Yuv);
+    }
+    
+    // Scenes kept running after use: "Scenes/warmCount", "Scenes/warmBudgetMB"
+    scenes.setWarmScenePolicy(
+        settings.value(QStringLiteral("Scenes/warmCount"), scenes.warmSceneLimit()).toInt(),
+        settings.value(QStringLiteral("Scenes/warmBudgetMB"),
+                       scenes.warmMemoryBudget() / (1024 * 1024)).toLongLong() * 1024 * 1024);
+    
     // Set up scene manager preview callback
     SceneManager::instance().setPreviewCallback([this](const QImage& frame) {
         // Use queued connection to update UI from render thread
@@ -326,6 +463,13 @@ void MainWindow::initializeManagers() {
                                   Q_ARG(QImage, frame));
     });
     
+    // Restore the last session's scenes and keep them saved
+    SceneCollection& collection = SceneCollection::instance();
+    if (QFile::exists(SceneCollection::defaultPath())) {
+        collection.load(SceneCollection::defaultPath());
+    }
+    collection.enableAutosave();
+    
     // Refresh UI
     refreshScenesList();
     refreshSourcesList();
@@ -335,6 +479,7 @@ void MainWindow::initializeManagers() {
     
     // Start stats timer
     m_statsTimer->start();
+    m_activityWindow.start();
     
     m_statusLabel->setText("Ready");
     qDebug() << "Managers initialized";
@@ -352,6 +497,16 @@ void MainWindow::onSceneSelected(QListWidgetItem* current, QListWidgetItem* /*pr
     }
 }
 
+void MainWindow::onSceneHovered(QListWidgetItem* item) {
+    // The pointer on a scene usually means a switch is coming: start its
+    // sources now so the click shows no cold frames
+    SceneManager& scenes = SceneManager::instance();
+    Scene* scene = item ? scenes.sceneByName(item->text()) : nullptr;
+    if (scene && scene != scenes.activeScene() && !scenes.isSceneWarm(scene)) {
+        scenes.preloadScene(scene);
+    }
+}
+
 void MainWindow::onAddScene() {
     bool ok;
     QString name = QInputDialog::getText(this, "New Scene",
@@ -447,6 +602,22 @@ void MainWindow::onAddSource() {
     }
     
     if (source) {
+        // Plugins provide one instance per source type: a second item shows
+        // the same content, and its settings are the first item's
+        bool shared = false;
+        for (Scene* scene : SceneManager::instance().scenes()) {
+            for (SceneItem* item : scene->items()) {
+                shared = shared || item->source() == source;
+            }
+        }
+        if (shared) {
+            const auto answer = QMessageBox::question(this, "Shared Source",
+                QString("\"%1\" sources share one instance. The new item will show the same "
+                        "content as the existing ones, and changing its settings changes all "
+                        "of them.\n\nAdd it anyway?").arg(sourceType));
+            if (answer != QMessageBox::Yes) return;
+        }
+        
         activeScene->addItem(sourceName, source);
         refreshSourcesList();
     }
@@ -469,43 +640,106 @@ void MainWindow::onRemoveSource() {
 }
 
 void MainWindow::onStartStreaming() {
-    QString url = m_streamUrlEdit->text().trimmed();
+    // A new session does not wait for the last one's delayed tail
+    if (m_drainingDelay) {
+        finishStopStreaming();
+    }
+    
+    QStringList urls;
+    for (const QString& entry : m_streamUrlEdit->text().split(',', Qt::SkipEmptyParts)) {
+        if (!entry.trimmed().isEmpty()) {
+            urls.append(entry.trimmed());
+        }
+    }
     QString key = m_streamKeyEdit->text().trimmed();
     
-    if (url.isEmpty()) {
+    if (urls.isEmpty()) {
         QMessageBox::warning(this, "Missing URL", "Please enter a stream URL.");
         return;
     }
     
     // Configure stream settings
     StreamSettings settings;
-    settings.url = url;
+    settings.url = urls.first();
     settings.streamKey = key;
+    
+    // Ingest candidates: the URLs given, or the list of a preset's service
+    QList<IngestEndpoint> ingests;
+    if (urls.size() > 1) {
+        for (const QString& url : urls) {
+            ingests.append(IngestEndpoint{QUrl(url).host(), url});
+        }
+    } else {
+        settings.service = StreamSettings::serviceForUrl(settings.url);
+    }
+    IngestSelector::instance().setEndpoints(StreamService::Custom, ingests);
     settings.videoWidth = 1920;
     settings.videoHeight = 1080;
     settings.videoFpsNum = 60;
     settings.videoBitrate = 6000;
     
-    StreamManager::instance().configure(settings);
+    // Bonded uplink: "host:port" of the receiver, links as "address[@kbps]"
+    const QString receiver = m_bondReceiverEdit->text().trimmed();
+    if (!receiver.isEmpty()) {
+        settings.bonding.enabled = true;
+        settings.bonding.receiverHost = receiver.section(':', 0, 0);
+        const int port = receiver.section(':', 1, 1).toInt();
+        if (port > 0) {
+            settings.bonding.receiverPort = static_cast<quint16>(port);
+        }
+        settings.bonding.secret = m_bondSecretEdit->text();
+        
+        const QStringList links = m_bondLinksEdit->text().split(',', Qt::SkipEmptyParts);
+        for (const QString& entry : links) {
+            BondedLinkSettings link;
+            link.localAddress = entry.section('@', 0, 0).trimmed();
+            link.maxKbps = entry.section('@', 1, 1).toInt();
+            link.name = link.localAddress;
+            settings.bonding.links.append(link);
+        }
+    }
+    
+    StreamManager& stream = StreamManager::instance();
+    if (!stream.isConnected()) {
+        stream.configure(settings);
+    }
     
-    // Start encoder first
-    if (!EncoderManager::instance().isRunning()) {
+    // Handshake with the ingest on the output thread while the encoder opens
+    if (!stream.prewarm()) {
+        QMessageBox::critical(this, "Stream Error", "Failed to start streaming.");
+        return;
+    }
+    
+    const bool encoderWasRunning = EncoderManager::instance().isRunning();
+    if (!encoderWasRunning) {
         EncoderManager::instance().start();
     }
+    stream.setCodecParameters(EncoderManager::instance().codecParameters());
     
-    // Connect encoder to stream
-    EncoderManager::instance().setPacketCallback([](const EncodedPacket& pkt) {
+    // Connect encoder to stream through the broadcast delay
+    BroadcastDelay::instance().setOutputCallback([](const EncodedPacket& pkt) {
         StreamManager::instance().writePacket(pkt.data, pkt.size,
                                               pkt.pts, pkt.dts, pkt.isKeyframe);
     });
+    EncoderManager::instance().setPacketCallback([](const EncodedPacket& pkt) {
+        BroadcastDelay::instance().push(pkt);
+    });
     
     // Enable encoder output from scene manager
     SceneManager::instance().setEncoderOutputEnabled(true);
     
-    // Start streaming
-    if (StreamManager::instance().startStream()) {
+    // Go live: publishing starts on the first (requested) keyframe
+    if (stream.startStream()) {
         m_statusLabel->setText("Connecting...");
     } else {
+        // Undo the wiring so the scene stops feeding an encoder nobody reads
+        SceneManager::instance().setEncoderOutputEnabled(false);
+        EncoderManager::instance().setPacketCallback(nullptr);
+        if (!encoderWasRunning) {
+            EncoderManager::instance().stop();
+        }
+        BroadcastDelay::instance().clear();
+        stream.stopStream();
         QMessageBox::critical(this, "Stream Error", "Failed to start streaming.");
     }
 }
@@ -513,6 +747,20 @@ void MainWindow::onStartStreaming() {
 void MainWindow::onStopStreaming() {
     SceneManager::instance().setEncoderOutputEnabled(false);
     EncoderManager::instance().stop();
+    
+    // The delayed tail still goes out; stopping again drops it
+    if (!m_drainingDelay && BroadcastDelay::instance().statistics().bufferedPackets > 0) {
+        m_drainingDelay = true;
+        BroadcastDelay::instance().drain();
+        m_statusLabel->setText("Sending delayed tail...");
+        return;
+    }
+    finishStopStreaming();
+}
+
+void MainWindow::finishStopStreaming() {
+    m_drainingDelay = false;
+    BroadcastDelay::instance().clear();
     StreamManager::instance().stopStream();
     m_statusLabel->setText("Stopped");
 }
@@ -528,15 +776,52 @@ void MainWindow::onPreviewFrame(const QImage& frame) {
 }
 
 void MainWindow::updateStatistics() {
+    // Rates over the activity summaries received since the last update
+    const double windowMs = static_cast<double>(std::max<qint64>(m_activityWindow.restart(), 1));
+    const ActivitySummary rendered = std::exchange(m_renderActivity, ActivitySummary());
+    const ActivitySummary encoded = std::exchange(m_encodeActivity, ActivitySummary());
+    const ActivitySummary sent = std::exchange(m_sendActivity, ActivitySummary());
+    
     // Render stats
     RenderStatistics renderStats = SceneManager::instance().statistics();
-    m_fpsLabel->setText(QString("FPS: %1").arg(renderStats.currentFps, 0, 'f', 1));
+    m_fpsLabel->setText(QString("FPS: %1").arg(rendered.count * 1000.0 / windowMs, 0, 'f', 1));
+    SourceActivationStatistics sourceStats = SourceActivation::instance().statistics();
+    m_fpsLabel->setToolTip(QString("Late frames: %1 of %2\n"
+                                   "Scene switch: %3 ms last, %4 ms average (%5 of %6 warm)\n"
+                                   "Sources: %7 active, %8 lingering\n%9")
+                           .arg(rendered.flagged)
+                           .arg(rendered.count)
+                           .arg(renderStats.lastSwitchLatencyMs, 0, 'f', 1)
+                           .arg(renderStats.averageSwitchLatencyMs, 0, 'f', 1)
+                           .arg(renderStats.warmSwitches)
+                           .arg(renderStats.sceneSwitches)
+                           .arg(sourceStats.active)
+                           .arg(sourceStats.lingering)
+                           .arg(ThreadPolicy::instance().diagnosticsText()));
     
     // Stream stats
     if (StreamManager::instance().isStreaming()) {
         StreamStatistics streamStats = StreamManager::instance().statistics();
+        // bytes * 8 / ms = kbit/s
         m_bitrateLabel->setText(QString("Bitrate: %1 kbps")
-                                .arg(streamStats.currentBitrateKbps, 0, 'f', 0));
+                                .arg(sent.bytes * 8.0 / windowMs, 0, 'f', 0));
+        
+        BroadcastDelayStatistics delayStats = BroadcastDelay::instance().statistics();
+        QString tooltip = QString("Encoder: %1 kbps, %2 keyframes\n"
+                                  "Delay: %3 s (%4 s buffered, %5 MB spilled to disk)")
+                              .arg(encoded.bytes * 8.0 / windowMs, 0, 'f', 0)
+                              .arg(encoded.flagged)
+                              .arg(delayStats.delayMs / 1000.0, 0, 'f', 1)
+                              .arg(delayStats.bufferedMs / 1000.0, 0, 'f', 1)
+                              .arg(delayStats.spilledBytes / (1024.0 * 1024.0), 0, 'f', 1);
+        for (const BondedLinkStatistics& link : streamStats.bondedLinks) {
+            tooltip += QString("\n%1: %2, %3 kbps, RTT %4 ms, %5 resent")
+                           .arg(link.name, link.up ? "up" : "down")
+                           .arg(link.throughputKbps, 0, 'f', 0)
+                           .arg(link.rttMs, 0, 'f', 0)
+                           .arg(link.chunksResent);
+        }
+        m_bitrateLabel->setToolTip(tooltip);
         
         // Duration
         int64_t ms = streamStats.streamDurationMs;
@@ -569,6 +854,12 @@ void MainWindow::updateStreamState() {
             m_startStreamBtn->setEnabled(false);
             break;
             
+        case StreamState::Standby:
+            m_statusLabel->setText("Standby");
+            m_startStreamBtn->setText("Go Live");
+            m_startStreamBtn->setEnabled(true);
+            break;
+            
         case StreamState::Streaming:
             m_statusLabel->setText("Live");
             m_statusLabel->setObjectName("successLabel");
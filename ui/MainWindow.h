@@ -4,13 +4,17 @@
 // Professional OBS-like streaming interface
 // ==============================================================================
 
+#include <ActivityMailbox.h>
+
 #include <QMainWindow>
 #include <QTimer>
+#include <QElapsedTimer>
 
 class QListWidget;
 class QListWidgetItem;
 class QLabel;
 class QLineEdit;
+class QSpinBox;
 class QPushButton;
 class QDockWidget;
 
@@ -37,6 +41,7 @@ public:
 private slots:
     // Scene management
     void onSceneSelected(QListWidgetItem* current, QListWidgetItem* previous);
+    void onSceneHovered(QListWidgetItem* item);
     void onAddScene();
     void onRemoveScene();
     
@@ -70,6 +75,7 @@ private:
     void refreshScenesList();
     void refreshSourcesList();
     void updateStreamButton();
+    void finishStopStreaming();
     
     // Central widget
     PreviewWidget* m_previewWidget = nullptr;
@@ -92,6 +98,10 @@ private:
     // Controls dock widgets
     QLineEdit* m_streamUrlEdit = nullptr;
     QLineEdit* m_streamKeyEdit = nullptr;
+    QSpinBox* m_streamDelaySpin = nullptr;
+    QLineEdit* m_bondReceiverEdit = nullptr;
+    QLineEdit* m_bondSecretEdit = nullptr;
+    QLineEdit* m_bondLinksEdit = nullptr;
     QPushButton* m_startStreamBtn = nullptr;
     QPushButton* m_settingsBtn = nullptr;
     
@@ -103,6 +113,15 @@ private:
     
     // Timers
     QTimer* m_statsTimer = nullptr;
+    
+    // Render/encode/send summaries gathered since the last statistics update
+    ActivitySummary m_renderActivity;
+    ActivitySummary m_encodeActivity;
+    ActivitySummary m_sendActivity;
+    QElapsedTimer m_activityWindow;
+    
+    // Stop requested; the broadcast delay is still sending its tail
+    bool m_drainingDelay = false;
 };
 
 } // namespace WeaR
@@ -4,8 +4,12 @@
 
 #include "PreviewWidget.h"
 
+#include <SceneManager.h>
+
 #include <QPainter>
 #include <QResizeEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 
 namespace WeaR {
 
@@ -23,7 +27,11 @@ PreviewWidget::PreviewWidget(QWidget* parent)
     setAutoFillBackground(false);
 }
 
-PreviewWidget::~PreviewWidget() = default;
+PreviewWidget::~PreviewWidget() {
+    if (m_renderConsumer) {
+        SceneManager::instance().releaseRenderConsumer(QStringLiteral("Preview"));
+    }
+}
 
 double PreviewWidget::aspectRatio() const {
     QMutexLocker lock(&m_mutex);
@@ -98,6 +106,25 @@ void PreviewWidget::resizeEvent(QResizeEvent* /*event*/) {
     m_needsScaling = true;
 }
 
+void PreviewWidget::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    
+    // Includes spontaneous events, e.g. restoring a minimized window
+    if (!m_renderConsumer) {
+        m_renderConsumer = true;
+        SceneManager::instance().acquireRenderConsumer(QStringLiteral("Preview"));
+    }
+}
+
+void PreviewWidget::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    
+    if (m_renderConsumer) {
+        m_renderConsumer = false;
+        SceneManager::instance().releaseRenderConsumer(QStringLiteral("Preview"));
+    }
+}
+
 void PreviewWidget::recalculateTargetRect() {
     if (m_frame.isNull()) {
         m_targetRect = rect();
@@ -15,6 +15,9 @@ namespace WeaR {
  * 
  * Displays video frames from the SceneManager. Optimized for
  * minimal overhead using opaque paint events.
+ * 
+ * Counts as a render consumer only while shown, so a hidden or
+ * minimized preview lets the render loop idle.
  */
 class PreviewWidget : public QWidget {
     Q_OBJECT
@@ -68,6 +71,8 @@ public slots:
 protected:
     void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 private:
     QImage m_frame;
@@ -77,6 +82,7 @@ private:
     
     bool m_keepAspectRatio = true;
     bool m_needsScaling = true;
+    bool m_renderConsumer = false;  ///< Registered with SceneManager while visible
     
     void recalculateTargetRect();
 };
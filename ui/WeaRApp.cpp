@@ -4,6 +4,7 @@
 // ==============================================================================
 
 #include "WeaRApp.h"
+#include "ThreadPolicy.h"
 
 #include <QStyleFactory>
 #include <QFont>
@@ -20,6 +21,9 @@ WeaRApp::WeaRApp(int& argc, char** argv)
     setOrganizationName(QStringLiteral("WeaR-studio"));
     setOrganizationDomain(QStringLiteral("wear-studio.com"));
     
+    // Before any pipeline thread starts and applies its role
+    ThreadPolicy::instance().loadSettings();
+    
     // Setup the dark theme
     setupDarkTheme();
     setupStylesheet();